@@ -0,0 +1,204 @@
+﻿#include "BlockSpriteCache.h"
+#include "RenderStats.h"
+#include <cmath>
+
+BlockSpriteCache::BlockSpriteCache(IsometricRenderer* isoRenderer)
+    : m_isoRenderer(isoRenderer),
+    m_bakeRenderer(isoRenderer->getTileWidth(), isoRenderer->getTileHeight()),
+    m_levelAtlas(ATLAS_PAGE_SIZE, LEVEL_ATLAS_MAX_PAGES),
+    m_exactAtlas(ATLAS_PAGE_SIZE, ATLAS_MAX_PAGES),
+    m_levelAtlasDirty(true), m_exactAtlasDirty(true),
+    m_exactZoom(0.0f), m_biomeType(-1), m_bakesLeft(MAX_BAKES_PER_FRAME) {
+}
+
+BlockSpriteCache::~BlockSpriteCache() {
+}
+
+void BlockSpriteCache::beginFrame() {
+    float zoom = m_isoRenderer->getCameraZoom();
+    m_zoomChain.update(zoom);
+    m_bakesLeft = MAX_BAKES_PER_FRAME;
+
+    // Спрайты точного масштаба нужны только при нем; уровни остаются
+    if (zoom != m_exactZoom) {
+        m_exactSprites.clear();
+        m_exactAtlasDirty = true;
+        m_exactZoom = zoom;
+    }
+}
+
+bool BlockSpriteCache::draw(SDL_Renderer* renderer, const TilePalette& palette, Uint16 paletteIndex,
+    float worldX, float worldY, float height, Uint8 faceMask,
+    int centerX, int centerY) {
+    // 1. Кэшируем только постоянные непрозрачные записи: у полупрозрачных
+    // контуры смешиваются с гранями, и копия из атласа дала бы другой цвет
+    if (paletteIndex >= TilePalette::TYPE_ENTRY_COUNT || faceMask == 0) {
+        return false;
+    }
+
+    // Программный растеризатор рисует весь мир в свой кадровый буфер - копии из атласа нарушили бы порядок
+    if (m_isoRenderer->getFaceBackend() == IsometricRenderer::FaceBackend::SOFTWARE) {
+        return false;
+    }
+
+    const TilePalette::Entry& colors = palette.get(paletteIndex);
+    if (colors.top.a != 255 || colors.left.a != 255 || colors.right.a != 255) {
+        return false;
+    }
+
+    int heightOffset = m_isoRenderer->getHeightInPixels(height);
+    if (heightOffset <= 0 || heightOffset > 0xFFFF || !m_levelAtlas.supportsRendering(renderer)) {
+        return false;
+    }
+
+    // 2. Атласы действительны для одного биома
+    if (palette.getBiomeType() != m_biomeType) {
+        m_levelSprites.clear();
+        m_exactSprites.clear();
+        m_levelAtlasDirty = true;
+        m_exactAtlasDirty = true;
+        m_biomeType = palette.getBiomeType();
+    }
+
+    if (m_levelAtlasDirty) {
+        m_levelAtlas.clear(renderer);
+        m_levelAtlasDirty = false;
+    }
+    if (m_exactAtlasDirty) {
+        m_exactAtlas.clear(renderer);
+        m_exactAtlasDirty = false;
+    }
+
+    // 3. Ищем спрайт точного масштаба; если масштаб совпадает с уровнем, он хранится в атласе уровней
+    float zoom = m_isoRenderer->getCameraZoom();
+    int level = ZoomMipChain::nearestLevelIndex(zoom);
+    float levelZoom = ZoomMipChain::getLevel(level);
+    bool exactIsLevel = zoom == levelZoom;
+
+    const Sprite* sprite = nullptr;
+    if (exactIsLevel) {
+        sprite = findOrBake(renderer, m_levelSprites, m_levelAtlas, makeKey(level, heightOffset, faceMask, paletteIndex),
+            colors, height, zoom, heightOffset, faceMask, true);
+    }
+    else {
+        sprite = findOrBake(renderer, m_exactSprites, m_exactAtlas, makeKey(0, heightOffset, faceMask, paletteIndex),
+            colors, height, zoom, heightOffset, faceMask, m_zoomChain.isStill());
+    }
+
+    // 4. Пока масштаб меняется, растягиваем спрайт ближайшего уровня
+    float scale = 1.0f;
+    if (!sprite && !exactIsLevel) {
+        m_bakeRenderer.setCameraZoom(levelZoom);
+        int levelHeightOffset = m_bakeRenderer.getHeightInPixels(height);
+        if (levelHeightOffset > 0) {
+            sprite = findOrBake(renderer, m_levelSprites, m_levelAtlas,
+                makeKey(level, levelHeightOffset, faceMask, paletteIndex),
+                colors, height, levelZoom, levelHeightOffset, faceMask, true);
+            scale = zoom / levelZoom;
+        }
+    }
+
+    // Бюджет запеканий исчерпан - блок рисуется напрямую
+    if (!sprite) {
+        return false;
+    }
+
+    SDL_Texture* page = sprite->atlas->getPageTexture(sprite->region.page);
+    if (!page) {
+        return false;
+    }
+
+    // 5. Выводим накопленные грани, чтобы сохранить порядок отрисовки, и копируем спрайт
+    m_isoRenderer->flush(renderer);
+
+    int baseX, baseY;
+    m_isoRenderer->worldToScreen(worldX, worldY, baseX, baseY);
+
+    SDL_Rect dst = {
+        baseX + centerX - sprite->anchorX,
+        baseY + centerY - sprite->anchorY,
+        sprite->region.rect.w, sprite->region.rect.h
+    };
+    if (scale != 1.0f) {
+        // Края округляются от вершины основания, как у неподвижного спрайта
+        int left = baseX + centerX - static_cast<int>(std::lround(sprite->anchorX * scale));
+        int top = baseY + centerY - static_cast<int>(std::lround(sprite->anchorY * scale));
+        int right = baseX + centerX + static_cast<int>(std::lround((sprite->region.rect.w - sprite->anchorX) * scale));
+        int bottom = baseY + centerY + static_cast<int>(std::lround((sprite->region.rect.h - sprite->anchorY) * scale));
+        dst = { left, top, right - left, bottom - top };
+    }
+
+    SDL_RenderCopy(renderer, page, &sprite->region.rect, &dst);
+    RenderStats::getInstance().addDrawCalls();
+    RenderStats::getInstance().addCachedSprite();
+    return true;
+}
+
+void BlockSpriteCache::invalidate() {
+    m_levelSprites.clear();
+    m_exactSprites.clear();
+
+    // Страницы пересоздаются при следующей отрисовке: после сброса устройства старые недействительны
+    m_levelAtlas.releaseTextures();
+    m_exactAtlas.releaseTextures();
+    m_levelAtlasDirty = true;
+    m_exactAtlasDirty = true;
+}
+
+const BlockSpriteCache::Sprite* BlockSpriteCache::findOrBake(SDL_Renderer* renderer,
+    std::unordered_map<Uint32, Sprite>& sprites, TextureAtlas& atlas, Uint32 key,
+    const TilePalette::Entry& colors, float height, float zoom, int heightOffset, Uint8 faceMask,
+    bool allowBake) {
+    auto it = sprites.find(key);
+    if (it == sprites.end()) {
+        if (!allowBake || m_bakesLeft <= 0) {
+            return nullptr;
+        }
+
+        m_bakesLeft--;
+        Sprite sprite;
+        sprite.atlas = &atlas;
+        bakeSprite(renderer, atlas, colors, height, zoom, heightOffset, faceMask, sprite);
+        it = sprites.emplace(key, sprite).first;
+    }
+
+    // Спрайт, не поместившийся в атлас, до следующего сброса рисуется напрямую
+    return it->second.region.isValid() ? &it->second : nullptr;
+}
+
+void BlockSpriteCache::bakeSprite(SDL_Renderer* renderer, TextureAtlas& atlas,
+    const TilePalette::Entry& colors, float height, float zoom,
+    int heightOffset, Uint8 faceMask, Sprite& sprite) {
+    // 1. Размер спрайта: силуэт блока с запасом в пиксель на контуры
+    int halfWidth = static_cast<int>(m_isoRenderer->getTileWidth() * zoom) / 2;
+    int scaledTileHeight = static_cast<int>(m_isoRenderer->getTileHeight() * zoom);
+
+    sprite.anchorX = halfWidth + 1;
+    sprite.anchorY = heightOffset + 1;
+
+    // 2. Место в атласе; если его нет, до следующего сброса такой блок рисуется напрямую
+    sprite.region = atlas.allocate(renderer, halfWidth * 2 + 3, heightOffset + scaledTileHeight + 3);
+    if (!sprite.region.isValid()) {
+        return;
+    }
+
+    // 3. Рисуем блок в атлас эталонным растеризатором (координаты - от угла области)
+    SDL_BlendMode previousBlendMode;
+    SDL_GetRenderDrawBlendMode(renderer, &previousBlendMode);
+
+    if (!atlas.beginRender(renderer, sprite.region)) {
+        sprite.region = TextureAtlas::Region();
+        return;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    m_bakeRenderer.setCameraPosition(0.0f, 0.0f);
+    m_bakeRenderer.setCameraZoom(zoom);
+    m_bakeRenderer.setFaceBackend(m_isoRenderer->getFaceBackend());
+    m_bakeRenderer.renderVolumetricTile(renderer, 0.0f, 0.0f, height, colors,
+        sprite.anchorX, sprite.anchorY, faceMask);
+    m_bakeRenderer.flush(renderer);
+
+    atlas.endRender(renderer);
+    SDL_SetRenderDrawBlendMode(renderer, previousBlendMode);
+}
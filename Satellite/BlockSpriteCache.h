@@ -0,0 +1,151 @@
+﻿#pragma once
+
+#include "IsometricRenderer.h"
+#include "TilePalette.h"
+#include "TextureAtlas.h"
+#include "ZoomMipChain.h"
+#include <SDL.h>
+#include <unordered_map>
+
+/**
+ * @brief Кэш заранее отрисованных объемных блоков
+ *
+ * Стены, скалы, лава и другие непрозрачные блоки встречаются в небольшом
+ * числе сочетаний (тип тайла, высота в пикселях, маска граней). Каждое
+ * сочетание один раз рисуется в атлас TextureAtlas через
+ * IsometricRenderer::renderVolumetricTile, после чего блок выводится одним
+ * SDL_RenderCopy.
+ *
+ * Спрайты уровней ZoomMipChain хранятся в отдельном атласе, который
+ * очищается только при смене биома. Пока масштаб меняется, блоки выводятся
+ * растянутыми спрайтами ближайшего уровня; спрайты точного масштаба
+ * запекаются во второй атлас, когда масштаб устоялся, и сбрасываются при
+ * следующем его изменении. За кадр запекается не больше MAX_BAKES_PER_FRAME
+ * спрайтов, остальные блоки до следующих кадров рисуются напрямую.
+ */
+class BlockSpriteCache {
+public:
+    static constexpr int ATLAS_PAGE_SIZE = 1024;  ///< Сторона страницы атласа в пикселях
+    static constexpr int ATLAS_MAX_PAGES = 2;     ///< Максимальное количество страниц атласа точного масштаба
+    static constexpr int LEVEL_ATLAS_MAX_PAGES = 4; ///< Максимальное количество страниц атласа уровней
+    static constexpr int MAX_BAKES_PER_FRAME = 32; ///< Запеканий спрайтов за кадр
+
+    /**
+     * @brief Конструктор
+     * @param isoRenderer Указатель на основной изометрический рендерер
+     */
+    BlockSpriteCache(IsometricRenderer* isoRenderer);
+
+    /**
+     * @brief Деструктор
+     */
+    ~BlockSpriteCache();
+
+    BlockSpriteCache(const BlockSpriteCache&) = delete;
+    BlockSpriteCache& operator=(const BlockSpriteCache&) = delete;
+
+    /**
+     * @brief Начало кадра: учет масштаба камеры и сброс бюджета запеканий
+     */
+    void beginFrame();
+
+    /**
+     * @brief Отрисовка объемного блока из атласа
+     *
+     * Кэшируются только непрозрачные записи палитры, соответствующие типам
+     * тайлов. Для остальных (и при исчерпанном бюджете запеканий) метод
+     * возвращает false, и блок нужно нарисовать обычным способом.
+     *
+     * @param renderer SDL рендерер
+     * @param palette Палитра цветов граней
+     * @param paletteIndex Индекс записи палитры
+     * @param worldX X координата в мировом пространстве
+     * @param worldY Y координата в мировом пространстве
+     * @param height Высота блока
+     * @param faceMask Маска видимых граней
+     * @param centerX X координата центра экрана
+     * @param centerY Y координата центра экрана
+     * @return true, если блок выведен из атласа
+     */
+    bool draw(SDL_Renderer* renderer, const TilePalette& palette, Uint16 paletteIndex,
+        float worldX, float worldY, float height, Uint8 faceMask,
+        int centerX, int centerY);
+
+    /**
+     * @brief Сброс всех спрайтов и освобождение атласов
+     *
+     * Нужен после потери текстур-целей (SDL_RENDER_TARGETS_RESET,
+     * SDL_RENDER_DEVICE_RESET); атласы создаются заново при следующей отрисовке.
+     */
+    void invalidate();
+
+private:
+    /**
+     * @brief Положение спрайта в атласе
+     */
+    struct Sprite {
+        TextureAtlas* atlas;          ///< Атлас, в котором лежит спрайт
+        TextureAtlas::Region region;  ///< Область атласа (невалидная - спрайт не поместился, рисуется напрямую)
+        int anchorX;                  ///< Смещение верхней вершины основания от левого края спрайта
+        int anchorY;                  ///< Смещение верхней вершины основания от верхнего края спрайта
+    };
+
+    /**
+     * @brief Ключ спрайта
+     * @param level Номер уровня масштаба (0 для атласа точного масштаба)
+     * @param heightOffset Высота блока в пикселях при масштабе спрайта
+     * @param faceMask Маска видимых граней
+     * @param paletteIndex Индекс записи палитры
+     * @return Ключ; вид блока полностью определяется высотой в пикселях при данном масштабе
+     */
+    static Uint32 makeKey(int level, int heightOffset, Uint8 faceMask, Uint16 paletteIndex) {
+        return (static_cast<Uint32>(level) << 27) | (static_cast<Uint32>(heightOffset) << 11) |
+            (static_cast<Uint32>(faceMask) << 8) | paletteIndex;
+    }
+
+    /**
+     * @brief Поиск спрайта с запеканием недостающего в пределах бюджета
+     * @param renderer SDL рендерер
+     * @param sprites Спрайты атласа
+     * @param atlas Атлас
+     * @param key Ключ спрайта
+     * @param colors Запись палитры
+     * @param height Высота блока
+     * @param zoom Масштаб спрайта
+     * @param heightOffset Высота блока в пикселях при масштабе спрайта
+     * @param faceMask Маска видимых граней
+     * @param allowBake Разрешено запекание недостающего спрайта
+     * @return Спрайт или nullptr, если его нет или он не поместился в атлас
+     */
+    const Sprite* findOrBake(SDL_Renderer* renderer, std::unordered_map<Uint32, Sprite>& sprites,
+        TextureAtlas& atlas, Uint32 key, const TilePalette::Entry& colors, float height, float zoom,
+        int heightOffset, Uint8 faceMask, bool allowBake);
+
+    /**
+     * @brief Размещение и отрисовка нового спрайта в атласе
+     * @param renderer SDL рендерер
+     * @param atlas Атлас
+     * @param colors Запись палитры
+     * @param height Высота блока
+     * @param zoom Масштаб спрайта
+     * @param heightOffset Высота блока в пикселях
+     * @param faceMask Маска видимых граней
+     * @param sprite Заполняемое описание спрайта
+     */
+    void bakeSprite(SDL_Renderer* renderer, TextureAtlas& atlas, const TilePalette::Entry& colors,
+        float height, float zoom, int heightOffset, Uint8 faceMask, Sprite& sprite);
+
+    IsometricRenderer* m_isoRenderer;        ///< Основной изометрический рендерер
+    IsometricRenderer m_bakeRenderer;        ///< Рендерер для отрисовки в атлас (камера в начале координат)
+    TextureAtlas m_levelAtlas;               ///< Атлас спрайтов уровней масштаба
+    TextureAtlas m_exactAtlas;               ///< Атлас спрайтов точного масштаба
+    bool m_levelAtlasDirty;                  ///< Атлас уровней нужно очистить перед следующим спрайтом
+    bool m_exactAtlasDirty;                  ///< Атлас точного масштаба нужно очистить перед следующим спрайтом
+
+    float m_exactZoom;                       ///< Масштаб, для которого заполнен атлас точного масштаба
+    int m_biomeType;                         ///< Биом палитры, для которого заполнены атласы
+    ZoomMipChain m_zoomChain;                ///< Отслеживание устоявшегося масштаба
+    int m_bakesLeft;                         ///< Оставшийся бюджет запеканий кадра
+    std::unordered_map<Uint32, Sprite> m_levelSprites; ///< Спрайты уровней по (уровень, высота, маска граней, индекс палитры)
+    std::unordered_map<Uint32, Sprite> m_exactSprites; ///< Спрайты точного масштаба по (высота, маска граней, индекс палитры)
+};
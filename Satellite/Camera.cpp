@@ -3,7 +3,7 @@
 #include <iostream>
 
 Camera::Camera(int screenWidth, int screenHeight)
-    : m_x(0.0f), m_y(0.0f), m_zoom(1.0f),
+    : m_x(0.0f), m_y(0.0f), m_prevX(0.0f), m_prevY(0.0f), m_zoom(1.0f),
     m_screenWidth(screenWidth), m_screenHeight(screenHeight),
     m_moveSpeed(5.0f), m_zoomSpeed(0.1f),
     m_targetX(nullptr), m_targetY(nullptr),
@@ -15,6 +15,10 @@ Camera::~Camera() {
 }
 
 void Camera::update(float deltaTime) {
+    // Запоминаем положение для интерполяции при отрисовке
+    m_prevX = m_x;
+    m_prevY = m_y;
+
     // Если есть целевой объект для слежения
     if (m_targetX && m_targetY) {
         // Проверка на NaN
@@ -69,12 +73,18 @@ void Camera::handleEvent(const SDL_Event& event) {
         // Устанавливаем новую позицию камеры
         m_x = m_dragStartCamX - worldDx;
         m_y = m_dragStartCamY - worldDy;
+
+        // Перетаскивание следует за мышью без задержки интерполяции
+        m_prevX = m_x;
+        m_prevY = m_y;
     }
 }
 
 void Camera::setPosition(float x, float y) {
     m_x = x;
     m_y = y;
+    m_prevX = x;
+    m_prevY = y;
 }
 
 void Camera::setZoom(float scale) {
@@ -50,6 +50,23 @@ public:
      */
     float getY() const { return m_y; }
 
+    /**
+     * @brief Получение X координаты камеры для отрисовки
+     *
+     * Положение интерполируется между двумя последними шагами update().
+     *
+     * @param alpha Коэффициент интерполяции [0, 1]
+     * @return X координата в мировом пространстве
+     */
+    float getRenderX(float alpha) const { return m_prevX + (m_x - m_prevX) * alpha; }
+
+    /**
+     * @brief Получение Y координаты камеры для отрисовки
+     * @param alpha Коэффициент интерполяции [0, 1]
+     * @return Y координата в мировом пространстве
+     */
+    float getRenderY(float alpha) const { return m_prevY + (m_y - m_prevY) * alpha; }
+
     /**
      * @brief Установка масштаба камеры
      * @param scale Масштаб (1.0 - нормальный размер)
@@ -116,6 +133,8 @@ public:
 private:
     float m_x;                  ///< X координата камеры в мировом пространстве
     float m_y;                  ///< Y координата камеры в мировом пространстве
+    float m_prevX;              ///< X координата на предыдущем шаге update()
+    float m_prevY;              ///< Y координата на предыдущем шаге update()
     float m_zoom;               ///< Масштаб камеры
 
     int m_screenWidth;          ///< Ширина экрана
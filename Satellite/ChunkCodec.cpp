@@ -0,0 +1,295 @@
+﻿#include "ChunkCodec.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const int LZ_MIN_MATCH = 4;        ///< Наименьшая длина совпадения
+    const int LZ_HASH_BITS = 10;       ///< Размер хэш-таблицы кодера (log2)
+    const int LZ_LENGTH_LIMIT = 15;    ///< Длина, после которой в токене нужны дополнительные байты
+
+    Uint32 read32(const Uint8* data) {
+        Uint32 value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    int hash32(Uint32 value) {
+        return static_cast<int>((value * 2654435761u) >> (32 - LZ_HASH_BITS));
+    }
+
+    /**
+     * @brief Запись длины сверх LZ_LENGTH_LIMIT байтами 255 и остатком
+     * @return false, если не хватает места
+     */
+    bool writeLength(int length, Uint8*& dst, const Uint8* end) {
+        length -= LZ_LENGTH_LIMIT;
+        while (length >= 255) {
+            if (dst >= end) {
+                return false;
+            }
+            *dst++ = 255;
+            length -= 255;
+        }
+        if (dst >= end) {
+            return false;
+        }
+        *dst++ = static_cast<Uint8>(length);
+        return true;
+    }
+
+    /**
+     * @brief Чтение длины, продолженной байтами после токена
+     * @return false, если данные закончились
+     */
+    bool readLength(int& length, const Uint8*& src, const Uint8* end) {
+        Uint8 value;
+        do {
+            if (src >= end) {
+                return false;
+            }
+            value = *src++;
+            length += value;
+        } while (value == 255);
+        return true;
+    }
+
+    /**
+     * @brief Запись последовательности: литералы и (кроме последней) совпадение
+     * @return false, если не хватает места
+     */
+    bool writeSequence(const Uint8* literals, int literalLength, int offset, int matchLength,
+        Uint8*& dst, const Uint8* end) {
+        if (dst >= end) {
+            return false;
+        }
+
+        Uint8* token = dst++;
+        int matchCode = matchLength > 0 ? matchLength - LZ_MIN_MATCH : 0;
+        *token = static_cast<Uint8>((std::min(literalLength, LZ_LENGTH_LIMIT) << 4) |
+            std::min(matchCode, LZ_LENGTH_LIMIT));
+
+        if (literalLength >= LZ_LENGTH_LIMIT && !writeLength(literalLength, dst, end)) {
+            return false;
+        }
+        if (literalLength > end - dst) {
+            return false;
+        }
+        std::memcpy(dst, literals, literalLength);
+        dst += literalLength;
+
+        if (matchLength == 0) {
+            return true;
+        }
+
+        if (end - dst < 2) {
+            return false;
+        }
+        *dst++ = static_cast<Uint8>(offset & 0xFF);
+        *dst++ = static_cast<Uint8>(offset >> 8);
+
+        return matchCode < LZ_LENGTH_LIMIT || writeLength(matchCode, dst, end);
+    }
+}
+
+constexpr int ChunkCodec::PLANE_HEADER_SIZE;
+constexpr int ChunkCodec::MAX_ENCODED_SIZE;
+
+void ChunkCodec::encode(const TileChunk& chunk, std::vector<Uint8>& out) {
+    encodePlane(chunk.types, out);
+    encodePlane(chunk.flags, out);
+    encodePlane(chunk.heights, out);
+}
+
+bool ChunkCodec::decode(const Uint8* data, size_t size, TileChunk& chunk) {
+    const Uint8* end = data + size;
+    data = decodePlane(data, end, chunk.types);
+    data = data ? decodePlane(data, end, chunk.flags) : nullptr;
+    data = data ? decodePlane(data, end, chunk.heights) : nullptr;
+    return data && data == end;
+}
+
+size_t ChunkCodec::encodeRLE(const Uint8* src, int count, Uint8* dst, size_t capacity) {
+    size_t size = 0;
+    int i = 0;
+    while (i < count) {
+        Uint8 value = src[i];
+        int run = 1;
+        while (i + run < count && run < 256 && src[i + run] == value) {
+            run++;
+        }
+
+        if (size + 2 > capacity) {
+            return 0;
+        }
+        dst[size++] = static_cast<Uint8>(run - 1);
+        dst[size++] = value;
+        i += run;
+    }
+    return size;
+}
+
+bool ChunkCodec::decodeRLE(const Uint8* src, size_t size, Uint8* dst, int count) {
+    if (size % 2 != 0) {
+        return false;
+    }
+
+    int written = 0;
+    for (size_t i = 0; i < size; i += 2) {
+        int run = src[i] + 1;
+        if (run > count - written) {
+            return false;
+        }
+        std::memset(dst + written, src[i + 1], run);
+        written += run;
+    }
+    return written == count;
+}
+
+size_t ChunkCodec::encodeLZ(const Uint8* src, int count, Uint8* dst, size_t capacity) {
+    int table[1 << LZ_HASH_BITS];
+    std::fill(table, table + (1 << LZ_HASH_BITS), -1);
+
+    Uint8* out = dst;
+    const Uint8* end = dst + capacity;
+    int anchor = 0;
+    int i = 0;
+
+    // 1. Жадный поиск: кандидат - последняя позиция с тем же хэшем четырех байт
+    while (i + LZ_MIN_MATCH <= count) {
+        Uint32 sequence = read32(src + i);
+        int hash = hash32(sequence);
+        int candidate = table[hash];
+        table[hash] = i;
+
+        if (candidate < 0 || i - candidate > 0xFFFF || read32(src + candidate) != sequence) {
+            i++;
+            continue;
+        }
+
+        // Совпадение может перекрывать текущую позицию - так кодируются серии
+        int length = LZ_MIN_MATCH;
+        while (i + length < count && src[candidate + length] == src[i + length]) {
+            length++;
+        }
+
+        if (!writeSequence(src + anchor, i - anchor, i - candidate, length, out, end)) {
+            return 0;
+        }
+        i += length;
+        anchor = i;
+    }
+
+    // 2. Последняя последовательность - только литералы
+    if (!writeSequence(src + anchor, count - anchor, 0, 0, out, end)) {
+        return 0;
+    }
+    return static_cast<size_t>(out - dst);
+}
+
+bool ChunkCodec::decodeLZ(const Uint8* src, size_t size, Uint8* dst, int count) {
+    const Uint8* end = src + size;
+    int written = 0;
+
+    while (src < end) {
+        Uint8 token = *src++;
+
+        // 1. Литералы
+        int literalLength = token >> 4;
+        if (literalLength == LZ_LENGTH_LIMIT && !readLength(literalLength, src, end)) {
+            return false;
+        }
+        if (literalLength > count - written || literalLength > end - src) {
+            return false;
+        }
+        std::memcpy(dst + written, src, literalLength);
+        written += literalLength;
+        src += literalLength;
+
+        // Последняя последовательность совпадения не содержит
+        if (src == end) {
+            break;
+        }
+
+        // 2. Совпадение (копируется побайтно: источник может перекрывать результат)
+        if (end - src < 2) {
+            return false;
+        }
+        int offset = src[0] | (src[1] << 8);
+        src += 2;
+
+        int matchLength = token & 0x0F;
+        if (matchLength == LZ_LENGTH_LIMIT && !readLength(matchLength, src, end)) {
+            return false;
+        }
+        matchLength += LZ_MIN_MATCH;
+
+        if (offset == 0 || offset > written || matchLength > count - written) {
+            return false;
+        }
+        const Uint8* match = dst + written - offset;
+        for (int i = 0; i < matchLength; ++i) {
+            dst[written + i] = match[i];
+        }
+        written += matchLength;
+    }
+
+    return written == count;
+}
+
+void ChunkCodec::encodePlane(const Uint8* plane, std::vector<Uint8>& out) {
+    // Сжатый блок, не меньший исходного, хранится без сжатия
+    Uint8 rle[TileChunk::AREA];
+    Uint8 lz[TileChunk::AREA];
+    size_t rleSize = encodeRLE(plane, TileChunk::AREA, rle, sizeof(rle) - 1);
+    size_t lzSize = encodeLZ(plane, TileChunk::AREA, lz, sizeof(lz) - 1);
+
+    Method method = Method::RAW;
+    const Uint8* payload = plane;
+    size_t size = TileChunk::AREA;
+    if (rleSize > 0 && rleSize < size) {
+        method = Method::RLE;
+        payload = rle;
+        size = rleSize;
+    }
+    if (lzSize > 0 && lzSize < size) {
+        method = Method::LZ;
+        payload = lz;
+        size = lzSize;
+    }
+
+    out.push_back(static_cast<Uint8>(method));
+    out.push_back(static_cast<Uint8>(size & 0xFF));
+    out.push_back(static_cast<Uint8>(size >> 8));
+    out.insert(out.end(), payload, payload + size);
+}
+
+const Uint8* ChunkCodec::decodePlane(const Uint8* data, const Uint8* end, Uint8* plane) {
+    if (end - data < PLANE_HEADER_SIZE) {
+        return nullptr;
+    }
+
+    Method method = static_cast<Method>(data[0]);
+    size_t size = data[1] | (data[2] << 8);
+    data += PLANE_HEADER_SIZE;
+    if (size > static_cast<size_t>(end - data)) {
+        return nullptr;
+    }
+
+    bool decoded = false;
+    switch (method) {
+    case Method::RAW:
+        decoded = size == TileChunk::AREA;
+        if (decoded) {
+            std::memcpy(plane, data, TileChunk::AREA);
+        }
+        break;
+    case Method::RLE:
+        decoded = decodeRLE(data, size, plane, TileChunk::AREA);
+        break;
+    case Method::LZ:
+        decoded = decodeLZ(data, size, plane, TileChunk::AREA);
+        break;
+    }
+
+    return decoded ? data + size : nullptr;
+}
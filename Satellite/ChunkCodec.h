@@ -0,0 +1,109 @@
+﻿#pragma once
+
+#include "TileChunk.h"
+#include <SDL.h>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Сжатие чанков карты
+ *
+ * Каждая плоскость чанка (типы, флаги, высоты) сжимается отдельно тем
+ * способом, который дает меньший размер: RLE для длинных серий одного
+ * значения (пустота, стены, пол биома), LZ для повторяющихся узоров или
+ * без сжатия. Блок плоскости - байт способа, длина данных (Uint16,
+ * little-endian) и сами данные; чанк - три блока подряд. Каждый чанк
+ * кодируется независимо, поэтому его можно распаковать по требованию,
+ * не трогая соседей.
+ *
+ * LZ - вариант формата блоков LZ4: токен с длинами литералов и совпадения,
+ * литералы, смещение совпадения (Uint16). Декодеры проверяют все границы
+ * и годятся для данных из файла.
+ */
+class ChunkCodec {
+public:
+    /**
+     * @brief Способ сжатия плоскости
+     */
+    enum class Method : Uint8 {
+        RAW = 0,   ///< Без сжатия
+        RLE = 1,   ///< Пары (длина серии - 1, значение)
+        LZ = 2     ///< Последовательности литералов и совпадений
+    };
+
+    static constexpr int PLANE_HEADER_SIZE = 3;  ///< Байт способа и длина данных
+    static constexpr int MAX_ENCODED_SIZE = 3 * (PLANE_HEADER_SIZE + TileChunk::AREA); ///< Наибольший размер сжатого чанка
+
+    /**
+     * @brief Сжатие чанка
+     * @param chunk Тайлы чанка
+     * @param out Буфер, в конец которого дописываются сжатые данные
+     */
+    static void encode(const TileChunk& chunk, std::vector<Uint8>& out);
+
+    /**
+     * @brief Распаковка чанка
+     * @param data Сжатые данные
+     * @param size Размер сжатых данных
+     * @param chunk Тайлы чанка (выходной параметр)
+     * @return true, если данные корректны и заняли ровно size байт
+     */
+    static bool decode(const Uint8* data, size_t size, TileChunk& chunk);
+
+    /**
+     * @brief Сжатие RLE
+     * @param src Исходные байты
+     * @param count Количество исходных байт
+     * @param dst Буфер результата
+     * @param capacity Размер буфера
+     * @return Размер результата или 0, если он не помещается в буфер
+     */
+    static size_t encodeRLE(const Uint8* src, int count, Uint8* dst, size_t capacity);
+
+    /**
+     * @brief Распаковка RLE
+     * @param src Сжатые данные
+     * @param size Размер сжатых данных
+     * @param dst Буфер результата
+     * @param count Ожидаемое количество байт результата
+     * @return true, если получено ровно count байт
+     */
+    static bool decodeRLE(const Uint8* src, size_t size, Uint8* dst, int count);
+
+    /**
+     * @brief Сжатие LZ
+     * @param src Исходные байты (не больше 65535 - смещения хранятся в Uint16)
+     * @param count Количество исходных байт
+     * @param dst Буфер результата
+     * @param capacity Размер буфера
+     * @return Размер результата или 0, если он не помещается в буфер
+     */
+    static size_t encodeLZ(const Uint8* src, int count, Uint8* dst, size_t capacity);
+
+    /**
+     * @brief Распаковка LZ
+     * @param src Сжатые данные
+     * @param size Размер сжатых данных
+     * @param dst Буфер результата
+     * @param count Ожидаемое количество байт результата
+     * @return true, если получено ровно count байт
+     */
+    static bool decodeLZ(const Uint8* src, size_t size, Uint8* dst, int count);
+
+private:
+    /**
+     * @brief Сжатие одной плоскости наиболее выгодным способом
+     * @param plane Плоскость чанка (TileChunk::AREA байт)
+     * @param out Буфер, в конец которого дописывается блок
+     */
+    static void encodePlane(const Uint8* plane, std::vector<Uint8>& out);
+
+    /**
+     * @brief Распаковка одной плоскости
+     * @param data Начало блока
+     * @param end Конец сжатых данных
+     * @param plane Плоскость чанка (выходной параметр)
+     * @return Начало следующего блока или nullptr при ошибке
+     */
+    static const Uint8* decodePlane(const Uint8* data, const Uint8* end, Uint8* plane);
+};
@@ -0,0 +1,413 @@
+﻿#include "ChunkStreamer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+
+ChunkStreamer::ChunkStreamer(std::shared_ptr<TileMap> tileMap, ChunkLoader loader, ChunkSaver saver)
+    : m_tileMap(tileMap), m_loader(loader), m_saver(saver), m_listenerId(0),
+    m_loadRadius(DEFAULT_LOAD_RADIUS), m_evictRadius(DEFAULT_EVICT_RADIUS),
+    m_prefetchDistance(DEFAULT_PREFETCH_DISTANCE), m_chunkCountX(0), m_chunkCountY(0),
+    m_pendingCount(0), m_lastCenterX(-1), m_lastCenterY(-1), m_lastDirectionX(0), m_lastDirectionY(0),
+    m_applying(false), m_workerBusy(false), m_stopping(false) {
+    resetResidency(true);
+
+    if (m_tileMap) {
+        m_listenerId = m_tileMap->addChangeListener([this](int minX, int minY, int maxX, int maxY) {
+            onTilesChanged(minX, minY, maxX, maxY);
+        });
+    }
+
+    m_worker = std::thread(&ChunkStreamer::workerLoop, this);
+}
+
+ChunkStreamer::~ChunkStreamer() {
+    if (m_tileMap && m_listenerId != 0) {
+        m_tileMap->removeChangeListener(m_listenerId);
+    }
+
+    // Рабочий поток допишет очередь сохранения и завершится
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_loadQueue.clear();
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+    m_worker.join();
+}
+
+void ChunkStreamer::setRadii(int loadRadius, int evictRadius) {
+    m_loadRadius = std::max(0, loadRadius);
+    m_evictRadius = std::max(m_loadRadius + 1, evictRadius);
+    m_lastCenterX = -1;
+}
+
+void ChunkStreamer::resetResidency(bool resident) {
+    waitIdle(true);
+
+    int countX = m_tileMap ? m_tileMap->getChunkCountX() : 0;
+    int countY = m_tileMap ? m_tileMap->getChunkCountY() : 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_chunkCountX = countX;
+        m_chunkCountY = countY;
+    }
+
+    // Текущее содержимое карты нигде не сохранено, поэтому занимающие память
+    // чанки считаются измененными. Однородные чанки никогда не выгружаются,
+    // пока их не изменят, и сохранять их незачем
+    m_states.assign(static_cast<size_t>(countX) * countY, resident ? STATE_RESIDENT : 0);
+    m_trackedChunks.clear();
+    if (resident) {
+        for (int chunkY = 0; chunkY < countY; ++chunkY) {
+            for (int chunkX = 0; chunkX < countX; ++chunkX) {
+                if (m_tileMap->isChunkAllocated(chunkX, chunkY)) {
+                    int chunkIndex = chunkY * countX + chunkX;
+                    m_states[chunkIndex] |= STATE_DIRTY;
+                    trackChunk(chunkIndex);
+                }
+            }
+        }
+    }
+
+    m_pendingCount = 0;
+    m_lastCenterX = -1;
+    m_lastCenterY = -1;
+}
+
+void ChunkStreamer::update(float playerX, float playerY, float directionX, float directionY) {
+    if (!m_tileMap || m_states.empty()) {
+        return;
+    }
+
+    int centerX = std::max(0, std::min(m_chunkCountX - 1,
+        static_cast<int>(std::floor(playerX)) >> TileChunk::SHIFT));
+    int centerY = std::max(0, std::min(m_chunkCountY - 1,
+        static_cast<int>(std::floor(playerY)) >> TileChunk::SHIFT));
+
+    // Направление сводится к одному из восьми соседних чанков
+    const float DIRECTION_THRESHOLD = 0.38f;
+    int stepX = directionX > DIRECTION_THRESHOLD ? 1 : (directionX < -DIRECTION_THRESHOLD ? -1 : 0);
+    int stepY = directionY > DIRECTION_THRESHOLD ? 1 : (directionY < -DIRECTION_THRESHOLD ? -1 : 0);
+
+    // 1. Переносим в карту готовые чанки
+    applyLoaded(centerX, centerY);
+
+    // 2. Очереди пересчитываются, только когда игрок сменил чанк или направление
+    if (centerX == m_lastCenterX && centerY == m_lastCenterY &&
+        stepX == m_lastDirectionX && stepY == m_lastDirectionY) {
+        return;
+    }
+
+    m_lastCenterX = centerX;
+    m_lastCenterY = centerY;
+    m_lastDirectionX = stepX;
+    m_lastDirectionY = stepY;
+
+    evictFarChunks(centerX, centerY);
+    requestLoads(centerX, centerY, static_cast<float>(stepX), static_cast<float>(stepY));
+}
+
+void ChunkStreamer::flush() {
+    // Измененные чанки всегда отслеживаются
+    for (int chunkIndex : m_trackedChunks) {
+        if (m_states[chunkIndex] & STATE_DIRTY) {
+            queueSave(chunkIndex);
+            m_states[chunkIndex] &= ~STATE_DIRTY;
+        }
+    }
+
+    waitIdle(false);
+}
+
+bool ChunkStreamer::isChunkResident(int chunkX, int chunkY) const {
+    if (chunkX < 0 || chunkX >= m_chunkCountX || chunkY < 0 || chunkY >= m_chunkCountY) {
+        return false;
+    }
+    return (m_states[chunkY * m_chunkCountX + chunkX] & STATE_RESIDENT) != 0;
+}
+
+bool ChunkStreamer::readEvictedChunk(int chunkX, int chunkY, TileChunk& chunk) {
+    if (!m_loader || chunkX < 0 || chunkX >= m_chunkCountX || chunkY < 0 || chunkY >= m_chunkCountY) {
+        return false;
+    }
+
+    // Чанк сохраняется при выгрузке в рабочем потоке - дожидаемся записи
+    waitIdle(false);
+    return m_loader(chunkX, chunkY, chunkY * m_chunkCountX + chunkX, chunk);
+}
+
+void ChunkStreamer::workerLoop() {
+    while (true) {
+        SaveJob save;
+        int loadIndex = -1;
+        int chunkIndex = 0;
+        int chunkX = 0;
+        int chunkY = 0;
+
+        // 1. Ждем задание; сохранения идут раньше загрузок, чтобы
+        // повторно загружаемый чанк читался уже в записанном виде
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait(lock, [this]() {
+                return m_stopping || !m_saveQueue.empty() || !m_loadQueue.empty();
+            });
+
+            if (!m_saveQueue.empty()) {
+                save = std::move(m_saveQueue.front());
+                m_saveQueue.pop_front();
+                chunkIndex = save.chunkIndex;
+                chunkX = chunkIndex % m_chunkCountX;
+                chunkY = chunkIndex / m_chunkCountX;
+            }
+            else if (m_stopping) {
+                return;
+            }
+            else {
+                loadIndex = m_loadQueue.front();
+                m_loadQueue.pop_front();
+                chunkIndex = loadIndex;
+                chunkX = chunkIndex % m_chunkCountX;
+                chunkY = chunkIndex / m_chunkCountX;
+            }
+            m_workerBusy = true;
+        }
+
+        // 2. Выполняем задание без блокировки
+        std::unique_ptr<TileChunk> loaded;
+        if (save.chunk) {
+            if (m_saver && !m_saver(chunkX, chunkY, chunkIndex, *save.chunk)) {
+                LOG_WARNING("Failed to save chunk (" + std::to_string(chunkX) + ", " +
+                    std::to_string(chunkY) + ")");
+            }
+        }
+        else {
+            loaded.reset(new TileChunk());
+            if (!m_loader || !m_loader(chunkX, chunkY, chunkIndex, *loaded)) {
+                loaded.reset();
+            }
+        }
+
+        // 3. Отдаем результат основному потоку
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (loadIndex >= 0) {
+                m_results.push_back({ loadIndex, std::move(loaded) });
+            }
+            m_workerBusy = false;
+        }
+        m_idleCondition.notify_all();
+    }
+}
+
+void ChunkStreamer::onTilesChanged(int minX, int minY, int maxX, int maxY) {
+    if (m_applying) {
+        return;
+    }
+
+    if (minX == TileMap::ALL_TILES) {
+        // Карта заполнена заново: прежние очереди относятся к старому содержимому
+        resetResidency(true);
+        return;
+    }
+
+    int firstChunkX = std::max(0, minX >> TileChunk::SHIFT);
+    int firstChunkY = std::max(0, minY >> TileChunk::SHIFT);
+    int lastChunkX = std::min(m_chunkCountX - 1, maxX >> TileChunk::SHIFT);
+    int lastChunkY = std::min(m_chunkCountY - 1, maxY >> TileChunk::SHIFT);
+
+    // Выгруженные чанки карта не меняет, их уведомления приходят только от самого стримера
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            int chunkIndex = chunkY * m_chunkCountX + chunkX;
+            if (m_states[chunkIndex] & STATE_RESIDENT) {
+                m_states[chunkIndex] |= STATE_DIRTY;
+                trackChunk(chunkIndex);
+            }
+        }
+    }
+}
+
+void ChunkStreamer::applyLoaded(int centerX, int centerY) {
+    std::vector<LoadResult> results;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_results.empty()) {
+            return;
+        }
+
+        size_t count = std::min(m_results.size(), static_cast<size_t>(MAX_APPLIED_PER_UPDATE));
+        for (size_t i = 0; i < count; ++i) {
+            results.push_back(std::move(m_results[i]));
+        }
+        m_results.erase(m_results.begin(), m_results.begin() + count);
+    }
+
+    int evictRadiusSquared = m_evictRadius * m_evictRadius;
+    for (LoadResult& result : results) {
+        int chunkIndex = result.chunkIndex;
+        m_pendingCount--;
+        m_states[chunkIndex] &= ~STATE_QUEUED;
+
+        int chunkX = chunkIndex % m_chunkCountX;
+        int chunkY = chunkIndex / m_chunkCountX;
+
+        // Пока чанк загружался, игрок мог уйти от него
+        if ((m_states[chunkIndex] & STATE_RESIDENT) ||
+            distanceSquared(chunkX, chunkY, centerX, centerY) > evictRadiusSquared) {
+            continue;
+        }
+
+        if (!result.chunk) {
+            // Чанк остается выгруженным и будет запрошен снова при смене чанка игрока
+            LOG_WARNING("Failed to load chunk (" + std::to_string(chunkX) + ", " +
+                std::to_string(chunkY) + ")");
+            continue;
+        }
+
+        m_applying = true;
+        m_tileMap->replaceChunk(chunkX, chunkY, std::move(result.chunk));
+        m_applying = false;
+
+        m_states[chunkIndex] |= STATE_RESIDENT;
+        if (m_tileMap->isChunkAllocated(chunkX, chunkY)) {
+            trackChunk(chunkIndex);
+        }
+    }
+}
+
+void ChunkStreamer::evictFarChunks(int centerX, int centerY) {
+    int evictRadiusSquared = m_evictRadius * m_evictRadius;
+    bool queued = false;
+
+    for (size_t i = 0; i < m_trackedChunks.size();) {
+        int chunkIndex = m_trackedChunks[i];
+        int chunkX = chunkIndex % m_chunkCountX;
+        int chunkY = chunkIndex / m_chunkCountX;
+
+        if (distanceSquared(chunkX, chunkY, centerX, centerY) <= evictRadiusSquared) {
+            ++i;
+            continue;
+        }
+
+        // 1. Измененный чанк сохраняем перед освобождением
+        Uint8& state = m_states[chunkIndex];
+        if (state & STATE_DIRTY) {
+            queueSave(chunkIndex);
+            queued = true;
+        }
+
+        // 2. Однородный неизмененный чанк памяти не занимает - просто перестаем его отслеживать
+        if (m_tileMap->isChunkAllocated(chunkX, chunkY) || (state & STATE_DIRTY)) {
+            m_applying = true;
+            m_tileMap->evictChunk(chunkX, chunkY);
+            m_applying = false;
+            state = 0;
+        }
+        else {
+            state &= ~STATE_TRACKED;
+        }
+
+        m_trackedChunks[i] = m_trackedChunks.back();
+        m_trackedChunks.pop_back();
+    }
+
+    if (queued) {
+        m_wakeCondition.notify_one();
+    }
+}
+
+void ChunkStreamer::requestLoads(int centerX, int centerY, float directionX, float directionY) {
+    // Второй центр загрузки - впереди по ходу движения
+    int aheadX = centerX + static_cast<int>(directionX) * m_prefetchDistance;
+    int aheadY = centerY + static_cast<int>(directionY) * m_prefetchDistance;
+
+    int loadRadiusSquared = m_loadRadius * m_loadRadius;
+    int evictRadiusSquared = m_evictRadius * m_evictRadius;
+
+    int minX = std::max(0, std::min(centerX, aheadX) - m_loadRadius);
+    int maxX = std::min(m_chunkCountX - 1, std::max(centerX, aheadX) + m_loadRadius);
+    int minY = std::max(0, std::min(centerY, aheadY) - m_loadRadius);
+    int maxY = std::min(m_chunkCountY - 1, std::max(centerY, aheadY) + m_loadRadius);
+
+    // 1. Собираем незагруженные чанки вокруг обоих центров. Приоритет - сумма
+    // расстояний до центров: сначала грузится полоса между игроком и точкой
+    // впереди, а чанки позади игрока - в последнюю очередь
+    m_candidates.clear();
+    for (int chunkY = minY; chunkY <= maxY; ++chunkY) {
+        for (int chunkX = minX; chunkX <= maxX; ++chunkX) {
+            int nearDistance = distanceSquared(chunkX, chunkY, centerX, centerY);
+            int aheadDistance = distanceSquared(chunkX, chunkY, aheadX, aheadY);
+            if ((nearDistance > loadRadiusSquared && aheadDistance > loadRadiusSquared) ||
+                nearDistance > evictRadiusSquared) {
+                continue;
+            }
+
+            int chunkIndex = chunkY * m_chunkCountX + chunkX;
+            if (!(m_states[chunkIndex] & STATE_RESIDENT)) {
+                m_candidates.emplace_back(nearDistance + aheadDistance, chunkIndex);
+            }
+        }
+    }
+    std::sort(m_candidates.begin(), m_candidates.end());
+
+    // 2. Заменяем очередь загрузки; чанк, который уже загружается, остается помеченным
+    bool hasLoads = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int chunkIndex : m_loadQueue) {
+            m_states[chunkIndex] &= ~STATE_QUEUED;
+            m_pendingCount--;
+        }
+        m_loadQueue.clear();
+
+        for (const auto& candidate : m_candidates) {
+            Uint8& state = m_states[candidate.second];
+            if (!(state & STATE_QUEUED)) {
+                state |= STATE_QUEUED;
+                m_pendingCount++;
+                m_loadQueue.push_back(candidate.second);
+            }
+        }
+        hasLoads = !m_loadQueue.empty();
+    }
+
+    if (hasLoads) {
+        m_wakeCondition.notify_one();
+    }
+}
+
+void ChunkStreamer::queueSave(int chunkIndex) {
+    std::unique_ptr<TileChunk> copy(new TileChunk());
+    m_tileMap->copyChunk(chunkIndex % m_chunkCountX, chunkIndex / m_chunkCountX, *copy);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_saveQueue.push_back({ chunkIndex, std::move(copy) });
+}
+
+void ChunkStreamer::trackChunk(int chunkIndex) {
+    if (!(m_states[chunkIndex] & STATE_TRACKED)) {
+        m_states[chunkIndex] |= STATE_TRACKED;
+        m_trackedChunks.push_back(chunkIndex);
+    }
+}
+
+void ChunkStreamer::waitIdle(bool dropPending) {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (dropPending) {
+            m_loadQueue.clear();
+            m_saveQueue.clear();
+        }
+        else {
+            m_wakeCondition.notify_one();
+        }
+
+        m_idleCondition.wait(lock, [this]() {
+            return !m_workerBusy && m_saveQueue.empty();
+        });
+
+        if (dropPending) {
+            m_results.clear();
+        }
+    }
+}
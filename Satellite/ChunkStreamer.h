@@ -0,0 +1,263 @@
+﻿#pragma once
+
+#include "TileMap.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Фоновая подгрузка и выгрузка чанков карты вокруг игрока
+ *
+ * Чанки в радиусе загрузки от игрока (и от точки впереди по направлению
+ * движения) запрашиваются у загрузчика в рабочем потоке: загрузчик может
+ * читать чанк с диска или генерировать его. Готовые чанки переносятся
+ * в карту в update() основного потока не больше MAX_APPLIED_PER_UPDATE
+ * за кадр, чтобы подгрузка не вызывала рывков. Чанки дальше радиуса
+ * выгрузки выгружаются из карты (TileMap::evictChunk); измененные перед
+ * этим передаются сохранителю (тоже в рабочем потоке). Пока чанк выгружен,
+ * карта отклоняет запись в него, поэтому изменения не теряются. Чанк,
+ * который не удалось загрузить, остается выгруженным и запрашивается
+ * снова, когда игрок сменит чанк. Радиус выгрузки больше радиуса загрузки,
+ * поэтому чанки на границе не загружаются и не выгружаются по очереди.
+ * Однородные чанки не занимают памяти, поэтому неизмененные однородные
+ * чанки не выгружаются вовсе.
+ *
+ * Изменения карты отслеживаются подпиской на TileMap. Если карта
+ * переинициализирована целиком (ALL_TILES), ее содержимое считается
+ * загруженным, а занимающие память чанки - измененными: при выгрузке
+ * они будут сохранены.
+ *
+ * Рабочий поток обращается только к буферам чанков и к функциям
+ * загрузки и сохранения, но никогда к самой карте.
+ */
+class ChunkStreamer {
+public:
+    static constexpr int DEFAULT_LOAD_RADIUS = 4;       ///< Радиус загрузки по умолчанию (в чанках)
+    static constexpr int DEFAULT_EVICT_RADIUS = 6;      ///< Радиус выгрузки по умолчанию (в чанках)
+    static constexpr int DEFAULT_PREFETCH_DISTANCE = 2; ///< Упреждение по направлению движения (в чанках)
+    static constexpr int MAX_APPLIED_PER_UPDATE = 4;    ///< Чанков, переносимых в карту за один update()
+
+    /**
+     * @brief Загрузка или генерация чанка (вызывается в рабочем потоке и из readEvictedChunk)
+     *
+     * Параметры: X и Y координаты чанка, его индекс в каталоге карты
+     * (chunkY * getChunkCountX() + chunkX на момент постановки задания),
+     * буфер для его тайлов. Возвращает true, если буфер заполнен.
+     * Загрузчик должен допускать одновременные вызовы из двух потоков.
+     */
+    using ChunkLoader = std::function<bool(int chunkX, int chunkY, int chunkIndex, TileChunk& chunk)>;
+
+    /**
+     * @brief Сохранение измененного чанка (вызывается в рабочем потоке)
+     *
+     * Параметры: X и Y координаты чанка, его индекс в каталоге карты, его тайлы.
+     * Возвращает true в случае успеха.
+     */
+    using ChunkSaver = std::function<bool(int chunkX, int chunkY, int chunkIndex, const TileChunk& chunk)>;
+
+    /**
+     * @brief Конструктор (запускает рабочий поток)
+     *
+     * Текущее содержимое карты считается загруженным (см. resetResidency).
+     *
+     * @param tileMap Карта тайлов
+     * @param loader Загрузчик чанков
+     * @param saver Сохранитель измененных чанков (nullptr - изменения при выгрузке теряются)
+     */
+    ChunkStreamer(std::shared_ptr<TileMap> tileMap, ChunkLoader loader, ChunkSaver saver);
+
+    /**
+     * @brief Деструктор (дожидается сохранения и останавливает поток)
+     */
+    ~ChunkStreamer();
+
+    ChunkStreamer(const ChunkStreamer&) = delete;
+    ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+    /**
+     * @brief Установка радиусов загрузки и выгрузки
+     * @param loadRadius Радиус загрузки в чанках
+     * @param evictRadius Радиус выгрузки в чанках (не меньше радиуса загрузки + 1)
+     */
+    void setRadii(int loadRadius, int evictRadius);
+
+    /**
+     * @brief Установка упреждения по направлению движения
+     * @param chunks Расстояние в чанках от игрока до второго центра загрузки
+     */
+    void setPrefetchDistance(int chunks) { m_prefetchDistance = chunks; }
+
+    /**
+     * @brief Сброс состояния чанков
+     *
+     * Дожидается рабочего потока и отбрасывает незавершенные загрузки.
+     *
+     * @param resident true - содержимое карты считается загруженным, а неоднородные чанки - измененными,
+     *                 false - все чанки будут запрошены у загрузчика
+     */
+    void resetResidency(bool resident);
+
+    /**
+     * @brief Обновление вокруг игрока (вызывается каждый кадр)
+     * @param playerX X координата игрока в тайлах
+     * @param playerY Y координата игрока в тайлах
+     * @param directionX Направление движения по X
+     * @param directionY Направление движения по Y
+     */
+    void update(float playerX, float playerY, float directionX, float directionY);
+
+    /**
+     * @brief Сохранение всех измененных загруженных чанков
+     *
+     * Возвращает управление после того, как рабочий поток все записал.
+     */
+    void flush();
+
+    /**
+     * @brief Проверка, загружен ли чанк
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @return true, если тайлы чанка находятся в карте
+     */
+    bool isChunkResident(int chunkX, int chunkY) const;
+
+    /**
+     * @brief Синхронное чтение тайлов выгруженного чанка (например, для сохранения уровня)
+     *
+     * Дожидается записи очереди сохранения, чтобы чанк читался в последнем
+     * виде, и вызывает загрузчик в текущем потоке. Карта не меняется.
+     * Подходит как LevelFile::ChunkReader.
+     *
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @param chunk Тайлы чанка (выходной параметр)
+     * @return true, если загрузчик заполнил буфер
+     */
+    bool readEvictedChunk(int chunkX, int chunkY, TileChunk& chunk);
+
+    /**
+     * @brief Получение количества запрошенных, но еще не перенесенных в карту чанков
+     * @return Количество ожидающих чанков
+     */
+    int getPendingChunkCount() const { return m_pendingCount; }
+
+private:
+    static constexpr Uint8 STATE_RESIDENT = 0x01;  ///< Тайлы чанка в карте
+    static constexpr Uint8 STATE_QUEUED = 0x02;    ///< Чанк в очереди загрузки или загружается
+    static constexpr Uint8 STATE_DIRTY = 0x04;     ///< Чанк изменен после загрузки
+    static constexpr Uint8 STATE_TRACKED = 0x08;   ///< Чанк в списке кандидатов на выгрузку
+
+    /**
+     * @brief Загруженный рабочим потоком чанк
+     */
+    struct LoadResult {
+        int chunkIndex;                      ///< Индекс чанка
+        std::unique_ptr<TileChunk> chunk;    ///< Тайлы (nullptr - загрузка не удалась)
+    };
+
+    /**
+     * @brief Задание на сохранение
+     */
+    struct SaveJob {
+        int chunkIndex;                      ///< Индекс чанка
+        std::unique_ptr<TileChunk> chunk;    ///< Копия тайлов на момент выгрузки
+    };
+
+    /**
+     * @brief Цикл рабочего потока
+     */
+    void workerLoop();
+
+    /**
+     * @brief Обработка изменения карты
+     * @param minX Левая граница измененной области (или TileMap::ALL_TILES)
+     * @param minY Верхняя граница
+     * @param maxX Правая граница (включительно)
+     * @param maxY Нижняя граница (включительно)
+     */
+    void onTilesChanged(int minX, int minY, int maxX, int maxY);
+
+    /**
+     * @brief Перенос готовых чанков в карту
+     * @param centerX X координата чанка игрока
+     * @param centerY Y координата чанка игрока
+     */
+    void applyLoaded(int centerX, int centerY);
+
+    /**
+     * @brief Выгрузка чанков дальше радиуса выгрузки
+     * @param centerX X координата чанка игрока
+     * @param centerY Y координата чанка игрока
+     */
+    void evictFarChunks(int centerX, int centerY);
+
+    /**
+     * @brief Замена очереди загрузки чанками вокруг игрока и впереди по ходу движения
+     * @param centerX X координата чанка игрока
+     * @param centerY Y координата чанка игрока
+     * @param directionX Направление движения по X
+     * @param directionY Направление движения по Y
+     */
+    void requestLoads(int centerX, int centerY, float directionX, float directionY);
+
+    /**
+     * @brief Постановка чанка в очередь сохранения
+     * @param chunkIndex Индекс чанка
+     */
+    void queueSave(int chunkIndex);
+
+    /**
+     * @brief Добавление загруженного чанка в список кандидатов на выгрузку
+     * @param chunkIndex Индекс чанка
+     */
+    void trackChunk(int chunkIndex);
+
+    /**
+     * @brief Ожидание, пока рабочий поток не закончит текущее задание
+     * @param dropPending true - все очереди и готовые результаты отбрасываются,
+     *                    false - дожидаемся выполнения очереди сохранения
+     */
+    void waitIdle(bool dropPending);
+
+    /**
+     * @brief Квадрат расстояния между чанками
+     */
+    static int distanceSquared(int x0, int y0, int x1, int y1) {
+        return (x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0);
+    }
+
+    std::shared_ptr<TileMap> m_tileMap;       ///< Карта тайлов
+    ChunkLoader m_loader;                     ///< Загрузчик чанков
+    ChunkSaver m_saver;                       ///< Сохранитель измененных чанков
+    int m_listenerId;                         ///< Подписка на изменения карты
+
+    int m_loadRadius;                         ///< Радиус загрузки (в чанках)
+    int m_evictRadius;                        ///< Радиус выгрузки (в чанках)
+    int m_prefetchDistance;                   ///< Упреждение по направлению движения
+
+    std::vector<Uint8> m_states;              ///< Состояние каждого чанка (STATE_*)
+    std::vector<int> m_trackedChunks;         ///< Загруженные чанки, которые могут занимать память
+    int m_chunkCountX;                        ///< Ширина каталога чанков
+    int m_chunkCountY;                        ///< Высота каталога чанков
+    int m_pendingCount;                       ///< Запрошенные, но не перенесенные чанки
+    int m_lastCenterX;                        ///< Чанк игрока при последнем обновлении
+    int m_lastCenterY;
+    int m_lastDirectionX;                     ///< Знак направления при последнем обновлении
+    int m_lastDirectionY;
+    bool m_applying;                          ///< Карта меняется самим стримером
+    std::vector<std::pair<int, int>> m_candidates; ///< Кандидаты на загрузку (приоритет, индекс)
+
+    std::thread m_worker;                     ///< Рабочий поток
+    mutable std::mutex m_mutex;               ///< Защита очередей
+    std::condition_variable m_wakeCondition;  ///< Сигнал о новых заданиях
+    std::condition_variable m_idleCondition;  ///< Сигнал о завершении задания
+    std::deque<int> m_loadQueue;              ///< Очередь загрузки (индексы чанков по приоритету)
+    std::deque<SaveJob> m_saveQueue;          ///< Очередь сохранения
+    std::vector<LoadResult> m_results;        ///< Загруженные чанки для основного потока
+    bool m_workerBusy;                        ///< Рабочий поток выполняет задание
+    bool m_stopping;                          ///< Поток останавливается
+};
@@ -0,0 +1,87 @@
+﻿#include "ChunkSwapFile.h"
+#include "Logger.h"
+#include <cstdio>
+
+static_assert(sizeof(TileChunk) == TileChunk::AREA * 3, "TileChunk must be a plain array of tile planes");
+
+ChunkSwapFile::ChunkSwapFile(const std::string& path)
+    : m_path(path), m_size(0) {
+}
+
+ChunkSwapFile::~ChunkSwapFile() {
+    if (m_file.is_open()) {
+        m_file.close();
+        std::remove(m_path.c_str());
+    }
+}
+
+bool ChunkSwapFile::write(int chunkIndex, const TileChunk& chunk) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.is_open() && !open()) {
+        return false;
+    }
+
+    // Новый чанк дописывается в конец, известный перезаписывается на месте
+    auto it = m_offsets.find(chunkIndex);
+    std::streamoff offset = it != m_offsets.end() ? it->second : m_size;
+
+    m_file.clear();
+    m_file.seekp(offset);
+    m_file.write(reinterpret_cast<const char*>(&chunk), RECORD_SIZE);
+    if (!m_file) {
+        LOG_ERROR("Failed to write chunk " + std::to_string(chunkIndex) + " to swap file " + m_path);
+        return false;
+    }
+
+    if (it == m_offsets.end()) {
+        m_offsets[chunkIndex] = offset;
+        m_size += RECORD_SIZE;
+    }
+    return true;
+}
+
+bool ChunkSwapFile::read(int chunkIndex, TileChunk& chunk) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_offsets.find(chunkIndex);
+    if (it == m_offsets.end() || !m_file.is_open()) {
+        return false;
+    }
+
+    m_file.clear();
+    m_file.seekg(it->second);
+    m_file.read(reinterpret_cast<char*>(&chunk), RECORD_SIZE);
+    if (m_file.gcount() != RECORD_SIZE) {
+        LOG_ERROR("Failed to read chunk " + std::to_string(chunkIndex) + " from swap file " + m_path);
+        return false;
+    }
+    return true;
+}
+
+bool ChunkSwapFile::contains(int chunkIndex) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_offsets.count(chunkIndex) != 0;
+}
+
+void ChunkSwapFile::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_offsets.clear();
+    m_size = 0;
+    if (m_file.is_open()) {
+        open();
+    }
+}
+
+bool ChunkSwapFile::open() {
+    if (m_file.is_open()) {
+        m_file.close();
+    }
+
+    m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        LOG_ERROR("Failed to open chunk swap file: " + m_path);
+        return false;
+    }
+
+    m_size = 0;
+    return true;
+}
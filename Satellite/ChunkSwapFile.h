@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include "TileChunk.h"
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Файл подкачки выгруженных чанков карты
+ *
+ * Чанки записываются записями фиксированного размера; повторная запись
+ * того же чанка перезаписывает его запись на месте, поэтому файл растет
+ * только с количеством разных выгруженных чанков. Индекс записей хранится
+ * в памяти: после clear() или перезапуска игры файл пуст.
+ *
+ * Методы защищены мьютексом и могут вызываться из потока подгрузки.
+ */
+class ChunkSwapFile {
+public:
+    /**
+     * @brief Конструктор
+     * @param path Путь к файлу подкачки (файл создается при первой записи)
+     */
+    explicit ChunkSwapFile(const std::string& path);
+
+    /**
+     * @brief Деструктор (закрывает и удаляет файл)
+     */
+    ~ChunkSwapFile();
+
+    ChunkSwapFile(const ChunkSwapFile&) = delete;
+    ChunkSwapFile& operator=(const ChunkSwapFile&) = delete;
+
+    /**
+     * @brief Запись чанка
+     * @param chunkIndex Индекс чанка в каталоге карты
+     * @param chunk Тайлы чанка
+     * @return true в случае успеха
+     */
+    bool write(int chunkIndex, const TileChunk& chunk);
+
+    /**
+     * @brief Чтение чанка
+     * @param chunkIndex Индекс чанка в каталоге карты
+     * @param chunk Тайлы чанка (выходной параметр)
+     * @return true, если чанк был записан и прочитан
+     */
+    bool read(int chunkIndex, TileChunk& chunk);
+
+    /**
+     * @brief Проверка, записан ли чанк
+     * @param chunkIndex Индекс чанка в каталоге карты
+     * @return true, если чанк есть в файле
+     */
+    bool contains(int chunkIndex) const;
+
+    /**
+     * @brief Забыть все записанные чанки (например, после генерации новой карты)
+     */
+    void clear();
+
+private:
+    static constexpr std::streamoff RECORD_SIZE = static_cast<std::streamoff>(sizeof(TileChunk)); ///< Размер записи
+
+    /**
+     * @brief Открытие файла с очисткой содержимого
+     * @return true, если файл открыт
+     */
+    bool open();
+
+    std::string m_path;                                      ///< Путь к файлу
+    std::fstream m_file;                                     ///< Открытый файл
+    std::unordered_map<int, std::streamoff> m_offsets;       ///< Смещения записей по индексу чанка
+    std::streamoff m_size;                                   ///< Размер файла
+    mutable std::mutex m_mutex;                              ///< Защита файла и индекса
+};
@@ -122,15 +122,15 @@ bool Door::initialize() {
         }
 
         // Получаем текущий тайл и сохраняем его тип, если он еще не биомный
-        MapTile* tile = m_tileMap->getTile(m_tileX, m_tileY);
+        MapTile tile = m_tileMap->getTile(m_tileX, m_tileY);
         if (tile) {
             // Если тайл нужного типа - оставляем как есть, иначе меняем на биомный тип
-            if (tile->getType() != floorType) {
+            if (tile.getType() != floorType) {
                 m_tileMap->setTileType(m_tileX, m_tileY, floorType);
             }
 
             // Делаем тайл непроходимым
-            tile->setWalkable(false);
+            m_tileMap->setTileWalkable(m_tileX, m_tileY, false);
         }
     }
 
@@ -258,11 +258,12 @@ void Door::update(float deltaTime) {
         }
 
         // НОВАЯ ПРОВЕРКА: Проверяем состояние тайла под дверью
-        if (m_tileMap && m_tileMap->isValidCoordinate(m_tileX, m_tileY)) {
-            MapTile* tile = m_tileMap->getTile(m_tileX, m_tileY);
+        // (тайл выгруженного чанка не изменить - он синхронизируется здесь же после загрузки)
+        if (m_tileMap && m_tileMap->isTileResident(m_tileX, m_tileY)) {
+            MapTile tile = m_tileMap->getTile(m_tileX, m_tileY);
             if (tile) {
-                TileType currentType = tile->getType();
-                bool isWalkable = tile->isWalkable();
+                TileType currentType = tile.getType();
+                bool isWalkable = tile.isWalkable();
 
                 // Проверка соответствия состояния тайла и двери
                 if (!m_isOpen && currentType != TileType::DOOR) {
@@ -272,18 +273,18 @@ void Door::update(float deltaTime) {
 
                     // Проверяем проходимость тайла после изменения типа
                     tile = m_tileMap->getTile(m_tileX, m_tileY);
-                    if (tile && tile->isWalkable()) {
+                    if (tile && tile.isWalkable()) {
                         LOG_WARNING("Closed door tile is walkable, fixing to non-walkable");
-                        tile->setWalkable(false);
+                        m_tileMap->setTileWalkable(m_tileX, m_tileY, false);
                     }
                 }
                 else if (m_isOpen && isWalkable != true) {
                     LOG_WARNING("Open door tile is not walkable, fixing");
-                    tile->setWalkable(true);
+                    m_tileMap->setTileWalkable(m_tileX, m_tileY, true);
                 }
                 else if (!m_isOpen && isWalkable == true) {
                     LOG_WARNING("Closed door tile is walkable, fixing to non-walkable");
-                    tile->setWalkable(false);
+                    m_tileMap->setTileWalkable(m_tileX, m_tileY, false);
                 }
             }
         }
@@ -443,13 +444,13 @@ void Door::completeInteraction() {
 
     // Меняем состояние двери
     if (m_tileMap && m_tileMap->isValidCoordinate(m_tileX, m_tileY)) {
-        MapTile* tile = m_tileMap->getTile(m_tileX, m_tileY);
+        MapTile tile = m_tileMap->getTile(m_tileX, m_tileY);
         if (tile) {
             if (!m_isOpen) {
                 // ОТКРЫВАЕМ ДВЕРЬ
 
                 // 1. Делаем тайл проходимым
-                tile->setWalkable(true);
+                m_tileMap->setTileWalkable(m_tileX, m_tileY, true);
 
                 // 2. Затем меняем состояние объекта
                 m_isOpen = true;
@@ -477,7 +478,7 @@ void Door::completeInteraction() {
                 // ЗАКРЫВАЕМ ДВЕРЬ
 
                 // 1. Делаем тайл непроходимым
-                tile->setWalkable(false);
+                m_tileMap->setTileWalkable(m_tileX, m_tileY, false);
 
                 // 2. Меняем состояние объекта
                 m_isOpen = false;
@@ -552,22 +553,23 @@ void Door::setOpen(bool open) {
 }
 
 void Door::updateTileWalkability() {
-    // Проверяем, что карта существует и координаты действительны
-    if (m_tileMap && m_tileMap->isValidCoordinate(m_tileX, m_tileY)) {
+    // Проверяем, что карта существует и чанк двери загружен (иначе тайл обновит проверка в update)
+    if (m_tileMap && m_tileMap->isTileResident(m_tileX, m_tileY)) {
         // Получаем текущий тайл
-        MapTile* tile = m_tileMap->getTile(m_tileX, m_tileY);
+        MapTile tile = m_tileMap->getTile(m_tileX, m_tileY);
         if (tile) {
             // Устанавливаем проходимость в зависимости от состояния двери
-            tile->setWalkable(m_isOpen);
+            // (через карту, чтобы подписчики - например, миникарта - узнали об изменении)
+            m_tileMap->setTileWalkable(m_tileX, m_tileY, m_isOpen);
 
             // ВАЖНО: НЕ меняем тип тайла! Оставляем его тем же самым.
             // Дверь - это интерактивный объект, а не тайл особого типа.
 
             // Дополнительная проверка проходимости
-            MapTile* verifyTile = m_tileMap->getTile(m_tileX, m_tileY);
-            if (verifyTile && verifyTile->isWalkable() != m_isOpen) {
+            MapTile verifyTile = m_tileMap->getTile(m_tileX, m_tileY);
+            if (verifyTile && verifyTile.isWalkable() != m_isOpen) {
                 LOG_WARNING("Walkability mismatch after update! Fixing...");
-                verifyTile->setWalkable(m_isOpen);
+                verifyTile.setWalkable(m_isOpen);
             }
         }
     }
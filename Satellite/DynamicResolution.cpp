@@ -0,0 +1,154 @@
+﻿#include "DynamicResolution.h"
+#include "Logger.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+DynamicResolution::DynamicResolution()
+    : m_enabled(true), m_scale(MAX_SCALE), m_samples(SAMPLE_COUNT, 0.0f),
+    m_sampleIndex(0), m_sampleCount(0),
+    m_texture(nullptr), m_textureOwner(nullptr), m_textureWidth(0), m_textureHeight(0),
+    m_targetActive(false), m_previousTarget(nullptr), m_previousViewport{ 0, 0, 0, 0 } {
+}
+
+DynamicResolution::~DynamicResolution() {
+    releaseTexture();
+}
+
+void DynamicResolution::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    if (!m_enabled) {
+        applyScale(MAX_SCALE);
+    }
+}
+
+void DynamicResolution::addFrameSample(float workTime, float frameTime, float budget) {
+    if (!m_enabled || budget <= 0.0f) {
+        return;
+    }
+
+    // 1. Пропущенный кадр учитываем целиком
+    float load = workTime;
+    if (frameTime > budget * MISSED_FRAME_FACTOR) {
+        load = std::max(workTime, frameTime);
+    }
+
+    m_samples[m_sampleIndex] = load / budget;
+    m_sampleIndex = (m_sampleIndex + 1) % SAMPLE_COUNT;
+    if (m_sampleCount < SAMPLE_COUNT) {
+        m_sampleCount++;
+        return;
+    }
+
+    // 2. Решение принимается только по полному окну замеров
+    float average = 0.0f;
+    for (float sample : m_samples) {
+        average += sample;
+    }
+    average /= SAMPLE_COUNT;
+
+    if (average > LOWER_THRESHOLD && m_scale > MIN_SCALE) {
+        // Время отрисовки примерно пропорционально площади, то есть квадрату масштаба
+        float scale = m_scale * std::sqrt(TARGET_LOAD / average);
+        scale = std::floor(scale / SCALE_STEP) * SCALE_STEP;
+        applyScale(std::min(scale, m_scale - SCALE_STEP));
+    }
+    else if (average < RAISE_THRESHOLD && m_scale < MAX_SCALE) {
+        applyScale(m_scale + SCALE_STEP);
+    }
+}
+
+void DynamicResolution::applyScale(float scale) {
+    scale = std::max(MIN_SCALE, std::min(MAX_SCALE, scale));
+    if (std::fabs(scale - m_scale) > 0.001f) {
+        m_scale = scale;
+        LOG_DEBUG("Dynamic resolution scale: " + std::to_string(m_scale));
+    }
+
+    // Замеры при прежнем масштабе больше не описывают нагрузку
+    m_sampleIndex = 0;
+    m_sampleCount = 0;
+}
+
+bool DynamicResolution::beginWorld(SDL_Renderer* renderer) {
+    m_targetActive = false;
+    if (!renderer || m_scale >= MAX_SCALE || SDL_RenderTargetSupported(renderer) != SDL_TRUE) {
+        return false;
+    }
+
+    // 1. Размер текстуры считается от текущей цели (обычно окна)
+    m_previousTarget = SDL_GetRenderTarget(renderer);
+    int outputWidth = 0;
+    int outputHeight = 0;
+    if (m_previousTarget) {
+        SDL_QueryTexture(m_previousTarget, nullptr, nullptr, &outputWidth, &outputHeight);
+    }
+    else {
+        SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight);
+    }
+
+    int width = std::max(1, static_cast<int>(std::lround(outputWidth * m_scale)));
+    int height = std::max(1, static_cast<int>(std::lround(outputHeight * m_scale)));
+    if (outputWidth <= 0 || outputHeight <= 0 || !ensureTexture(renderer, width, height)) {
+        return false;
+    }
+
+    // 2. Переключаемся на текстуру мира
+    SDL_RenderGetViewport(renderer, &m_previousViewport);
+    if (SDL_SetRenderTarget(renderer, m_texture) != 0) {
+        LOG_ERROR("Failed to set world render target: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    m_targetActive = true;
+    return true;
+}
+
+void DynamicResolution::endWorld(SDL_Renderer* renderer) {
+    if (!m_targetActive) {
+        return;
+    }
+    m_targetActive = false;
+
+    // Возвращаем прежнюю цель и растягиваем на нее мир
+    SDL_SetRenderTarget(renderer, m_previousTarget);
+    SDL_RenderSetViewport(renderer, &m_previousViewport);
+    SDL_RenderCopy(renderer, m_texture, nullptr, nullptr);
+    RenderStats::getInstance().addDrawCalls();
+}
+
+bool DynamicResolution::ensureTexture(SDL_Renderer* renderer, int width, int height) {
+    if (m_texture && m_textureOwner == renderer &&
+        m_textureWidth == width && m_textureHeight == height) {
+        return true;
+    }
+
+    releaseTexture();
+
+    m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+        SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!m_texture) {
+        LOG_ERROR("Failed to create world render target: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    // Мир непрозрачен и при растягивании сглаживается
+    SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_NONE);
+    SDL_SetTextureScaleMode(m_texture, SDL_ScaleModeLinear);
+
+    m_textureOwner = renderer;
+    m_textureWidth = width;
+    m_textureHeight = height;
+    return true;
+}
+
+void DynamicResolution::releaseTexture() {
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+        m_texture = nullptr;
+    }
+    m_textureOwner = nullptr;
+    m_textureWidth = 0;
+    m_textureHeight = 0;
+}
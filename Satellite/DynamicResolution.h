@@ -0,0 +1,133 @@
+﻿#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+/**
+ * @brief Динамическое разрешение мира по измеренному времени кадра
+ *
+ * Мир рисуется в текстуру-цель уменьшенного размера, которая затем
+ * растягивается на все окно одним SDL_RenderCopy; интерфейс рисуется
+ * поверх уже в родном разрешении. Масштаб выбирается по скользящему
+ * среднему отношения времени работы кадра к бюджету кадра: при перегрузке
+ * масштаб сразу снижается пропорционально нагрузке, а при запасе
+ * повышается по одному шагу. После каждого изменения окно замеров
+ * набирается заново, поэтому масштаб не колеблется от кадра к кадру.
+ *
+ * При масштабе 1.0 текстура не используется и мир рисуется прямо в окно.
+ */
+class DynamicResolution {
+public:
+    static constexpr float MIN_SCALE = 0.5f;            ///< Минимальный масштаб разрешения
+    static constexpr float MAX_SCALE = 1.0f;            ///< Максимальный масштаб (родное разрешение)
+    static constexpr float SCALE_STEP = 0.05f;          ///< Шаг изменения масштаба
+    static constexpr int SAMPLE_COUNT = 30;             ///< Размер окна усреднения (кадров)
+    static constexpr float LOWER_THRESHOLD = 0.9f;      ///< Доля бюджета, выше которой масштаб снижается
+    static constexpr float RAISE_THRESHOLD = 0.6f;      ///< Доля бюджета, ниже которой масштаб повышается
+    static constexpr float TARGET_LOAD = 0.8f;          ///< Доля бюджета, к которой стремится снижение
+    static constexpr float MISSED_FRAME_FACTOR = 1.2f;  ///< Кадр длиннее бюджета в столько раз считается пропущенным
+
+    /**
+     * @brief Конструктор
+     */
+    DynamicResolution();
+
+    /**
+     * @brief Деструктор (освобождает текстуру)
+     */
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    /**
+     * @brief Включение/выключение динамического разрешения
+     *
+     * При выключении масштаб возвращается к 1.0.
+     *
+     * @param enabled true - масштаб подстраивается под время кадра
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Проверка, включено ли динамическое разрешение
+     * @return true, если масштаб подстраивается
+     */
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Получение текущего масштаба разрешения мира
+     * @return Масштаб от MIN_SCALE до MAX_SCALE
+     */
+    float getScale() const { return m_scale; }
+
+    /**
+     * @brief Учет замера очередного кадра
+     *
+     * Если весь кадр длился заметно дольше бюджета (например, при
+     * вертикальной синхронизации пропущен обратный ход луча), нагрузкой
+     * считается полное время кадра: узким местом тогда может быть GPU,
+     * работа которого в workTime не видна.
+     *
+     * @param workTime Время работы кадра (отрисовка, без ожидания дисплея) в секундах
+     * @param frameTime Полное время кадра в секундах
+     * @param budget Бюджет времени на кадр в секундах
+     */
+    void addFrameSample(float workTime, float frameTime, float budget);
+
+    /**
+     * @brief Начало отрисовки мира
+     *
+     * При масштабе меньше 1.0 назначает целью рендерера текстуру
+     * уменьшенного размера. Если текстуры-цели не поддерживаются,
+     * мир рисуется прямо в окно.
+     *
+     * @param renderer SDL рендерер
+     * @return true, если мир рисуется в текстуру
+     */
+    bool beginWorld(SDL_Renderer* renderer);
+
+    /**
+     * @brief Завершение отрисовки мира
+     *
+     * Возвращает прежнюю цель рендерера и растягивает на нее текстуру мира.
+     *
+     * @param renderer SDL рендерер
+     */
+    void endWorld(SDL_Renderer* renderer);
+
+    /**
+     * @brief Освобождение текстуры (например, после SDL_RENDER_TARGETS_RESET)
+     */
+    void releaseTexture();
+
+private:
+    /**
+     * @brief Создание текстуры мира нужного размера
+     * @param renderer SDL рендерер
+     * @param width Ширина текстуры
+     * @param height Высота текстуры
+     * @return true, если текстура готова
+     */
+    bool ensureTexture(SDL_Renderer* renderer, int width, int height);
+
+    /**
+     * @brief Смена масштаба с началом нового окна замеров
+     * @param scale Новый масштаб (ограничивается допустимым диапазоном)
+     */
+    void applyScale(float scale);
+
+    bool m_enabled;                   ///< Масштаб подстраивается под время кадра
+    float m_scale;                    ///< Текущий масштаб разрешения мира
+    std::vector<float> m_samples;     ///< Кольцевой буфер нагрузки (доля бюджета)
+    int m_sampleIndex;                ///< Позиция следующей записи в буфере
+    int m_sampleCount;                ///< Количество накопленных замеров
+
+    SDL_Texture* m_texture;           ///< Текстура-цель мира
+    SDL_Renderer* m_textureOwner;     ///< Рендерер, создавший текстуру
+    int m_textureWidth;               ///< Ширина текстуры
+    int m_textureHeight;              ///< Высота текстуры
+    bool m_targetActive;              ///< Мир сейчас рисуется в текстуру
+    SDL_Texture* m_previousTarget;    ///< Цель рендерера до beginWorld()
+    SDL_Rect m_previousViewport;      ///< Область вывода до beginWorld()
+};
@@ -4,10 +4,17 @@
 #include <iostream>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
+#include "RenderStats.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
 
 Engine::Engine(const std::string& title, int width, int height)
     : m_title(title), m_width(width), m_height(height), m_isRunning(false),
-    m_window(nullptr), m_renderer(nullptr), m_deltaTime(0.0f) {
+    m_window(nullptr), m_renderer(nullptr),
+    m_deltaTime(1.0f / 60.0f), m_frameTime(0.0f), m_accumulator(0.0f), m_interpolationAlpha(0.0f),
+    m_updateRate(60), m_targetFrameRate(0), m_vsyncEnabled(true),
+    m_vsyncActive(false), m_displayRefreshRate(60) {
 }
 
 Engine::~Engine() {
@@ -15,8 +22,16 @@ Engine::~Engine() {
 }
 
 bool Engine::initialize() {
-    // 1. Инициализация SDL
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+    // 1. Инициализация SDL (без дисплея - через внеэкранный драйвер, при его отсутствии - через пустой)
+    if (m_headless) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+        if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+            std::cerr << "Offscreen video driver unavailable, trying dummy: " << SDL_GetError() << std::endl;
+            SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+        }
+    }
+
+    if (!SDL_WasInit(SDL_INIT_VIDEO) && SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cerr << "SDL could not initialize! SDL Error: " << SDL_GetError() << std::endl;
         return false;
     }
@@ -40,7 +55,7 @@ bool Engine::initialize() {
         SDL_WINDOWPOS_CENTERED,
         SDL_WINDOWPOS_CENTERED,
         m_width, m_height,
-        SDL_WINDOW_SHOWN
+        m_headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN
     );
 
     if (!m_window) {
@@ -49,10 +64,20 @@ bool Engine::initialize() {
     }
 
     // 5. Создание рендерера
-    m_renderer = SDL_CreateRenderer(
-        m_window, -1,
-        SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
-    );
+    Uint32 rendererFlags = m_headless ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED;
+    if (m_vsyncEnabled && !m_headless) {
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    m_renderer = SDL_CreateRenderer(m_window, -1, rendererFlags);
+
+    // 5.1. Без дисплея у окна может не быть буфера кадра - рисуем в поверхность в памяти
+    if (!m_renderer && m_headless) {
+        std::cerr << "Window software renderer unavailable, using surface renderer: " << SDL_GetError() << std::endl;
+        m_headlessSurface = SDL_CreateRGBSurfaceWithFormat(0, m_width, m_height, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (m_headlessSurface) {
+            m_renderer = SDL_CreateSoftwareRenderer(m_headlessSurface);
+        }
+    }
 
     if (!m_renderer) {
         std::cerr << "Renderer could not be created! SDL Error: " << SDL_GetError() << std::endl;
@@ -69,8 +94,12 @@ bool Engine::initialize() {
         return false;
     }
 
+    // 8. Фактический режим вывода определяет работу ограничителя кадров
+    queryPresentMode();
+
     m_isRunning = true;
     m_lastFrameTime = std::chrono::high_resolution_clock::now();
+    m_nextFrameTime = m_lastFrameTime;
 
     std::cout << "Engine initialized successfully" << std::endl;
     return true;
@@ -82,16 +111,49 @@ void Engine::run() {
         return;
     }
 
-    // Основной игровой цикл
+    m_lastFrameTime = std::chrono::high_resolution_clock::now();
+    m_nextFrameTime = m_lastFrameTime;
+    m_accumulator = 0.0f;
+
+    // Основной игровой цикл: логика идет фиксированными шагами,
+    // отрисовка - так часто, как позволяет ограничитель кадров
     while (m_isRunning) {
+        // 1. Реальное время кадра пополняет накопитель
         calculateDeltaTime();
+        m_accumulator += m_frameTime;
+
+        // 2. Ввод обрабатывается раз за кадр
         processInput();
-        update();
+
+        // 3. Выполняем все накопившиеся шаги симуляции
+        int steps = 0;
+        while (m_accumulator >= m_deltaTime && steps < MAX_UPDATES_PER_FRAME) {
+            update();
+            m_accumulator -= m_deltaTime;
+            ++steps;
+        }
+
+        // Не успеваем за реальным временем - отбрасываем долг, чтобы не уйти в "спираль смерти"
+        if (steps == MAX_UPDATES_PER_FRAME && m_accumulator >= m_deltaTime) {
+            m_accumulator = std::fmod(m_accumulator, m_deltaTime);
+        }
+
+        // 4. Отрисовка между двумя последними состояниями симуляции
+        m_interpolationAlpha = m_accumulator / m_deltaTime;
+        if (m_activeScene) {
+            m_activeScene->setInterpolationAlpha(m_interpolationAlpha);
+        }
         render();
+
+        // 5. Ожидание следующего кадра
+        limitFrameRate();
     }
 }
 
 void Engine::shutdown() {
+    // 0. Освобождаем сцену до уничтожения рендерера: она владеет текстурами
+    m_activeScene.reset();
+
     // 1. Очистка ResourceManager
     if (m_resourceManager) {
         m_resourceManager->clearAll();
@@ -104,6 +166,11 @@ void Engine::shutdown() {
         m_renderer = nullptr;
     }
 
+    if (m_headlessSurface) {
+        SDL_FreeSurface(m_headlessSurface);
+        m_headlessSurface = nullptr;
+    }
+
     if (m_window) {
         SDL_DestroyWindow(m_window);
         m_window = nullptr;
@@ -151,6 +218,9 @@ void Engine::update() {
 }
 
 void Engine::render() {
+        RenderStats::getInstance().beginFrame();
+        auto renderStart = std::chrono::high_resolution_clock::now();
+
         // 1. Выбираем цвет фона в зависимости от текущего биома
         switch (m_currentBiome) {
         case 1: // FOREST
@@ -177,12 +247,108 @@ void Engine::render() {
             m_activeScene->render(m_renderer);
         }
 
-        // 3. Вывод отрисованного кадра на экран
+        // 3. Вывод отрисованного кадра на экран (время вывода считается отдельно:
+        // при вертикальной синхронизации в нем есть ожидание, а не работа)
+        auto presentStart = std::chrono::high_resolution_clock::now();
         SDL_RenderPresent(m_renderer);
+        auto presentEnd = std::chrono::high_resolution_clock::now();
+
+        m_renderTime = std::chrono::duration<float>(presentStart - renderStart).count();
+        m_presentTime = std::chrono::duration<float>(presentEnd - presentStart).count();
+}
+
+float Engine::getFrameBudget() const {
+    int frameRate = m_targetFrameRate > 0 ? m_targetFrameRate : m_displayRefreshRate;
+    return 1.0f / static_cast<float>(std::max(1, frameRate));
 }
 
 void Engine::calculateDeltaTime() {
     auto currentTime = std::chrono::high_resolution_clock::now();
-    m_deltaTime = std::chrono::duration<float>(currentTime - m_lastFrameTime).count();
+    m_frameTime = std::chrono::duration<float>(currentTime - m_lastFrameTime).count();
     m_lastFrameTime = currentTime;
+
+    // После паузы (перетаскивание окна, точка останова) не пытаемся догонять все пропущенное время
+    m_frameTime = std::min(m_frameTime, MAX_FRAME_TIME);
+}
+
+void Engine::setUpdateRate(int updatesPerSecond) {
+    m_updateRate = std::max(1, updatesPerSecond);
+    m_deltaTime = 1.0f / static_cast<float>(m_updateRate);
+}
+
+void Engine::setTargetFrameRate(int framesPerSecond) {
+    m_targetFrameRate = std::max(0, framesPerSecond);
+}
+
+void Engine::setVSyncEnabled(bool enabled) {
+    m_vsyncEnabled = enabled;
+
+    if (m_renderer) {
+        if (SDL_RenderSetVSync(m_renderer, enabled ? 1 : 0) != 0) {
+            std::cerr << "Failed to change VSync mode: " << SDL_GetError() << std::endl;
+        }
+        queryPresentMode();
+    }
+}
+
+void Engine::queryPresentMode() {
+    // 1. Драйвер может проигнорировать запрос синхронизации (например, программный рендерер)
+    SDL_RendererInfo info;
+    m_vsyncActive = m_renderer && SDL_GetRendererInfo(m_renderer, &info) == 0 &&
+        (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+
+    // 2. Частота дисплея - предел для автоматического режима ограничителя
+    m_displayRefreshRate = 60;
+    SDL_DisplayMode mode;
+    if (m_window && SDL_GetWindowDisplayMode(m_window, &mode) == 0 && mode.refresh_rate > 0) {
+        m_displayRefreshRate = mode.refresh_rate;
+    }
+}
+
+double Engine::resolveFramePeriod() const {
+    if (m_targetFrameRate > 0) {
+        return 1.0 / m_targetFrameRate;
+    }
+
+    // Автоматический режим: SDL_RenderPresent уже ждет обратного хода луча
+    if (m_vsyncActive) {
+        return 0.0;
+    }
+
+    return 1.0 / m_displayRefreshRate;
+}
+
+void Engine::limitFrameRate() {
+    using Clock = std::chrono::high_resolution_clock;
+
+    double period = resolveFramePeriod();
+    if (period <= 0.0) {
+        m_nextFrameTime = Clock::now();
+        return;
+    }
+
+    // 1. Плановое время следующего кадра считается от предыдущего плана,
+    // чтобы ошибки ожидания не накапливались
+    auto framePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+    m_nextFrameTime += framePeriod;
+
+    auto now = Clock::now();
+    if (now >= m_nextFrameTime) {
+        // Кадр занял больше периода - не пытаемся наверстать, начинаем отсчет заново
+        if (now - m_nextFrameTime > framePeriod) {
+            m_nextFrameTime = now;
+        }
+        return;
+    }
+
+    // 2. Спим, пока до цели больше SPIN_MARGIN
+    double remaining = std::chrono::duration<double>(m_nextFrameTime - now).count();
+    if (remaining > SPIN_MARGIN) {
+        SDL_Delay(static_cast<Uint32>((remaining - SPIN_MARGIN) * 1000.0));
+    }
+
+    // 3. Остаток досчитываем активным ожиданием
+    while (Clock::now() < m_nextFrameTime) {
+        std::this_thread::yield();
+    }
 }
\ No newline at end of file
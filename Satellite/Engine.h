@@ -43,6 +43,32 @@ public:
      */
     void run();
 
+    /**
+     * @brief Отрисовывает и выводит один кадр активной сцены
+     *
+     * Используется игровым циклом и замерами производительности.
+     * Счетчики RenderStats сбрасываются в начале кадра.
+     */
+    void render();
+
+    /**
+     * @brief Включение режима без дисплея
+     *
+     * Должен вызываться до initialize(): окно создается скрытым через
+     * видеодрайвер SDL "offscreen" (или "dummy"), а кадры рисует
+     * программный рендерер. Если программный рендерер окна недоступен,
+     * используется рендерер поверх SDL_Surface в памяти.
+     *
+     * @param headless true - работать без дисплея
+     */
+    void setHeadless(bool headless) { m_headless = headless; }
+
+    /**
+     * @brief Проверка режима без дисплея
+     * @return true, если движок работает без дисплея
+     */
+    bool isHeadless() const { return m_headless; }
+
     /**
      * @brief Завершает работу движка
      */
@@ -67,11 +93,93 @@ public:
     std::shared_ptr<ResourceManager> getResourceManager() const { return m_resourceManager; }
 
     /**
-     * @brief Получает время, прошедшее с последнего кадра
-     * @return Время в секундах
+     * @brief Получает шаг симуляции, передаваемый в update()
+     * @return Время в секундах (фиксированный шаг)
      */
     float getDeltaTime() const { return m_deltaTime; }
 
+    /**
+     * @brief Получает реальное время последнего кадра
+     * @return Время в секундах (после ограничения MAX_FRAME_TIME)
+     */
+    float getFrameTime() const { return m_frameTime; }
+
+    /**
+     * @brief Получает время отрисовки последнего кадра (без вывода на экран)
+     * @return Время в секундах от начала render() до SDL_RenderPresent
+     */
+    float getRenderTime() const { return m_renderTime; }
+
+    /**
+     * @brief Получает время вывода последнего кадра
+     *
+     * При вертикальной синхронизации включает ожидание обратного хода луча.
+     *
+     * @return Время SDL_RenderPresent в секундах
+     */
+    float getPresentTime() const { return m_presentTime; }
+
+    /**
+     * @brief Получает бюджет времени на кадр
+     * @return Период целевой частоты кадров (в автоматическом режиме - период дисплея) в секундах
+     */
+    float getFrameBudget() const;
+
+    /**
+     * @brief Проверка, синхронизирует ли рендерер вывод с дисплеем
+     * @return true, если SDL_RenderPresent ждет обратного хода луча
+     */
+    bool isVSyncActive() const { return m_vsyncActive; }
+
+    /**
+     * @brief Установка частоты обновления логики
+     * @param updatesPerSecond Количество шагов симуляции в секунду
+     */
+    void setUpdateRate(int updatesPerSecond);
+
+    /**
+     * @brief Получение частоты обновления логики
+     * @return Количество шагов симуляции в секунду
+     */
+    int getUpdateRate() const { return m_updateRate; }
+
+    /**
+     * @brief Установка ограничения частоты кадров
+     *
+     * 0 - автоматический режим: при работающей вертикальной синхронизации
+     * ограничитель отключен, иначе кадры ограничиваются частотой дисплея.
+     *
+     * @param framesPerSecond Целевая частота кадров (0 - автоматически)
+     */
+    void setTargetFrameRate(int framesPerSecond);
+
+    /**
+     * @brief Получение ограничения частоты кадров
+     * @return Целевая частота кадров (0 - автоматически)
+     */
+    int getTargetFrameRate() const { return m_targetFrameRate; }
+
+    /**
+     * @brief Включение/выключение вертикальной синхронизации
+     *
+     * До initialize() только запоминает выбор, после - применяет к рендереру.
+     *
+     * @param enabled true - ждать обратного хода луча при выводе кадра
+     */
+    void setVSyncEnabled(bool enabled);
+
+    /**
+     * @brief Проверка, запрошена ли вертикальная синхронизация
+     * @return true, если синхронизация включена
+     */
+    bool isVSyncEnabled() const { return m_vsyncEnabled; }
+
+    /**
+     * @brief Доля шага симуляции, прошедшая после последнего update()
+     * @return Коэффициент интерполяции [0, 1) для отрисовки
+     */
+    float getInterpolationAlpha() const { return m_interpolationAlpha; }
+
     /**
      * @brief Проверяет, работает ли движок
      * @return true, если движок работает, false в противном случае
@@ -90,17 +198,36 @@ private:
     void update();
 
     /**
-     * @brief Отрисовывает текущий кадр
+     * @brief Вычисляет время, прошедшее с последнего кадра
      */
-    void render();
+    void calculateDeltaTime();
 
     /**
-     * @brief Вычисляет время, прошедшее с последнего кадра
+     * @brief Ожидание начала следующего кадра
+     *
+     * Большую часть времени поток спит (SDL_Delay), последние
+     * SPIN_MARGIN секунд досчитываются активным ожиданием, так как
+     * точность сна системы - единицы миллисекунд.
      */
-    void calculateDeltaTime();
+    void limitFrameRate();
+
+    /**
+     * @brief Определение фактического периода кадра для ограничителя
+     * @return Период в секундах (0 - ограничитель не нужен)
+     */
+    double resolveFramePeriod() const;
+
+    /**
+     * @brief Опрос фактического режима вывода (синхронизация, частота дисплея)
+     */
+    void queryPresentMode();
 
 
 private:
+    static constexpr float MAX_FRAME_TIME = 0.25f;     ///< Ограничение времени кадра (защита от "спирали смерти")
+    static constexpr int MAX_UPDATES_PER_FRAME = 8;    ///< Максимум шагов симуляции за кадр
+    static constexpr double SPIN_MARGIN = 0.002;       ///< Остаток ожидания, проводимый в активном цикле (с)
+
     std::string m_title;           ///< Заголовок окна
     int m_width;                   ///< Ширина окна
     int m_height;                  ///< Высота окна
@@ -108,12 +235,25 @@ private:
 
     SDL_Window* m_window;          ///< Указатель на окно SDL
     SDL_Renderer* m_renderer;      ///< Указатель на рендерер SDL
+    SDL_Surface* m_headlessSurface = nullptr; ///< Поверхность программного рендерера без окна
+    bool m_headless = false;       ///< Режим без дисплея
 
     std::shared_ptr<ResourceManager> m_resourceManager;  ///< Менеджер ресурсов
     std::shared_ptr<Scene> m_activeScene;  ///< Активная сцена
 
     std::chrono::time_point<std::chrono::high_resolution_clock> m_lastFrameTime;  ///< Время последнего кадра
-    float m_deltaTime;             ///< Время между кадрами
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_nextFrameTime;  ///< Плановое начало следующего кадра
+    float m_deltaTime;             ///< Фиксированный шаг симуляции
+    float m_frameTime;             ///< Реальное время последнего кадра
+    float m_renderTime = 0.0f;     ///< Время отрисовки последнего кадра (без вывода)
+    float m_presentTime = 0.0f;    ///< Время вывода последнего кадра
+    float m_accumulator;           ///< Накопленное, но еще не просимулированное время
+    float m_interpolationAlpha;    ///< Коэффициент интерполяции для отрисовки
+    int m_updateRate;              ///< Частота обновления логики (шагов в секунду)
+    int m_targetFrameRate;         ///< Ограничение частоты кадров (0 - автоматически)
+    bool m_vsyncEnabled;           ///< Запрошена вертикальная синхронизация
+    bool m_vsyncActive;            ///< Рендерер действительно синхронизирует вывод
+    int m_displayRefreshRate;      ///< Частота обновления дисплея (Гц)
     int m_currentBiome = 0; ///< Текущий биом для визуализации
 
 };
\ No newline at end of file
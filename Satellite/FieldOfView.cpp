@@ -0,0 +1,259 @@
+﻿#include "FieldOfView.h"
+#include <algorithm>
+
+FieldOfView::FieldOfView(std::shared_ptr<TileMap> tileMap, int radius)
+    : m_tileMap(tileMap), m_mapListenerId(0), m_width(0), m_height(0),
+    m_radius(std::max(1, radius)), m_originX(-1), m_originY(-1),
+    m_visibleBounds({ 0, 0, 0, 0 }), m_transparencyDirty(true), m_dirty(true),
+    m_nextListenerId(1) {
+    // Прозрачность обновляется по изменениям карты (в том числе при открытии дверей)
+    m_mapListenerId = m_tileMap->addChangeListener([this](int minX, int minY, int maxX, int maxY) {
+        onTilesChanged(minX, minY, maxX, maxY);
+        });
+}
+
+FieldOfView::~FieldOfView() {
+    if (m_tileMap) {
+        m_tileMap->removeChangeListener(m_mapListenerId);
+    }
+}
+
+bool FieldOfView::update(int originX, int originY) {
+    if (m_transparencyDirty) {
+        rebuildTransparency();
+    }
+
+    if (!m_dirty && originX == m_originX && originY == m_originY) {
+        return false;
+    }
+
+    m_dirty = false;
+    m_originX = originX;
+    m_originY = originY;
+
+    // 1. Гасим прошлое поле зрения (оно целиком лежит в своем прямоугольнике)
+    SDL_Rect previousBounds = m_visibleBounds;
+    for (int y = previousBounds.y; y < previousBounds.y + previousBounds.h; ++y) {
+        for (int x = previousBounds.x; x < previousBounds.x + previousBounds.w; ++x) {
+            setBit(m_visible, static_cast<size_t>(y) * m_width + x, false);
+        }
+    }
+
+    // 2. Новый прямоугольник видимости - квадрат радиуса, обрезанный картой
+    int minX = std::max(0, originX - m_radius);
+    int minY = std::max(0, originY - m_radius);
+    int maxX = std::min(m_width - 1, originX + m_radius);
+    int maxY = std::min(m_height - 1, originY + m_radius);
+    m_visibleBounds = { minX, minY, std::max(0, maxX - minX + 1), std::max(0, maxY - minY + 1) };
+
+    // 3. Наблюдатель видит свой тайл и восемь октантов вокруг
+    if (originX >= 0 && originY >= 0 && originX < m_width && originY < m_height) {
+        markVisible(originX, originY);
+
+        static const int multipliers[4][8] = {
+            { 1, 0, 0, -1, -1, 0, 0, 1 },
+            { 0, 1, -1, 0, 0, -1, 1, 0 },
+            { 0, 1, 1, 0, 0, -1, -1, 0 },
+            { 1, 0, 0, 1, -1, 0, 0, -1 }
+        };
+        for (int octant = 0; octant < 8; ++octant) {
+            castLight(1, 1.0f, 0.0f, multipliers[0][octant], multipliers[1][octant],
+                multipliers[2][octant], multipliers[3][octant]);
+        }
+    }
+
+    // 4. Сообщаем об изменениях в объединении старого и нового прямоугольников
+    if (previousBounds.w > 0 && previousBounds.h > 0) {
+        minX = std::min(minX, previousBounds.x);
+        minY = std::min(minY, previousBounds.y);
+        maxX = std::max(maxX, previousBounds.x + previousBounds.w - 1);
+        maxY = std::max(maxY, previousBounds.y + previousBounds.h - 1);
+    }
+    if (minX <= maxX && minY <= maxY) {
+        notifyChanged(minX, minY, maxX, maxY);
+    }
+
+    return true;
+}
+
+void FieldOfView::setRadius(int radius) {
+    radius = std::max(1, radius);
+    if (radius != m_radius) {
+        m_radius = radius;
+        m_dirty = true;
+    }
+}
+
+int FieldOfView::addChangeListener(ChangeListener listener) {
+    int listenerId = m_nextListenerId++;
+    m_listeners.emplace_back(listenerId, std::move(listener));
+    return listenerId;
+}
+
+void FieldOfView::removeChangeListener(int listenerId) {
+    m_listeners.erase(
+        std::remove_if(m_listeners.begin(), m_listeners.end(),
+            [listenerId](const std::pair<int, ChangeListener>& entry) {
+                return entry.first == listenerId;
+            }),
+        m_listeners.end());
+}
+
+void FieldOfView::onTilesChanged(int minX, int minY, int maxX, int maxY) {
+    if (minX == TileMap::ALL_TILES) {
+        // Новая карта: память исследованных тайлов сбрасывается, битовые поля
+        // перестраиваются при следующем update() (генератор мог менять тайлы в обход карты)
+        size_t words = (static_cast<size_t>(m_tileMap->getWidth()) * m_tileMap->getHeight() + 63) / 64;
+        m_width = m_tileMap->getWidth();
+        m_height = m_tileMap->getHeight();
+        m_visible.assign(words, 0);
+        m_explored.assign(words, 0);
+        m_visibleBounds = { 0, 0, 0, 0 };
+        m_transparencyDirty = true;
+        m_dirty = true;
+
+        if (m_width > 0 && m_height > 0) {
+            notifyChanged(0, 0, m_width - 1, m_height - 1);
+        }
+        return;
+    }
+
+    if (m_transparencyDirty) {
+        return;
+    }
+
+    // Пересчитываем видимость, только если прозрачность действительно изменилась
+    minX = std::max(0, minX);
+    minY = std::max(0, minY);
+    maxX = std::min(m_width - 1, maxX);
+    maxY = std::min(m_height - 1, maxY);
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            size_t index = static_cast<size_t>(y) * m_width + x;
+            bool transparent = isTileTransparent(x, y);
+            if (testBit(m_transparent, index) != transparent) {
+                setBit(m_transparent, index, transparent);
+                m_dirty = true;
+            }
+        }
+    }
+}
+
+void FieldOfView::rebuildTransparency() {
+    m_transparencyDirty = false;
+
+    // Размер карты мог измениться без уведомления ALL_TILES только при первом вызове
+    if (m_width != m_tileMap->getWidth() || m_height != m_tileMap->getHeight()) {
+        m_width = m_tileMap->getWidth();
+        m_height = m_tileMap->getHeight();
+        size_t words = (static_cast<size_t>(m_width) * m_height + 63) / 64;
+        m_visible.assign(words, 0);
+        m_explored.assign(words, 0);
+        m_visibleBounds = { 0, 0, 0, 0 };
+    }
+
+    m_transparent.assign((static_cast<size_t>(m_width) * m_height + 63) / 64, 0);
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            if (isTileTransparent(x, y)) {
+                setBit(m_transparent, static_cast<size_t>(y) * m_width + x, true);
+            }
+        }
+    }
+
+    m_dirty = true;
+}
+
+void FieldOfView::castLight(int row, float startSlope, float endSlope, int xx, int xy, int yx, int yy) {
+    if (startSlope < endSlope) {
+        return;
+    }
+
+    int radiusSquared = m_radius * m_radius;
+    float nextStartSlope = startSlope;
+
+    for (int distance = row; distance <= m_radius; ++distance) {
+        bool blocked = false;
+        int dy = -distance;
+
+        for (int dx = -distance; dx <= 0; ++dx) {
+            // Наклоны краев клетки относительно наблюдателя
+            float leftSlope = (dx - 0.5f) / (dy + 0.5f);
+            float rightSlope = (dx + 0.5f) / (dy - 0.5f);
+            if (startSlope < rightSlope) {
+                continue;
+            }
+            if (endSlope > leftSlope) {
+                break;
+            }
+
+            int x = m_originX + dx * xx + dy * xy;
+            int y = m_originY + dx * yx + dy * yy;
+
+            // Видимые в пределах круга тайлы; непрозрачные тоже видны (стены освещены)
+            if (dx * dx + dy * dy <= radiusSquared) {
+                markVisible(x, y);
+            }
+
+            bool opaque = !isTransparentAt(x, y);
+            if (blocked) {
+                // Идем вдоль препятствия: тень продолжается
+                if (opaque) {
+                    nextStartSlope = rightSlope;
+                    continue;
+                }
+                blocked = false;
+                startSlope = nextStartSlope;
+            }
+            else if (opaque && distance < m_radius) {
+                // Начало препятствия: освещаем просвет до него в следующих строках
+                blocked = true;
+                castLight(distance + 1, startSlope, leftSlope, xx, xy, yx, yy);
+                nextStartSlope = rightSlope;
+            }
+        }
+
+        if (blocked) {
+            break;
+        }
+    }
+}
+
+void FieldOfView::markVisible(int x, int y) {
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height) {
+        return;
+    }
+
+    // Выгруженный чанк непрозрачен, но его настоящие тайлы не видны - не запоминаем пустоту
+    if (!m_tileMap->isTileResident(x, y)) {
+        return;
+    }
+
+    size_t index = static_cast<size_t>(y) * m_width + x;
+    setBit(m_visible, index, true);
+    setBit(m_explored, index, true);
+}
+
+bool FieldOfView::isTransparentAt(int x, int y) const {
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height) {
+        return false;
+    }
+
+    return testBit(m_transparent, static_cast<size_t>(y) * m_width + x);
+}
+
+bool FieldOfView::isTileTransparent(int x, int y) const {
+    Uint8 flags = m_tileMap->getTileFlags(x, y);
+    if ((flags & TileMap::FLAG_TRANSPARENT) == 0) {
+        return false;
+    }
+
+    // Проходимый по типу тайл, помеченный непроходимым, - закрытая дверь
+    return (flags & TileMap::FLAG_WALKABLE) != 0 || !IsWalkable(m_tileMap->getTileType(x, y));
+}
+
+void FieldOfView::notifyChanged(int minX, int minY, int maxX, int maxY) {
+    for (auto& entry : m_listeners) {
+        entry.second(minX, minY, maxX, maxY);
+    }
+}
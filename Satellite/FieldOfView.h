@@ -0,0 +1,215 @@
+﻿#pragma once
+
+#include "TileMap.h"
+#include <SDL.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Поле зрения игрока и память исследованных тайлов (туман войны)
+ *
+ * Видимость считается рекурсивным теневым сканированием (shadowcasting)
+ * по восьми октантам вокруг тайла игрока. Прозрачность тайлов хранится
+ * упакованным битовым полем и обновляется по подписке на изменения карты;
+ * закрытая дверь (проходимый по типу тайл, помеченный непроходимым)
+ * считается непрозрачной. Пересчет выполняется только при переходе игрока
+ * на другой тайл или при изменении прозрачности (например, открытии двери).
+ *
+ * Все, что однажды попало в поле зрения, запоминается в битовом поле
+ * исследованных тайлов и остается на экране затемненным.
+ */
+class FieldOfView {
+public:
+    static constexpr int DEFAULT_RADIUS = 12;  ///< Радиус обзора по умолчанию (в тайлах)
+
+    /**
+     * @brief Состояние тайла для отрисовки
+     */
+    enum class Visibility {
+        HIDDEN,      ///< Ни разу не виден - не рисуется
+        REMEMBERED,  ///< Исследован, но сейчас не виден - рисуется затемненным
+        VISIBLE      ///< В поле зрения
+    };
+
+    /**
+     * @brief Слушатель изменений видимости
+     *
+     * Вызывается с прямоугольником тайлов (границы включительно), в котором
+     * могла измениться видимость.
+     */
+    using ChangeListener = std::function<void(int minX, int minY, int maxX, int maxY)>;
+
+    /**
+     * @brief Конструктор
+     * @param tileMap Указатель на карту тайлов
+     * @param radius Радиус обзора в тайлах
+     */
+    FieldOfView(std::shared_ptr<TileMap> tileMap, int radius = DEFAULT_RADIUS);
+
+    /**
+     * @brief Деструктор (отписывается от карты)
+     */
+    ~FieldOfView();
+
+    FieldOfView(const FieldOfView&) = delete;
+    FieldOfView& operator=(const FieldOfView&) = delete;
+
+    /**
+     * @brief Обновление поля зрения
+     *
+     * Пересчитывает видимость, только если сменился тайл наблюдателя,
+     * изменилась прозрачность карты или радиус.
+     *
+     * @param originX X координата тайла наблюдателя
+     * @param originY Y координата тайла наблюдателя
+     * @return true, если видимость пересчитана
+     */
+    bool update(int originX, int originY);
+
+    /**
+     * @brief Получение состояния тайла
+     * @param x X координата
+     * @param y Y координата
+     * @return Состояние тайла (за пределами карты - HIDDEN)
+     */
+    Visibility getVisibility(int x, int y) const {
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height) {
+            return Visibility::HIDDEN;
+        }
+
+        size_t index = static_cast<size_t>(y) * m_width + x;
+        if (testBit(m_visible, index)) {
+            return Visibility::VISIBLE;
+        }
+        return testBit(m_explored, index) ? Visibility::REMEMBERED : Visibility::HIDDEN;
+    }
+
+    /**
+     * @brief Проверка, находится ли тайл в поле зрения
+     * @param x X координата
+     * @param y Y координата
+     * @return true, если тайл виден
+     */
+    bool isVisible(int x, int y) const { return getVisibility(x, y) == Visibility::VISIBLE; }
+
+    /**
+     * @brief Проверка, был ли тайл когда-либо виден
+     * @param x X координата
+     * @param y Y координата
+     * @return true, если тайл исследован
+     */
+    bool isExplored(int x, int y) const { return getVisibility(x, y) != Visibility::HIDDEN; }
+
+    /**
+     * @brief Установка радиуса обзора
+     * @param radius Радиус в тайлах
+     */
+    void setRadius(int radius);
+
+    /**
+     * @brief Получение радиуса обзора
+     * @return Радиус в тайлах
+     */
+    int getRadius() const { return m_radius; }
+
+    /**
+     * @brief Подписка на изменения видимости
+     * @param listener Функция обратного вызова
+     * @return Идентификатор подписки
+     */
+    int addChangeListener(ChangeListener listener);
+
+    /**
+     * @brief Отписка от изменений видимости
+     * @param listenerId Идентификатор, полученный от addChangeListener
+     */
+    void removeChangeListener(int listenerId);
+
+private:
+    /**
+     * @brief Обработка изменения карты
+     * @param minX Левая граница измененной области (или TileMap::ALL_TILES)
+     * @param minY Верхняя граница
+     * @param maxX Правая граница (включительно)
+     * @param maxY Нижняя граница (включительно)
+     */
+    void onTilesChanged(int minX, int minY, int maxX, int maxY);
+
+    /**
+     * @brief Перестроение битового поля прозрачности по всей карте
+     */
+    void rebuildTransparency();
+
+    /**
+     * @brief Освещение одного октанта (рекурсивное теневое сканирование)
+     * @param row Первая строка октанта (расстояние от наблюдателя)
+     * @param startSlope Начальный наклон луча
+     * @param endSlope Конечный наклон луча
+     * @param xx Преобразование координат октанта
+     * @param xy Преобразование координат октанта
+     * @param yx Преобразование координат октанта
+     * @param yy Преобразование координат октанта
+     */
+    void castLight(int row, float startSlope, float endSlope, int xx, int xy, int yx, int yy);
+
+    /**
+     * @brief Отметка тайла видимым и исследованным (тайлы выгруженных чанков пропускаются)
+     * @param x X координата
+     * @param y Y координата
+     */
+    void markVisible(int x, int y);
+
+    /**
+     * @brief Проверка прозрачности тайла по битовому полю
+     * @param x X координата
+     * @param y Y координата
+     * @return true, если сквозь тайл видно (за пределами карты - false)
+     */
+    bool isTransparentAt(int x, int y) const;
+
+    /**
+     * @brief Прозрачность тайла карты
+     * @param x X координата тайла
+     * @param y Y координата тайла
+     * @return true, если сквозь тайл видно
+     */
+    bool isTileTransparent(int x, int y) const;
+
+    /**
+     * @brief Уведомление слушателей
+     */
+    void notifyChanged(int minX, int minY, int maxX, int maxY);
+
+    static bool testBit(const std::vector<Uint64>& bits, size_t index) {
+        return (bits[index >> 6] >> (index & 63)) & 1u;
+    }
+
+    static void setBit(std::vector<Uint64>& bits, size_t index, bool value) {
+        if (value) {
+            bits[index >> 6] |= Uint64(1) << (index & 63);
+        }
+        else {
+            bits[index >> 6] &= ~(Uint64(1) << (index & 63));
+        }
+    }
+
+    std::shared_ptr<TileMap> m_tileMap;   ///< Карта тайлов
+    int m_mapListenerId;                  ///< Идентификатор подписки на изменения карты
+    int m_width;                          ///< Ширина битовых полей (ширина карты)
+    int m_height;                         ///< Высота битовых полей (высота карты)
+    int m_radius;                         ///< Радиус обзора
+
+    std::vector<Uint64> m_transparent;    ///< Прозрачность тайлов
+    std::vector<Uint64> m_visible;        ///< Тайлы в поле зрения
+    std::vector<Uint64> m_explored;       ///< Тайлы, которые когда-либо были видны
+
+    int m_originX;                        ///< Тайл наблюдателя при последнем пересчете
+    int m_originY;                        ///< Тайл наблюдателя при последнем пересчете
+    SDL_Rect m_visibleBounds;             ///< Прямоугольник, в котором лежат видимые тайлы
+    bool m_transparencyDirty;             ///< Битовое поле прозрачности нужно перестроить
+    bool m_dirty;                         ///< Видимость нужно пересчитать
+
+    std::vector<std::pair<int, ChangeListener>> m_listeners; ///< Подписчики на изменения видимости
+    int m_nextListenerId;                 ///< Следующий идентификатор подписки
+};
@@ -0,0 +1,448 @@
+﻿#include "FloorChunkCache.h"
+#include "Logger.h"
+#include "RenderStats.h"
+#include "TilePalette.h"
+#include <algorithm>
+#include <cmath>
+
+FloorChunkCache::FloorChunkCache(std::shared_ptr<TileMap> tileMap,
+    std::shared_ptr<IsometricRenderer> isoRenderer)
+    : m_tileMap(tileMap), m_isoRenderer(isoRenderer),
+    m_bakeRenderer(isoRenderer->getTileWidth(), isoRenderer->getTileHeight()),
+    m_listenerId(0), m_fovListenerId(0), m_chunksX(0), m_chunksY(0), m_cachedPixels(0), m_frame(0),
+    m_maxSizeQueried(false), m_targetsSupported(false),
+    m_maxTextureWidth(0), m_maxTextureHeight(0) {
+    resizeChunkGrid();
+
+    // Подписываемся на изменения карты, чтобы помечать чанки устаревшими
+    m_listenerId = m_tileMap->addChangeListener([this](int minX, int minY, int maxX, int maxY) {
+        onTilesChanged(minX, minY, maxX, maxY);
+        });
+}
+
+FloorChunkCache::~FloorChunkCache() {
+    if (m_tileMap) {
+        m_tileMap->removeChangeListener(m_listenerId);
+    }
+    if (m_fieldOfView) {
+        m_fieldOfView->removeChangeListener(m_fovListenerId);
+    }
+    invalidateAll();
+}
+
+void FloorChunkCache::setFieldOfView(std::shared_ptr<FieldOfView> fieldOfView) {
+    if (fieldOfView == m_fieldOfView) {
+        return;
+    }
+
+    if (m_fieldOfView) {
+        m_fieldOfView->removeChangeListener(m_fovListenerId);
+    }
+
+    m_fieldOfView = fieldOfView;
+    m_fovListenerId = 0;
+
+    // Изменение видимости делает устаревшими чанки, которые она затронула
+    if (m_fieldOfView) {
+        m_fovListenerId = m_fieldOfView->addChangeListener([this](int minX, int minY, int maxX, int maxY) {
+            onVisibilityChanged(minX, minY, maxX, maxY);
+            });
+    }
+
+    // Туман включен или выключен - все запеченные полы устарели
+    for (unsigned int& revision : m_chunkRevisions) {
+        revision++;
+    }
+}
+
+void FloorChunkCache::render(SDL_Renderer* renderer, int startX, int startY, int endX, int endY,
+    int centerX, int centerY) {
+    // 1. Однократно запрашиваем возможности рендерера
+    if (!m_maxSizeQueried) {
+        m_maxSizeQueried = true;
+        m_targetsSupported = SDL_RenderTargetSupported(renderer) == SDL_TRUE;
+
+        SDL_RendererInfo info;
+        if (SDL_GetRendererInfo(renderer, &info) == 0) {
+            m_maxTextureWidth = info.max_texture_width;
+            m_maxTextureHeight = info.max_texture_height;
+        }
+
+        if (!m_targetsSupported) {
+            LOG_WARNING("Render targets are not supported, floor chunks will be drawn directly");
+        }
+    }
+
+    if (m_chunksX == 0 || m_chunksY == 0) {
+        return;
+    }
+
+    m_frame++;
+
+    // 2. Определяем диапазон чанков, пересекающих запрошенную область
+    int firstChunkX = std::max(0, startX / CHUNK_SIZE);
+    int firstChunkY = std::max(0, startY / CHUNK_SIZE);
+    int lastChunkX = std::min(m_chunksX - 1, endX / CHUNK_SIZE);
+    int lastChunkY = std::min(m_chunksY - 1, endY / CHUNK_SIZE);
+
+    // Масштаб квантуется до сотых, чтобы дрейф float не плодил лишние текстуры
+    float cameraZoom = m_isoRenderer->getCameraZoom();
+    int exactBucket = ZoomMipChain::quantize(cameraZoom);
+    int nearestLevel = ZoomMipChain::nearestLevelIndex(cameraZoom);
+    int nearestBucket = ZoomMipChain::quantize(ZoomMipChain::getLevel(nearestLevel));
+
+    // Точный масштаб запекается, только когда он совпадает с уровнем или устоялся
+    m_zoomChain.update(cameraZoom);
+    bool exactAllowed = exactBucket == nearestBucket || m_zoomChain.isStill();
+    int bakeBudget = MAX_BAKES_PER_FRAME;
+
+    SDL_Rect viewport;
+    SDL_RenderGetViewport(renderer, &viewport);
+
+    ChunkLayout layout = getLayout(exactBucket);
+
+    // Программный растеризатор рисует полы в свой кадровый буфер вместе с блоками
+    bool software = m_isoRenderer->getFaceBackend() == IsometricRenderer::FaceBackend::SOFTWARE;
+
+    bool tooLarge = software || !m_targetsSupported ||
+        (m_maxTextureWidth > 0 && layout.width > m_maxTextureWidth) ||
+        (m_maxTextureHeight > 0 && layout.height > m_maxTextureHeight);
+
+    // 3. Выводим каждый чанк одной текстурой
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            int originX, originY;
+            m_isoRenderer->worldToScreen(static_cast<float>(chunkX * CHUNK_SIZE),
+                static_cast<float>(chunkY * CHUNK_SIZE), originX, originY);
+            originX += centerX;
+            originY += centerY;
+
+            // Пропускаем чанки за пределами экрана
+            if (originX + layout.halfWidth + 2 < 0 || originY - 1 + layout.height < 0 ||
+                originX - layout.halfWidth - 1 > viewport.w || originY - 1 > viewport.h) {
+                continue;
+            }
+
+            if (tooLarge) {
+                renderChunkDirect(renderer, chunkX, chunkY, centerX, centerY);
+                continue;
+            }
+
+            int chunkIndex = chunkY * m_chunksX + chunkX;
+
+            // 3.1. Точный масштаб: готовый или запекаемый в пределах бюджета
+            ChunkEntry* entry = findReadyEntry(chunkIndex, exactBucket);
+            if (!entry && exactAllowed && bakeBudget > 0) {
+                bakeBudget--;
+                entry = &bakeEntry(renderer, chunkIndex, chunkX, chunkY, exactBucket);
+            }
+            if (entry) {
+                drawEntry(renderer, *entry, exactBucket, originX, originY);
+                if (entry->tooLarge) {
+                    renderChunkDirect(renderer, chunkX, chunkY, centerX, centerY);
+                }
+                continue;
+            }
+
+            // 3.2. Ближайший уровень с растяжением (запекается один раз на уровень)
+            int levelBucket = nearestBucket;
+            entry = findReadyEntry(chunkIndex, nearestBucket);
+            if (!entry && bakeBudget > 0) {
+                bakeBudget--;
+                entry = &bakeEntry(renderer, chunkIndex, chunkX, chunkY, nearestBucket);
+            }
+
+            // 3.3. Любой другой готовый уровень
+            for (int level = 0; level < ZoomMipChain::LEVEL_COUNT && !entry; ++level) {
+                levelBucket = ZoomMipChain::quantize(ZoomMipChain::getLevel(level));
+                entry = findReadyEntry(chunkIndex, levelBucket);
+            }
+
+            // 3.4. Бюджет исчерпан, а запеченных уровней нет - рисуем напрямую
+            if (!entry || entry->tooLarge) {
+                renderChunkDirect(renderer, chunkX, chunkY, centerX, centerY);
+                continue;
+            }
+
+            drawEntry(renderer, *entry, levelBucket, originX, originY);
+        }
+    }
+
+    // 4. Освобождаем текстуры сверх бюджета
+    evictIfNeeded();
+}
+
+void FloorChunkCache::invalidateAll() {
+    for (auto& pair : m_entries) {
+        if (pair.second.texture) {
+            SDL_DestroyTexture(pair.second.texture);
+        }
+    }
+    m_entries.clear();
+    m_cachedPixels = 0;
+}
+
+void FloorChunkCache::onTilesChanged(int minX, int minY, int maxX, int maxY) {
+    if (minX == TileMap::ALL_TILES) {
+        // Карта изменилась целиком (возможно, и ее размер)
+        invalidateAll();
+        resizeChunkGrid();
+        return;
+    }
+
+    // Выгруженный чанк далеко от камеры, запеченный пол остается верным до его загрузки
+    if (!m_tileMap->hasResidentChunk(minX, minY, maxX, maxY)) {
+        return;
+    }
+
+    // Устаревают чанки, которые пересекает измененная область
+    markChunksStale(minX, minY, maxX, maxY);
+}
+
+void FloorChunkCache::onVisibilityChanged(int minX, int minY, int maxX, int maxY) {
+    markChunksStale(minX, minY, maxX, maxY);
+}
+
+void FloorChunkCache::markChunksStale(int minX, int minY, int maxX, int maxY) {
+    int firstChunkX = std::max(0, minX / CHUNK_SIZE);
+    int firstChunkY = std::max(0, minY / CHUNK_SIZE);
+    int lastChunkX = std::min(m_chunksX - 1, maxX / CHUNK_SIZE);
+    int lastChunkY = std::min(m_chunksY - 1, maxY / CHUNK_SIZE);
+
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            m_chunkRevisions[chunkY * m_chunksX + chunkX]++;
+        }
+    }
+}
+
+void FloorChunkCache::resizeChunkGrid() {
+    m_chunksX = (m_tileMap->getWidth() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_chunksY = (m_tileMap->getHeight() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    // Ревизии начинаются с 1, новые записи кэша (ревизия 0) сразу запекаются
+    m_chunkRevisions.assign(static_cast<size_t>(m_chunksX) * m_chunksY, 1u);
+}
+
+FloorChunkCache::ChunkLayout FloorChunkCache::getLayout(int zoomBucket) const {
+    float zoom = static_cast<float>(zoomBucket) / 100.0f;
+
+    // Ромб чанка с запасом в пиксель на контуры
+    ChunkLayout layout;
+    layout.halfWidth = static_cast<int>(std::ceil(CHUNK_SIZE * m_isoRenderer->getTileWidth() / 2.0f * zoom));
+    layout.width = layout.halfWidth * 2 + 3;
+    layout.height = static_cast<int>(std::ceil(CHUNK_SIZE * m_isoRenderer->getTileHeight() * zoom)) + 3;
+    return layout;
+}
+
+FloorChunkCache::ChunkEntry* FloorChunkCache::findReadyEntry(int chunkIndex, int zoomBucket) {
+    auto it = m_entries.find(makeKey(chunkIndex, zoomBucket));
+    if (it == m_entries.end() || it->second.revision != m_chunkRevisions[chunkIndex]) {
+        return nullptr;
+    }
+
+    it->second.lastUsedFrame = m_frame;
+    return &it->second;
+}
+
+FloorChunkCache::ChunkEntry& FloorChunkCache::bakeEntry(SDL_Renderer* renderer, int chunkIndex,
+    int chunkX, int chunkY, int zoomBucket) {
+    ChunkEntry& entry = m_entries[makeKey(chunkIndex, zoomBucket)];
+    entry.lastUsedFrame = m_frame;
+    bakeChunk(renderer, entry, chunkX, chunkY, zoomBucket);
+    entry.revision = m_chunkRevisions[chunkIndex];
+    return entry;
+}
+
+void FloorChunkCache::drawEntry(SDL_Renderer* renderer, const ChunkEntry& entry, int zoomBucket,
+    int originX, int originY) {
+    if (!entry.texture) {
+        return;
+    }
+
+    ChunkLayout layout = getLayout(zoomBucket);
+    SDL_Rect dst = {
+        originX - (layout.halfWidth + 1),
+        originY - 1,
+        entry.width, entry.height
+    };
+
+    // Другой уровень растягивается до текущего масштаба; края округляются
+    // от начала чанка, чтобы соседние чанки стыковались одинаково
+    float cameraZoom = m_isoRenderer->getCameraZoom();
+    if (zoomBucket != ZoomMipChain::quantize(cameraZoom)) {
+        float scale = cameraZoom * 100.0f / static_cast<float>(zoomBucket);
+        int left = originX - static_cast<int>(std::lround((layout.halfWidth + 1) * scale));
+        int top = originY - static_cast<int>(std::lround(scale));
+        int right = originX + static_cast<int>(std::lround((entry.width - layout.halfWidth - 1) * scale));
+        int bottom = originY + static_cast<int>(std::lround((entry.height - 1) * scale));
+        dst = { left, top, right - left, bottom - top };
+    }
+
+    SDL_RenderCopy(renderer, entry.texture, nullptr, &dst);
+    RenderStats::getInstance().addDrawCalls();
+    RenderStats::getInstance().addChunkBlit();
+}
+
+void FloorChunkCache::bakeChunk(SDL_Renderer* renderer, ChunkEntry& entry,
+    int chunkX, int chunkY, int zoomBucket) {
+    int tileStartX = chunkX * CHUNK_SIZE;
+    int tileStartY = chunkY * CHUNK_SIZE;
+    int tileEndX = std::min(m_tileMap->getWidth(), tileStartX + CHUNK_SIZE);
+    int tileEndY = std::min(m_tileMap->getHeight(), tileStartY + CHUNK_SIZE);
+
+    // 1. Проверяем, есть ли в чанке полы вообще
+    bool hasFloor = false;
+    for (int y = tileStartY; y < tileEndY && !hasFloor; ++y) {
+        for (int x = tileStartX; x < tileEndX; ++x) {
+            SDL_Color color;
+            if (getFloorColor(x, y, color)) {
+                hasFloor = true;
+                break;
+            }
+        }
+    }
+
+    ChunkLayout layout = getLayout(zoomBucket);
+    int halfWidth = layout.halfWidth;
+    int textureWidth = layout.width;
+    int textureHeight = layout.height;
+
+    // Пустой чанк: освобождаем текстуру, выводить нечего
+    if (!hasFloor) {
+        if (entry.texture) {
+            m_cachedPixels -= static_cast<long long>(entry.width) * entry.height;
+            SDL_DestroyTexture(entry.texture);
+            entry.texture = nullptr;
+        }
+        entry.width = 0;
+        entry.height = 0;
+        return;
+    }
+
+    // 2. Создаем текстуру-цель (или переиспользуем имеющуюся того же размера)
+    if (entry.texture && (entry.width != textureWidth || entry.height != textureHeight)) {
+        m_cachedPixels -= static_cast<long long>(entry.width) * entry.height;
+        SDL_DestroyTexture(entry.texture);
+        entry.texture = nullptr;
+    }
+
+    if (!entry.texture) {
+        entry.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+            SDL_TEXTUREACCESS_TARGET, textureWidth, textureHeight);
+        if (!entry.texture) {
+            LOG_WARNING("Failed to create floor chunk texture: " + std::string(SDL_GetError()));
+            entry.tooLarge = true;
+            return;
+        }
+        SDL_SetTextureBlendMode(entry.texture, SDL_BLENDMODE_BLEND);
+        entry.width = textureWidth;
+        entry.height = textureHeight;
+        m_cachedPixels += static_cast<long long>(textureWidth) * textureHeight;
+    }
+
+    // 3. Перенаправляем вывод в текстуру, сохраняя состояние рендерера
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_Rect previousViewport;
+    SDL_RenderGetViewport(renderer, &previousViewport);
+    SDL_BlendMode previousBlendMode;
+    SDL_GetRenderDrawBlendMode(renderer, &previousBlendMode);
+
+    SDL_SetRenderTarget(renderer, entry.texture);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    // 4. Рисуем полы чанка так же, как при прямой отрисовке
+    m_bakeRenderer.setCameraPosition(static_cast<float>(tileStartX), static_cast<float>(tileStartY));
+    m_bakeRenderer.setCameraZoom(static_cast<float>(zoomBucket) / 100.0f);
+
+    for (int y = tileStartY; y < tileEndY; ++y) {
+        for (int x = tileStartX; x < tileEndX; ++x) {
+            SDL_Color color;
+            if (getFloorColor(x, y, color)) {
+                m_bakeRenderer.renderTile(renderer, static_cast<float>(x), static_cast<float>(y),
+                    0.0f, color, halfWidth + 1, 1);
+            }
+        }
+    }
+
+    // Грани должны попасть в текстуру чанка, а не в следующую цель вывода
+    m_bakeRenderer.flush(renderer);
+
+    // 5. Восстанавливаем исходную цель вывода
+    SDL_SetRenderTarget(renderer, previousTarget);
+    SDL_RenderSetViewport(renderer, &previousViewport);
+    SDL_SetRenderDrawBlendMode(renderer, previousBlendMode);
+}
+
+void FloorChunkCache::renderChunkDirect(SDL_Renderer* renderer, int chunkX, int chunkY,
+    int centerX, int centerY) {
+    int tileStartX = chunkX * CHUNK_SIZE;
+    int tileStartY = chunkY * CHUNK_SIZE;
+    int tileEndX = std::min(m_tileMap->getWidth(), tileStartX + CHUNK_SIZE);
+    int tileEndY = std::min(m_tileMap->getHeight(), tileStartY + CHUNK_SIZE);
+
+    for (int y = tileStartY; y < tileEndY; ++y) {
+        for (int x = tileStartX; x < tileEndX; ++x) {
+            SDL_Color color;
+            if (getFloorColor(x, y, color)) {
+                m_isoRenderer->renderTile(renderer, static_cast<float>(x), static_cast<float>(y),
+                    0.0f, color, centerX, centerY);
+            }
+        }
+    }
+
+    // Кадровый буфер программного растеризатора выводится один раз после блоков
+    if (m_isoRenderer->getFaceBackend() != IsometricRenderer::FaceBackend::SOFTWARE) {
+        m_isoRenderer->flush(renderer);
+    }
+}
+
+void FloorChunkCache::evictIfNeeded() {
+    while (m_cachedPixels > MAX_CACHED_PIXELS) {
+        // Ищем запись, которая дольше всех не использовалась (кроме текущего кадра)
+        auto oldest = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->second.texture && it->second.lastUsedFrame != m_frame &&
+                (oldest == m_entries.end() || it->second.lastUsedFrame < oldest->second.lastUsedFrame)) {
+                oldest = it;
+            }
+        }
+
+        // Все текстуры нужны в этом кадре - превышение бюджета допустимо
+        if (oldest == m_entries.end()) {
+            break;
+        }
+
+        m_cachedPixels -= static_cast<long long>(oldest->second.width) * oldest->second.height;
+        SDL_DestroyTexture(oldest->second.texture);
+        m_entries.erase(oldest);
+    }
+}
+
+bool FloorChunkCache::getFloorColor(int x, int y, SDL_Color& color) const {
+    if (!isFloorTile(x, y)) {
+        return false;
+    }
+
+    color = m_tileMap->getTileColor(x, y);
+    if (!m_fieldOfView) {
+        return true;
+    }
+
+    // Туман войны: неисследованные полы не рисуются, невидимые сейчас - затемнены
+    switch (m_fieldOfView->getVisibility(x, y)) {
+    case FieldOfView::Visibility::HIDDEN:
+        return false;
+    case FieldOfView::Visibility::REMEMBERED:
+        color = TilePalette::shade(color, TilePalette::REMEMBERED_SHADE);
+        return true;
+    default:
+        return true;
+    }
+}
+
+bool FloorChunkCache::isFloorTile(int x, int y) const {
+    return m_tileMap->getTileType(x, y) != TileType::EMPTY && m_tileMap->getTileHeight(x, y) <= 0.0f;
+}
@@ -0,0 +1,243 @@
+﻿#pragma once
+
+#include "TileMap.h"
+#include "IsometricRenderer.h"
+#include "FieldOfView.h"
+#include "ZoomMipChain.h"
+#include <SDL.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Кэш плоского слоя пола, запеченного в текстуры по чанкам
+ *
+ * Карта делится на чанки CHUNK_SIZE x CHUNK_SIZE тайлов. Полы каждого чанка
+ * один раз отрисовываются в текстуру-цель (отдельно для каждого масштаба),
+ * после чего весь слой пола выводится несколькими вызовами SDL_RenderCopy.
+ * Чанк перерисовывается только после изменения тайла внутри него.
+ *
+ * Пока масштаб меняется, выводится ближайший уровень ZoomMipChain
+ * с растяжением; точный масштаб запекается, когда он устоялся. За кадр
+ * запекается не больше MAX_BAKES_PER_FRAME чанков, остальные ждут
+ * следующих кадров (до этого рисуются другим уровнем или напрямую).
+ *
+ * С полем зрения (FieldOfView) полы запекаются с туманом войны: чанки,
+ * в которых изменилась видимость, становятся устаревшими.
+ */
+class FloorChunkCache {
+public:
+    static constexpr int CHUNK_SIZE = 16;                      ///< Размер чанка в тайлах
+    static constexpr long long MAX_CACHED_PIXELS = 32LL * 1024 * 1024; ///< Бюджет текстур (в пикселях)
+    static constexpr int MAX_BAKES_PER_FRAME = 4;              ///< Запеканий чанков за кадр
+
+    /**
+     * @brief Конструктор
+     * @param tileMap Указатель на карту тайлов
+     * @param isoRenderer Указатель на изометрический рендерер
+     */
+    FloorChunkCache(std::shared_ptr<TileMap> tileMap,
+        std::shared_ptr<IsometricRenderer> isoRenderer);
+
+    /**
+     * @brief Деструктор (отписывается от карты и освобождает текстуры)
+     */
+    ~FloorChunkCache();
+
+    FloorChunkCache(const FloorChunkCache&) = delete;
+    FloorChunkCache& operator=(const FloorChunkCache&) = delete;
+
+    /**
+     * @brief Отрисовка полов в указанной области карты
+     *
+     * Выводятся все чанки, пересекающие область. Устаревшие чанки
+     * перезапекаются в пределах бюджета кадра.
+     *
+     * @param renderer SDL рендерер
+     * @param startX Начальная X координата области (в тайлах)
+     * @param startY Начальная Y координата области (в тайлах)
+     * @param endX Конечная X координата области (включительно)
+     * @param endY Конечная Y координата области (включительно)
+     * @param centerX X координата центра экрана
+     * @param centerY Y координата центра экрана
+     */
+    void render(SDL_Renderer* renderer, int startX, int startY, int endX, int endY,
+        int centerX, int centerY);
+
+    /**
+     * @brief Сброс всех запеченных текстур
+     *
+     * Нужен, например, после потери содержимого текстур-целей
+     * (SDL_RENDER_TARGETS_RESET).
+     */
+    void invalidateAll();
+
+    /**
+     * @brief Установка поля зрения для тумана войны
+     * @param fieldOfView Поле зрения (nullptr - полы видны целиком)
+     */
+    void setFieldOfView(std::shared_ptr<FieldOfView> fieldOfView);
+
+private:
+    /**
+     * @brief Запеченный чанк для одного масштаба
+     */
+    struct ChunkEntry {
+        SDL_Texture* texture = nullptr; ///< Текстура с полами (nullptr, если полов нет)
+        int width = 0;                  ///< Ширина текстуры
+        int height = 0;                 ///< Высота текстуры
+        unsigned int revision = 0;      ///< Ревизия чанка на момент запекания
+        unsigned int lastUsedFrame = 0; ///< Кадр последнего использования (для LRU)
+        bool tooLarge = false;          ///< Текстура не помещается в ограничения рендерера
+    };
+
+    /**
+     * @brief Размеры текстуры чанка при заданном масштабе
+     */
+    struct ChunkLayout {
+        int halfWidth = 0;              ///< Половина ширины ромба чанка
+        int width = 0;                  ///< Ширина текстуры (с запасом на контуры)
+        int height = 0;                 ///< Высота текстуры (с запасом на контуры)
+    };
+
+    /**
+     * @brief Ключ записи кэша
+     * @param chunkIndex Индекс чанка
+     * @param zoomBucket Масштаб в сотых долях
+     * @return Ключ для m_entries
+     */
+    static unsigned long long makeKey(int chunkIndex, int zoomBucket) {
+        return (static_cast<unsigned long long>(chunkIndex) << 16) |
+            static_cast<unsigned long long>(zoomBucket & 0xFFFF);
+    }
+
+    /**
+     * @brief Расчет размеров текстуры чанка
+     * @param zoomBucket Масштаб в сотых долях
+     * @return Размеры текстуры
+     */
+    ChunkLayout getLayout(int zoomBucket) const;
+
+    /**
+     * @brief Поиск актуальной записи кэша
+     * @param chunkIndex Индекс чанка
+     * @param zoomBucket Масштаб в сотых долях
+     * @return Запись или nullptr, если ее нет или она устарела
+     */
+    ChunkEntry* findReadyEntry(int chunkIndex, int zoomBucket);
+
+    /**
+     * @brief Создание (или обновление) и запекание записи кэша
+     * @param renderer SDL рендерер
+     * @param chunkIndex Индекс чанка
+     * @param chunkX X индекс чанка
+     * @param chunkY Y индекс чанка
+     * @param zoomBucket Масштаб в сотых долях
+     * @return Запеченная запись
+     */
+    ChunkEntry& bakeEntry(SDL_Renderer* renderer, int chunkIndex, int chunkX, int chunkY, int zoomBucket);
+
+    /**
+     * @brief Вывод запеченного чанка (с растяжением, если масштаб записи отличается от текущего)
+     * @param renderer SDL рендерер
+     * @param entry Запись кэша
+     * @param zoomBucket Масштаб записи в сотых долях
+     * @param originX Экранная X координата начала чанка
+     * @param originY Экранная Y координата начала чанка
+     */
+    void drawEntry(SDL_Renderer* renderer, const ChunkEntry& entry, int zoomBucket, int originX, int originY);
+
+    /**
+     * @brief Обработка изменения карты
+     * @param minX Левая граница измененной области (или TileMap::ALL_TILES)
+     * @param minY Верхняя граница
+     * @param maxX Правая граница (включительно)
+     * @param maxY Нижняя граница (включительно)
+     */
+    void onTilesChanged(int minX, int minY, int maxX, int maxY);
+
+    /**
+     * @brief Обработка изменения видимости
+     * @param minX Левая граница области (в тайлах)
+     * @param minY Верхняя граница области
+     * @param maxX Правая граница области (включительно)
+     * @param maxY Нижняя граница области (включительно)
+     */
+    void onVisibilityChanged(int minX, int minY, int maxX, int maxY);
+
+    /**
+     * @brief Пометка устаревшими чанков, пересекающих область
+     * @param minX Левая граница области (в тайлах)
+     * @param minY Верхняя граница области
+     * @param maxX Правая граница области (включительно)
+     * @param maxY Нижняя граница области (включительно)
+     */
+    void markChunksStale(int minX, int minY, int maxX, int maxY);
+
+    /**
+     * @brief Приведение массива ревизий к размеру карты
+     */
+    void resizeChunkGrid();
+
+    /**
+     * @brief Запекание полов чанка в текстуру
+     * @param renderer SDL рендерер
+     * @param entry Запись кэша
+     * @param chunkX X индекс чанка
+     * @param chunkY Y индекс чанка
+     * @param zoomBucket Масштаб запекания в сотых долях
+     */
+    void bakeChunk(SDL_Renderer* renderer, ChunkEntry& entry, int chunkX, int chunkY, int zoomBucket);
+
+    /**
+     * @brief Прямая отрисовка полов чанка без кэша
+     * @param renderer SDL рендерер
+     * @param chunkX X индекс чанка
+     * @param chunkY Y индекс чанка
+     * @param centerX X координата центра экрана
+     * @param centerY Y координата центра экрана
+     */
+    void renderChunkDirect(SDL_Renderer* renderer, int chunkX, int chunkY, int centerX, int centerY);
+
+    /**
+     * @brief Вытеснение давно не использованных чанков при превышении бюджета
+     */
+    void evictIfNeeded();
+
+    /**
+     * @brief Цвет пола с учетом тумана войны
+     * @param x X координата тайла
+     * @param y Y координата тайла
+     * @param color Цвет пола (выходной параметр)
+     * @return true, если на тайле нужно рисовать пол
+     */
+    bool getFloorColor(int x, int y, SDL_Color& color) const;
+
+    /**
+     * @brief Проверка, является ли тайл плоским полом
+     * @param x X координата тайла
+     * @param y Y координата тайла
+     * @return true, если тайл рисуется в слое пола
+     */
+    bool isFloorTile(int x, int y) const;
+
+    std::shared_ptr<TileMap> m_tileMap;               ///< Карта тайлов
+    std::shared_ptr<IsometricRenderer> m_isoRenderer; ///< Основной изометрический рендерер
+    IsometricRenderer m_bakeRenderer;                 ///< Рендерер для запекания (камера в начале чанка)
+    int m_listenerId;                                 ///< Идентификатор подписки на изменения карты
+    std::shared_ptr<FieldOfView> m_fieldOfView;       ///< Поле зрения для тумана войны (может быть nullptr)
+    int m_fovListenerId;                              ///< Идентификатор подписки на изменения видимости
+
+    int m_chunksX;                                    ///< Количество чанков по X
+    int m_chunksY;                                    ///< Количество чанков по Y
+    std::vector<unsigned int> m_chunkRevisions;       ///< Ревизии чанков (растут при изменениях)
+    std::unordered_map<unsigned long long, ChunkEntry> m_entries; ///< Запеченные чанки по (чанк, масштаб)
+    long long m_cachedPixels;                         ///< Суммарный размер текстур в пикселях
+    unsigned int m_frame;                             ///< Счетчик кадров для LRU
+    ZoomMipChain m_zoomChain;                         ///< Отслеживание устоявшегося масштаба
+
+    bool m_maxSizeQueried;                            ///< Ограничения рендерера уже получены
+    bool m_targetsSupported;                          ///< Рендерер поддерживает текстуры-цели
+    int m_maxTextureWidth;                            ///< Максимальная ширина текстуры (0 - без ограничений)
+    int m_maxTextureHeight;                           ///< Максимальная высота текстуры (0 - без ограничений)
+};
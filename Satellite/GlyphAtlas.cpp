@@ -0,0 +1,157 @@
+﻿#include "GlyphAtlas.h"
+#include "RenderStats.h"
+#include <algorithm>
+
+GlyphAtlas::GlyphAtlas()
+    : m_atlas(PAGE_SIZE, MAX_PAGES) {
+}
+
+const GlyphAtlas::TextLayout* GlyphAtlas::layout(SDL_Renderer* renderer, TTF_Font* font, const std::string& text) {
+    if (!font) {
+        return nullptr;
+    }
+
+    // 1. Ключ кэша - шрифт и текст; цвет в разметку не входит
+    std::string key(reinterpret_cast<const char*>(&font), sizeof(font));
+    key += text;
+
+    auto found = m_layoutIndex.find(key);
+    if (found != m_layoutIndex.end()) {
+        m_layouts.splice(m_layouts.begin(), m_layouts, found->second);
+        return &found->second->second;
+    }
+
+    // 2. Раскладываем строку: перо сдвигается на advance глифа с учетом кернинга
+    TextLayout result;
+    result.height = TTF_FontHeight(font);
+
+    int penX = 0;
+    Uint32 previous = 0;
+    for (unsigned char byte : text) {
+        Uint32 ch = byte;
+        if (previous != 0) {
+            penX += TTF_GetFontKerningSizeGlyphs32(font, previous, ch);
+        }
+
+        const Glyph* glyph = getGlyph(renderer, font, ch);
+        if (!glyph) {
+            return nullptr;
+        }
+
+        if (glyph->region.isValid()) {
+            GlyphQuad quad;
+            quad.page = glyph->region.page;
+            quad.src = glyph->region.rect;
+            quad.dst = { penX + glyph->offsetX, 0, glyph->region.rect.w, glyph->region.rect.h };
+            result.quads.push_back(quad);
+            result.width = std::max(result.width, quad.dst.x + quad.dst.w);
+        }
+
+        penX += glyph->advance;
+        previous = ch;
+    }
+    result.width = std::max(result.width, penX);
+
+    // 3. Сохраняем разметку, вытесняя самую давнюю
+    if (m_layouts.size() >= MAX_CACHED_LAYOUTS) {
+        m_layoutIndex.erase(m_layouts.back().first);
+        m_layouts.pop_back();
+    }
+
+    m_layouts.emplace_front(key, std::move(result));
+    m_layoutIndex[key] = m_layouts.begin();
+    return &m_layouts.front().second;
+}
+
+bool GlyphAtlas::draw(SDL_Renderer* renderer, const TextLayout& layout, float x, float y, float scale, SDL_Color color) {
+    // Глифы обычно лежат на одной странице, поэтому чаще всего это один вызов
+    for (int page = 0; page < m_atlas.getPageCount(); ++page) {
+        m_vertices.clear();
+        m_indices.clear();
+
+        SDL_Texture* texture = m_atlas.getPageTexture(page);
+        int pageWidth = 0, pageHeight = 0;
+        if (!texture || SDL_QueryTexture(texture, nullptr, nullptr, &pageWidth, &pageHeight) != 0 ||
+            pageWidth <= 0 || pageHeight <= 0) {
+            continue;
+        }
+        float invWidth = 1.0f / static_cast<float>(pageWidth);
+        float invHeight = 1.0f / static_cast<float>(pageHeight);
+
+        for (const GlyphQuad& quad : layout.quads) {
+            if (quad.page != page) {
+                continue;
+            }
+
+            float left = x + quad.dst.x * scale;
+            float top = y + quad.dst.y * scale;
+            float right = left + quad.dst.w * scale;
+            float bottom = top + quad.dst.h * scale;
+
+            float u0 = quad.src.x * invWidth;
+            float v0 = quad.src.y * invHeight;
+            float u1 = (quad.src.x + quad.src.w) * invWidth;
+            float v1 = (quad.src.y + quad.src.h) * invHeight;
+
+            int base = static_cast<int>(m_vertices.size());
+            m_vertices.push_back({ { left, top }, color, { u0, v0 } });
+            m_vertices.push_back({ { right, top }, color, { u1, v0 } });
+            m_vertices.push_back({ { right, bottom }, color, { u1, v1 } });
+            m_vertices.push_back({ { left, bottom }, color, { u0, v1 } });
+
+            m_indices.insert(m_indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+        }
+
+        if (m_indices.empty()) {
+            continue;
+        }
+
+        RenderStats::getInstance().addDrawCalls();
+        if (SDL_RenderGeometry(renderer, texture,
+            m_vertices.data(), static_cast<int>(m_vertices.size()),
+            m_indices.data(), static_cast<int>(m_indices.size())) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void GlyphAtlas::clear() {
+    m_layouts.clear();
+    m_layoutIndex.clear();
+    m_glyphs.clear();
+    m_atlas.releaseTextures();
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::getGlyph(SDL_Renderer* renderer, TTF_Font* font, Uint32 ch) {
+    auto& fontGlyphs = m_glyphs[font];
+    auto found = fontGlyphs.find(ch);
+    if (found != fontGlyphs.end()) {
+        return &found->second;
+    }
+
+    Glyph glyph;
+    int minX = 0, maxX = 0, minY = 0, maxY = 0;
+    if (TTF_GlyphMetrics32(font, ch, &minX, &maxX, &minY, &maxY, &glyph.advance) != 0) {
+        glyph.advance = 0;
+    }
+
+    // Изображение глифа начинается левее пера, если у него отрицательный minx
+    glyph.offsetX = std::min(0, minX);
+
+    // Глиф растеризуется белым, цвет задается вершинами при выводе
+    SDL_Surface* surface = TTF_RenderGlyph32_Blended(font, ch, SDL_Color{ 255, 255, 255, 255 });
+    if (surface) {
+        if (surface->w > 0 && surface->h > 0) {
+            glyph.region = m_atlas.addSurface(renderer, surface);
+            if (!glyph.region.isValid()) {
+                SDL_FreeSurface(surface);
+                return nullptr;
+            }
+        }
+        SDL_FreeSurface(surface);
+    }
+
+    return &(fontGlyphs[ch] = glyph);
+}
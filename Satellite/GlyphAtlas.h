@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include "TextureAtlas.h"
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Атлас глифов и кэш размеченных строк для вывода текста
+ *
+ * Каждый глиф растеризуется один раз для шрифта (белым цветом) и хранится
+ * в странице TextureAtlas. Строка раскладывается в набор прямоугольников
+ * с учетом кернинга и выводится одним вызовом SDL_RenderGeometry на страницу,
+ * цвет задается цветом вершин. Последние MAX_CACHED_LAYOUTS разметок
+ * хранятся в LRU-кэше, поэтому постоянные надписи не раскладываются заново.
+ */
+class GlyphAtlas {
+public:
+    static constexpr int PAGE_SIZE = 1024;            ///< Сторона страницы атласа
+    static constexpr int MAX_PAGES = 2;               ///< Максимальное количество страниц
+    static constexpr size_t MAX_CACHED_LAYOUTS = 256; ///< Емкость кэша разметок
+
+    /**
+     * @brief Прямоугольник одного глифа в разметке строки
+     */
+    struct GlyphQuad {
+        int page;      ///< Страница атласа
+        SDL_Rect src;  ///< Область глифа в странице
+        SDL_Rect dst;  ///< Положение относительно левого верхнего угла строки
+    };
+
+    /**
+     * @brief Разметка строки
+     */
+    struct TextLayout {
+        int width = 0;                 ///< Ширина строки в пикселях
+        int height = 0;                ///< Высота строки в пикселях
+        std::vector<GlyphQuad> quads;  ///< Прямоугольники видимых глифов
+    };
+
+    /**
+     * @brief Конструктор
+     */
+    GlyphAtlas();
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    /**
+     * @brief Получение разметки строки (из кэша или с раскладкой)
+     *
+     * Байты строки трактуются как Latin-1, как в TTF_RenderText_Blended.
+     * Указатель действителен до следующего вызова layout или clear.
+     *
+     * @param renderer SDL рендерер
+     * @param font Шрифт
+     * @param text Строка
+     * @return Разметка или nullptr, если глифы не поместились в атлас
+     */
+    const TextLayout* layout(SDL_Renderer* renderer, TTF_Font* font, const std::string& text);
+
+    /**
+     * @brief Вывод размеченной строки
+     * @param renderer SDL рендерер
+     * @param layout Разметка строки
+     * @param x X левого верхнего угла строки
+     * @param y Y левого верхнего угла строки
+     * @param scale Масштаб строки
+     * @param color Цвет текста
+     * @return true в случае успеха
+     */
+    bool draw(SDL_Renderer* renderer, const TextLayout& layout, float x, float y, float scale, SDL_Color color);
+
+    /**
+     * @brief Сброс глифов и разметок с освобождением страниц
+     *
+     * Нужен при удалении шрифтов и после потери текстур (сброс устройства).
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Глиф в атласе
+     */
+    struct Glyph {
+        TextureAtlas::Region region;  ///< Область в атласе (невалидная для пустых глифов)
+        int offsetX = 0;              ///< Смещение изображения относительно пера
+        int advance = 0;              ///< Сдвиг пера после глифа
+    };
+
+    /**
+     * @brief Получение глифа с растеризацией при первом обращении
+     * @param renderer SDL рендерер
+     * @param font Шрифт
+     * @param ch Код символа
+     * @return Глиф или nullptr, если атлас заполнен
+     */
+    const Glyph* getGlyph(SDL_Renderer* renderer, TTF_Font* font, Uint32 ch);
+
+    typedef std::list<std::pair<std::string, TextLayout>> LayoutList;
+
+    TextureAtlas m_atlas;                                                      ///< Страницы с глифами
+    std::unordered_map<TTF_Font*, std::unordered_map<Uint32, Glyph>> m_glyphs; ///< Глифы по шрифтам
+    LayoutList m_layouts;                                                      ///< Разметки (недавние - в начале)
+    std::unordered_map<std::string, LayoutList::iterator> m_layoutIndex;        ///< Поиск разметки по ключу
+    std::vector<SDL_Vertex> m_vertices;                                        ///< Буфер вершин для вывода
+    std::vector<int> m_indices;                                                ///< Буфер индексов для вывода
+};
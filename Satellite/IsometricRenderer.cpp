@@ -1,12 +1,22 @@
 ﻿#include "IsometricRenderer.h"
+#include "RenderStats.h"
+#include "Logger.h"
 #include <algorithm>
 #include <cmath>
 #include <vector>
 #include <iostream>
 
+namespace {
+    /**
+     * @brief Вершины ромба внутри области изометрической текстуры (верх, право, низ, лево)
+     */
+    const SDL_FPoint DIAMOND_TEX_COORDS[4] = { { 0.5f, 0.0f }, { 1.0f, 0.5f }, { 0.5f, 1.0f }, { 0.0f, 0.5f } };
+}
+
 IsometricRenderer::IsometricRenderer(int tileWidth, int tileHeight)
     : m_tileWidth(tileWidth), m_tileHeight(tileHeight),
-    m_cameraX(0.0f), m_cameraY(0.0f), m_cameraZoom(1.0f) {
+    m_cameraX(0.0f), m_cameraY(0.0f), m_cameraZoom(1.0f),
+    m_faceBackend(FaceBackend::GEOMETRY) {
 }
 
 IsometricRenderer::~IsometricRenderer() {
@@ -65,6 +75,20 @@ void IsometricRenderer::renderTile(SDL_Renderer* renderer, float worldX, float w
     points[2] = { baseX, baseY + scaledTileHeight - heightOffset };          // Нижняя вершина
     points[3] = { baseX - scaledTileWidth / 2, baseY + scaledTileHeight / 2 - heightOffset }; // Левая вершина
 
+    // В пакетном режиме только накапливаем вершины
+    if (m_faceBackend == FaceBackend::GEOMETRY) {
+        batchQuad(points, color);
+        batchOutline(points, 4, color);
+        return;
+    }
+
+    // Программный растеризатор рисует в свой кадровый буфер (при ошибке - построчно через SDL)
+    if (m_faceBackend == FaceBackend::SOFTWARE && m_rasterizer.begin(renderer)) {
+        m_rasterizer.fillDiamond(points, color);
+        m_rasterizer.drawOutline(points, 4, color);
+        return;
+    }
+
     // Устанавливаем цвет
     SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
 
@@ -77,13 +101,21 @@ void IsometricRenderer::renderTile(SDL_Renderer* renderer, float worldX, float w
             points[i].x, points[i].y,
             points[(i + 1) % 4].x, points[(i + 1) % 4].y);
     }
+    RenderStats::getInstance().addDrawCalls(4);
+}
+
+void IsometricRenderer::renderVolumetricTile(SDL_Renderer* renderer, float worldX, float worldY, float height,
+    SDL_Color topColor, SDL_Color leftColor, SDL_Color rightColor, int centerX, int centerY,
+    Uint8 faceMask) const {
+    renderVolumetricTile(renderer, worldX, worldY, height,
+        TilePalette::makeEntry(topColor, leftColor, rightColor), centerX, centerY, faceMask);
 }
 
 void IsometricRenderer::renderVolumetricTile(SDL_Renderer* renderer, float worldX, float worldY, float height,
-    SDL_Color topColor, SDL_Color leftColor, SDL_Color rightColor, int centerX, int centerY) const {
+    const TilePalette::Entry& colors, int centerX, int centerY, Uint8 faceMask) const {
     if (height <= 0.0f) {
         // Если высота нулевая или отрицательная, рисуем обычный тайл
-        renderTile(renderer, worldX, worldY, 0.0f, topColor, centerX, centerY);
+        renderTile(renderer, worldX, worldY, 0.0f, colors.top, centerX, centerY);
         return;
     }
 
@@ -123,30 +155,69 @@ void IsometricRenderer::renderVolumetricTile(SDL_Renderer* renderer, float world
     rightFace[2] = { baseX + scaledTileWidth / 2, baseY + scaledTileHeight / 2 }; // Нижняя правая
     rightFace[3] = { baseX, baseY + scaledTileHeight }; // Нижняя левая
 
+    // В пакетном режиме грани и контуры добавляются в общий буфер вершин в том же порядке
+    if (m_faceBackend == FaceBackend::GEOMETRY) {
+        if (faceMask & FACE_LEFT) batchQuad(leftFace, colors.left);
+        if (faceMask & FACE_RIGHT) batchQuad(rightFace, colors.right);
+        if (faceMask & FACE_TOP) batchQuad(topFace, colors.top);
+        if (faceMask & FACE_TOP) batchOutline(topFace, 4, colors.topOutline);
+        if (faceMask & FACE_LEFT) batchOutline(leftFace, 4, colors.leftOutline);
+        if (faceMask & FACE_RIGHT) batchOutline(rightFace, 4, colors.rightOutline);
+        return;
+    }
+
+    if (m_faceBackend == FaceBackend::SOFTWARE && m_rasterizer.begin(renderer)) {
+        if (faceMask & FACE_LEFT) m_rasterizer.fillLeftFace(leftFace, colors.left);
+        if (faceMask & FACE_RIGHT) m_rasterizer.fillRightFace(rightFace, colors.right);
+        if (faceMask & FACE_TOP) m_rasterizer.fillDiamond(topFace, colors.top);
+        if (faceMask & FACE_TOP) m_rasterizer.drawOutline(topFace, 4, colors.topOutline);
+        if (faceMask & FACE_LEFT) m_rasterizer.drawOutline(leftFace, 4, colors.leftOutline);
+        if (faceMask & FACE_RIGHT) m_rasterizer.drawOutline(rightFace, 4, colors.rightOutline);
+        return;
+    }
+
     // Сначала рисуем левую и правую грани, затем верхнюю для правильного перекрытия
-    SDL_SetRenderDrawColor(renderer, leftColor.r, leftColor.g, leftColor.b, leftColor.a);
-    fillPolygon(renderer, leftFace, 4);
+    if (faceMask & FACE_LEFT) {
+        SDL_SetRenderDrawColor(renderer, colors.left.r, colors.left.g, colors.left.b, colors.left.a);
+        fillPolygon(renderer, leftFace, 4);
+    }
 
-    SDL_SetRenderDrawColor(renderer, rightColor.r, rightColor.g, rightColor.b, rightColor.a);
-    fillPolygon(renderer, rightFace, 4);
+    if (faceMask & FACE_RIGHT) {
+        SDL_SetRenderDrawColor(renderer, colors.right.r, colors.right.g, colors.right.b, colors.right.a);
+        fillPolygon(renderer, rightFace, 4);
+    }
 
-    SDL_SetRenderDrawColor(renderer, topColor.r, topColor.g, topColor.b, topColor.a);
-    fillPolygon(renderer, topFace, 4);
+    if (faceMask & FACE_TOP) {
+        SDL_SetRenderDrawColor(renderer, colors.top.r, colors.top.g, colors.top.b, colors.top.a);
+        fillPolygon(renderer, topFace, 4);
+    }
 
     // Рисуем контуры для четкости
-    SDL_SetRenderDrawColor(renderer, topColor.r * 0.8, topColor.g * 0.8, topColor.b * 0.8, topColor.a);
-    for (int i = 0; i < 4; ++i) {
-        SDL_RenderDrawLine(renderer, topFace[i].x, topFace[i].y, topFace[(i + 1) % 4].x, topFace[(i + 1) % 4].y);
+    if (faceMask & FACE_TOP) {
+        const SDL_Color& outline = colors.topOutline;
+        SDL_SetRenderDrawColor(renderer, outline.r, outline.g, outline.b, outline.a);
+        for (int i = 0; i < 4; ++i) {
+            SDL_RenderDrawLine(renderer, topFace[i].x, topFace[i].y, topFace[(i + 1) % 4].x, topFace[(i + 1) % 4].y);
+        }
+        RenderStats::getInstance().addDrawCalls(4);
     }
 
-    SDL_SetRenderDrawColor(renderer, leftColor.r * 0.8, leftColor.g * 0.8, leftColor.b * 0.8, leftColor.a);
-    for (int i = 0; i < 4; ++i) {
-        SDL_RenderDrawLine(renderer, leftFace[i].x, leftFace[i].y, leftFace[(i + 1) % 4].x, leftFace[(i + 1) % 4].y);
+    if (faceMask & FACE_LEFT) {
+        const SDL_Color& outline = colors.leftOutline;
+        SDL_SetRenderDrawColor(renderer, outline.r, outline.g, outline.b, outline.a);
+        for (int i = 0; i < 4; ++i) {
+            SDL_RenderDrawLine(renderer, leftFace[i].x, leftFace[i].y, leftFace[(i + 1) % 4].x, leftFace[(i + 1) % 4].y);
+        }
+        RenderStats::getInstance().addDrawCalls(4);
     }
 
-    SDL_SetRenderDrawColor(renderer, rightColor.r * 0.8, rightColor.g * 0.8, rightColor.b * 0.8, rightColor.a);
-    for (int i = 0; i < 4; ++i) {
-        SDL_RenderDrawLine(renderer, rightFace[i].x, rightFace[i].y, rightFace[(i + 1) % 4].x, rightFace[(i + 1) % 4].y);
+    if (faceMask & FACE_RIGHT) {
+        const SDL_Color& outline = colors.rightOutline;
+        SDL_SetRenderDrawColor(renderer, outline.r, outline.g, outline.b, outline.a);
+        for (int i = 0; i < 4; ++i) {
+            SDL_RenderDrawLine(renderer, rightFace[i].x, rightFace[i].y, rightFace[(i + 1) % 4].x, rightFace[(i + 1) % 4].y);
+        }
+        RenderStats::getInstance().addDrawCalls(4);
     }
 }
 
@@ -303,12 +374,131 @@ void IsometricRenderer::fillPolygon(SDL_Renderer* renderer, const SDL_Point* poi
         for (size_t i = 0; i < nodeX.size(); i += 2) {
             if (i + 1 < nodeX.size()) {
                 SDL_RenderDrawLine(renderer, nodeX[i], y, nodeX[i + 1], y);
+                RenderStats::getInstance().addDrawCalls();
             }
         }
     }
 }
 
-void IsometricRenderer::renderTileWithTexture(SDL_Renderer* renderer, SDL_Texture* texture,
+void IsometricRenderer::batchQuad(const SDL_Point* points, SDL_Color color) const {
+    int base = static_cast<int>(m_vertices.size());
+
+    for (int i = 0; i < 4; ++i) {
+        SDL_Vertex vertex;
+        vertex.position = { static_cast<float>(points[i].x), static_cast<float>(points[i].y) };
+        vertex.color = color;
+        vertex.tex_coord = { 0.0f, 0.0f };
+        m_vertices.push_back(vertex);
+    }
+
+    // Грани выпуклые, поэтому веер из первой вершины дает корректное разбиение
+    const int quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+    for (int index : quadIndices) {
+        m_indices.push_back(base + index);
+    }
+}
+
+void IsometricRenderer::batchOutline(const SDL_Point* points, int count, SDL_Color color) const {
+    for (int i = 0; i < count; ++i) {
+        const SDL_Point& a = points[i];
+        const SDL_Point& b = points[(i + 1) % count];
+
+        // Линия превращается в полоску шириной 1 пиксель вдоль меньшей оси наклона,
+        // что совпадает с покрытием SDL_RenderDrawLine для изометрических ребер
+        int dx = std::abs(b.x - a.x);
+        int dy = std::abs(b.y - a.y);
+        int offsetX = (dx >= dy) ? 0 : 1;
+        int offsetY = (dx >= dy) ? 1 : 0;
+
+        SDL_Point strip[4] = {
+            a,
+            b,
+            { b.x + offsetX, b.y + offsetY },
+            { a.x + offsetX, a.y + offsetY }
+        };
+        batchQuad(strip, color);
+    }
+}
+
+void IsometricRenderer::flush(SDL_Renderer* renderer) {
+    // Кадровый буфер программного растеризатора выводится одной текстурой
+    if (m_rasterizer.isActive() && !m_rasterizer.present(renderer)) {
+        LOG_WARNING("Software rasterizer output failed, falling back to SDL_RenderGeometry");
+        m_faceBackend = FaceBackend::GEOMETRY;
+    }
+
+    if (m_indices.empty()) {
+        return;
+    }
+
+    RenderStats::getInstance().addDrawCalls();
+    if (SDL_RenderGeometry(renderer, nullptr,
+        m_vertices.data(), static_cast<int>(m_vertices.size()),
+        m_indices.data(), static_cast<int>(m_indices.size())) != 0) {
+        // Рендерер не поддерживает геометрию - возвращаемся к построчной заливке
+        LOG_WARNING("SDL_RenderGeometry failed, falling back to scanline fill: " + std::string(SDL_GetError()));
+        m_faceBackend = FaceBackend::SCANLINE;
+
+        // Пакет этого кадра дорисовываем построчно: каждая грань - 4 вершины и 6 индексов
+        for (size_t base = 0; base + 4 <= m_vertices.size(); base += 4) {
+            SDL_Point quad[4];
+            for (int i = 0; i < 4; ++i) {
+                quad[i].x = static_cast<int>(m_vertices[base + i].position.x);
+                quad[i].y = static_cast<int>(m_vertices[base + i].position.y);
+            }
+
+            const SDL_Color& color = m_vertices[base].color;
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+            fillPolygon(renderer, quad, 4);
+        }
+    }
+
+    m_vertices.clear();
+    m_indices.clear();
+}
+
+bool IsometricRenderer::renderAtlasQuad(SDL_Renderer* renderer, const TextureAtlas& atlas,
+    const TextureAtlas::Region& region, const SDL_Point* points,
+    const SDL_FPoint* texCoords) const {
+    SDL_Texture* page = atlas.getPageTexture(region.page);
+    int pageWidth = 0, pageHeight = 0;
+    if (!page || SDL_QueryTexture(page, nullptr, nullptr, &pageWidth, &pageHeight) != 0) {
+        return false;
+    }
+
+    // 1. Текстурные координаты переводятся из долей области в доли страницы
+    SDL_Vertex vertices[4];
+    for (int i = 0; i < 4; ++i) {
+        vertices[i].position = { static_cast<float>(points[i].x), static_cast<float>(points[i].y) };
+        vertices[i].color = { 255, 255, 255, 255 };
+        vertices[i].tex_coord = {
+            (region.rect.x + texCoords[i].x * region.rect.w) / pageWidth,
+            (region.rect.y + texCoords[i].y * region.rect.h) / pageHeight
+        };
+    }
+
+    // 2. Все области одной страницы выводятся с одной текстурой и объединяются рендерером в пакет
+    const int quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+    RenderStats::getInstance().addDrawCalls();
+    if (SDL_RenderGeometry(renderer, page, vertices, 4, quadIndices, 6) == 0) {
+        return true;
+    }
+
+    // 3. Без поддержки геометрии копируем область в описанный прямоугольник
+    int minX = points[0].x, maxX = points[0].x;
+    int minY = points[0].y, maxY = points[0].y;
+    for (int i = 1; i < 4; ++i) {
+        minX = std::min(minX, points[i].x);
+        maxX = std::max(maxX, points[i].x);
+        minY = std::min(minY, points[i].y);
+        maxY = std::max(maxY, points[i].y);
+    }
+    SDL_Rect destRect = { minX, minY, maxX - minX, maxY - minY };
+    return SDL_RenderCopy(renderer, page, &region.rect, &destRect) == 0;
+}
+
+void IsometricRenderer::renderTileWithTexture(SDL_Renderer* renderer,
+    const TextureAtlas& atlas, const TextureAtlas::Region& region,
     float worldX, float worldY, float height,
     int centerX, int centerY) const {
 
@@ -335,20 +525,22 @@ void IsometricRenderer::renderTileWithTexture(SDL_Renderer* renderer, SDL_Textur
     points[2] = { screenX, screenY + scaledTileHeight };             // Нижняя вершина
     points[3] = { screenX - scaledTileWidth / 2, screenY + scaledTileHeight / 2 }; // Левая вершина
 
-    // 6. Выбираем цвет в зависимости от положения (шахматный порядок)
-    SDL_Color tileColor;
-    if ((int)(worldX + worldY) % 2 == 0) {
-        // Для травы - зеленый
-        tileColor = { 30, 150, 30, 255 };
-    }
-    else {
-        // Для камня - светло-серый
-        tileColor = { 180, 180, 180, 255 };
-    }
+    // 6. Выводим ромб из области атласа (изометрическая текстура вписана в нее ромбом)
+    if (!region.isValid() || !renderAtlasQuad(renderer, atlas, region, points, DIAMOND_TEX_COORDS)) {
+        // 7. Без текстуры выбираем цвет в зависимости от положения (шахматный порядок)
+        SDL_Color tileColor;
+        if ((int)(worldX + worldY) % 2 == 0) {
+            // Для травы - зеленый
+            tileColor = { 30, 150, 30, 255 };
+        }
+        else {
+            // Для камня - светло-серый
+            tileColor = { 180, 180, 180, 255 };
+        }
 
-    // 7. Заполняем ромб выбранным цветом
-    SDL_SetRenderDrawColor(renderer, tileColor.r, tileColor.g, tileColor.b, tileColor.a);
-    fillPolygon(renderer, points, 4);
+        SDL_SetRenderDrawColor(renderer, tileColor.r, tileColor.g, tileColor.b, tileColor.a);
+        fillPolygon(renderer, points, 4);
+    }
 
     // 8. Добавляем тонкую рамку
     SDL_SetRenderDrawColor(renderer, 20, 35, 20, 255);
@@ -360,17 +552,18 @@ void IsometricRenderer::renderTileWithTexture(SDL_Renderer* renderer, SDL_Textur
 }
 
 void IsometricRenderer::renderVolumetricTileWithTextures(SDL_Renderer* renderer,
-    SDL_Texture* topTexture,
-    SDL_Texture* leftTexture,
-    SDL_Texture* rightTexture,
+    const TextureAtlas& atlas,
+    const TextureAtlas::Region& topRegion,
+    const TextureAtlas::Region& leftRegion,
+    const TextureAtlas::Region& rightRegion,
     float worldX, float worldY, float height,
     int centerX, int centerY) const {
 
     // 1. Проверка наличия высоты и текстур
     if (height <= 0.0f) {
         // Если высота нулевая или отрицательная, рисуем обычный тайл
-        if (topTexture) {
-            renderTileWithTexture(renderer, topTexture, worldX, worldY, 0.0f, centerX, centerY);
+        if (topRegion.isValid()) {
+            renderTileWithTexture(renderer, atlas, topRegion, worldX, worldY, 0.0f, centerX, centerY);
         }
         else {
             SDL_Color grayColor = { 150, 150, 150, 255 };
@@ -416,44 +609,19 @@ void IsometricRenderer::renderVolumetricTileWithTextures(SDL_Renderer* renderer,
     rightFace[2] = { screenX + scaledTileWidth / 2, screenY + scaledTileHeight / 2 };
     rightFace[3] = { screenX, screenY + scaledTileHeight };
 
-    // 9. Отрисовка левой грани с улучшенными параметрами для текстуры
-    if (leftTexture) {
-        // Создаем целевую область для левой грани с точными координатами
-        SDL_Rect leftRect = {
-            std::min(leftFace[0].x, leftFace[3].x),
-            std::min(leftFace[0].y, leftFace[1].y),
-            abs(leftFace[1].x - leftFace[0].x),
-            abs(leftFace[3].y - leftFace[0].y)
-        };
+    // Боковые грани перечислены от верхнего левого угла по часовой стрелке, как и их текстуры
+    const SDL_FPoint faceCoords[4] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
 
-        // Применяем текстуру с корректным форматом
-        SDL_SetTextureBlendMode(leftTexture, SDL_BLENDMODE_BLEND);
-        SDL_SetTextureAlphaMod(leftTexture, 255);
-        SDL_RenderCopy(renderer, leftTexture, nullptr, &leftRect);
-    }
-    else {
+    // 9. Отрисовка левой грани из области атласа
+    if (!leftRegion.isValid() || !renderAtlasQuad(renderer, atlas, leftRegion, leftFace, faceCoords)) {
         // Улучшенное цветовое затенение с увеличенным контрастом
         SDL_Color leftColor = { 120, 120, 120, 255 };
         SDL_SetRenderDrawColor(renderer, leftColor.r, leftColor.g, leftColor.b, leftColor.a);
         fillPolygon(renderer, leftFace, 4);
     }
 
-    // 10. Отрисовка правой грани с улучшенными параметрами для текстуры
-    if (rightTexture) {
-        // Создаем целевую область для правой грани с точными координатами
-        SDL_Rect rightRect = {
-            std::min(rightFace[0].x, rightFace[3].x),
-            std::min(rightFace[0].y, rightFace[1].y),
-            abs(rightFace[1].x - rightFace[0].x),
-            abs(rightFace[3].y - rightFace[0].y)
-        };
-
-        // Применяем текстуру с корректным форматом
-        SDL_SetTextureBlendMode(rightTexture, SDL_BLENDMODE_BLEND);
-        SDL_SetTextureAlphaMod(rightTexture, 255);
-        SDL_RenderCopy(renderer, rightTexture, nullptr, &rightRect);
-    }
-    else {
+    // 10. Отрисовка правой грани из области атласа
+    if (!rightRegion.isValid() || !renderAtlasQuad(renderer, atlas, rightRegion, rightFace, faceCoords)) {
         // Улучшенное цветовое затенение с увеличенным контрастом
         SDL_Color rightColor = { 80, 80, 80, 255 };
         SDL_SetRenderDrawColor(renderer, rightColor.r, rightColor.g, rightColor.b, rightColor.a);
@@ -461,21 +629,7 @@ void IsometricRenderer::renderVolumetricTileWithTextures(SDL_Renderer* renderer,
     }
 
     // 11. Отрисовка верхней грани (ромба) поверх остальных граней
-    if (topTexture) {
-        // Создаем область для отрисовки верхней грани с точными координатами
-        SDL_Rect topRect = {
-            topFace[3].x,
-            topFace[0].y,
-            topFace[1].x - topFace[3].x,
-            topFace[2].y - topFace[0].y
-        };
-
-        // Применяем текстуру с корректным форматом
-        SDL_SetTextureBlendMode(topTexture, SDL_BLENDMODE_BLEND);
-        SDL_SetTextureAlphaMod(topTexture, 255);
-        SDL_RenderCopy(renderer, topTexture, nullptr, &topRect);
-    }
-    else {
+    if (!topRegion.isValid() || !renderAtlasQuad(renderer, atlas, topRegion, topFace, DIAMOND_TEX_COORDS)) {
         // Стандартное заполнение цветом
         SDL_Color topColor = { 150, 150, 150, 255 };
         SDL_SetRenderDrawColor(renderer, topColor.r, topColor.g, topColor.b, topColor.a);
@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include "TilePalette.h"
+#include "SoftwareRasterizer.h"
+#include "TextureAtlas.h"
 #include <SDL.h>
 #include <vector>
 
@@ -11,6 +14,25 @@ public:
     // Константа для масштабирования высоты
     static constexpr float HEIGHT_SCALE = 30.0f;  // Увеличено с 20.0f для более выраженного 3D-эффекта
 
+    /**
+     * @brief Битовая маска граней объемного тайла
+     */
+    enum FaceMask : Uint8 {
+        FACE_TOP = 1 << 0,    ///< Верхняя грань
+        FACE_LEFT = 1 << 1,   ///< Левая грань (обращена к тайлу X, Y+1)
+        FACE_RIGHT = 1 << 2,  ///< Правая грань (обращена к тайлу X+1, Y)
+        FACE_ALL = FACE_TOP | FACE_LEFT | FACE_RIGHT
+    };
+
+    /**
+     * @brief Способ отрисовки граней тайлов
+     */
+    enum class FaceBackend {
+        SCANLINE,   ///< Построчная заливка через SDL_RenderDrawLine (исходный путь)
+        GEOMETRY,   ///< Накопление треугольников и вывод пакетом через SDL_RenderGeometry
+        SOFTWARE    ///< Заливка в кадровый буфер SoftwareRasterizer и вывод одной текстурой
+    };
+
     /**
      * @brief Конструктор
      * @param tileWidth Ширина изометрического тайла
@@ -83,16 +105,22 @@ public:
         int centerX = 0, int centerY = 0) const;
 
     /**
-     * @brief Отрисовка изометрического тайла с текстурой
+     * @brief Отрисовка изометрического тайла с текстурой из атласа
+     *
+     * Ромб выводится геометрией со страницы атласа, поэтому тайлы с
+     * областями одной страницы рисуются без переключения текстуры.
+     *
      * @param renderer SDL рендерер
-     * @param texture Текстура для отрисовки
+     * @param atlas Атлас текстур
+     * @param region Область атласа (невалидная - заливка цветом)
      * @param worldX X координата в мировом пространстве
      * @param worldY Y координата в мировом пространстве
      * @param height Высота тайла (для объемных тайлов)
      * @param centerX X координата центра экрана (по умолчанию 0)
      * @param centerY Y координата центра экрана (по умолчанию 0)
      */
-    void renderTileWithTexture(SDL_Renderer* renderer, SDL_Texture* texture,
+    void renderTileWithTexture(SDL_Renderer* renderer,
+        const TextureAtlas& atlas, const TextureAtlas::Region& region,
         float worldX, float worldY, float height,
         int centerX = 0, int centerY = 0) const;
 
@@ -107,17 +135,34 @@ public:
      * @param rightColor Цвет правой грани
      * @param centerX X координата центра экрана (по умолчанию 0)
      * @param centerY Y координата центра экрана (по умолчанию 0)
+     * @param faceMask Маска рисуемых граней (скрытые соседями грани пропускаются)
      */
     void renderVolumetricTile(SDL_Renderer* renderer, float worldX, float worldY, float height,
         SDL_Color topColor, SDL_Color leftColor, SDL_Color rightColor,
-        int centerX = 0, int centerY = 0) const;
+        int centerX = 0, int centerY = 0, Uint8 faceMask = FACE_ALL) const;
 
     /**
-     * @brief Отрисовка изометрического объемного тайла с текстурами
+     * @brief Отрисовка изометрического объемного тайла с готовыми цветами граней и контуров
      * @param renderer SDL рендерер
-     * @param topTexture Текстура для верхней грани
-     * @param leftTexture Текстура для левой грани
-     * @param rightTexture Текстура для правой грани
+     * @param worldX X координата в мировом пространстве
+     * @param worldY Y координата в мировом пространстве
+     * @param height Высота тайла (для объемных тайлов)
+     * @param colors Запись палитры с цветами граней и контуров
+     * @param centerX X координата центра экрана (по умолчанию 0)
+     * @param centerY Y координата центра экрана (по умолчанию 0)
+     * @param faceMask Маска рисуемых граней (скрытые соседями грани пропускаются)
+     */
+    void renderVolumetricTile(SDL_Renderer* renderer, float worldX, float worldY, float height,
+        const TilePalette::Entry& colors,
+        int centerX = 0, int centerY = 0, Uint8 faceMask = FACE_ALL) const;
+
+    /**
+     * @brief Отрисовка изометрического объемного тайла с текстурами из атласа
+     * @param renderer SDL рендерер
+     * @param atlas Атлас текстур
+     * @param topRegion Область для верхней грани (невалидная - заливка цветом)
+     * @param leftRegion Область для левой грани (невалидная - заливка цветом)
+     * @param rightRegion Область для правой грани (невалидная - заливка цветом)
      * @param worldX X координата в мировом пространстве
      * @param worldY Y координата в мировом пространстве
      * @param height Высота тайла (для объемных тайлов)
@@ -125,9 +170,10 @@ public:
      * @param centerY Y координата центра экрана (по умолчанию 0)
      */
     void renderVolumetricTileWithTextures(SDL_Renderer* renderer,
-        SDL_Texture* topTexture,
-        SDL_Texture* leftTexture,
-        SDL_Texture* rightTexture,
+        const TextureAtlas& atlas,
+        const TextureAtlas::Region& topRegion,
+        const TextureAtlas::Region& leftRegion,
+        const TextureAtlas::Region& rightRegion,
         float worldX, float worldY, float height,
         int centerX = 0, int centerY = 0) const;
 
@@ -216,6 +262,36 @@ public:
      */
     float getCameraZoom() const { return m_cameraZoom; }
 
+    /**
+     * @brief Выбор способа отрисовки граней
+     * @param backend Способ отрисовки
+     */
+    void setFaceBackend(FaceBackend backend) { m_faceBackend = backend; }
+
+    /**
+     * @brief Получение текущего способа отрисовки граней
+     * @return Способ отрисовки
+     */
+    FaceBackend getFaceBackend() const { return m_faceBackend; }
+
+    /**
+     * @brief Вывод накопленных граней одним вызовом SDL_RenderGeometry
+     *
+     * В режиме GEOMETRY renderTile и renderVolumetricTile только накапливают
+     * вершины, в режиме SOFTWARE - рисуют в кадровый буфер, который здесь
+     * выводится одной текстурой. Метод нужно вызывать перед любой отрисовкой
+     * в обход этого класса и перед сменой цели вывода, иначе нарушится
+     * порядок наложения.
+     *
+     * @param renderer SDL рендерер
+     */
+    void flush(SDL_Renderer* renderer);
+
+    /**
+     * @brief Освобождение текстур рендерера (после SDL_RENDER_DEVICE_RESET)
+     */
+    void releaseDeviceResources() { m_rasterizer.releaseTexture(); }
+
     void renderTexturedDiamond(SDL_Renderer* renderer, SDL_Texture* texture, SDL_Point* points) const;
 
     /**
@@ -241,6 +317,34 @@ private:
      */
     void fillPolygon(SDL_Renderer* renderer, const SDL_Point* points, int count) const;
 
+    /**
+     * @brief Добавление выпуклого четырехугольника в пакет (два треугольника)
+     * @param points Массив из 4 вершин
+     * @param color Цвет грани
+     */
+    void batchQuad(const SDL_Point* points, SDL_Color color) const;
+
+    /**
+     * @brief Добавление замкнутого контура в пакет (линии толщиной в 1 пиксель)
+     * @param points Массив вершин контура
+     * @param count Количество вершин
+     * @param color Цвет контура
+     */
+    void batchOutline(const SDL_Point* points, int count, SDL_Color color) const;
+
+    /**
+     * @brief Вывод четырехугольника с областью атласа
+     * @param renderer SDL рендерер
+     * @param atlas Атлас текстур
+     * @param region Область атласа
+     * @param points Массив из 4 вершин на экране
+     * @param texCoords Точки внутри области для каждой вершины (от 0.0 до 1.0)
+     * @return true, если четырехугольник выведен
+     */
+    bool renderAtlasQuad(SDL_Renderer* renderer, const TextureAtlas& atlas,
+        const TextureAtlas::Region& region, const SDL_Point* points,
+        const SDL_FPoint* texCoords) const;
+
     /**
      * @brief Отрисовка текстурированного полигона
      * @param renderer SDL рендерер
@@ -260,4 +364,9 @@ private:
     float m_cameraX;    ///< X координата камеры в мировом пространстве
     float m_cameraY;    ///< Y координата камеры в мировом пространстве
     float m_cameraZoom; ///< Масштаб камеры (1.0 - нормальный размер)
+
+    FaceBackend m_faceBackend;                 ///< Способ отрисовки граней
+    mutable std::vector<SDL_Vertex> m_vertices; ///< Накопленные вершины пакета
+    mutable std::vector<int> m_indices;         ///< Индексы треугольников пакета
+    mutable SoftwareRasterizer m_rasterizer;    ///< Кадровый буфер режима SOFTWARE
 };
\ No newline at end of file
@@ -0,0 +1,116 @@
+﻿#include "JobSystem.h"
+#include "Logger.h"
+#include <algorithm>
+
+JobSystem::JobSystem(int workerCount)
+    : m_job(nullptr), m_jobCount(0), m_nextIndex(0), m_completed(0),
+    m_activeWorkers(0), m_generation(0), m_stopping(false) {
+    if (workerCount < 0) {
+        // Одно ядро остается вызывающему потоку
+        unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = cores > 1 ? static_cast<int>(cores) - 1 : 0;
+    }
+
+    m_workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+
+    LOG_INFO("JobSystem started with " + std::to_string(workerCount) + " worker threads");
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::parallelFor(int count, const std::function<void(int)>& job) {
+    if (count <= 0) {
+        return;
+    }
+
+    // Без рабочих потоков или для одной задачи пул не нужен
+    if (m_workers.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    // 1. Публикуем пакет и будим рабочих
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_jobCount = count;
+        m_nextIndex.store(0);
+        m_completed.store(0);
+        m_generation++;
+    }
+    m_wakeCondition.notify_all();
+
+    // 2. Вызывающий поток работает наравне с остальными
+    runJobs(job, count);
+
+    // 3. Ждем, пока все задачи выполнены и ни один поток не держит ссылку на пакет
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this, count]() {
+        return m_completed.load() == count && m_activeWorkers == 0;
+    });
+    m_job = nullptr;
+    m_jobCount = 0;
+}
+
+void JobSystem::runJobs(const std::function<void(int)>& job, int count) {
+    while (true) {
+        int index = m_nextIndex.fetch_add(1);
+        if (index >= count) {
+            return;
+        }
+
+        job(index);
+        m_completed.fetch_add(1);
+    }
+}
+
+void JobSystem::workerLoop() {
+    unsigned int seenGeneration = 0;
+
+    while (true) {
+        const std::function<void(int)>* job = nullptr;
+        int count = 0;
+
+        // 1. Ждем новый пакет или остановку
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait(lock, [this, seenGeneration]() {
+                return m_stopping || (m_job && m_generation != seenGeneration);
+            });
+
+            if (m_stopping) {
+                return;
+            }
+
+            seenGeneration = m_generation;
+            job = m_job;
+            count = m_jobCount;
+            m_activeWorkers++;
+        }
+
+        // 2. Разбираем задачи пакета
+        runJobs(*job, count);
+
+        // 3. Отпускаем пакет; последний поток будит ожидающего
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeWorkers--;
+        }
+        m_doneCondition.notify_one();
+    }
+}
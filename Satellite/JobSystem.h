@@ -0,0 +1,75 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Пул рабочих потоков для параллельной обработки независимых задач
+ *
+ * Потоки создаются один раз и спят между вызовами parallelFor.
+ * Вызывающий поток тоже выполняет задачи, поэтому при нулевом числе
+ * рабочих потоков parallelFor просто выполняет все задачи по очереди.
+ */
+class JobSystem {
+public:
+    /**
+     * @brief Конструктор
+     * @param workerCount Количество рабочих потоков (-1 - по числу ядер минус один)
+     */
+    explicit JobSystem(int workerCount = -1);
+
+    /**
+     * @brief Деструктор (останавливает и присоединяет потоки)
+     */
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Получение количества потоков, выполняющих задачи
+     * @return Количество рабочих потоков плюс вызывающий
+     */
+    int getThreadCount() const { return static_cast<int>(m_workers.size()) + 1; }
+
+    /**
+     * @brief Выполнение задач с индексами [0, count) на всех потоках
+     *
+     * Возвращает управление после завершения всех задач. Задачи не должны
+     * бросать исключения и не должны вызывать parallelFor повторно.
+     *
+     * @param count Количество задач
+     * @param job Функция задачи, получает индекс задачи
+     */
+    void parallelFor(int count, const std::function<void(int)>& job);
+
+private:
+    /**
+     * @brief Цикл рабочего потока
+     */
+    void workerLoop();
+
+    /**
+     * @brief Выполнение задач текущего пакета, пока они не закончатся
+     * @param job Функция задачи
+     * @param count Количество задач в пакете
+     */
+    void runJobs(const std::function<void(int)>& job, int count);
+
+    std::vector<std::thread> m_workers;         ///< Рабочие потоки
+    std::mutex m_mutex;                         ///< Защита состояния пакета
+    std::condition_variable m_wakeCondition;    ///< Сигнал о новом пакете задач
+    std::condition_variable m_doneCondition;    ///< Сигнал о завершении пакета
+
+    const std::function<void(int)>* m_job;      ///< Функция текущего пакета
+    int m_jobCount;                             ///< Количество задач в пакете
+    std::atomic<int> m_nextIndex;               ///< Следующий невыданный индекс
+    std::atomic<int> m_completed;               ///< Количество выполненных задач
+    int m_activeWorkers;                        ///< Потоки, работающие над текущим пакетом
+    unsigned int m_generation;                  ///< Номер пакета (меняется при каждом parallelFor)
+    bool m_stopping;                            ///< Пул останавливается
+};
@@ -0,0 +1,487 @@
+﻿#include "LevelFile.h"
+#include "TileMap.h"
+#include "TileMapSnapshot.h"
+#include "ChunkCodec.h"
+#include "EntityManager.h"
+#include "Door.h"
+#include "Terminal.h"
+#include "PickupItem.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+constexpr Uint32 LevelFile::MAGIC;
+constexpr Uint16 LevelFile::VERSION;
+constexpr Uint16 LevelFile::MIN_VERSION;
+constexpr Uint32 LevelFile::FLAG_COMPRESSED_CHUNKS;
+constexpr Uint32 LevelFile::NO_CHUNK_DATA;
+constexpr Uint64 LevelFile::SECTION_ALIGNMENT;
+
+namespace {
+    /**
+     * @brief Выравнивание смещения вверх до границы секции
+     */
+    Uint64 alignSection(Uint64 offset) {
+        return (offset + LevelFile::SECTION_ALIGNMENT - 1) & ~(LevelFile::SECTION_ALIGNMENT - 1);
+    }
+
+    /**
+     * @brief Запись имени в поле фиксированной длины (с обрезкой и дополнением нулями)
+     */
+    template <size_t Length>
+    void writeName(char (&field)[Length], const std::string& name) {
+        std::memset(field, 0, Length);
+        std::memcpy(field, name.data(), std::min(name.size(), Length - 1));
+    }
+}
+
+LevelFile::LevelFile()
+    : m_header(nullptr), m_sections(nullptr), m_chunkIndex(nullptr),
+    m_types(nullptr), m_flags(nullptr), m_heights(nullptr), m_chunkOffsets(nullptr), m_chunkData(nullptr),
+    m_doors(nullptr), m_terminals(nullptr), m_pickups(nullptr),
+    m_doorCount(0), m_terminalCount(0), m_pickupCount(0) {
+}
+
+bool LevelFile::save(const std::string& path, const TileMap& map, const EntityManager* entities,
+    float spawnX, float spawnY, int biomeType, bool compressChunks, const ChunkReader& evictedChunks) {
+    int chunkCountX = map.getChunkCountX();
+    int chunkCountY = map.getChunkCountY();
+    int chunkCount = chunkCountX * chunkCountY;
+
+    // 1. Индекс чанков: неоднородные чанки получают номера по порядку
+    // и попадают в плоскости или сжимаются снимком
+    TileMapSnapshot snapshot;
+    std::vector<LevelChunkEntry> planeIndex;
+    std::vector<const TileChunk*> storedChunks;
+    std::vector<std::unique_ptr<TileChunk>> evictedTiles;
+    if (compressChunks) {
+        if (!snapshot.capture(map, evictedChunks)) {
+            LOG_ERROR("Failed to save level: " + path);
+            return false;
+        }
+    }
+    else {
+        planeIndex.resize(chunkCount);
+        for (int chunkY = 0; chunkY < chunkCountY; ++chunkY) {
+            for (int chunkX = 0; chunkX < chunkCountX; ++chunkX) {
+                LevelChunkEntry& entry = planeIndex[chunkY * chunkCountX + chunkX];
+                const TileChunk* tiles = map.getChunkTiles(chunkX, chunkY);
+                TileCell uniform = tiles ? TileCell() : map.getChunkUniformCell(chunkX, chunkY);
+
+                // Выгруженный чанк в карте - заглушка, настоящие тайлы читаются из источника
+                if (!map.isChunkResident(chunkX, chunkY)) {
+                    std::unique_ptr<TileChunk> evicted(new TileChunk());
+                    if (!evictedChunks || !evictedChunks(chunkX, chunkY, *evicted)) {
+                        LOG_ERROR("Failed to read evicted chunk (" + std::to_string(chunkX) + ", " +
+                            std::to_string(chunkY) + "), level not saved: " + path);
+                        return false;
+                    }
+
+                    tiles = nullptr;
+                    if (!evicted->isUniform(uniform)) {
+                        tiles = evicted.get();
+                        evictedTiles.push_back(std::move(evicted));
+                    }
+                }
+
+                entry.dataIndex = tiles ? static_cast<Uint32>(storedChunks.size()) : NO_CHUNK_DATA;
+                entry.type = uniform.type;
+                entry.flags = uniform.flags;
+                entry.height = uniform.height;
+                entry.reserved = 0;
+                if (tiles) {
+                    storedChunks.push_back(tiles);
+                }
+            }
+        }
+    }
+
+    const std::vector<LevelChunkEntry>& chunkIndex = compressChunks ? snapshot.getChunkIndex() : planeIndex;
+    size_t storedChunkCount = compressChunks ? snapshot.getChunkOffsets().size() - 1 : storedChunks.size();
+
+    // 2. Записи интерактивных объектов
+    std::vector<LevelDoorRecord> doors;
+    std::vector<LevelTerminalRecord> terminals;
+    std::vector<LevelPickupRecord> pickups;
+    if (entities) {
+        for (const auto& object : entities->getInteractiveObjects()) {
+            if (!object || !object->isActive()) {
+                continue;
+            }
+
+            const auto& position = object->getPosition();
+            if (auto door = std::dynamic_pointer_cast<Door>(object)) {
+                LevelDoorRecord record = {};
+                record.x = position.x;
+                record.y = position.y;
+                record.open = door->isOpen() ? 1 : 0;
+                record.vertical = door->isVertical() ? 1 : 0;
+                writeName(record.name, door->getName());
+                doors.push_back(record);
+            }
+            else if (auto terminal = std::dynamic_pointer_cast<Terminal>(object)) {
+                LevelTerminalRecord record = {};
+                record.x = position.x;
+                record.y = position.y;
+                record.type = static_cast<Uint8>(terminal->getTerminalType());
+                record.activated = terminal->isActivated() ? 1 : 0;
+                writeName(record.name, terminal->getName());
+                terminals.push_back(record);
+            }
+            else if (auto pickup = std::dynamic_pointer_cast<PickupItem>(object)) {
+                LevelPickupRecord record = {};
+                record.x = position.x;
+                record.y = position.y;
+                record.type = static_cast<Uint8>(pickup->getItemType());
+                record.value = pickup->getValue();
+                record.weight = pickup->getWeight();
+                writeName(record.name, pickup->getName());
+                pickups.push_back(record);
+            }
+        }
+    }
+
+    // 3. Раскладка секций
+    std::vector<LevelSectionEntry> sections;
+    auto addSection = [&sections](SectionType type, Uint64 size) {
+        LevelSectionEntry section = { static_cast<Uint32>(type), 0, 0, size };
+        sections.push_back(section);
+    };
+
+    addSection(SectionType::CHUNK_INDEX, chunkIndex.size() * sizeof(LevelChunkEntry));
+    if (compressChunks) {
+        addSection(SectionType::CHUNK_OFFSETS, snapshot.getChunkOffsets().size() * sizeof(Uint64));
+        addSection(SectionType::CHUNK_DATA, snapshot.getChunkData().size());
+    }
+    else {
+        Uint64 planeSize = static_cast<Uint64>(storedChunks.size()) * TileChunk::AREA;
+        addSection(SectionType::CHUNK_TYPES, planeSize);
+        addSection(SectionType::CHUNK_FLAGS, planeSize);
+        addSection(SectionType::CHUNK_HEIGHTS, planeSize);
+    }
+    addSection(SectionType::DOORS, doors.size() * sizeof(LevelDoorRecord));
+    addSection(SectionType::TERMINALS, terminals.size() * sizeof(LevelTerminalRecord));
+    addSection(SectionType::PICKUPS, pickups.size() * sizeof(LevelPickupRecord));
+
+    Uint64 tableEnd = sizeof(LevelFileHeader) + sections.size() * sizeof(LevelSectionEntry);
+    Uint64 offset = tableEnd;
+    for (LevelSectionEntry& section : sections) {
+        offset = alignSection(offset);
+        section.offset = offset;
+        offset += section.size;
+    }
+
+    LevelFileHeader header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.headerSize = sizeof(LevelFileHeader);
+    header.fileSize = offset;
+    header.width = static_cast<Uint32>(map.getWidth());
+    header.height = static_cast<Uint32>(map.getHeight());
+    header.chunkCountX = static_cast<Uint32>(chunkCountX);
+    header.chunkCountY = static_cast<Uint32>(chunkCountY);
+    header.storedChunkCount = static_cast<Uint32>(storedChunkCount);
+    header.sectionCount = static_cast<Uint32>(sections.size());
+    header.spawnX = spawnX;
+    header.spawnY = spawnY;
+    header.biomeType = biomeType;
+    header.flags = compressChunks ? FLAG_COMPRESSED_CHUNKS : 0;
+
+    // 4. Запись файла крупными блоками
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR("Failed to open level file for writing: " + path);
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(sections.data()),
+        static_cast<std::streamsize>(sections.size() * sizeof(LevelSectionEntry)));
+
+    const char padding[SECTION_ALIGNMENT] = {};
+    Uint64 position = tableEnd;
+    for (const LevelSectionEntry& section : sections) {
+        file.write(padding, static_cast<std::streamsize>(section.offset - position));
+        position = section.offset + section.size;
+
+        switch (static_cast<SectionType>(section.type)) {
+        case SectionType::CHUNK_INDEX:
+            file.write(reinterpret_cast<const char*>(chunkIndex.data()), static_cast<std::streamsize>(section.size));
+            break;
+        case SectionType::CHUNK_OFFSETS:
+            file.write(reinterpret_cast<const char*>(snapshot.getChunkOffsets().data()),
+                static_cast<std::streamsize>(section.size));
+            break;
+        case SectionType::CHUNK_DATA:
+            file.write(reinterpret_cast<const char*>(snapshot.getChunkData().data()),
+                static_cast<std::streamsize>(section.size));
+            break;
+        case SectionType::CHUNK_TYPES:
+            for (const TileChunk* tiles : storedChunks) {
+                file.write(reinterpret_cast<const char*>(tiles->types), TileChunk::AREA);
+            }
+            break;
+        case SectionType::CHUNK_FLAGS:
+            for (const TileChunk* tiles : storedChunks) {
+                file.write(reinterpret_cast<const char*>(tiles->flags), TileChunk::AREA);
+            }
+            break;
+        case SectionType::CHUNK_HEIGHTS:
+            for (const TileChunk* tiles : storedChunks) {
+                file.write(reinterpret_cast<const char*>(tiles->heights), TileChunk::AREA);
+            }
+            break;
+        case SectionType::DOORS:
+            file.write(reinterpret_cast<const char*>(doors.data()), static_cast<std::streamsize>(section.size));
+            break;
+        case SectionType::TERMINALS:
+            file.write(reinterpret_cast<const char*>(terminals.data()), static_cast<std::streamsize>(section.size));
+            break;
+        case SectionType::PICKUPS:
+            file.write(reinterpret_cast<const char*>(pickups.data()), static_cast<std::streamsize>(section.size));
+            break;
+        }
+    }
+
+    file.close();
+    if (!file) {
+        LOG_ERROR("Failed to write level file: " + path);
+        return false;
+    }
+
+    LOG_INFO("Level saved to " + path + ": " + std::to_string(storedChunkCount) + " of " +
+        std::to_string(chunkCount) + " chunks stored" + (compressChunks ? " compressed (" +
+        std::to_string(snapshot.getChunkData().size()) + " bytes)" : std::string()) + ", " +
+        std::to_string(doors.size()) + " doors, " +
+        std::to_string(terminals.size()) + " terminals, " + std::to_string(pickups.size()) + " pickups");
+    return true;
+}
+
+bool LevelFile::hasSignature(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    Uint32 magic = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    return file && magic == MAGIC;
+}
+
+bool LevelFile::open(const std::string& path) {
+    close();
+
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    if (!validate()) {
+        LOG_ERROR("Invalid level file: " + path);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void LevelFile::close() {
+    m_file.close();
+    m_header = nullptr;
+    m_sections = nullptr;
+    m_chunkIndex = nullptr;
+    m_types = nullptr;
+    m_flags = nullptr;
+    m_heights = nullptr;
+    m_chunkOffsets = nullptr;
+    m_chunkData = nullptr;
+    m_doors = nullptr;
+    m_terminals = nullptr;
+    m_pickups = nullptr;
+    m_doorCount = 0;
+    m_terminalCount = 0;
+    m_pickupCount = 0;
+}
+
+bool LevelFile::copyChunk(int chunkIndex, TileChunk& chunk) const {
+    const LevelChunkEntry& entry = m_chunkIndex[chunkIndex];
+    if (entry.dataIndex == NO_CHUNK_DATA) {
+        TileCell uniform;
+        uniform.type = entry.type;
+        uniform.flags = entry.flags;
+        uniform.height = entry.height;
+        chunk.fill(uniform);
+        return true;
+    }
+
+    if (!isCompressed()) {
+        size_t offset = static_cast<size_t>(entry.dataIndex) * TileChunk::AREA;
+        std::memcpy(chunk.types, m_types + offset, TileChunk::AREA);
+        std::memcpy(chunk.flags, m_flags + offset, TileChunk::AREA);
+        std::memcpy(chunk.heights, m_heights + offset, TileChunk::AREA);
+        return true;
+    }
+
+    // Сжатые типы проверяются после распаковки: при открытии файла они не видны
+    Uint64 begin = m_chunkOffsets[entry.dataIndex];
+    Uint64 end = m_chunkOffsets[entry.dataIndex + 1];
+    const Uint8 maxType = static_cast<Uint8>(TileType::FOREST);
+    return ChunkCodec::decode(m_chunkData + begin, static_cast<size_t>(end - begin), chunk) &&
+        std::none_of(chunk.types, chunk.types + TileChunk::AREA, [maxType](Uint8 type) { return type > maxType; });
+}
+
+std::string LevelFile::readName(const char* name) {
+    const size_t length = sizeof(LevelDoorRecord::name);
+    return std::string(name, std::find(name, name + length, '\0'));
+}
+
+const Uint8* LevelFile::findSection(SectionType type, Uint64& size) const {
+    for (Uint32 i = 0; i < m_header->sectionCount; ++i) {
+        if (m_sections[i].type == static_cast<Uint32>(type)) {
+            size = m_sections[i].size;
+            return m_file.getData() + m_sections[i].offset;
+        }
+    }
+
+    size = 0;
+    return nullptr;
+}
+
+bool LevelFile::validate() {
+    const Uint8* data = m_file.getData();
+    Uint64 fileSize = m_file.getSize();
+
+    // 1. Заголовок
+    if (fileSize < sizeof(LevelFileHeader)) {
+        LOG_ERROR("Level file is too small");
+        return false;
+    }
+
+    const LevelFileHeader* header = reinterpret_cast<const LevelFileHeader*>(data);
+    if (header->magic != MAGIC || header->headerSize != sizeof(LevelFileHeader)) {
+        LOG_ERROR("Level file signature mismatch");
+        return false;
+    }
+    if (header->version < MIN_VERSION || header->version > VERSION ||
+        (header->version < 2 && header->flags != 0)) {
+        LOG_ERROR("Unsupported level file version " + std::to_string(header->version));
+        return false;
+    }
+    if (header->fileSize != fileSize) {
+        LOG_ERROR("Level file is truncated");
+        return false;
+    }
+    if (header->width == 0 || header->height == 0 ||
+        header->width > static_cast<Uint32>(TileMap::MAX_DIMENSION) ||
+        header->height > static_cast<Uint32>(TileMap::MAX_DIMENSION) ||
+        header->chunkCountX != ((header->width + TileChunk::MASK) >> TileChunk::SHIFT) ||
+        header->chunkCountY != ((header->height + TileChunk::MASK) >> TileChunk::SHIFT)) {
+        LOG_ERROR("Invalid level dimensions");
+        return false;
+    }
+
+    // 2. Таблица секций: каждая секция выровнена и целиком лежит в файле
+    if (header->sectionCount > (fileSize - sizeof(LevelFileHeader)) / sizeof(LevelSectionEntry)) {
+        LOG_ERROR("Level section table is out of bounds");
+        return false;
+    }
+
+    m_header = header;
+    m_sections = reinterpret_cast<const LevelSectionEntry*>(data + sizeof(LevelFileHeader));
+    for (Uint32 i = 0; i < header->sectionCount; ++i) {
+        const LevelSectionEntry& section = m_sections[i];
+        if (section.offset % SECTION_ALIGNMENT != 0 || section.offset > fileSize ||
+            section.size > fileSize - section.offset) {
+            LOG_ERROR("Level section " + std::to_string(section.type) + " is out of bounds");
+            return false;
+        }
+    }
+
+    // 3. Индекс чанков: значения вне TileType недопустимы
+    Uint64 chunkCount = static_cast<Uint64>(header->chunkCountX) * header->chunkCountY;
+    Uint64 indexSize = 0;
+    m_chunkIndex = reinterpret_cast<const LevelChunkEntry*>(findSection(SectionType::CHUNK_INDEX, indexSize));
+    if (!m_chunkIndex || indexSize != chunkCount * sizeof(LevelChunkEntry)) {
+        LOG_ERROR("Level chunk index is missing or has wrong size");
+        return false;
+    }
+
+    const Uint8 maxType = static_cast<Uint8>(TileType::FOREST);
+    for (Uint64 i = 0; i < chunkCount; ++i) {
+        const LevelChunkEntry& entry = m_chunkIndex[i];
+        if (entry.dataIndex == NO_CHUNK_DATA ? entry.type > maxType : entry.dataIndex >= header->storedChunkCount) {
+            LOG_ERROR("Invalid level chunk index entry " + std::to_string(i));
+            return false;
+        }
+    }
+
+    // 4. Тайлы неоднородных чанков
+    if (isCompressed()) {
+        // Смещения возрастают от 0 до конца данных, и ни один чанк не длиннее
+        // наибольшего сжатого размера; содержимое проверяется при распаковке
+        Uint64 offsetsSize = 0;
+        Uint64 dataSize = 0;
+        m_chunkOffsets = reinterpret_cast<const Uint64*>(findSection(SectionType::CHUNK_OFFSETS, offsetsSize));
+        m_chunkData = findSection(SectionType::CHUNK_DATA, dataSize);
+        if (!m_chunkOffsets || !m_chunkData ||
+            offsetsSize != (static_cast<Uint64>(header->storedChunkCount) + 1) * sizeof(Uint64) ||
+            m_chunkOffsets[0] != 0 || m_chunkOffsets[header->storedChunkCount] != dataSize) {
+            LOG_ERROR("Level compressed chunk sections are missing or have wrong size");
+            return false;
+        }
+        for (Uint32 i = 0; i < header->storedChunkCount; ++i) {
+            if (m_chunkOffsets[i + 1] < m_chunkOffsets[i] ||
+                m_chunkOffsets[i + 1] - m_chunkOffsets[i] > static_cast<Uint64>(ChunkCodec::MAX_ENCODED_SIZE)) {
+                LOG_ERROR("Invalid compressed chunk offset " + std::to_string(i));
+                return false;
+            }
+        }
+    }
+    else {
+        Uint64 planeSize = static_cast<Uint64>(header->storedChunkCount) * TileChunk::AREA;
+        Uint64 typesSize = 0;
+        Uint64 flagsSize = 0;
+        Uint64 heightsSize = 0;
+        m_types = findSection(SectionType::CHUNK_TYPES, typesSize);
+        m_flags = findSection(SectionType::CHUNK_FLAGS, flagsSize);
+        m_heights = findSection(SectionType::CHUNK_HEIGHTS, heightsSize);
+        if (!m_types || !m_flags || !m_heights ||
+            typesSize != planeSize || flagsSize != planeSize || heightsSize != planeSize) {
+            LOG_ERROR("Level tile planes are missing or have wrong size");
+            return false;
+        }
+        if (std::any_of(m_types, m_types + planeSize, [maxType](Uint8 type) { return type > maxType; })) {
+            LOG_ERROR("Invalid tile type in level file");
+            return false;
+        }
+    }
+
+    // 5. Необязательные секции объектов
+    Uint64 doorsSize = 0;
+    Uint64 terminalsSize = 0;
+    Uint64 pickupsSize = 0;
+    m_doors = reinterpret_cast<const LevelDoorRecord*>(findSection(SectionType::DOORS, doorsSize));
+    m_terminals = reinterpret_cast<const LevelTerminalRecord*>(findSection(SectionType::TERMINALS, terminalsSize));
+    m_pickups = reinterpret_cast<const LevelPickupRecord*>(findSection(SectionType::PICKUPS, pickupsSize));
+    if (doorsSize % sizeof(LevelDoorRecord) != 0 || terminalsSize % sizeof(LevelTerminalRecord) != 0 ||
+        pickupsSize % sizeof(LevelPickupRecord) != 0) {
+        LOG_ERROR("Level object sections have wrong size");
+        return false;
+    }
+    m_doorCount = static_cast<int>(doorsSize / sizeof(LevelDoorRecord));
+    m_terminalCount = static_cast<int>(terminalsSize / sizeof(LevelTerminalRecord));
+    m_pickupCount = static_cast<int>(pickupsSize / sizeof(LevelPickupRecord));
+
+    for (int i = 0; i < m_terminalCount; ++i) {
+        if (m_terminals[i].type > static_cast<Uint8>(Terminal::TerminalType::SCIENCE_STATION)) {
+            LOG_ERROR("Invalid terminal type in level file");
+            return false;
+        }
+    }
+    for (int i = 0; i < m_pickupCount; ++i) {
+        if (m_pickups[i].type > static_cast<Uint8>(PickupItem::ItemType::GENERIC)) {
+            LOG_ERROR("Invalid pickup type in level file");
+            return false;
+        }
+    }
+
+    return true;
+}
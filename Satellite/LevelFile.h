@@ -0,0 +1,302 @@
+﻿#pragma once
+
+#include "MappedFile.h"
+#include "TileChunk.h"
+#include <SDL.h>
+#include <functional>
+#include <string>
+
+class TileMap;
+class EntityManager;
+
+/**
+ * @brief Заголовок файла уровня
+ *
+ * Все записи файла имеют фиксированный размер и порядок байт little-endian.
+ */
+struct LevelFileHeader {
+    Uint32 magic;            ///< Сигнатура LevelFile::MAGIC
+    Uint16 version;          ///< Версия формата
+    Uint16 headerSize;       ///< Размер заголовка в байтах
+    Uint64 fileSize;         ///< Размер всего файла в байтах
+    Uint32 width;            ///< Ширина карты в тайлах
+    Uint32 height;           ///< Высота карты в тайлах
+    Uint32 chunkCountX;      ///< Чанков по горизонтали
+    Uint32 chunkCountY;      ///< Чанков по вертикали
+    Uint32 storedChunkCount; ///< Чанков с собственными тайлами в секциях плоскостей
+    Uint32 sectionCount;     ///< Записей в таблице секций (идет сразу за заголовком)
+    float spawnX;            ///< X координата появления игрока
+    float spawnY;            ///< Y координата появления игрока
+    Sint32 biomeType;        ///< Биом уровня
+    Uint32 flags;            ///< Флаги файла (LevelFile::FLAG_*, в версии 1 - 0)
+};
+
+/**
+ * @brief Запись таблицы секций
+ */
+struct LevelSectionEntry {
+    Uint32 type;             ///< Тип секции (LevelFile::SectionType)
+    Uint32 reserved;         ///< Зарезервировано (0)
+    Uint64 offset;           ///< Смещение от начала файла (кратно SECTION_ALIGNMENT)
+    Uint64 size;             ///< Размер в байтах
+};
+
+/**
+ * @brief Запись индекса чанков
+ */
+struct LevelChunkEntry {
+    Uint32 dataIndex;        ///< Номер чанка в плоскостях (NO_CHUNK_DATA - чанк однороден)
+    Uint8 type;              ///< Тип тайлов однородного чанка
+    Uint8 flags;             ///< Флаги тайлов однородного чанка
+    Uint8 height;            ///< Высота тайлов однородного чанка (в сотых)
+    Uint8 reserved;          ///< Зарезервировано (0)
+};
+
+/**
+ * @brief Запись двери
+ */
+struct LevelDoorRecord {
+    float x;                 ///< X координата
+    float y;                 ///< Y координата
+    Uint8 open;              ///< Дверь открыта
+    Uint8 vertical;          ///< Дверь вертикальная
+    Uint8 reserved[2];       ///< Зарезервировано (0)
+    char name[48];           ///< Имя (дополнено нулями)
+};
+
+/**
+ * @brief Запись терминала
+ */
+struct LevelTerminalRecord {
+    float x;                 ///< X координата
+    float y;                 ///< Y координата
+    Uint8 type;              ///< Тип терминала (Terminal::TerminalType)
+    Uint8 activated;         ///< Терминал активирован
+    Uint8 reserved[2];       ///< Зарезервировано (0)
+    char name[48];           ///< Имя (дополнено нулями)
+};
+
+/**
+ * @brief Запись предмета для подбора
+ */
+struct LevelPickupRecord {
+    float x;                 ///< X координата
+    float y;                 ///< Y координата
+    Uint8 type;              ///< Тип предмета (PickupItem::ItemType)
+    Uint8 reserved[3];       ///< Зарезервировано (0)
+    Sint32 value;            ///< Ценность
+    float weight;            ///< Вес
+    char name[48];           ///< Имя (дополнено нулями)
+};
+
+/**
+ * @brief Версионированный двоичный формат уровня
+ *
+ * Файл состоит из заголовка, таблицы секций и секций, выровненных
+ * на SECTION_ALIGNMENT байт:
+ * - индекс чанков: по записи LevelChunkEntry на чанк, построчно;
+ * - три плоскости тайлов (типы, флаги, высоты): по TileChunk::AREA байт
+ *   на каждый неоднородный чанк в порядке dataIndex - то же представление
+ *   структуры массивов, что и в TileChunk;
+ * - либо, с флагом FLAG_COMPRESSED_CHUNKS (версия 2), вместо плоскостей -
+ *   неоднородные чанки, сжатые ChunkCodec, и таблица их смещений;
+ * - записи дверей, терминалов и предметов из EntityManager.
+ *
+ * Файл открывается отображением в память: open() проверяет заголовок,
+ * границы секций и индекс, после чего тайлы чанков и записи объектов
+ * читаются прямо из отображения, без разбора файла по полям. Сжатые
+ * чанки распаковываются по одному при обращении к ним.
+ */
+class LevelFile {
+public:
+    static constexpr Uint32 MAGIC = 0x4C564C53;        ///< "SLVL"
+    static constexpr Uint16 VERSION = 2;               ///< Текущая версия формата
+    static constexpr Uint16 MIN_VERSION = 1;           ///< Старейшая читаемая версия
+    static constexpr Uint32 FLAG_COMPRESSED_CHUNKS = 0x01; ///< Чанки сжаты (секции CHUNK_OFFSETS и CHUNK_DATA)
+    static constexpr Uint32 NO_CHUNK_DATA = 0xFFFFFFFF; ///< dataIndex однородного чанка
+    static constexpr Uint64 SECTION_ALIGNMENT = 64;    ///< Выравнивание секций в файле
+
+    /**
+     * @brief Чтение тайлов выгруженного чанка (см. TileMap::evictChunk)
+     *
+     * Параметры: X и Y координаты чанка, буфер для его тайлов.
+     * Возвращает true, если буфер заполнен.
+     */
+    using ChunkReader = std::function<bool(int chunkX, int chunkY, TileChunk& chunk)>;
+
+    /**
+     * @brief Типы секций
+     */
+    enum class SectionType : Uint32 {
+        CHUNK_INDEX = 1,   ///< Индекс чанков
+        CHUNK_TYPES,       ///< Плоскость типов тайлов
+        CHUNK_FLAGS,       ///< Плоскость флагов тайлов
+        CHUNK_HEIGHTS,     ///< Плоскость высот тайлов
+        DOORS,             ///< Двери
+        TERMINALS,         ///< Терминалы
+        PICKUPS,           ///< Предметы для подбора
+        CHUNK_OFFSETS,     ///< Смещения сжатых чанков (Uint64, на один больше, чем чанков)
+        CHUNK_DATA         ///< Сжатые чанки
+    };
+
+    /**
+     * @brief Конструктор
+     */
+    LevelFile();
+
+    /**
+     * @brief Сохранение уровня
+     * @param path Путь к файлу
+     * @param map Карта тайлов
+     * @param entities Менеджер сущностей (nullptr - без дверей, терминалов и предметов)
+     * @param spawnX X координата появления игрока
+     * @param spawnY Y координата появления игрока
+     * @param biomeType Биом уровня
+     * @param compressChunks true - чанки сжимаются, false - плоскости для использования без распаковки
+     * @param evictedChunks Источник выгруженных чанков карты (без него карта с выгруженными чанками не сохраняется)
+     * @return true в случае успеха, false при ошибке
+     */
+    static bool save(const std::string& path, const TileMap& map, const EntityManager* entities = nullptr,
+        float spawnX = 0.0f, float spawnY = 0.0f, int biomeType = 0, bool compressChunks = true,
+        const ChunkReader& evictedChunks = nullptr);
+
+    /**
+     * @brief Проверка сигнатуры файла
+     * @param path Путь к файлу
+     * @return true, если файл начинается с сигнатуры формата уровня
+     */
+    static bool hasSignature(const std::string& path);
+
+    /**
+     * @brief Открытие уровня
+     *
+     * Отображает файл в память и проверяет его структуру.
+     *
+     * @param path Путь к файлу
+     * @return true, если файл корректен
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Закрытие уровня
+     */
+    void close();
+
+    /**
+     * @brief Проверка, открыт ли уровень
+     * @return true после успешного open()
+     */
+    bool isOpen() const { return m_header != nullptr; }
+
+    /**
+     * @brief Получение заголовка
+     * @return Заголовок (только для открытого уровня)
+     */
+    const LevelFileHeader& getHeader() const { return *m_header; }
+
+    /**
+     * @brief Получение записи индекса чанков
+     * @param chunkIndex Индекс чанка (chunkY * chunkCountX + chunkX)
+     * @return Запись индекса
+     */
+    const LevelChunkEntry& getChunkEntry(int chunkIndex) const { return m_chunkIndex[chunkIndex]; }
+
+    /**
+     * @brief Копирование или распаковка тайлов чанка
+     *
+     * Не меняет состояние файла, поэтому может вызываться из рабочего потока
+     * (например, как ChunkStreamer::ChunkLoader).
+     *
+     * @param chunkIndex Индекс чанка
+     * @param chunk Тайлы чанка (выходной параметр; однородный чанк заполняется его значением)
+     * @return true, если данные чанка корректны
+     */
+    bool copyChunk(int chunkIndex, TileChunk& chunk) const;
+
+    /**
+     * @brief Проверка, сжаты ли чанки
+     * @return true, если файл записан с FLAG_COMPRESSED_CHUNKS
+     */
+    bool isCompressed() const { return (m_header->flags & FLAG_COMPRESSED_CHUNKS) != 0; }
+
+    /**
+     * @brief Получение записей дверей
+     * @return Первая запись (действительна до close())
+     */
+    const LevelDoorRecord* getDoors() const { return m_doors; }
+
+    /**
+     * @brief Получение количества дверей
+     * @return Количество записей
+     */
+    int getDoorCount() const { return m_doorCount; }
+
+    /**
+     * @brief Получение записей терминалов
+     * @return Первая запись (действительна до close())
+     */
+    const LevelTerminalRecord* getTerminals() const { return m_terminals; }
+
+    /**
+     * @brief Получение количества терминалов
+     * @return Количество записей
+     */
+    int getTerminalCount() const { return m_terminalCount; }
+
+    /**
+     * @brief Получение записей предметов
+     * @return Первая запись (действительна до close())
+     */
+    const LevelPickupRecord* getPickups() const { return m_pickups; }
+
+    /**
+     * @brief Получение количества предметов
+     * @return Количество записей
+     */
+    int getPickupCount() const { return m_pickupCount; }
+
+    /**
+     * @brief Чтение имени объекта из поля фиксированной длины
+     * @param name Поле имени
+     * @return Имя без дополняющих нулей
+     */
+    static std::string readName(const char* name);
+
+private:
+    /**
+     * @brief Поиск секции в таблице
+     * @param type Тип секции
+     * @param size Размер секции (выходной параметр)
+     * @return Начало секции или nullptr, если секции нет
+     */
+    const Uint8* findSection(SectionType type, Uint64& size) const;
+
+    /**
+     * @brief Проверка структуры отображенного файла и заполнение указателей
+     * @return true, если файл корректен
+     */
+    bool validate();
+
+    MappedFile m_file;                         ///< Отображение файла
+    const LevelFileHeader* m_header;           ///< Заголовок (nullptr - уровень не открыт)
+    const LevelSectionEntry* m_sections;       ///< Таблица секций
+    const LevelChunkEntry* m_chunkIndex;       ///< Индекс чанков
+    const Uint8* m_types;                      ///< Плоскость типов
+    const Uint8* m_flags;                      ///< Плоскость флагов
+    const Uint8* m_heights;                    ///< Плоскость высот
+    const Uint64* m_chunkOffsets;              ///< Смещения сжатых чанков
+    const Uint8* m_chunkData;                  ///< Сжатые чанки
+    const LevelDoorRecord* m_doors;            ///< Записи дверей
+    const LevelTerminalRecord* m_terminals;    ///< Записи терминалов
+    const LevelPickupRecord* m_pickups;        ///< Записи предметов
+    int m_doorCount;                           ///< Количество дверей
+    int m_terminalCount;                       ///< Количество терминалов
+    int m_pickupCount;                         ///< Количество предметов
+};
+
+static_assert(sizeof(LevelFileHeader) == 56, "LevelFileHeader layout is part of the file format");
+static_assert(sizeof(LevelSectionEntry) == 24, "LevelSectionEntry layout is part of the file format");
+static_assert(sizeof(LevelChunkEntry) == 8, "LevelChunkEntry layout is part of the file format");
+static_assert(sizeof(LevelDoorRecord) == 60, "LevelDoorRecord layout is part of the file format");
+static_assert(sizeof(LevelTerminalRecord) == 60, "LevelTerminalRecord layout is part of the file format");
+static_assert(sizeof(LevelPickupRecord) == 68, "LevelPickupRecord layout is part of the file format");
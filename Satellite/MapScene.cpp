@@ -8,6 +8,15 @@
 #include "Logger.h"
 #include <set>
 #include "WorldGenerator.h"
+#include "RenderStats.h"
+#include "LevelFile.h"
+#include "TileMapSnapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
 
 
 MapScene::MapScene(const std::string& name, Engine* engine)
@@ -25,6 +34,14 @@ bool MapScene::initialize() {
     // 1. Инициализация изометрического рендерера
     m_isoRenderer = std::make_shared<IsometricRenderer>(64, 32);
 
+    // С программным рендерером SDL (в том числе без дисплея) грани выгоднее растеризовать самим
+    SDL_RendererInfo rendererInfo;
+    if (m_engine && m_engine->getRenderer() &&
+        SDL_GetRendererInfo(m_engine->getRenderer(), &rendererInfo) == 0 &&
+        (rendererInfo.flags & SDL_RENDERER_SOFTWARE) != 0) {
+        m_isoRenderer->setFaceBackend(IsometricRenderer::FaceBackend::SOFTWARE);
+    }
+
     // 2. Инициализация камеры
     m_camera = std::make_shared<Camera>(800, 600);
 
@@ -35,6 +52,21 @@ bool MapScene::initialize() {
         return false;
     }
 
+    // 3.1. Поле зрения подписывается на карту до генерации, чтобы сбросить память при новой карте
+    m_fieldOfView = std::make_shared<FieldOfView>(m_tileMap);
+
+    // 3.2. Чанки далеко от игрока выгружаются в файл подкачки и подгружаются обратно при приближении
+    m_chunkSwap = std::make_shared<ChunkSwapFile>("chunks.swap");
+    // Индекс чанка передает стример: ширина каталога меняется при загрузке карты другого размера
+    std::shared_ptr<ChunkSwapFile> chunkSwap = m_chunkSwap;
+    m_chunkStreamer = std::make_shared<ChunkStreamer>(m_tileMap,
+        [chunkSwap](int, int, int chunkIndex, TileChunk& chunk) {
+            return chunkSwap->read(chunkIndex, chunk);
+        },
+        [chunkSwap](int, int, int chunkIndex, const TileChunk& chunk) {
+            return chunkSwap->write(chunkIndex, chunk);
+        });
+
     // 3.5. Инициализация EntityManager
     m_entityManager = std::make_shared<EntityManager>(m_tileMap);
 
@@ -95,8 +127,12 @@ bool MapScene::initialize() {
 
     m_renderingSystem = std::make_shared<RenderingSystem>(
         m_tileMap, m_tileRenderer, m_isoRenderer);
+    m_renderingSystem->setFieldOfView(m_fieldOfView);
 
     m_uiManager = std::make_shared<UIManager>(m_engine);
+    m_uiManager->setFieldOfView(m_fieldOfView);
+
+    m_dynamicResolution = std::make_shared<DynamicResolution>();
 
     std::cout << "MapScene initialized successfully" << std::endl;
 
@@ -160,6 +196,22 @@ void MapScene::handleEvent(const SDL_Event& event) {
         playerY = m_player->getFullY();
     }
 
+    // Содержимое текстур-целей потеряно (например, после сброса устройства Direct3D)
+    if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+        if (m_renderingSystem) {
+            m_renderingSystem->invalidateCaches();
+        }
+        if (m_uiManager) {
+            m_uiManager->invalidateCaches();
+        }
+        if (m_dynamicResolution) {
+            m_dynamicResolution->releaseTexture();
+        }
+        if (m_engine && m_engine->getResourceManager()) {
+            m_engine->getResourceManager()->invalidateTextCache();
+        }
+    }
+
     // Обработка клавиатурных событий
     if (event.type == SDL_KEYDOWN) {
         switch (event.key.keysym.sym) {
@@ -179,6 +231,87 @@ void MapScene::handleEvent(const SDL_Event& event) {
             LOG_DEBUG("Debug mode: " + std::string(m_showDebug ? "enabled" : "disabled"));
             break;
 
+        case SDLK_F2:
+            // Переключение способа отрисовки граней для сравнения времени кадра
+            // (пакет SDL_RenderGeometry -> построчно -> программный растеризатор)
+            switch (m_isoRenderer->getFaceBackend()) {
+            case IsometricRenderer::FaceBackend::GEOMETRY:
+                m_isoRenderer->setFaceBackend(IsometricRenderer::FaceBackend::SCANLINE);
+                LOG_INFO("Face backend: scanline");
+                break;
+            case IsometricRenderer::FaceBackend::SCANLINE:
+                m_isoRenderer->setFaceBackend(IsometricRenderer::FaceBackend::SOFTWARE);
+                LOG_INFO("Face backend: software rasterizer");
+                break;
+            default:
+                m_isoRenderer->setFaceBackend(IsometricRenderer::FaceBackend::GEOMETRY);
+                LOG_INFO("Face backend: SDL_RenderGeometry batch");
+                break;
+            }
+            break;
+
+        case SDLK_F3:
+            // Переключение порядка отрисовки: обход диагоналей или сортировка по приоритетам
+            if (m_renderingSystem->getRenderOrderMode() == RenderingSystem::RenderOrderMode::DIAGONAL_BUCKETS) {
+                m_renderingSystem->setRenderOrderMode(RenderingSystem::RenderOrderMode::SORTED);
+            }
+            else {
+                m_renderingSystem->setRenderOrderMode(RenderingSystem::RenderOrderMode::DIAGONAL_BUCKETS);
+            }
+            LOG_INFO("Render order: " + std::string(
+                m_renderingSystem->getRenderOrderMode() == RenderingSystem::RenderOrderMode::DIAGONAL_BUCKETS ?
+                "diagonal buckets" : "sorted"));
+            break;
+
+        case SDLK_F4:
+            // Переключение отсечения тайлов, закрытых стенами
+            m_renderingSystem->setOcclusionEnabled(!m_renderingSystem->isOcclusionEnabled());
+            LOG_INFO("Occlusion culling: " + std::string(
+                m_renderingSystem->isOcclusionEnabled() ? "enabled" : "disabled"));
+            break;
+
+        case SDLK_F5:
+            // Переключение вывода блоков из кэша спрайтов
+            m_tileRenderer->setSpriteCacheEnabled(!m_tileRenderer->isSpriteCacheEnabled());
+            LOG_INFO("Block sprite cache: " + std::string(
+                m_tileRenderer->isSpriteCacheEnabled() ? "enabled" : "disabled"));
+            break;
+
+        case SDLK_F6:
+            // Переключение тумана войны (без него видна вся карта)
+            if (m_renderingSystem->getFieldOfView()) {
+                m_renderingSystem->setFieldOfView(nullptr);
+                m_uiManager->setFieldOfView(nullptr);
+            }
+            else {
+                m_renderingSystem->setFieldOfView(m_fieldOfView);
+                m_uiManager->setFieldOfView(m_fieldOfView);
+            }
+            LOG_INFO("Fog of war: " + std::string(m_renderingSystem->getFieldOfView() ? "enabled" : "disabled"));
+            break;
+
+        case SDLK_F7:
+            // Переключение динамического разрешения мира
+            m_dynamicResolution->setEnabled(!m_dynamicResolution->isEnabled());
+            LOG_INFO("Dynamic resolution: " + std::string(
+                m_dynamicResolution->isEnabled() ? "enabled" : "disabled"));
+            break;
+
+        case SDLK_F8:
+            // Сохранение уровня
+            saveLevel("level.sav");
+            break;
+
+        case SDLK_F9:
+            // Загрузка сохраненного уровня
+            loadLevel("level.sav");
+            break;
+
+        case SDLK_m:
+            // Переключение миникарты
+            m_uiManager->setMinimapVisible(!m_uiManager->isMinimapVisible());
+            break;
+
         case SDLK_e:
         {
             // НОВОЕ: Глобальная блокировка взаимодействия до полного отпускания клавиши
@@ -283,11 +416,11 @@ void MapScene::handleEvent(const SDL_Event& event) {
 
                         // Дополнительно проверим тайл на проходимость
                         if (m_tileMap && m_tileMap->isValidCoordinate(doorX, doorY)) {
-                            MapTile* tile = m_tileMap->getTile(doorX, doorY);
+                            MapTile tile = m_tileMap->getTile(doorX, doorY);
                             if (tile) {
                                 LOG_DEBUG("   Tile at door position: walkable=" +
-                                    std::string(tile->isWalkable() ? "true" : "false") +
-                                    ", type=" + std::to_string(static_cast<int>(tile->getType())));
+                                    std::string(tile.isWalkable() ? "true" : "false") +
+                                    ", type=" + std::to_string(static_cast<int>(tile.getType())));
                             }
                         }
 
@@ -395,13 +528,29 @@ else if (event.type == SDL_KEYUP && event.key.keysym.sym == SDLK_e) {
 }
 
 void MapScene::render(SDL_Renderer* renderer) {
-    // Получаем размеры окна
-    int windowWidth, windowHeight;
-    SDL_GetRendererOutputSize(renderer, &windowWidth, &windowHeight);
+    // 1. Масштаб разрешения подбирается по времени прошлого кадра. При вертикальной
+    // синхронизации время вывода - это ожидание дисплея, а не работа
+    if (m_engine) {
+        float workTime = m_engine->getRenderTime();
+        if (!m_engine->isVSyncActive()) {
+            workTime += m_engine->getPresentTime();
+        }
+        m_dynamicResolution->addFrameSample(workTime, m_engine->getFrameTime(), m_engine->getFrameBudget());
+    }
 
-    // Используем RenderingSystem для основного рендеринга
+    // 2. Мир рисуется в текстуру пониженного разрешения (или прямо в окно)
+    bool scaled = m_dynamicResolution->beginWorld(renderer);
+    m_renderingSystem->setResolutionScale(scaled ? m_dynamicResolution->getScale() : 1.0f);
+    m_renderingSystem->setInterpolationAlpha(m_interpolationAlpha);
     m_renderingSystem->render(renderer, m_camera, m_player, m_entityManager, m_currentBiome);
 
+    // 3. Растягиваем мир на окно; интерфейс проецирует объекты в родном разрешении
+    if (scaled) {
+        m_isoRenderer->flush(renderer);
+        m_dynamicResolution->endWorld(renderer);
+        m_isoRenderer->setCameraZoom(m_camera->getZoom());
+    }
+
     // Используем UIManager для отрисовки интерфейса
     m_uiManager->render(
         renderer,
@@ -446,6 +595,11 @@ void MapScene::generateTestMap() {
     auto playerStartPos = m_worldGenerator->generateTestMap(m_currentBiome);
     m_worldGenerator->generateDoors(0.4f, 8);
 
+    // Выгруженные чанки прежней карты больше не нужны
+    if (m_chunkSwap) {
+        m_chunkSwap->clear();
+    }
+
     // Устанавливаем игрока на стартовую позицию
     if (m_player) {
         m_player->setPosition(playerStartPos.first, playerStartPos.second, 0.0f);
@@ -463,6 +617,91 @@ void MapScene::generateTestMap() {
         std::to_string(playerStartPos.second) + ")");
 }
 
+bool MapScene::saveLevel(const std::string& path) {
+    if (!m_tileMap || !m_player) {
+        return false;
+    }
+
+    // Выгруженные стримером чанки карта не хранит - они читаются из файла подкачки
+    std::shared_ptr<ChunkStreamer> streamer = m_chunkStreamer;
+    return LevelFile::save(path, *m_tileMap, m_entityManager.get(),
+        m_player->getFullX(), m_player->getFullY(), m_currentBiome, true,
+        [streamer](int chunkX, int chunkY, TileChunk& chunk) {
+            return streamer && streamer->readEvictedChunk(chunkX, chunkY, chunk);
+        });
+}
+
+bool MapScene::loadLevel(const std::string& path) {
+    if (!m_tileMap || !m_entityManager || !m_worldGenerator || !m_player) {
+        return false;
+    }
+
+    // 1. Отображаем файл и проверяем структуру до того, как трогать текущую карту
+    LevelFile level;
+    if (!level.open(path)) {
+        LOG_ERROR("Failed to load level: " + path);
+        return false;
+    }
+
+    // 2. Карта тайлов
+    if (!m_tileMap->loadFromLevel(level)) {
+        LOG_ERROR("Failed to apply level tiles: " + path);
+        return false;
+    }
+    if (m_chunkSwap) {
+        m_chunkSwap->clear();
+    }
+
+    const LevelFileHeader& header = level.getHeader();
+    m_currentBiome = header.biomeType;
+    m_worldGenerator->setCurrentBiome(m_currentBiome);
+
+    // 3. Объекты сцены создаются заново по записям файла
+    m_entityManager->clear();
+    m_entityManager->addEntity(m_player);
+
+    for (int i = 0; i < level.getDoorCount(); ++i) {
+        const LevelDoorRecord& record = level.getDoors()[i];
+        auto door = m_worldGenerator->createTestDoor(record.x, record.y, LevelFile::readName(record.name));
+        if (door) {
+            door->setVertical(record.vertical != 0);
+            door->setOpen(record.open != 0);
+        }
+    }
+
+    for (int i = 0; i < level.getTerminalCount(); ++i) {
+        const LevelTerminalRecord& record = level.getTerminals()[i];
+        auto terminal = m_worldGenerator->createTestTerminal(record.x, record.y,
+            LevelFile::readName(record.name), static_cast<Terminal::TerminalType>(record.type));
+        if (terminal) {
+            terminal->setActivated(record.activated != 0);
+        }
+    }
+
+    for (int i = 0; i < level.getPickupCount(); ++i) {
+        const LevelPickupRecord& record = level.getPickups()[i];
+        auto item = m_worldGenerator->createTestPickupItem(record.x, record.y,
+            LevelFile::readName(record.name), static_cast<PickupItem::ItemType>(record.type));
+        if (item) {
+            item->setValue(record.value);
+            item->setWeight(record.weight);
+        }
+    }
+
+    // 4. Игрок
+    float spawnX = std::floor(header.spawnX);
+    float spawnY = std::floor(header.spawnY);
+    m_player->setPosition(spawnX, spawnY, 0.0f);
+    m_player->setSubX(header.spawnX - spawnX);
+    m_player->setSubY(header.spawnY - spawnY);
+
+    initializeDoors();
+
+    LOG_INFO("Level loaded from " + path + " (" + std::to_string(header.width) + "x" +
+        std::to_string(header.height) + ", biome " + std::to_string(m_currentBiome) + ")");
+    return true;
+}
+
 void MapScene::detectKeyInput() {
     // Этот метод теперь просто делегирует обработку клавиш игроку
     if (m_player) {
@@ -495,6 +734,18 @@ void MapScene::update(float deltaTime) {
         m_player->update(deltaTime);
     }
 
+    // 1.1. Поле зрения пересчитывается, только если игрок перешел на другой тайл или открылась дверь
+    if (m_player && m_fieldOfView) {
+        m_fieldOfView->update(static_cast<int>(std::floor(m_player->getFullX())),
+            static_cast<int>(std::floor(m_player->getFullY())));
+    }
+
+    // 1.2. Подгрузка чанков вокруг игрока и впереди по ходу движения
+    if (m_player && m_chunkStreamer) {
+        m_chunkStreamer->update(m_player->getFullX(), m_player->getFullY(),
+            m_player->getDirectionX(), m_player->getDirectionY());
+    }
+
     // 2. Обновление камеры
     m_camera->update(deltaTime);
 
@@ -620,4 +871,254 @@ void MapScene::update(float deltaTime) {
 
     // 5. Обновление базового класса
     Scene::update(deltaTime);
-}
\ No newline at end of file
+}
+
+bool MapScene::runBenchmark(int frameCount, const std::string& csvPath) {
+    if (!m_engine || !m_camera || !m_tileMap || !m_renderingSystem || !m_dynamicResolution || frameCount <= 0) {
+        return false;
+    }
+
+    std::ofstream csv(csvPath, std::ios::out | std::ios::trunc);
+    if (!csv.is_open()) {
+        LOG_ERROR("Failed to open benchmark output: " + csvPath);
+        return false;
+    }
+    csv << "frame,render_ms,draw_calls,tiles,cached_sprites,chunk_blits,camera_x,camera_y,zoom\n";
+
+    // 1. Камера движется по заданному пути, а не за игроком
+    const float pi = 3.14159265f;
+    float mapCenterX = m_tileMap->getWidth() * 0.5f;
+    float mapCenterY = m_tileMap->getHeight() * 0.5f;
+    float radius = std::min(m_tileMap->getWidth(), m_tileMap->getHeight()) * 0.35f;
+    float savedX = m_camera->getX();
+    float savedY = m_camera->getY();
+    float savedZoom = m_camera->getZoom();
+    m_camera->setTarget(nullptr, nullptr);
+
+    // Все кадры рисуются в последнем просимулированном состоянии
+    setInterpolationAlpha(1.0f);
+
+    // Замеряется отрисовка всей карты: туман войны скрыл бы все вдали от игрока
+    std::shared_ptr<FieldOfView> savedFieldOfView = m_renderingSystem->getFieldOfView();
+    m_renderingSystem->setFieldOfView(nullptr);
+
+    // Динамическое разрешение исказило бы сравнение кадров между запусками
+    bool savedDynamicResolution = m_dynamicResolution->isEnabled();
+    m_dynamicResolution->setEnabled(false);
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frameCount);
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+        // 2. Положение на пути: окружность вокруг центра карты, масштаб колеблется от 0.5 до 1.5
+        float t = static_cast<float>(frame) / frameCount;
+        float cameraX = mapCenterX + radius * std::cos(2.0f * pi * t);
+        float cameraY = mapCenterY + radius * std::sin(2.0f * pi * t);
+        float zoom = 1.0f + 0.5f * std::sin(4.0f * pi * t);
+        m_camera->setPosition(cameraX, cameraY);
+        m_camera->setZoom(zoom);
+
+        // Очередь событий не должна переполняться, даже если окно скрыто
+        SDL_PumpEvents();
+
+        // 3. Замер отрисовки и вывода кадра
+        auto start = std::chrono::high_resolution_clock::now();
+        m_engine->render();
+        auto end = std::chrono::high_resolution_clock::now();
+        double renderMs = std::chrono::duration<double, std::milli>(end - start).count();
+        frameTimes.push_back(renderMs);
+
+        const RenderFrameStats& stats = RenderStats::getInstance().getFrame();
+        csv << frame << ',' << renderMs << ',' << stats.drawCalls << ',' << stats.tiles << ','
+            << stats.cachedSprites << ',' << stats.chunkBlits << ','
+            << cameraX << ',' << cameraY << ',' << m_camera->getZoom() << '\n';
+    }
+
+    // 4. Возвращаем камеру игроку, туман войны и динамическое разрешение
+    m_renderingSystem->setFieldOfView(savedFieldOfView);
+    m_dynamicResolution->setEnabled(savedDynamicResolution);
+    m_camera->setZoom(savedZoom);
+    m_camera->setPosition(savedX, savedY);
+    if (m_player) {
+        m_camera->setTarget(&m_player->getPosition().x, &m_player->getPosition().y);
+    }
+
+    // 5. Сводка: первый кадр включает запекание кэшей, поэтому важны перцентили
+    std::vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double value : frameTimes) {
+        total += value;
+    }
+    auto percentile = [&sorted](double p) {
+        size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    };
+
+    LOG_INFO("Benchmark: " + std::to_string(frameCount) + " frames, avg " +
+        std::to_string(total / frameCount) + " ms, p50 " + std::to_string(percentile(0.5)) +
+        " ms, p95 " + std::to_string(percentile(0.95)) + " ms, max " +
+        std::to_string(sorted.back()) + " ms");
+    LOG_INFO("Benchmark results written to " + csvPath);
+
+    return csv.good();
+}
+
+bool MapScene::runStreamingCheck() {
+    if (!m_tileMap || !m_chunkStreamer || !m_chunkSwap) {
+        return false;
+    }
+
+    // 1. Эталонная карта: шире демонстрационной, ни один чанк не однороден
+    const int chunksPerSide = 8;
+    const int size = chunksPerSide * TileChunk::SIZE;
+    TileMap reference(size, size);
+    if (!reference.initialize()) {
+        return false;
+    }
+
+    const TileType pattern[] = { TileType::FLOOR, TileType::GRASS, TileType::STONE, TileType::WALL, TileType::SAND };
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            reference.setTileType(x, y, pattern[(x * 7 + y * 13) % 5]);
+        }
+    }
+
+    // 2. Карта сцены заменяется эталоном целиком: стример сбрасывается по ALL_TILES,
+    // ширина каталога чанков меняется, файл подкачки очищается как при загрузке уровня
+    TileMapSnapshot snapshot;
+    snapshot.capture(reference);
+    if (!m_tileMap->loadFromSnapshot(snapshot)) {
+        LOG_ERROR("Streaming check: failed to apply the test map");
+        return false;
+    }
+    m_chunkSwap->clear();
+
+    // Изменение до выгрузки (закрытая дверь) должно пережить выгрузку
+    m_tileMap->setTileType(3, 3, TileType::DOOR);
+    m_tileMap->setTileWalkable(3, 3, false);
+    reference.setTileType(3, 3, TileType::DOOR);
+    reference.setTileWalkable(3, 3, false);
+
+    // 3. Малые радиусы: из дальнего угла карты выгружается почти все
+    m_chunkStreamer->setRadii(1, 2);
+    m_chunkStreamer->setPrefetchDistance(0);
+
+    // Игрок стоит в центре углового чанка, пока рабочий поток не подгрузит все вокруг
+    bool success = true;
+    auto settle = [this, &success](float position) {
+        m_chunkStreamer->update(position, position, 0.0f, 0.0f);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (m_chunkStreamer->getPendingChunkCount() > 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            m_chunkStreamer->update(position, position, 0.0f, 0.0f);
+        }
+
+        if (m_chunkStreamer->getPendingChunkCount() > 0) {
+            LOG_ERROR("Streaming check: chunks are still loading after 5 seconds");
+            success = false;
+        }
+    };
+
+    // Загруженные чанки должны совпадать с эталоном; возвращает количество проверенных
+    auto verifyResident = [this, &reference, &success, chunksPerSide]() {
+        int verified = 0;
+        TileChunk expected;
+        TileChunk actual;
+        for (int chunkY = 0; chunkY < chunksPerSide; ++chunkY) {
+            for (int chunkX = 0; chunkX < chunksPerSide; ++chunkX) {
+                if (!m_tileMap->copyChunk(chunkX, chunkY, actual)) {
+                    continue;
+                }
+
+                reference.copyChunk(chunkX, chunkY, expected);
+                if (std::memcmp(&expected, &actual, sizeof(TileChunk)) != 0) {
+                    LOG_ERROR("Streaming check: chunk (" + std::to_string(chunkX) + ", " +
+                        std::to_string(chunkY) + ") differs after reload");
+                    success = false;
+                }
+                verified++;
+            }
+        }
+        return verified;
+    };
+
+    float nearPosition = TileChunk::SIZE * 0.5f;
+    float farPosition = size - nearPosition;
+    settle(nearPosition);
+    settle(farPosition);
+    int verified = verifyResident();
+
+    int evicted = 0;
+    for (int chunkY = 0; chunkY < chunksPerSide; ++chunkY) {
+        for (int chunkX = 0; chunkX < chunksPerSide; ++chunkX) {
+            if (!m_tileMap->isChunkResident(chunkX, chunkY)) {
+                evicted++;
+            }
+        }
+    }
+
+    if (m_tileMap->isChunkResident(0, 0)) {
+        LOG_ERROR("Streaming check: chunk (0, 0) was not evicted");
+        success = false;
+    }
+    else if (m_tileMap->setTileType(0, 0, TileType::FLOOR) ||
+        m_tileMap->getTileFlags(0, 0) != 0) {
+        LOG_ERROR("Streaming check: evicted chunk accepted a write or reads as walkable");
+        success = false;
+    }
+
+    // Сохранение уровня и снимок карты, пока большая часть чанков выгружена,
+    // должны содержать настоящие тайлы, а не заглушки выгруженных чанков
+    auto verifyMap = [&reference, chunksPerSide](const TileMap& map) {
+        TileChunk expected;
+        TileChunk actual;
+        for (int chunkY = 0; chunkY < chunksPerSide; ++chunkY) {
+            for (int chunkX = 0; chunkX < chunksPerSide; ++chunkX) {
+                reference.copyChunk(chunkX, chunkY, expected);
+                if (!map.copyChunk(chunkX, chunkY, actual) ||
+                    std::memcmp(&expected, &actual, sizeof(TileChunk)) != 0) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    const std::string levelPath = "streaming_check.sav";
+    LevelFile level;
+    TileMap savedMap(1, 1);
+    if (!saveLevel(levelPath) || !level.open(levelPath) || !savedMap.loadFromLevel(level) ||
+        !verifyMap(savedMap)) {
+        LOG_ERROR("Streaming check: level saved with evicted chunks differs after loading");
+        success = false;
+    }
+    level.close();
+    std::remove(levelPath.c_str());
+
+    TileMapSnapshot evictedSnapshot;
+    TileMap restoredMap(1, 1);
+    if (!evictedSnapshot.capture(*m_tileMap, [this](int chunkX, int chunkY, TileChunk& chunk) {
+            return m_chunkStreamer->readEvictedChunk(chunkX, chunkY, chunk);
+        }) || !evictedSnapshot.restore(restoredMap) || !verifyMap(restoredMap)) {
+        LOG_ERROR("Streaming check: snapshot taken with evicted chunks differs after restoring");
+        success = false;
+    }
+
+    // 4. Возвращаемся: чанки дальнего угла выгружаются повторно, ближние подгружаются
+    settle(nearPosition);
+
+    verified += verifyResident();
+    if (!m_tileMap->isChunkResident(0, 0)) {
+        LOG_ERROR("Streaming check: chunk (0, 0) was not reloaded");
+        success = false;
+    }
+
+    m_chunkStreamer->setRadii(ChunkStreamer::DEFAULT_LOAD_RADIUS, ChunkStreamer::DEFAULT_EVICT_RADIUS);
+    m_chunkStreamer->setPrefetchDistance(ChunkStreamer::DEFAULT_PREFETCH_DISTANCE);
+
+    LOG_INFO("Streaming check: " + std::to_string(evicted) + " chunks evicted, " +
+        std::to_string(verified) + " resident chunks verified after reload: " +
+        (success ? "passed" : "FAILED"));
+    return success;
+}
@@ -11,6 +11,9 @@
 #include "InteractionSystem.h"
 #include "RenderingSystem.h"
 #include "UIManager.h"  // Добавлено новое включение
+#include "DynamicResolution.h"
+#include "ChunkStreamer.h"
+#include "ChunkSwapFile.h"
 #include <SDL.h>
 #include <memory>
 #include <vector>
@@ -175,6 +178,56 @@ public:
  */
     Engine* getEngine() const { return m_engine; }
 
+    /**
+     * @brief Замер производительности отрисовки по заданному маршруту камеры
+     *
+     * Камера проходит замкнутый путь вокруг центра карты с переменным
+     * масштабом, каждый кадр отрисовывается и выводится через Engine::render().
+     * Для каждого кадра в CSV пишутся время отрисовки и счетчики RenderStats,
+     * итоговая сводка выводится в лог. Логика сцены не обновляется.
+     *
+     * @param frameCount Количество кадров
+     * @param csvPath Путь к CSV файлу с результатами
+     * @return true, если замер выполнен и файл записан
+     */
+    bool runBenchmark(int frameCount, const std::string& csvPath);
+
+    /**
+     * @brief Проверка выгрузки и подгрузки чанков (режим --streaming-check)
+     *
+     * Карта сцены заменяется картой 8x8 неоднородных чанков, радиусы
+     * стримера уменьшаются, и игрок условно переходит в дальний угол
+     * карты и обратно. Проверяется, что дальние чанки выгружены, запись
+     * в них отклоняется, а после возвращения они подгружены из файла
+     * подкачки без потерь (включая изменения, сделанные до выгрузки).
+     * Пока чанки выгружены, уровень сохраняется через saveLevel и снимается
+     * снимок карты; оба должны совпасть с эталоном после загрузки.
+     * Итог выводится в лог. После проверки сцена не восстанавливается.
+     *
+     * @return true, если все проверки прошли
+     */
+    bool runStreamingCheck();
+
+    /**
+     * @brief Сохранение карты, дверей, терминалов, предметов и позиции игрока в файл уровня
+     *
+     * Выгруженные стримером чанки читаются из файла подкачки.
+     *
+     * @param path Путь к файлу
+     * @return true в случае успеха
+     */
+    bool saveLevel(const std::string& path);
+
+    /**
+     * @brief Загрузка уровня, сохраненного saveLevel
+     *
+     * Файл отображается в память; объекты сцены создаются заново по записям файла.
+     *
+     * @param path Путь к файлу
+     * @return true в случае успеха
+     */
+    bool loadLevel(const std::string& path);
+
 private:
     /**
      * @brief Отрисовка интерактивных объектов
@@ -196,7 +249,11 @@ private:
     std::shared_ptr<Player> m_player;                    ///< Игрок
     std::shared_ptr<CollisionSystem> m_collisionSystem;  ///< Система коллизий
     std::shared_ptr<RenderingSystem> m_renderingSystem;  ///< Система рендеринга
+    std::shared_ptr<FieldOfView> m_fieldOfView;          ///< Поле зрения игрока (туман войны)
     std::shared_ptr<UIManager> m_uiManager;              /// Добавлен новый член класса
+    std::shared_ptr<DynamicResolution> m_dynamicResolution; ///< Динамическое разрешение мира
+    std::shared_ptr<ChunkSwapFile> m_chunkSwap;          ///< Файл выгруженных чанков
+    std::shared_ptr<ChunkStreamer> m_chunkStreamer;      ///< Подгрузка чанков вокруг игрока
     bool m_waitingForKeyRelease = false;
    // bool m_waitingForKeyRelease;  ///< Флаг, указывающий, что ожидается отпускание клавиши E
 
@@ -4,44 +4,60 @@
 #include <string>
 #include <SDL.h>
 
+class TileMap;
+
 /**
- * @brief Класс для представления тайла на карте
+ * @brief Представление одного тайла карты
+ *
+ * Сами данные тайлов хранятся в чанках TileMap массивами (тип, флаги,
+ * высота), а MapTile - легкий вид на ячейку: карта и координаты. Вид
+ * копируется по значению, все чтения и записи идут в массивы карты,
+ * поэтому изменения через вид оповещают слушателей так же, как методы
+ * TileMap::setTile*. Вид действителен, пока карта не переинициализирована.
+ *
+ * Цвет тайла не хранится, а берется из таблицы цветов типов.
  */
 class MapTile {
 public:
     /**
-     * @brief Конструктор по умолчанию (создает пустой тайл)
+     * @brief Конструктор по умолчанию (пустой вид, ни на что не указывает)
      */
-    MapTile();
+    MapTile() : m_map(nullptr), m_x(0), m_y(0) {}
 
     /**
-     * @brief Конструктор с указанием типа
-     * @param type Тип тайла
+     * @brief Конструктор вида на тайл карты
+     * @param map Карта тайлов
+     * @param x X координата тайла
+     * @param y Y координата тайла
      */
-    MapTile(TileType type);
+    MapTile(TileMap* map, int x, int y) : m_map(map), m_x(x), m_y(y) {}
 
     /**
-     * @brief Конструктор с указанием всех параметров
-     * @param type Тип тайла
-     * @param walkable Флаг проходимости
-     * @param transparent Флаг прозрачности
-     * @param height Высота тайла
+     * @brief Проверка, указывает ли вид на тайл
+     * @return true, если вид получен для координат внутри карты
+     */
+    explicit operator bool() const { return m_map != nullptr; }
+
+    /**
+     * @brief Получение X координаты тайла
+     * @return X координата
      */
-    MapTile(TileType type, bool walkable, bool transparent, float height);
+    int getX() const { return m_x; }
 
     /**
-     * @brief Деструктор
+     * @brief Получение Y координаты тайла
+     * @return Y координата
      */
-    ~MapTile();
+    int getY() const { return m_y; }
 
     /**
      * @brief Получение типа тайла
      * @return Тип тайла
      */
-    TileType getType() const { return m_type; }
+    TileType getType() const;
 
     /**
-     * @brief Установка типа тайла
+     * @brief Установка типа тайла (со стандартными флагами и высотой типа)
      * @param type Тип тайла
      */
     void setType(TileType type);
@@ -50,49 +66,43 @@ public:
      * @brief Проверка проходимости тайла
      * @return true, если тайл проходим, false в противном случае
      */
-    bool isWalkable() const { return m_walkable; }
+    bool isWalkable() const;
 
     /**
      * @brief Установка признака проходимости
      * @param walkable Признак проходимости
      */
-    void setWalkable(bool walkable) { m_walkable = walkable; }
+    void setWalkable(bool walkable);
 
     /**
      * @brief Проверка прозрачности тайла
      * @return true, если тайл прозрачный, false в противном случае
      */
-    bool isTransparent() const { return m_transparent; }
+    bool isTransparent() const;
 
     /**
      * @brief Установка признака прозрачности
      * @param transparent Признак прозрачности
      */
-    void setTransparent(bool transparent) { m_transparent = transparent; }
+    void setTransparent(bool transparent);
 
     /**
      * @brief Получение высоты тайла
-     * @return Высота тайла
+     * @return Высота тайла (с точностью до TileMap::HEIGHT_SCALE)
      */
-    float getHeight() const { return m_height; }
+    float getHeight() const;
 
     /**
      * @brief Установка высоты тайла
      * @param height Высота тайла
      */
-    void setHeight(float height) { m_height = height; }
+    void setHeight(float height);
 
     /**
      * @brief Получение цвета для рендеринга тайла
-     * @return Цвет тайла (SDL_Color)
+     * @return Цвет типа тайла (SDL_Color)
      */
-    SDL_Color getColor() const;
-
-    /**
-     * @brief Установка цвета для рендеринга тайла
-     * @param color Цвет тайла
-     */
-    void setColor(const SDL_Color& color) { m_color = color; }
+    SDL_Color getColor() const { return getTypeColor(getType()); }
 
     /**
      * @brief Получение строкового представления тайла
@@ -104,18 +114,49 @@ public:
      * @brief Проверка, является ли тайл водой
      * @return true, если тайл является водой, false в противном случае
      */
-    bool isWater() const { return m_type == TileType::WATER; }
+    bool isWater() const { return getType() == TileType::WATER; }
+
+    /**
+     * @brief Получение цвета типа тайла
+     * @param type Тип тайла
+     * @return Цвет из таблицы цветов типов
+     */
+    static SDL_Color getTypeColor(TileType type) {
+        int index = static_cast<int>(type);
+        return index >= 0 && index < TYPE_COLOR_COUNT ? TYPE_COLORS[index] : DEFAULT_COLOR;
+    }
 
 private:
-    TileType m_type;       ///< Тип тайла
-    bool m_walkable;       ///< Признак проходимости
-    bool m_transparent;    ///< Признак прозрачности
-    float m_height;        ///< Высота тайла
-    SDL_Color m_color;     ///< Цвет для рендеринга
-
-    // Дополнительные свойства, которые могут быть добавлены позже:
-    // bool m_destructible;  ///< Может ли тайл быть разрушен
-    // bool m_flammable;     ///< Может ли тайл гореть
-    // float m_friction;     ///< Трение поверхности
-    // int m_hardness;       ///< Прочность тайла
-};
\ No newline at end of file
+    static constexpr SDL_Color DEFAULT_COLOR = { 120, 120, 120, 255 }; ///< Серый для типов без своего цвета
+
+    /**
+     * @brief Цвета типов тайлов (индекс - значение TileType)
+     */
+    static constexpr SDL_Color TYPE_COLORS[] = {
+        { 0, 0, 0, 0 },          // EMPTY - полностью прозрачный
+        { 180, 180, 180, 255 },  // FLOOR - светло-серый
+        { 100, 100, 100, 255 },  // WALL - темно-серый
+        { 120, 60, 0, 255 },     // DOOR - коричневый
+        { 0, 100, 255, 200 },    // WATER - полупрозрачный синий
+        { 50, 180, 50, 255 },    // GRASS - зеленый
+        { 150, 150, 150, 255 },  // STONE - серый камень
+        { 170, 170, 190, 255 },  // METAL - серебристый
+        { 200, 200, 255, 150 },  // GLASS - полупрозрачный голубой
+        { 150, 100, 50, 255 },   // WOOD - коричневый
+        DEFAULT_COLOR,           // SPECIAL
+        DEFAULT_COLOR,           // OBSTACLE
+        { 230, 220, 170, 255 },  // SAND - песочный
+        { 240, 240, 255, 255 },  // SNOW - белый с оттенком синего
+        { 200, 220, 255, 200 },  // ICE - голубой полупрозрачный
+        DEFAULT_COLOR,           // ROCK_FORMATION
+        { 255, 100, 0, 255 },    // LAVA - оранжево-красный
+        DEFAULT_COLOR            // FOREST
+    };
+
+    static constexpr int TYPE_COLOR_COUNT = static_cast<int>(sizeof(TYPE_COLORS) / sizeof(TYPE_COLORS[0]));
+    static_assert(TYPE_COLOR_COUNT == static_cast<int>(TileType::FOREST) + 1, "Each TileType needs a color");
+
+    TileMap* m_map;    ///< Карта, которой принадлежит тайл (nullptr - пустой вид)
+    int m_x;           ///< X координата тайла
+    int m_y;           ///< Y координата тайла
+};
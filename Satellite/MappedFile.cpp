@@ -0,0 +1,107 @@
+﻿#include "MappedFile.h"
+#include "Logger.h"
+#include <cstdint>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NOGDI
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    // 1. Открываем файл и узнаем размер
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to open file for mapping: " + path);
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 ||
+        static_cast<unsigned long long>(size.QuadPart) > static_cast<unsigned long long>(SIZE_MAX)) {
+        LOG_ERROR("Cannot map empty or oversized file: " + path);
+        CloseHandle(file);
+        return false;
+    }
+
+    // 2. Отображаем файл целиком; отображение остается действительным
+    // и после закрытия описателей
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        LOG_ERROR("Failed to create file mapping: " + path);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        LOG_ERROR("Failed to map view of file: " + path);
+        return false;
+    }
+
+    m_data = static_cast<const Uint8*>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+#else
+    // 1. Открываем файл и узнаем размер
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        LOG_ERROR("Failed to open file for mapping: " + path);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || info.st_size <= 0) {
+        LOG_ERROR("Cannot map empty file: " + path);
+        ::close(descriptor);
+        return false;
+    }
+
+    // 2. Отображаем файл целиком; отображение остается действительным
+    // и после закрытия дескриптора
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (view == MAP_FAILED) {
+        LOG_ERROR("Failed to map file: " + path);
+        return false;
+    }
+
+    m_data = static_cast<const Uint8*>(view);
+    m_size = static_cast<size_t>(info.st_size);
+#endif
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (!m_data) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+#else
+    munmap(const_cast<Uint8*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
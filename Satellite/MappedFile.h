@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include <SDL.h>
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Файл, отображенный в память только для чтения
+ *
+ * Содержимое файла доступно как непрерывный массив байт без копирования:
+ * страницы подгружаются системой при первом обращении. Используется
+ * mmap на POSIX и отображение файлов Win32 на Windows. Дескрипторы
+ * закрываются сразу после отображения, отображение живет до close().
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Конструктор
+     */
+    MappedFile();
+
+    /**
+     * @brief Деструктор (снимает отображение)
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Отображение файла в память
+     *
+     * Прежнее отображение снимается.
+     *
+     * @param path Путь к файлу
+     * @return true в случае успеха, false если файл не открыт или пуст
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Снятие отображения
+     */
+    void close();
+
+    /**
+     * @brief Проверка, отображен ли файл
+     * @return true, если данные доступны
+     */
+    bool isOpen() const { return m_data != nullptr; }
+
+    /**
+     * @brief Получение содержимого файла
+     * @return Указатель на первый байт (nullptr, если файл не отображен)
+     */
+    const Uint8* getData() const { return m_data; }
+
+    /**
+     * @brief Получение размера файла
+     * @return Размер в байтах
+     */
+    size_t getSize() const { return m_size; }
+
+private:
+    const Uint8* m_data; ///< Начало отображения
+    size_t m_size;       ///< Размер отображения в байтах
+};
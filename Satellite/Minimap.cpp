@@ -0,0 +1,223 @@
+﻿#include "Minimap.h"
+#include "Logger.h"
+#include "RenderStats.h"
+#include "TilePalette.h"
+#include <algorithm>
+
+Minimap::Minimap(std::shared_ptr<TileMap> tileMap)
+    : m_tileMap(tileMap), m_listenerId(0), m_fovListenerId(0),
+    m_texture(nullptr), m_textureOwner(nullptr), m_textureWidth(0), m_textureHeight(0),
+    m_fullRebuild(true), m_dirtyMinX(0), m_dirtyMinY(0), m_dirtyMaxX(-1), m_dirtyMaxY(-1) {
+    // Подписываемся на изменения карты, чтобы обновлять только измененные тайлы
+    m_listenerId = m_tileMap->addChangeListener([this](int minX, int minY, int maxX, int maxY) {
+        onTilesChanged(minX, minY, maxX, maxY);
+        });
+}
+
+Minimap::~Minimap() {
+    if (m_tileMap) {
+        m_tileMap->removeChangeListener(m_listenerId);
+    }
+    if (m_fieldOfView) {
+        m_fieldOfView->removeChangeListener(m_fovListenerId);
+    }
+    releaseTexture();
+}
+
+void Minimap::setFieldOfView(std::shared_ptr<FieldOfView> fieldOfView) {
+    if (fieldOfView == m_fieldOfView) {
+        return;
+    }
+
+    if (m_fieldOfView) {
+        m_fieldOfView->removeChangeListener(m_fovListenerId);
+    }
+
+    m_fieldOfView = fieldOfView;
+    m_fovListenerId = 0;
+    if (m_fieldOfView) {
+        m_fovListenerId = m_fieldOfView->addChangeListener([this](int minX, int minY, int maxX, int maxY) {
+            markDirty(minX, minY, maxX, maxY);
+            });
+    }
+
+    m_fullRebuild = true;
+}
+
+bool Minimap::render(SDL_Renderer* renderer, const SDL_Rect& dst) {
+    if (!ensureTexture(renderer)) {
+        return false;
+    }
+
+    // 1. Загружаем накопленные изменения
+    if (m_fullRebuild) {
+        SDL_Rect area = { 0, 0, m_textureWidth, m_textureHeight };
+        if (!uploadArea(area, false)) {
+            return false;
+        }
+        m_fullRebuild = false;
+    }
+    else if (m_dirtyMaxX >= m_dirtyMinX && m_dirtyMaxY >= m_dirtyMinY) {
+        SDL_Rect area = { m_dirtyMinX, m_dirtyMinY,
+            m_dirtyMaxX - m_dirtyMinX + 1, m_dirtyMaxY - m_dirtyMinY + 1 };
+        if (!uploadArea(area, true)) {
+            return false;
+        }
+    }
+    m_dirtyMaxX = -1;
+    m_dirtyMaxY = -1;
+
+    // 2. Выводим миникарту одним копированием
+    SDL_RenderCopy(renderer, m_texture, nullptr, &dst);
+    RenderStats::getInstance().addDrawCalls();
+    return true;
+}
+
+void Minimap::releaseTexture() {
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+        m_texture = nullptr;
+    }
+    m_textureOwner = nullptr;
+    m_textureWidth = 0;
+    m_textureHeight = 0;
+    m_fullRebuild = true;
+}
+
+void Minimap::onTilesChanged(int minX, int minY, int maxX, int maxY) {
+    if (minX == TileMap::ALL_TILES) {
+        // Карта изменилась целиком (возможно, и ее размер)
+        m_fullRebuild = true;
+        return;
+    }
+
+    // Выгрузка чанка не меняет уже нарисованные на миникарте тайлы
+    if (!m_tileMap->hasResidentChunk(minX, minY, maxX, maxY)) {
+        return;
+    }
+
+    markDirty(minX, minY, maxX, maxY);
+}
+
+void Minimap::markDirty(int minX, int minY, int maxX, int maxY) {
+    if (m_dirtyMaxX < m_dirtyMinX) {
+        m_dirtyMinX = minX;
+        m_dirtyMinY = minY;
+        m_dirtyMaxX = maxX;
+        m_dirtyMaxY = maxY;
+        return;
+    }
+
+    m_dirtyMinX = std::min(m_dirtyMinX, minX);
+    m_dirtyMinY = std::min(m_dirtyMinY, minY);
+    m_dirtyMaxX = std::max(m_dirtyMaxX, maxX);
+    m_dirtyMaxY = std::max(m_dirtyMaxY, maxY);
+}
+
+bool Minimap::ensureTexture(SDL_Renderer* renderer) {
+    int width = m_tileMap->getWidth();
+    int height = m_tileMap->getHeight();
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    if (m_texture && m_textureOwner == renderer &&
+        m_textureWidth == width && m_textureHeight == height) {
+        return true;
+    }
+
+    releaseTexture();
+
+    m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (!m_texture) {
+        LOG_ERROR("Failed to create minimap texture: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+    m_textureOwner = renderer;
+    m_textureWidth = width;
+    m_textureHeight = height;
+    m_fullRebuild = true;
+    return true;
+}
+
+bool Minimap::uploadArea(const SDL_Rect& area, bool skipEvicted) {
+    // Изменения за пределами текстуры (карта уменьшилась) отбрасываются
+    SDL_Rect bounds = { 0, 0, m_textureWidth, m_textureHeight };
+    SDL_Rect clipped;
+    if (!SDL_IntersectRect(&area, &bounds, &clipped)) {
+        return true;
+    }
+
+    int right = clipped.x + clipped.w - 1;
+    int bottom = clipped.y + clipped.h - 1;
+    if (!skipEvicted || m_tileMap->isAreaResident(clipped.x, clipped.y, right, bottom)) {
+        return uploadPixels(clipped);
+    }
+
+    // Область задевает выгруженные чанки: обновляем только загруженные части,
+    // выгруженные сохраняют то, что было нарисовано до выгрузки
+    for (int chunkY = clipped.y >> TileChunk::SHIFT; chunkY <= bottom >> TileChunk::SHIFT; ++chunkY) {
+        for (int chunkX = clipped.x >> TileChunk::SHIFT; chunkX <= right >> TileChunk::SHIFT; ++chunkX) {
+            if (!m_tileMap->isChunkResident(chunkX, chunkY)) {
+                continue;
+            }
+
+            SDL_Rect chunkArea = { chunkX << TileChunk::SHIFT, chunkY << TileChunk::SHIFT,
+                TileChunk::SIZE, TileChunk::SIZE };
+            SDL_Rect part;
+            if (SDL_IntersectRect(&chunkArea, &clipped, &part) && !uploadPixels(part)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Minimap::uploadPixels(const SDL_Rect& clipped) {
+    void* pixels = nullptr;
+    int pitch = 0;
+    if (SDL_LockTexture(m_texture, &clipped, &pixels, &pitch) != 0) {
+        LOG_ERROR("Failed to lock minimap texture: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    // Заблокированная память доступна только на запись - заполняем каждый пиксель области
+    for (int y = 0; y < clipped.h; ++y) {
+        Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(pixels) + y * pitch);
+        for (int x = 0; x < clipped.w; ++x) {
+            row[x] = getTilePixel(clipped.x + x, clipped.y + y);
+        }
+    }
+
+    SDL_UnlockTexture(m_texture);
+    return true;
+}
+
+Uint32 Minimap::getTilePixel(int x, int y) const {
+    TileType type = m_tileMap->getTileType(x, y);
+    if (type == TileType::EMPTY) {
+        return 0;
+    }
+
+    FieldOfView::Visibility visibility = m_fieldOfView ?
+        m_fieldOfView->getVisibility(x, y) : FieldOfView::Visibility::VISIBLE;
+    if (visibility == FieldOfView::Visibility::HIDDEN) {
+        return 0;
+    }
+
+    // Проходимый по типу, но закрытый тайл - запертая дверь
+    SDL_Color color = MapTile::getTypeColor(type);
+    if (!m_tileMap->isTileWalkable(x, y) && IsWalkable(type)) {
+        color = { 220, 140, 40, 255 };
+    }
+
+    if (visibility == FieldOfView::Visibility::REMEMBERED) {
+        color = TilePalette::shade(color, TilePalette::REMEMBERED_SHADE);
+    }
+
+    return (0xFFu << 24) | (static_cast<Uint32>(color.r) << 16) |
+        (static_cast<Uint32>(color.g) << 8) | color.b;
+}
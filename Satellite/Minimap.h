@@ -0,0 +1,130 @@
+﻿#pragma once
+
+#include "TileMap.h"
+#include "FieldOfView.h"
+#include <SDL.h>
+#include <memory>
+
+/**
+ * @brief Миникарта уровня в потоковой текстуре
+ *
+ * Каждому тайлу соответствует один пиксель текстуры. Текстура заполняется
+ * целиком после генерации уровня, а затем обновляется только в области
+ * измененных тайлов (например, при открытии двери): изменения карты
+ * приходят через подписку TileMap и копятся в ограничивающем прямоугольнике
+ * до следующей отрисовки. Сама миникарта выводится одним SDL_RenderCopy.
+ *
+ * С полем зрения на миникарте видны только исследованные тайлы;
+ * невидимые сейчас затемнены так же, как в мире.
+ */
+class Minimap {
+public:
+    /**
+     * @brief Конструктор
+     * @param tileMap Указатель на карту тайлов
+     */
+    explicit Minimap(std::shared_ptr<TileMap> tileMap);
+
+    /**
+     * @brief Деструктор (отписывается от карты и освобождает текстуру)
+     */
+    ~Minimap();
+
+    Minimap(const Minimap&) = delete;
+    Minimap& operator=(const Minimap&) = delete;
+
+    /**
+     * @brief Получение карты, по которой построена миникарта
+     * @return Указатель на карту тайлов
+     */
+    const TileMap* getTileMap() const { return m_tileMap.get(); }
+
+    /**
+     * @brief Установка поля зрения для тумана войны
+     * @param fieldOfView Поле зрения (nullptr - карта видна целиком)
+     */
+    void setFieldOfView(std::shared_ptr<FieldOfView> fieldOfView);
+
+    /**
+     * @brief Отрисовка миникарты
+     *
+     * Перед выводом в текстуру загружаются накопленные изменения.
+     *
+     * @param renderer SDL рендерер
+     * @param dst Прямоугольник на экране (один тайл - dst.w / ширина карты пикселей)
+     * @return true, если миникарта выведена
+     */
+    bool render(SDL_Renderer* renderer, const SDL_Rect& dst);
+
+    /**
+     * @brief Освобождение текстуры (например, после SDL_RENDER_DEVICE_RESET)
+     *
+     * Текстура создается и заполняется заново при следующей отрисовке.
+     */
+    void releaseTexture();
+
+private:
+    /**
+     * @brief Обработка изменения карты
+     * @param minX Левая граница измененной области (или TileMap::ALL_TILES)
+     * @param minY Верхняя граница
+     * @param maxX Правая граница (включительно)
+     * @param maxY Нижняя граница (включительно)
+     */
+    void onTilesChanged(int minX, int minY, int maxX, int maxY);
+
+    /**
+     * @brief Расширение измененной области
+     * @param minX Левая граница (в тайлах)
+     * @param minY Верхняя граница
+     * @param maxX Правая граница (включительно)
+     * @param maxY Нижняя граница (включительно)
+     */
+    void markDirty(int minX, int minY, int maxX, int maxY);
+
+    /**
+     * @brief Создание текстуры под текущий размер карты
+     * @param renderer SDL рендерер
+     * @return true, если текстура готова
+     */
+    bool ensureTexture(SDL_Renderer* renderer);
+
+    /**
+     * @brief Загрузка области карты в текстуру
+     * @param area Область в тайлах
+     * @param skipEvicted true - тайлы выгруженных чанков не перерисовываются
+     * @return true в случае успеха
+     */
+    bool uploadArea(const SDL_Rect& area, bool skipEvicted);
+
+    /**
+     * @brief Запись пикселей области в текстуру
+     * @param clipped Область в тайлах (внутри текстуры)
+     * @return true в случае успеха
+     */
+    bool uploadPixels(const SDL_Rect& clipped);
+
+    /**
+     * @brief Цвет тайла на миникарте
+     * @param x X координата тайла
+     * @param y Y координата тайла
+     * @return Цвет в формате ARGB8888
+     */
+    Uint32 getTilePixel(int x, int y) const;
+
+    std::shared_ptr<TileMap> m_tileMap;   ///< Карта тайлов
+    int m_listenerId;                     ///< Идентификатор подписки на изменения карты
+    std::shared_ptr<FieldOfView> m_fieldOfView; ///< Поле зрения (может быть nullptr)
+    int m_fovListenerId;                  ///< Идентификатор подписки на изменения видимости
+
+    SDL_Texture* m_texture;               ///< Потоковая текстура миникарты
+    SDL_Renderer* m_textureOwner;         ///< Рендерер, создавший текстуру
+    int m_textureWidth;                   ///< Ширина текстуры (в тайлах)
+    int m_textureHeight;                  ///< Высота текстуры (в тайлах)
+
+    bool m_fullRebuild;                   ///< Текстуру нужно заполнить целиком
+    int m_dirtyMinX;                      ///< Левая граница измененной области
+    int m_dirtyMinY;                      ///< Верхняя граница измененной области
+    int m_dirtyMaxX;                      ///< Правая граница (меньше левой - изменений нет)
+    int m_dirtyMaxY;                      ///< Нижняя граница измененной области
+};
@@ -0,0 +1,86 @@
+﻿#include "OcclusionBuffer.h"
+#include <algorithm>
+#include <cstdlib>
+
+void OcclusionBuffer::reset(int viewWidth, int viewHeight) {
+    m_viewWidth = viewWidth;
+    m_viewHeight = viewHeight;
+
+    int columns = (viewWidth + COLUMN_WIDTH - 1) / COLUMN_WIDTH;
+    m_coveredTop.assign(columns, 0);
+    m_coveredBottom.assign(columns, -1);
+}
+
+bool OcclusionBuffer::isRectOccluded(int left, int top, int right, int bottom) const {
+    // Обрезаем прямоугольник экраном: невидимые части не требуют перекрытия
+    left = std::max(left, 0);
+    top = std::max(top, 0);
+    right = std::min(right, m_viewWidth - 1);
+    bottom = std::min(bottom, m_viewHeight - 1);
+
+    if (left > right || top > bottom) {
+        return true;
+    }
+
+    int firstColumn = left / COLUMN_WIDTH;
+    int lastColumn = right / COLUMN_WIDTH;
+
+    for (int column = firstColumn; column <= lastColumn; ++column) {
+        if (m_coveredTop[column] > top || m_coveredBottom[column] < bottom) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void OcclusionBuffer::addBlock(int baseX, int baseY, int tileWidth, int tileHeight, int heightOffset) {
+    int halfWidth = tileWidth / 2;
+    if (halfWidth <= 0 || tileHeight <= 0 || m_coveredTop.empty()) {
+        return;
+    }
+
+    // Рассматриваем только колонки, целиком лежащие внутри силуэта
+    int firstColumn = std::max(0, (baseX - halfWidth + COLUMN_WIDTH - 1) / COLUMN_WIDTH);
+    int lastColumn = std::min(static_cast<int>(m_coveredTop.size()) - 1,
+        (baseX + halfWidth + 1) / COLUMN_WIDTH - 1);
+
+    for (int column = firstColumn; column <= lastColumn; ++column) {
+        int columnLeft = column * COLUMN_WIDTH;
+        int columnRight = columnLeft + COLUMN_WIDTH - 1;
+        if (columnLeft < baseX - halfWidth || columnRight > baseX + halfWidth) {
+            continue;
+        }
+
+        // Наибольшее удаление пикселей колонки от центральной оси блока
+        int distance = std::max(std::abs(columnLeft - baseX), std::abs(columnRight - baseX));
+
+        // Верх силуэта - ребра верхней грани, низ - ребра основания (наклон tileHeight/tileWidth).
+        // Пиксель запаса с каждой стороны компенсирует округление при растеризации
+        int slope = (distance * tileHeight + tileWidth - 1) / tileWidth;
+        int top = baseY - heightOffset + slope + 1;
+        int bottom = baseY + tileHeight - slope - 1;
+        if (top > bottom) {
+            continue;
+        }
+
+        int& coveredTop = m_coveredTop[column];
+        int& coveredBottom = m_coveredBottom[column];
+
+        if (coveredTop > coveredBottom) {
+            // Колонка еще пуста
+            coveredTop = top;
+            coveredBottom = bottom;
+        }
+        else if (top <= coveredBottom + 1 && bottom >= coveredTop - 1) {
+            // Отрезки пересекаются или соприкасаются - объединяем
+            coveredTop = std::min(coveredTop, top);
+            coveredBottom = std::max(coveredBottom, bottom);
+        }
+        else if (bottom - top > coveredBottom - coveredTop) {
+            // Хранится один отрезок, оставляем более длинный
+            coveredTop = top;
+            coveredBottom = bottom;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include <vector>
+
+/**
+ * @brief Грубый экранный буфер перекрытия для отсечения невидимых тайлов
+ *
+ * Экран делится на вертикальные колонки шириной COLUMN_WIDTH пикселей.
+ * Для каждой колонки хранится один непрерывный отрезок по Y, гарантированно
+ * закрытый уже обработанными непрозрачными блоками. Буфер заполняется
+ * спереди назад, поэтому тайл, чей прямоугольник целиком лежит в закрытых
+ * отрезках, можно не рисовать.
+ */
+class OcclusionBuffer {
+public:
+    static constexpr int COLUMN_WIDTH = 8;  ///< Ширина колонки в пикселях
+
+    /**
+     * @brief Сброс буфера под новый кадр
+     * @param viewWidth Ширина области вывода
+     * @param viewHeight Высота области вывода
+     */
+    void reset(int viewWidth, int viewHeight);
+
+    /**
+     * @brief Проверка, закрыт ли прямоугольник уже добавленными блоками
+     *
+     * Части прямоугольника за пределами экрана считаются закрытыми.
+     *
+     * @param left Левая граница (включительно)
+     * @param top Верхняя граница (включительно)
+     * @param right Правая граница (включительно)
+     * @param bottom Нижняя граница (включительно)
+     * @return true, если прямоугольник полностью перекрыт
+     */
+    bool isRectOccluded(int left, int top, int right, int bottom) const;
+
+    /**
+     * @brief Добавление непрозрачного изометрического блока как перекрывающего
+     *
+     * В буфер попадает только внутренняя часть силуэта блока (шестиугольника),
+     * гарантированно закрытая во всей ширине колонки.
+     *
+     * @param baseX X верхней вершины ромба основания на экране
+     * @param baseY Y верхней вершины ромба основания на экране
+     * @param tileWidth Ширина ромба в пикселях
+     * @param tileHeight Высота ромба в пикселях
+     * @param heightOffset Высота блока в пикселях
+     */
+    void addBlock(int baseX, int baseY, int tileWidth, int tileHeight, int heightOffset);
+
+private:
+    int m_viewWidth = 0;            ///< Ширина области вывода
+    int m_viewHeight = 0;           ///< Высота области вывода
+    std::vector<int> m_coveredTop;    ///< Верх закрытого отрезка колонки
+    std::vector<int> m_coveredBottom; ///< Низ закрытого отрезка колонки (меньше верха - пусто)
+};
@@ -6,7 +6,7 @@
 
 Player::Player(const std::string& name, TileMap* tileMap)
     : Entity(name), m_tileMap(tileMap), m_currentDirection(Direction::SOUTH),
-    m_subX(0.5f), m_subY(0.5f), m_moveSpeed(0.05f), m_dX(0.0f), m_dY(0.0f),
+    m_subX(0.5f), m_subY(0.5f), m_prevFullX(0.0f), m_prevFullY(0.0f), m_moveSpeed(0.05f), m_dX(0.0f), m_dY(0.0f),
     m_collisionSize(0.35f), m_height(0.5f)
 {
     // Устанавливаем начальный цвет игрока (красный)
@@ -80,6 +80,10 @@ void Player::detectKeyInput()
 
 void Player::update(float deltaTime)
 {
+    // Запоминаем положение для интерполяции при отрисовке
+    m_prevFullX = getFullX();
+    m_prevFullY = getFullY();
+
     // Если нет движения, то выходим
     if (m_dX == 0.0f && m_dY == 0.0f) {
         return;
@@ -89,7 +93,7 @@ void Player::update(float deltaTime)
     int currentTileX = static_cast<int>(m_position.x);
     int currentTileY = static_cast<int>(m_position.y);
 
-    // Нормализация скорости для разных частот кадров
+    // Скорость задана в тайлах за шаг 1/60 секунды
     float normalizedSpeed = m_moveSpeed * deltaTime * 60.0f;
 
     // Рассчитываем дельту передвижения
@@ -177,6 +181,24 @@ void Player::update(float deltaTime)
     }
 }
 
+float Player::getRenderX(float alpha) const
+{
+    float fullX = getFullX();
+    if (std::fabs(fullX - m_prevFullX) > 1.0f) {
+        return fullX;
+    }
+    return m_prevFullX + (fullX - m_prevFullX) * alpha;
+}
+
+float Player::getRenderY(float alpha) const
+{
+    float fullY = getFullY();
+    if (std::fabs(fullY - m_prevFullY) > 1.0f) {
+        return fullY;
+    }
+    return m_prevFullY + (fullY - m_prevFullY) * alpha;
+}
+
 void Player::render(SDL_Renderer* renderer)
 {
     // Отрисовка будет осуществляться через TileRenderer в MapScene
@@ -294,10 +316,10 @@ void Player::NormalizeSubCoordinates() {
     }
 }
 
-void Player::renderDirectionIndicator(SDL_Renderer* renderer, IsometricRenderer* isoRenderer, int centerX, int centerY) const {
+void Player::renderDirectionIndicator(SDL_Renderer* renderer, IsometricRenderer* isoRenderer, int centerX, int centerY, float alpha) const {
     // Получаем координаты игрока
-    float playerX = getFullX();
-    float playerY = getFullY();
+    float playerX = getRenderX(alpha);
+    float playerY = getRenderY(alpha);
     float playerZ = getHeight();
 
     // Вычисляем направляющий вектор в зависимости от текущего направления
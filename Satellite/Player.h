@@ -121,6 +121,24 @@ public:
      */
     float getFullY() const { return m_position.y + m_subY; }
 
+    /**
+     * @brief Получение X координаты для отрисовки
+     *
+     * Положение интерполируется между двумя последними шагами update().
+     * Скачки больше тайла (телепортация, сброс позиции) не интерполируются.
+     *
+     * @param alpha Коэффициент интерполяции [0, 1]
+     * @return X координата в мировом пространстве
+     */
+    float getRenderX(float alpha) const;
+
+    /**
+     * @brief Получение Y координаты для отрисовки
+     * @param alpha Коэффициент интерполяции [0, 1]
+     * @return Y координата в мировом пространстве
+     */
+    float getRenderY(float alpha) const;
+
     /**
      * @brief Получение размера коллизии
      * @return Размер коллизии (радиус)
@@ -199,10 +217,11 @@ public:
      * @param isoRenderer Изометрический рендерер
      * @param centerX X-координата центра экрана
      * @param centerY Y-координата центра экрана
+     * @param alpha Коэффициент интерполяции положения
      */
     void renderDirectionIndicator(SDL_Renderer* renderer,
         IsometricRenderer* isoRenderer,
-        int centerX, int centerY) const;
+        int centerX, int centerY, float alpha = 1.0f) const;
 
     /**
      * @brief Проверка, следует ли отображать указатель направления
@@ -244,6 +263,8 @@ private:
     Direction m_currentDirection;   ///< Текущее направление игрока
     float m_subX;                   ///< Позиция внутри тайла по X (0.0-1.0)
     float m_subY;                   ///< Позиция внутри тайла по Y (0.0-1.0)
+    float m_prevFullX;              ///< Полная X координата на предыдущем шаге update()
+    float m_prevFullY;              ///< Полная Y координата на предыдущем шаге update()
     float m_moveSpeed;              ///< Скорость движения
     float m_dX;                     ///< Направление движения по X
     float m_dY;                     ///< Направление движения по Y
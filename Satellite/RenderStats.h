@@ -0,0 +1,68 @@
+﻿#pragma once
+
+/**
+ * @brief Счетчики отрисовки текущего кадра
+ */
+struct RenderFrameStats {
+    int drawCalls = 0;      ///< Вызовы SDL_Render* (заливки, линии, копирования, пакеты геометрии)
+    int tiles = 0;          ///< Тайлы, переданные на отрисовку
+    int cachedSprites = 0;  ///< Объемные тайлы, выведенные из кэша спрайтов
+    int chunkBlits = 0;     ///< Чанки пола, выведенные из кэша
+};
+
+/**
+ * @brief Сбор статистики отрисовки для отладки и замеров производительности
+ *
+ * Счетчики увеличиваются в местах вызова SDL_Render* мира и текста;
+ * отдельные элементы интерфейса не учитываются.
+ */
+class RenderStats {
+public:
+    /**
+     * @brief Получение экземпляра синглтона
+     * @return Ссылка на экземпляр статистики
+     */
+    static RenderStats& getInstance() {
+        static RenderStats instance;
+        return instance;
+    }
+
+    /**
+     * @brief Сброс счетчиков перед новым кадром
+     */
+    void beginFrame() { m_frame = RenderFrameStats(); }
+
+    /**
+     * @brief Учет вызовов отрисовки
+     * @param count Количество вызовов
+     */
+    void addDrawCalls(int count = 1) { m_frame.drawCalls += count; }
+
+    /**
+     * @brief Учет тайла, переданного на отрисовку
+     */
+    void addTile() { ++m_frame.tiles; }
+
+    /**
+     * @brief Учет спрайта, выведенного из кэша
+     */
+    void addCachedSprite() { ++m_frame.cachedSprites; }
+
+    /**
+     * @brief Учет чанка пола, выведенного из кэша
+     */
+    void addChunkBlit() { ++m_frame.chunkBlits; }
+
+    /**
+     * @brief Получение счетчиков текущего кадра
+     * @return Счетчики с момента последнего beginFrame()
+     */
+    const RenderFrameStats& getFrame() const { return m_frame; }
+
+private:
+    RenderStats() = default;
+    RenderStats(const RenderStats&) = delete;
+    RenderStats& operator=(const RenderStats&) = delete;
+
+    RenderFrameStats m_frame; ///< Счетчики текущего кадра
+};
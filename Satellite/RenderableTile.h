@@ -21,29 +21,32 @@ public:
     // Приоритет рендеринга (более высокое значение означает, что объект будет отрисован поверх других)
     float renderPriority = 0.0f;  // Изменено с int на float для более точной сортировки
 
+    // Маска видимых граней объемного тайла (IsometricRenderer::FaceMask), по умолчанию все
+    Uint8 faceMask = 0x07;
+
+    // Индекс записи палитры TilePalette с цветами граней и контуров
+    Uint16 paletteIndex = 0;
+
+    // Упакованный ключ сортировки (вычисляется один раз при добавлении в TileRenderer)
+    Uint64 sortKey = 0;
+
     // Текстуры (могут быть nullptr)
     SDL_Texture* topTexture = nullptr;    // Верхняя грань
     SDL_Texture* leftTexture = nullptr;   // Левая грань (для объемных)
     SDL_Texture* rightTexture = nullptr;  // Правая грань (для объемных)
 
-    // Цвета для отрисовки без текстур
-    SDL_Color topColor = { 255, 255, 255, 255 };
-    SDL_Color leftColor = { 200, 200, 200, 255 };
-    SDL_Color rightColor = { 150, 150, 150, 255 };
-
     // Конструктор для плоского тайла
-    RenderableTile(float x, float y, SDL_Texture* texture, SDL_Color color, float priority = 0.0f)
+    RenderableTile(float x, float y, SDL_Texture* texture, Uint16 palette, float priority = 0.0f)
         : worldX(x), worldY(y), worldZ(0.0f), type(TileType::FLAT),
-        renderPriority(priority), topTexture(texture), topColor(color) {
+        renderPriority(priority), paletteIndex(palette), topTexture(texture) {
     }
 
     // Конструктор для объемного тайла
     RenderableTile(float x, float y, float z,
         SDL_Texture* top, SDL_Texture* left, SDL_Texture* right,
-        SDL_Color topCol, SDL_Color leftCol, SDL_Color rightCol,
-        float priority = 0.0f)
+        Uint16 palette, float priority = 0.0f)
         : worldX(x), worldY(y), worldZ(z), type(TileType::VOLUMETRIC),
-        renderPriority(priority), topTexture(top), leftTexture(left), rightTexture(right),
-        topColor(topCol), leftColor(leftCol), rightColor(rightCol) {
+        renderPriority(priority), paletteIndex(palette),
+        topTexture(top), leftTexture(left), rightTexture(right) {
     }
 };
\ No newline at end of file
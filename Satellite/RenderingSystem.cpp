@@ -7,9 +7,37 @@ RenderingSystem::RenderingSystem(std::shared_ptr<TileMap> tileMap,
     std::shared_ptr<TileRenderer> tileRenderer,
     std::shared_ptr<IsometricRenderer> isoRenderer)
     : m_tileMap(tileMap), m_tileRenderer(tileRenderer), m_isoRenderer(isoRenderer) {
+    m_floorCache = std::make_shared<FloorChunkCache>(m_tileMap, m_isoRenderer);
+    m_jobSystem = std::make_shared<JobSystem>();
+
+    // Максимальная высота тайлов нужна для расширения видимой области вниз экрана
+    m_mapListenerId = m_tileMap->addChangeListener([this](int minX, int minY, int maxX, int maxY) {
+        if (minX == TileMap::ALL_TILES) {
+            m_maxTileHeightDirty = true;
+        }
+        else {
+            m_maxTileHeight = std::max(m_maxTileHeight, m_tileMap->getMaxTileHeight(minX, minY, maxX, maxY));
+        }
+        });
+
     LOG_INFO("RenderingSystem initialized");
 }
 
+RenderingSystem::~RenderingSystem() {
+    m_tileMap->removeChangeListener(m_mapListenerId);
+}
+
+void RenderingSystem::setFieldOfView(std::shared_ptr<FieldOfView> fieldOfView) {
+    m_fieldOfView = fieldOfView;
+    m_floorCache->setFieldOfView(fieldOfView);
+}
+
+void RenderingSystem::invalidateCaches() {
+    m_floorCache->invalidateAll();
+    m_tileRenderer->invalidateSpriteCache();
+    m_isoRenderer->releaseDeviceResources();
+}
+
 void RenderingSystem::render(SDL_Renderer* renderer,
     std::shared_ptr<Camera> camera,
     std::shared_ptr<Player> player,
@@ -19,18 +47,34 @@ void RenderingSystem::render(SDL_Renderer* renderer,
     SDL_SetRenderDrawColor(renderer, 20, 35, 20, 255);
     SDL_RenderClear(renderer);
 
-    // Получаем размер окна
-    int windowWidth, windowHeight;
-    SDL_GetRendererOutputSize(renderer, &windowWidth, &windowHeight);
+    // Получаем размер цели вывода (окна или текстуры мира при пониженном разрешении)
+    int windowWidth = 0;
+    int windowHeight = 0;
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    if (!target || SDL_QueryTexture(target, nullptr, nullptr, &windowWidth, &windowHeight) != 0) {
+        SDL_GetRendererOutputSize(renderer, &windowWidth, &windowHeight);
+    }
     int centerX = windowWidth / 2;
     int centerY = windowHeight / 2;
 
     // Настраиваем рендерер с учетом камеры
-    m_isoRenderer->setCameraPosition(camera->getX(), camera->getY());
-    m_isoRenderer->setCameraZoom(camera->getZoom());
+    m_isoRenderer->setCameraPosition(camera->getRenderX(m_interpolationAlpha), camera->getRenderY(m_interpolationAlpha));
+    m_isoRenderer->setCameraZoom(camera->getZoom() * m_resolutionScale);
+
+    // Палитра граней перестраивается только при смене биома
+    m_tileRenderer->getPalette().build(biomeType);
 
-    // Используем блочную сортировку для отрисовки тайлов, игрока и интерактивных объектов
-    renderWithBlockSorting(renderer, player, entityManager, centerX, centerY, biomeType);
+    // Определяем видимые тайлы по углам экрана и отсекаем закрытые стенами
+    computeVisibleArea(player, entityManager, centerX, centerY, windowWidth, windowHeight);
+    computeOcclusion(centerX, centerY, windowWidth, windowHeight);
+
+    // Отрисовываем тайлы, игрока и интерактивные объекты в выбранном порядке
+    if (m_renderOrderMode == RenderOrderMode::DIAGONAL_BUCKETS) {
+        renderWithDiagonalBuckets(renderer, player, entityManager, centerX, centerY);
+    }
+    else {
+        renderWithBlockSorting(renderer, player, entityManager, centerX, centerY);
+    }
 
     // Добавляем индикатор игрока, чтобы его можно было видеть за стенами
     renderPlayerIndicator(renderer, player, centerX, centerY);
@@ -38,7 +82,7 @@ void RenderingSystem::render(SDL_Renderer* renderer,
 
 float RenderingSystem::calculateZOrderPriority(float x, float y, float z,
     float playerFullX, float playerFullY,
-    float playerDirectionX, float playerDirectionY) {
+    float playerDirectionX, float playerDirectionY) const {
     // 1. Базовый приоритет на основе положения в пространстве
     float baseDepth = (x + y) * 10.0f;
 
@@ -79,527 +123,569 @@ float RenderingSystem::calculateZOrderPriority(float x, float y, float z,
 void RenderingSystem::renderWithBlockSorting(SDL_Renderer* renderer,
     std::shared_ptr<Player> player,
     std::shared_ptr<EntityManager> entityManager,
-    int centerX, int centerY,
-    int biomeType) {
+    int centerX, int centerY) {
     // 1. Очистка рендерера перед отрисовкой
     m_tileRenderer->clear();
+    TilePalette& palette = m_tileRenderer->getPalette();
 
-    // 2. Получение координат игрока и определение текущего блока
-    float playerFullX = player ? player->getFullX() : 0.0f;
-    float playerFullY = player ? player->getFullY() : 0.0f;
+    // 2. Получение координат игрока
+    float playerFullX = player ? player->getRenderX(m_interpolationAlpha) : 0.0f;
+    float playerFullY = player ? player->getRenderY(m_interpolationAlpha) : 0.0f;
 
-    // Определяем блок, в котором находится игрок (2x2 тайла)
-    int blockColStart = static_cast<int>(playerFullX);
-    int blockRowStart = static_cast<int>(playerFullY);
+    // 3-4. Видимая область уже вычислена в render()
+    const VisibleArea& area = m_visibleArea;
+    if (area.spans.empty()) {
+        return;
+    }
 
-    // 3. Определение радиуса рендеринга вокруг игрока
-    int renderRadius = 30;
+    // 5. ЭТАП 1: ОТРИСОВКА ВСЕХ ПОЛОВ (ПЛОСКИХ ТАЙЛОВ) ПЕРЕД ВСЕМИ ОБЪЕКТАМИ
+    // Полы запечены в текстуры по чанкам и выводятся сразу, до объемных тайлов
+    m_floorCache->render(renderer, area.startX, area.startY, area.endX, area.endY, centerX, centerY);
+
+    // 6. ЭТАП 2: ФОРМИРОВАНИЕ ЕДИНОГО СПИСКА ОТРИСОВКИ
+    // Каждый объект добавляется в TileRenderer один раз с окончательным приоритетом,
+    // сортировка выполняется только в TileRenderer::render
+    float directionX = player ? player->getDirectionX() : 0.0f;
+    float directionY = player ? player->getDirectionY() : 0.0f;
+
+    // 6.1. Объемные тайлы видимой области строятся параллельно полосами строк:
+    // каждая полоса пишет в свой список и сортирует его, общей сортировки нет
+    int rowCount = static_cast<int>(area.spans.size());
+    int bandCount = std::max(1, std::min(rowCount / MIN_ROWS_PER_BAND,
+        m_jobSystem->getThreadCount() * BANDS_PER_THREAD));
+    int rowsPerBand = (rowCount + bandCount - 1) / bandCount;
+    bandCount = (rowCount + rowsPerBand - 1) / rowsPerBand;
+
+    m_sliceTiles.resize(bandCount);
+
+    m_jobSystem->parallelFor(bandCount, [&](int band) {
+        int firstSpan = band * rowsPerBand;
+        int endSpan = std::min(rowCount, firstSpan + rowsPerBand);
+        buildDrawSlice(firstSpan, endSpan, m_sliceTiles[band],
+            playerFullX, playerFullY, directionX, directionY);
+        });
 
-    // 4. Вычисление границ видимой области
-    int startX = std::max(0, blockColStart - renderRadius);
-    int startY = std::max(0, blockRowStart - renderRadius);
-    int endX = std::min(m_tileMap->getWidth() - 1, blockColStart + renderRadius);
-    int endY = std::min(m_tileMap->getHeight() - 1, blockRowStart + renderRadius);
+    // 6.2. Игрок (смещение +0.5 удерживает его поверх тайла, на котором он стоит)
+    if (player) {
+        float priority = calculateZOrderPriority(playerFullX, playerFullY,
+            player->getHeight(), playerFullX, playerFullY, directionX, directionY) + 0.5f;
 
-    // 5. ЭТАП 1: ОТРИСОВКА ВСЕХ ПОЛОВ (ПЛОСКИХ ТАЙЛОВ) ПЕРЕД ВСЕМИ ОБЪЕКТАМИ
-    int depth = 1; // Начальный приоритет
-
-    // Отрисовываем все полы в видимой области
-    for (int y = startY; y <= endY; y++) {
-        for (int x = startX; x <= endX; x++) {
-            const MapTile* tile = m_tileMap->getTile(x, y);
-            if (tile && tile->getType() != TileType::EMPTY && tile->getHeight() <= 0.0f) {
-                // Это плоский тайл (пол)
-                SDL_Color color = tile->getColor();
-                m_tileRenderer->addFlatTile(
-                    static_cast<float>(x), static_cast<float>(y),
-                    nullptr,
-                    color,
-                    depth++
-                );
+        m_tileRenderer->addVolumetricTile(
+            playerFullX, playerFullY, player->getHeight(),
+            palette.addDynamic(player->getColor()), priority
+        );
+    }
+
+    // 6.3. Интерактивные объекты
+    for (const auto& object : entityManager->getInteractiveObjects()) {
+        if (!object->isActive()) continue;
+
+        const auto& position = object->getPosition();
+
+        // Пропускаем объекты вне видимой области и скрытые туманом войны
+        if (!isInVisibleArea(position.x, position.y) || !isObjectRevealed(object.get())) {
+            continue;
+        }
+
+        float priority = calculateZOrderPriority(position.x, position.y, position.z,
+            playerFullX, playerFullY, directionX, directionY);
+
+        addInteractiveObject(object.get(), priority);
+    }
+
+    // 7. Сливаем отсортированные полосы с динамическими объектами и рендерим по порядку
+    m_tileRenderer->mergePresorted(m_sliceTiles);
+    m_tileRenderer->renderInOrder(renderer, centerX, centerY);
+
+    // 8. Отрисовываем указатель направления и индикаторы прогресса над дверями
+    renderOverlays(renderer, player, entityManager, centerX, centerY);
+}
+
+void RenderingSystem::buildDrawSlice(int firstSpan, int endSpan, std::vector<RenderableTile>& tiles,
+    float playerFullX, float playerFullY, float directionX, float directionY) const {
+    tiles.clear();
+
+    const TileMap& tileMap = *m_tileMap;
+
+    // 1. Объемные тайлы строк полосы (построчные отрезки ромба видимости)
+    for (int spanIndex = firstSpan; spanIndex < endSpan; ++spanIndex) {
+        const TileSpan& span = m_visibleArea.spans[spanIndex];
+        int y = span.y;
+        for (int x = span.startX; x <= span.endX; x++) {
+            TileType type = tileMap.getTileType(x, y);
+            float height = tileMap.getTileHeight(x, y);
+            if (type == TileType::EMPTY || height <= 0.0f) {
+                continue;
+            }
+
+            // Тайлы, полностью закрытые стоящими перед ними или ни разу не виденные, пропускаем
+            Uint8 faceMask = getTileFaceMask(x, y);
+            FieldOfView::Visibility visibility = getTileVisibility(x, y);
+            if (faceMask == 0 || visibility == FieldOfView::Visibility::HIDDEN) {
+                continue;
             }
+
+            float priority = calculateZOrderPriority(static_cast<float>(x), static_cast<float>(y),
+                height, playerFullX, playerFullY, directionX, directionY);
+
+            // Цвет определяется типом, поэтому запись палитры постоянная и потокобезопасна
+            Uint16 paletteIndex = getTilePaletteIndex(type, visibility == FieldOfView::Visibility::REMEMBERED);
+
+            tiles.emplace_back(static_cast<float>(x), static_cast<float>(y), height,
+                nullptr, nullptr, nullptr, paletteIndex, priority);
+            tiles.back().faceMask = faceMask;
+            tiles.back().sortKey = TileRenderer::makeSortKey(tiles.back(), type);
         }
     }
 
-    // 6. ЭТАП 2: ОПРЕДЕЛЕНИЕ ОБЩЕГО ПОРЯДКА ОТРИСОВКИ ОБЪЕКТОВ
+    // 2. Устойчивая сортировка полосы; полосы потом сливаются без общей сортировки
+    std::stable_sort(tiles.begin(), tiles.end(), [](const RenderableTile& a, const RenderableTile& b) {
+        return a.sortKey < b.sortKey;
+    });
+}
+
+void RenderingSystem::renderWithDiagonalBuckets(SDL_Renderer* renderer,
+    std::shared_ptr<Player> player,
+    std::shared_ptr<EntityManager> entityManager,
+    int centerX, int centerY) {
+    // 1. Очистка рендерера перед отрисовкой
+    m_tileRenderer->clear();
+    TilePalette& palette = m_tileRenderer->getPalette();
+
+    // 2. Видимая область уже вычислена в render()
+    const VisibleArea& area = m_visibleArea;
+    if (area.spans.empty()) {
+        return;
+    }
+
+    // 3. ЭТАП 1: полы из кэша чанков, до всех объемных объектов
+    m_floorCache->render(renderer, area.startX, area.startY, area.endX, area.endY, centerX, centerY);
+
+    // 4. Раскладываем динамические объекты по корзинам диагоналей X+Y.
+    // Объект попадает в диагональ, в которой лежит его позиция, и рисуется после ее тайлов
+    int firstDiagonal = std::max(area.minDiagonal, area.startX + area.startY);
+    int lastDiagonal = std::min(area.maxDiagonal, area.endX + area.endY);
+    int diagonalCount = lastDiagonal - firstDiagonal + 1;
+    if (diagonalCount <= 0) {
+        return;
+    }
+
+    if (static_cast<int>(m_diagonalBuckets.size()) < diagonalCount) {
+        m_diagonalBuckets.resize(diagonalCount);
+    }
+    for (int i = 0; i < diagonalCount; ++i) {
+        m_diagonalBuckets[i].clear();
+    }
 
-    // Добавляем интерактивные объекты в список для сортировки
-    struct RenderObject {
-        enum class Type { TILE, PLAYER, INTERACTIVE } type;
-        float x, y, z;
-        int tileX, tileY;
-        float priority;
-        std::shared_ptr<InteractiveObject> interactiveObj;
+    auto addToBucket = [&](InteractiveObject* object, float x, float y, float z) {
+        int diagonal = static_cast<int>(std::floor(x + y));
+        int bucket = std::max(0, std::min(diagonalCount - 1, diagonal - firstDiagonal));
+        m_diagonalBuckets[bucket].push_back({ object, x + y, z });
     };
 
-    std::vector<RenderObject> objectsToRender;
+    if (player) {
+        addToBucket(nullptr, player->getRenderX(m_interpolationAlpha), player->getRenderY(m_interpolationAlpha), player->getHeight());
+    }
 
-    // 6.0. Добавляем интерактивные объекты в список сортировки
-    for (auto& object : entityManager->getInteractiveObjects()) {
+    for (const auto& object : entityManager->getInteractiveObjects()) {
         if (!object->isActive()) continue;
 
-        float objectX = object->getPosition().x;
-        float objectY = object->getPosition().y;
-        float objectZ = object->getPosition().z;
+        const auto& position = object->getPosition();
 
-        // Пропускаем объекты вне видимой области
-        if (objectX < startX - 5 || objectX > endX + 5 ||
-            objectY < startY - 5 || objectY > endY + 5) {
+        // Пропускаем объекты вне видимой области и скрытые туманом войны
+        if (!isInVisibleArea(position.x, position.y) || !isObjectRevealed(object.get())) {
             continue;
         }
 
-        float priority = calculateZOrderPriority(objectX, objectY, objectZ,
-            playerFullX, playerFullY,
-            player->getDirectionX(), player->getDirectionY());
-
-        RenderObject renderObj;
-        renderObj.type = RenderObject::Type::INTERACTIVE;
-        renderObj.x = objectX;
-        renderObj.y = objectY;
-        renderObj.z = objectZ;
-        renderObj.tileX = static_cast<int>(objectX);
-        renderObj.tileY = static_cast<int>(objectY);
-        renderObj.priority = priority;
-        renderObj.interactiveObj = object;
-
-        objectsToRender.push_back(renderObj);
+        addToBucket(object.get(), position.x, position.y, position.z);
     }
 
-    // 6.1. Отрисовка объемных тайлов и персонажа с учетом блочного порядка
-    // Сначала блоки перед блоком игрока
-    for (int y = startY; y < blockRowStart; y++) {
-        for (int x = startX; x <= endX; x++) {
-            const MapTile* tile = m_tileMap->getTile(x, y);
-            if (tile && tile->getType() != TileType::EMPTY && tile->getHeight() > 0.0f) {
-                float priority = calculateZOrderPriority(static_cast<float>(x), static_cast<float>(y),
-                    tile->getHeight(), playerFullX, playerFullY,
-                    player->getDirectionX(), player->getDirectionY());
-
-                RenderObject renderObj;
-                renderObj.type = RenderObject::Type::TILE;
-                renderObj.x = x;
-                renderObj.y = y;
-                renderObj.z = tile->getHeight();
-                renderObj.tileX = x;
-                renderObj.tileY = y;
-                renderObj.priority = priority;
-
-                objectsToRender.push_back(renderObj);
+    // 5. ЭТАП 2: объемные тайлы строятся параллельно полосами соседних диагоналей.
+    // Диагонали уже упорядочены от дальней к ближней, поэтому полосы не сливаются, а склеиваются
+    int bandCount = std::max(1, std::min(diagonalCount / MIN_DIAGONALS_PER_BAND,
+        m_jobSystem->getThreadCount() * BANDS_PER_THREAD));
+    int diagonalsPerBand = (diagonalCount + bandCount - 1) / bandCount;
+    bandCount = (diagonalCount + diagonalsPerBand - 1) / diagonalsPerBand;
+
+    m_sliceTiles.resize(bandCount);
+    m_diagonalEnds.resize(diagonalCount);
+
+    m_jobSystem->parallelFor(bandCount, [&](int band) {
+        int firstIndex = band * diagonalsPerBand;
+        int endIndex = std::min(diagonalCount, firstIndex + diagonalsPerBand);
+        buildDiagonalSlice(firstDiagonal, firstIndex, endIndex, m_sliceTiles[band]);
+        });
+
+    // 6. Склеиваем полосы по порядку: после тайлов каждой диагонали - ее динамические объекты
+    for (int i = 0; i < diagonalCount; ++i) {
+        const std::vector<RenderableTile>& slice = m_sliceTiles[i / diagonalsPerBand];
+        size_t begin = (i % diagonalsPerBand == 0) ? 0 : m_diagonalEnds[i - 1];
+        m_tileRenderer->appendInOrder(slice.data() + begin, m_diagonalEnds[i] - begin);
+
+        // Динамические объекты диагонали: корзины крошечные, хватает сортировки вставками
+        auto& bucket = m_diagonalBuckets[i];
+        for (size_t j = 1; j < bucket.size(); ++j) {
+            DiagonalObject current = bucket[j];
+            size_t k = j;
+            while (k > 0 && (bucket[k - 1].depth > current.depth ||
+                (bucket[k - 1].depth == current.depth && bucket[k - 1].z > current.z))) {
+                bucket[k] = bucket[k - 1];
+                --k;
             }
+            bucket[k] = current;
         }
-    }
 
-    // 6.2. Отрисовка объектов в том же ряду, но перед блоком игрока
-    for (int y = blockRowStart; y < blockRowStart + 2; y++) {
-        for (int x = startX; x < blockColStart; x++) {
-            const MapTile* tile = m_tileMap->getTile(x, y);
-            if (tile && tile->getType() != TileType::EMPTY && tile->getHeight() > 0.0f) {
-                float priority = calculateZOrderPriority(static_cast<float>(x), static_cast<float>(y),
-                    tile->getHeight(), playerFullX, playerFullY,
-                    player->getDirectionX(), player->getDirectionY());
-
-                RenderObject renderObj;
-                renderObj.type = RenderObject::Type::TILE;
-                renderObj.x = x;
-                renderObj.y = y;
-                renderObj.z = tile->getHeight();
-                renderObj.tileX = x;
-                renderObj.tileY = y;
-                renderObj.priority = priority;
-
-                objectsToRender.push_back(renderObj);
+        for (const DiagonalObject& entry : bucket) {
+            if (entry.object) {
+                addInteractiveObject(entry.object, 0.0f);
+            }
+            else {
+                m_tileRenderer->addVolumetricTile(
+                    player->getRenderX(m_interpolationAlpha), player->getRenderY(m_interpolationAlpha), player->getHeight(),
+                    palette.addDynamic(player->getColor())
+                );
             }
         }
     }
 
-    // 6.3. Отрисовка блока игрока (2x2 тайла)
-    for (int y = blockRowStart; y < blockRowStart + 2; y++) {
-        for (int x = blockColStart; x < blockColStart + 2; x++) {
-            // Проверяем, совпадает ли тайл с позицией игрока
-            bool isPlayerTile = false;
-            if (player) {
-                isPlayerTile = (x == static_cast<int>(playerFullX) &&
-                    y == static_cast<int>(playerFullY));
-            }
+    // 7. Список уже упорядочен, сортировка не нужна
+    m_tileRenderer->renderInOrder(renderer, centerX, centerY);
+
+    // 8. Указатель направления и индикаторы прогресса над дверями
+    renderOverlays(renderer, player, entityManager, centerX, centerY);
+}
+
+void RenderingSystem::buildDiagonalSlice(int firstDiagonal, int firstIndex, int endIndex,
+    std::vector<RenderableTile>& tiles) {
+    tiles.clear();
+
+    const TileMap& tileMap = *m_tileMap;
 
-            // Если это тайл с игроком, то рисуем его
-            if (isPlayerTile) {
-                RenderObject renderObj;
-                renderObj.type = RenderObject::Type::PLAYER;
-                renderObj.x = playerFullX;
-                renderObj.y = playerFullY;
-                renderObj.z = player->getHeight();
-                renderObj.tileX = static_cast<int>(playerFullX);
-                renderObj.tileY = static_cast<int>(playerFullY);
-                renderObj.priority = calculateZOrderPriority(playerFullX, playerFullY,
-                    player->getHeight(), playerFullX, playerFullY,
-                    player->getDirectionX(), player->getDirectionY()) + 0.5f;
-
-                objectsToRender.push_back(renderObj);
+    // Тайлы одной диагонали не перекрываются, поэтому порядок внутри нее не важен
+    for (int i = firstIndex; i < endIndex; ++i) {
+        int diagonal = firstDiagonal + i;
+
+        int xFrom, xTo;
+        getDiagonalRange(diagonal, xFrom, xTo);
+
+        for (int x = xFrom; x <= xTo; ++x) {
+            int y = diagonal - x;
+            TileType type = tileMap.getTileType(x, y);
+            float height = tileMap.getTileHeight(x, y);
+            if (type == TileType::EMPTY || height <= 0.0f) {
+                continue;
             }
 
-            // Затем добавляем стены или другие объемные объекты в этом тайле
-            const MapTile* tile = m_tileMap->getTile(x, y);
-            if (tile && tile->getType() != TileType::EMPTY && tile->getHeight() > 0.0f) {
-                float priority = calculateZOrderPriority(static_cast<float>(x), static_cast<float>(y),
-                    tile->getHeight(), playerFullX, playerFullY,
-                    player->getDirectionX(), player->getDirectionY());
-
-                RenderObject renderObj;
-                renderObj.type = RenderObject::Type::TILE;
-                renderObj.x = x;
-                renderObj.y = y;
-                renderObj.z = tile->getHeight();
-                renderObj.tileX = x;
-                renderObj.tileY = y;
-                renderObj.priority = priority;
-
-                objectsToRender.push_back(renderObj);
+            Uint8 faceMask = getTileFaceMask(x, y);
+            FieldOfView::Visibility visibility = getTileVisibility(x, y);
+            if (faceMask == 0 || visibility == FieldOfView::Visibility::HIDDEN) {
+                continue;
             }
+
+            // Цвет определяется типом, поэтому запись палитры постоянная и потокобезопасна
+            Uint16 paletteIndex = getTilePaletteIndex(type, visibility == FieldOfView::Visibility::REMEMBERED);
+
+            tiles.emplace_back(static_cast<float>(x), static_cast<float>(y), height,
+                nullptr, nullptr, nullptr, paletteIndex, 0.0f);
+            tiles.back().faceMask = faceMask;
         }
+
+        m_diagonalEnds[i] = tiles.size();
     }
+}
 
-    // 6.4. Отрисовка объектов в том же ряду, но после блока игрока
-    for (int y = blockRowStart; y < blockRowStart + 2; y++) {
-        for (int x = blockColStart + 2; x <= endX; x++) {
-            const MapTile* tile = m_tileMap->getTile(x, y);
-            if (tile && tile->getType() != TileType::EMPTY && tile->getHeight() > 0.0f) {
-                float priority = calculateZOrderPriority(static_cast<float>(x), static_cast<float>(y),
-                    tile->getHeight(), playerFullX, playerFullY,
-                    player->getDirectionX(), player->getDirectionY());
-
-                RenderObject renderObj;
-                renderObj.type = RenderObject::Type::TILE;
-                renderObj.x = x;
-                renderObj.y = y;
-                renderObj.z = tile->getHeight();
-                renderObj.tileX = x;
-                renderObj.tileY = y;
-                renderObj.priority = priority;
-
-                objectsToRender.push_back(renderObj);
-            }
-        }
+void RenderingSystem::computeVisibleArea(const std::shared_ptr<Player>& player,
+    const std::shared_ptr<EntityManager>& entityManager,
+    int centerX, int centerY, int viewWidth, int viewHeight) {
+    VisibleArea& area = m_visibleArea;
+    area.spans.clear();
+
+    // 1. Самый высокий объект определяет, насколько тайлы ниже экрана могут в него "дорасти"
+    if (m_maxTileHeightDirty) {
+        m_maxTileHeight = m_tileMap->getMaxTileHeight();
+        m_maxTileHeightDirty = false;
     }
 
-    // 6.5. Отрисовка объектов после блока игрока
-    for (int y = blockRowStart + 2; y <= endY; y++) {
-        for (int x = startX; x <= endX; x++) {
-            const MapTile* tile = m_tileMap->getTile(x, y);
-            if (tile && tile->getType() != TileType::EMPTY && tile->getHeight() > 0.0f) {
-                float priority = calculateZOrderPriority(static_cast<float>(x), static_cast<float>(y),
-                    tile->getHeight(), playerFullX, playerFullY,
-                    player->getDirectionX(), player->getDirectionY());
-
-                RenderObject renderObj;
-                renderObj.type = RenderObject::Type::TILE;
-                renderObj.x = x;
-                renderObj.y = y;
-                renderObj.z = tile->getHeight();
-                renderObj.tileX = x;
-                renderObj.tileY = y;
-                renderObj.priority = priority;
-
-                objectsToRender.push_back(renderObj);
-            }
+    float maxHeight = m_maxTileHeight;
+    if (player) {
+        maxHeight = std::max(maxHeight, player->getHeight());
+    }
+    for (const auto& object : entityManager->getInteractiveObjects()) {
+        // Запас на пульсацию терминалов и парение предметов
+        maxHeight = std::max(maxHeight, object->getPosition().z + 0.5f);
+    }
+
+    // 2. Углы экрана в мировых координатах. В осях U = X - Y и V = X + Y
+    // экран - прямоугольник, а видимые тайлы - ромб на карте
+    float topLeftX, topLeftY, bottomRightX, bottomRightY;
+    m_isoRenderer->screenToWorld(-centerX, -centerY, topLeftX, topLeftY);
+    m_isoRenderer->screenToWorld(viewWidth - centerX, viewHeight - centerY, bottomRightX, bottomRightY);
+
+    float minU = topLeftX - topLeftY;
+    float maxU = bottomRightX - bottomRightY;
+    float minV = topLeftX + topLeftY;
+    float maxV = bottomRightX + bottomRightY;
+
+    // 3. Расширяем границы на размер тайла: ромб тайла занимает U в [u-1, u+1], V в [v, v+2].
+    // Высокие тайлы ниже экрана поднимаются на maxHeight * HEIGHT_SCALE пикселей
+    float heightInDiagonals = maxHeight * IsometricRenderer::HEIGHT_SCALE /
+        (m_isoRenderer->getTileHeight() / 2.0f);
+
+    area.minAntiDiagonal = static_cast<int>(std::floor(minU)) - 1;
+    area.maxAntiDiagonal = static_cast<int>(std::ceil(maxU)) + 1;
+    area.minDiagonal = static_cast<int>(std::floor(minV)) - 2;
+    area.maxDiagonal = static_cast<int>(std::ceil(maxV + heightInDiagonals));
+
+    // 4. Построчные отрезки: для строки y допустимы X из пересечения полос U и V с картой
+    int mapWidth = m_tileMap->getWidth();
+    int mapHeight = m_tileMap->getHeight();
+    int firstRow = std::max(0, floorDiv(area.minDiagonal - area.maxAntiDiagonal, 2));
+    int lastRow = std::min(mapHeight - 1, ceilDiv(area.maxDiagonal - area.minAntiDiagonal, 2));
+
+    area.startX = mapWidth;
+    area.endX = -1;
+    area.startY = mapHeight;
+    area.endY = -1;
+
+    for (int y = firstRow; y <= lastRow; ++y) {
+        int spanStart = std::max({ 0, area.minAntiDiagonal + y, area.minDiagonal - y });
+        int spanEnd = std::min({ mapWidth - 1, area.maxAntiDiagonal + y, area.maxDiagonal - y });
+        if (spanStart > spanEnd) {
+            continue;
         }
+
+        area.spans.push_back({ y, spanStart, spanEnd });
+        area.startX = std::min(area.startX, spanStart);
+        area.endX = std::max(area.endX, spanEnd);
+        area.startY = std::min(area.startY, y);
+        area.endY = std::max(area.endY, y);
     }
+}
 
-    // 7. Сортируем все объекты по приоритету
-    std::sort(objectsToRender.begin(), objectsToRender.end(),
-        [](const RenderObject& a, const RenderObject& b) {
-            return a.priority < b.priority;
-        });
+void RenderingSystem::getDiagonalRange(int diagonal, int& xFrom, int& xTo) const {
+    const VisibleArea& area = m_visibleArea;
 
-    // 8. Отрисовываем отсортированные объекты
-    for (const auto& obj : objectsToRender) {
-        switch (obj.type) {
-        case RenderObject::Type::TILE: {
-            const MapTile* tile = m_tileMap->getTile(obj.tileX, obj.tileY);
-            if (tile) {
-                float height = tile->getHeight();
-                SDL_Color color = tile->getColor();
-
-                // Создаем оттенки для граней
-                SDL_Color topColor = color;
-                SDL_Color leftColor = {
-                    static_cast<Uint8>(color.r * 0.7f),
-                    static_cast<Uint8>(color.g * 0.7f),
-                    static_cast<Uint8>(color.b * 0.7f),
-                    color.a
-                };
-                SDL_Color rightColor = {
-                    static_cast<Uint8>(color.r * 0.5f),
-                    static_cast<Uint8>(color.g * 0.5f),
-                    static_cast<Uint8>(color.b * 0.5f),
-                    color.a
-                };
+    // Пересечение диагонали с ограничивающим прямоугольником и с полосой видимости по X-Y
+    xFrom = std::max(area.startX, diagonal - area.endY);
+    xTo = std::min(area.endX, diagonal - area.startY);
+    xFrom = std::max(xFrom, ceilDiv(diagonal + area.minAntiDiagonal, 2));
+    xTo = std::min(xTo, floorDiv(diagonal + area.maxAntiDiagonal, 2));
+}
 
-                m_tileRenderer->addVolumetricTile(
-                    obj.x, obj.y, height,
-                    nullptr, nullptr, nullptr,
-                    topColor, leftColor, rightColor,
-                    obj.priority
-                );
+void RenderingSystem::computeOcclusion(int centerX, int centerY, int viewWidth, int viewHeight) {
+    const VisibleArea& area = m_visibleArea;
+    int areaWidth = area.endX - area.startX + 1;
+    int areaHeight = area.endY - area.startY + 1;
+    if (areaWidth <= 0 || areaHeight <= 0) {
+        m_tileFaceMasks.clear();
+        return;
+    }
+
+    m_tileFaceMasks.assign(static_cast<size_t>(areaWidth) * areaHeight, IsometricRenderer::FACE_ALL);
+    if (!m_occlusionEnabled) {
+        return;
+    }
+
+    m_occlusionBuffer.reset(viewWidth, viewHeight);
+
+    int scaledTileWidth = static_cast<int>(m_isoRenderer->getTileWidth() * m_isoRenderer->getCameraZoom());
+    int scaledTileHeight = static_cast<int>(m_isoRenderer->getTileHeight() * m_isoRenderer->getCameraZoom());
+
+    // Непрозрачный объемный тайл не ниже заданной высоты полностью закрывает грань соседа
+    // (скрытый туманом войны не рисуется и ничего не закрывает)
+    auto isOpaqueBlock = [this](int x, int y, float minHeight) {
+        TileType type = m_tileMap->getTileType(x, y);
+        return type != TileType::EMPTY &&
+            MapTile::getTypeColor(type).a == 255 && m_tileMap->getTileHeight(x, y) >= minHeight &&
+            getTileVisibility(x, y) != FieldOfView::Visibility::HIDDEN;
+    };
+
+    // Обход спереди назад: от ближних диагоналей к дальним
+    int firstDiagonal = std::max(area.minDiagonal, area.startX + area.startY);
+    int lastDiagonal = std::min(area.maxDiagonal, area.endX + area.endY);
+
+    for (int diagonal = lastDiagonal; diagonal >= firstDiagonal; --diagonal) {
+        int xFrom, xTo;
+        getDiagonalRange(diagonal, xFrom, xTo);
+
+        for (int x = xFrom; x <= xTo; ++x) {
+            int y = diagonal - x;
+            TileType type = m_tileMap->getTileType(x, y);
+            float height = m_tileMap->getTileHeight(x, y);
+            if (type == TileType::EMPTY || height <= 0.0f ||
+                getTileVisibility(x, y) == FieldOfView::Visibility::HIDDEN) {
+                continue;
             }
-            break;
-        }
-        case RenderObject::Type::PLAYER: {
-            if (player) {
-                SDL_Color playerColor = player->getColor();
-
-                // Создаем оттенки для граней
-                SDL_Color leftColor = {
-                    static_cast<Uint8>(playerColor.r * 0.7f),
-                    static_cast<Uint8>(playerColor.g * 0.7f),
-                    static_cast<Uint8>(playerColor.b * 0.7f),
-                    playerColor.a
-                };
-                SDL_Color rightColor = {
-                    static_cast<Uint8>(playerColor.r * 0.5f),
-                    static_cast<Uint8>(playerColor.g * 0.5f),
-                    static_cast<Uint8>(playerColor.b * 0.5f),
-                    playerColor.a
-                };
 
-                m_tileRenderer->addVolumetricTile(
-                    playerFullX, playerFullY, player->getHeight(),
-                    nullptr, nullptr, nullptr,
-                    playerColor, leftColor, rightColor,
-                    obj.priority
-                );
+            Uint8& faceMask = m_tileFaceMasks[(y - area.startY) * areaWidth + (x - area.startX)];
 
-                // Отрисовка указателя направления персонажа
-                if (player && player->isShowingDirectionIndicator()) {
-                    player->renderDirectionIndicator(renderer, m_isoRenderer.get(), centerX, centerY);
-                }
+            // 1. Весь блок закрыт тем, что уже лежит ближе к зрителю
+            int baseX, baseY;
+            m_isoRenderer->worldToScreen(static_cast<float>(x), static_cast<float>(y), baseX, baseY);
+            baseX += centerX;
+            baseY += centerY;
+            int heightOffset = m_isoRenderer->getHeightInPixels(height);
+
+            if (m_occlusionBuffer.isRectOccluded(baseX - scaledTileWidth / 2, baseY - heightOffset,
+                baseX + scaledTileWidth / 2, baseY + scaledTileHeight)) {
+                faceMask = 0;
+                continue;
             }
-            break;
-        }
-        case RenderObject::Type::INTERACTIVE: {
-            auto& interactive = obj.interactiveObj;
-            if (interactive) {
-                SDL_Color color = interactive->getColor();
-                float height = obj.z;
-
-                // Обработка двери как визуального объекта
-                if (auto doorObj = std::dynamic_pointer_cast<Door>(interactive)) {
-                    height = doorObj->getHeight();
-                    bool isVertical = doorObj->isVertical();
-                    SDL_Color topColor = color;
-                    SDL_Color leftColor = {
-                        static_cast<Uint8>(color.r * 0.7f),
-                        static_cast<Uint8>(color.g * 0.7f),
-                        static_cast<Uint8>(color.b * 0.7f),
-                        color.a
-                    };
-                    SDL_Color rightColor = {
-                        static_cast<Uint8>(color.r * 0.5f),
-                        static_cast<Uint8>(color.g * 0.5f),
-                        static_cast<Uint8>(color.b * 0.5f),
-                        color.a
-                    };
-
-                    // Расчет размера и положения двери в зависимости от ориентации
-                    float doorWidth = 0.3f;  // Ширина двери (доля от тайла)
-                    float doorLength = 0.8f; // Длина двери (доля от тайла)
-                    float offsetX = 0.0f;
-                    float offsetY = 0.0f;
-
-                    if (isVertical) {
-                        // Вертикальная дверь (проход север-юг)
-                        offsetX = (1.0f - doorWidth) / 2.0f;
-                    }
-                    else {
-                        // Горизонтальная дверь (проход запад-восток)
-                        offsetY = (1.0f - doorWidth) / 2.0f;
-                    }
-
-                    // Увеличиваем ширину для лучшей видимости в зависимости от биома
-                    switch (biomeType) {
-                    case 1: // FOREST - ветви более протяженные
-                        doorWidth = 0.4f;
-                        break;
-                    case 2: // DESERT - песчаные завалы более широкие
-                        doorWidth = 0.5f;
-                        break;
-                    case 3: // TUNDRA - ледяные преграды тонкие
-                        doorWidth = 0.25f;
-                        break;
-                    case 4: // VOLCANIC - каменные завалы широкие
-                        doorWidth = 0.5f;
-                        break;
-                    }
-
-                    if (isVertical) {
-                        // Рендерим вертикальную дверь
-                        m_tileRenderer->addVolumetricTile(
-                            obj.x + offsetX,
-                            obj.y + (1.0f - doorLength) / 2.0f,
-                            height,
-                            nullptr, nullptr, nullptr,
-                            topColor, leftColor, rightColor,
-                            obj.priority
-                        );
-                    }
-                    else {
-                        // Рендерим горизонтальную дверь
-                        m_tileRenderer->addVolumetricTile(
-                            obj.x + (1.0f - doorLength) / 2.0f,
-                            obj.y + offsetY,
-                            height,
-                            nullptr, nullptr, nullptr,
-                            topColor, leftColor, rightColor,
-                            obj.priority
-                        );
-                    }
-                }
-                else if (auto terminalObj = std::dynamic_pointer_cast<Terminal>(interactive)) {
-                    // Специальная визуализация для терминалов
-                    height = obj.z;
-                    SDL_Color color = terminalObj->getColor();
-                    SDL_Color screenColor;
-
-                    if (terminalObj->shouldShowIndicator()) {
-                        // Для непрочитанных терминалов делаем намного ярче с пульсацией
-                        screenColor = {
-                            static_cast<Uint8>(std::min(255, color.r + 100)),
-                            static_cast<Uint8>(std::min(255, color.g + 100)),
-                            static_cast<Uint8>(std::min(255, color.b + 100)),
-                            255
-                        };
-                    }
-                    else {
-                        // Для уже прочитанных - стандартная яркость
-                        screenColor = {
-                            static_cast<Uint8>(std::min(255, color.r + 50)),
-                            static_cast<Uint8>(std::min(255, color.g + 50)),
-                            static_cast<Uint8>(std::min(255, color.b + 50)),
-                            color.a
-                        };
-                    }
-
-                    // Боковые части (корпус) темнее
-                    SDL_Color leftColor = {
-                        static_cast<Uint8>(color.r * 0.6f),
-                        static_cast<Uint8>(color.g * 0.6f),
-                        static_cast<Uint8>(color.b * 0.6f),
-                        color.a
-                    };
-
-                    SDL_Color rightColor = {
-                        static_cast<Uint8>(color.r * 0.4f),
-                        static_cast<Uint8>(color.g * 0.4f),
-                        static_cast<Uint8>(color.b * 0.4f),
-                        color.a
-                    };
-
-                    // Добавляем плавающий эффект и пульсацию для терминалов
-                    float pulseEffect;
-                    if (terminalObj->shouldShowIndicator()) {
-                        // Более заметная пульсация для непрочитанных терминалов
-                        pulseEffect = 0.3f * sinf(SDL_GetTicks() / 150.0f);
-                    }
-                    else {
-                        // Обычная пульсация для прочитанных терминалов
-                        pulseEffect = 0.1f * sinf(SDL_GetTicks() / 200.0f);
-                    }
-
-                    // Основная база терминала (нижняя часть)
-                    m_tileRenderer->addVolumetricTile(
-                        obj.x, obj.y, height * 0.6f,
-                        nullptr, nullptr, nullptr,
-                        color, leftColor, rightColor,
-                        obj.priority
-                    );
-
-                    // Экран терминала (верхняя часть)
-                    m_tileRenderer->addVolumetricTile(
-                        obj.x, obj.y, height + pulseEffect,
-                        nullptr, nullptr, nullptr,
-                        screenColor, screenColor, screenColor,
-                        obj.priority + 0.1f
-                    );
-                }
-                else if (auto pickupItem = std::dynamic_pointer_cast<PickupItem>(interactive)) {
-                    // Эффект парения для предметов
-                    height += 0.15f * sinf(SDL_GetTicks() / 500.0f);
-
-                    // Стандартные цвета для других интерактивных объектов
-                    SDL_Color leftColor = {
-                        static_cast<Uint8>(color.r * 0.7f),
-                        static_cast<Uint8>(color.g * 0.7f),
-                        static_cast<Uint8>(color.b * 0.7f),
-                        color.a
-                    };
-
-                    SDL_Color rightColor = {
-                        static_cast<Uint8>(color.r * 0.5f),
-                        static_cast<Uint8>(color.g * 0.5f),
-                        static_cast<Uint8>(color.b * 0.5f),
-                        color.a
-                    };
-
-                    m_tileRenderer->addVolumetricTile(
-                        obj.x, obj.y, height,
-                        nullptr, nullptr, nullptr,
-                        color, leftColor, rightColor,
-                        obj.priority
-                    );
-                }
-                else {
-                    // Стандартные цвета для других интерактивных объектов
-                    SDL_Color leftColor = {
-                        static_cast<Uint8>(color.r * 0.7f),
-                        static_cast<Uint8>(color.g * 0.7f),
-                        static_cast<Uint8>(color.b * 0.7f),
-                        color.a
-                    };
-
-                    SDL_Color rightColor = {
-                        static_cast<Uint8>(color.r * 0.5f),
-                        static_cast<Uint8>(color.g * 0.5f),
-                        static_cast<Uint8>(color.b * 0.5f),
-                        color.a
-                    };
-
-                    m_tileRenderer->addVolumetricTile(
-                        obj.x, obj.y, height,
-                        nullptr, nullptr, nullptr,
-                        color, leftColor, rightColor,
-                        obj.priority
-                    );
-                }
+
+            // 2. Боковые грани, к которым вплотную примыкает блок не ниже этого
+            if (isOpaqueBlock(x, y + 1, height)) {
+                faceMask &= ~IsometricRenderer::FACE_LEFT;
+            }
+            if (isOpaqueBlock(x + 1, y, height)) {
+                faceMask &= ~IsometricRenderer::FACE_RIGHT;
+            }
+
+            // 3. Непрозрачный блок сам закрывает то, что лежит за ним
+            if (MapTile::getTypeColor(type).a == 255) {
+                m_occlusionBuffer.addBlock(baseX, baseY, scaledTileWidth, scaledTileHeight, heightOffset);
             }
-            break;
-        }
         }
     }
+}
+
+Uint8 RenderingSystem::getTileFaceMask(int x, int y) const {
+    const VisibleArea& area = m_visibleArea;
+    if (x < area.startX || x > area.endX || y < area.startY || y > area.endY || m_tileFaceMasks.empty()) {
+        return IsometricRenderer::FACE_ALL;
+    }
+
+    return m_tileFaceMasks[(y - area.startY) * (area.endX - area.startX + 1) + (x - area.startX)];
+}
+
+FieldOfView::Visibility RenderingSystem::getObjectVisibility(const InteractiveObject* object) const {
+    const auto& position = object->getPosition();
+    return getTileVisibility(static_cast<int>(std::floor(position.x)), static_cast<int>(std::floor(position.y)));
+}
+
+bool RenderingSystem::isObjectRevealed(InteractiveObject* object) const {
+    FieldOfView::Visibility visibility = getObjectVisibility(object);
+    if (visibility == FieldOfView::Visibility::VISIBLE) {
+        return true;
+    }
+
+    return visibility == FieldOfView::Visibility::REMEMBERED && dynamic_cast<Door*>(object) != nullptr;
+}
+
+Uint16 RenderingSystem::getTilePaletteIndex(TileType type, bool remembered) {
+    Uint16 index = TilePalette::getTypeIndex(type);
+    return remembered ? TilePalette::getRememberedIndex(index) : index;
+}
+
+bool RenderingSystem::isInVisibleArea(float x, float y) const {
+    // Объекты могут выходить за свой тайл, поэтому оставляем запас в один тайл
+    float u = x - y;
+    float v = x + y;
+    return u >= m_visibleArea.minAntiDiagonal - 1 && u <= m_visibleArea.maxAntiDiagonal + 1 &&
+        v >= m_visibleArea.minDiagonal - 1 && v <= m_visibleArea.maxDiagonal + 1;
+}
 
-    // 9. Рендерим все тайлы в правильном порядке
-    m_tileRenderer->render(renderer, centerX, centerY);
+int RenderingSystem::floorDiv(int value, int divisor) {
+    int quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+int RenderingSystem::ceilDiv(int value, int divisor) {
+    int quotient = value / divisor;
+    return (value % divisor != 0 && value > 0) ? quotient + 1 : quotient;
+}
 
+void RenderingSystem::renderOverlays(SDL_Renderer* renderer,
+    const std::shared_ptr<Player>& player,
+    const std::shared_ptr<EntityManager>& entityManager,
+    int centerX, int centerY) {
     if (player) {
-        player->renderDirectionIndicator(renderer, m_isoRenderer.get(), centerX, centerY);
+        player->renderDirectionIndicator(renderer, m_isoRenderer.get(), centerX, centerY, m_interpolationAlpha);
     }
 
-    // 10. Отрисовываем индикаторы прогресса над дверями
-    for (auto& obj : entityManager->getInteractiveObjects()) {
-        if (auto doorObj = std::dynamic_pointer_cast<Door>(obj)) {
+    for (const auto& obj : entityManager->getInteractiveObjects()) {
+        if (auto doorObj = dynamic_cast<Door*>(obj.get())) {
             // Отрисовка прогресс-бара над дверью
             doorObj->render(renderer, m_isoRenderer.get(), centerX, centerY);
         }
     }
 }
 
+void RenderingSystem::addInteractiveObject(InteractiveObject* object, float priority) {
+    const auto& position = object->getPosition();
+    SDL_Color color = object->getColor();
+    TilePalette& palette = m_tileRenderer->getPalette();
+
+    // 1. Двери: тонкий блок, ориентированный поперек прохода
+    if (auto doorObj = dynamic_cast<Door*>(object)) {
+        float height = doorObj->getHeight();
+
+        // Расчет положения двери в зависимости от ориентации (доли от тайла)
+        float doorWidth = 0.3f;
+        float doorLength = 0.8f;
+        float offset = (1.0f - doorWidth) / 2.0f;
+        float lengthOffset = (1.0f - doorLength) / 2.0f;
+        float drawX = doorObj->isVertical() ? position.x + offset : position.x + lengthOffset;
+        float drawY = doorObj->isVertical() ? position.y + lengthOffset : position.y + offset;
+
+        // Дверь на исследованном, но невидимом тайле затемнена, как и сам тайл
+        if (getObjectVisibility(object) == FieldOfView::Visibility::REMEMBERED) {
+            color = TilePalette::shade(color, TilePalette::REMEMBERED_SHADE);
+        }
+
+        m_tileRenderer->addVolumetricTile(drawX, drawY, height, palette.addDynamic(color), priority);
+        return;
+    }
+
+    // 2. Терминалы: корпус и пульсирующий экран над ним
+    if (auto terminalObj = dynamic_cast<Terminal*>(object)) {
+        bool unread = terminalObj->shouldShowIndicator();
+        color = terminalObj->getColor();
+
+        // Непрочитанные терминалы намного ярче, прочитанные - стандартной яркости
+        int boost = unread ? 100 : 50;
+        SDL_Color screenColor = {
+            static_cast<Uint8>(std::min(255, color.r + boost)),
+            static_cast<Uint8>(std::min(255, color.g + boost)),
+            static_cast<Uint8>(std::min(255, color.b + boost)),
+            unread ? static_cast<Uint8>(255) : color.a
+        };
+
+        // Более заметная пульсация для непрочитанных терминалов
+        float pulseEffect = unread ?
+            0.3f * sinf(SDL_GetTicks() / 150.0f) :
+            0.1f * sinf(SDL_GetTicks() / 200.0f);
+
+        // Основная база терминала (нижняя часть), корпус темнее
+        m_tileRenderer->addVolumetricTile(
+            position.x, position.y, position.z * 0.6f,
+            palette.addDynamic(color, 0.6f, 0.4f), priority
+        );
+
+        // Экран терминала (верхняя часть)
+        m_tileRenderer->addVolumetricTile(
+            position.x, position.y, position.z + pulseEffect,
+            palette.addDynamic(screenColor, screenColor, screenColor), priority + 0.1f
+        );
+        return;
+    }
+
+    // 3. Предметы парят над полом, остальные объекты рисуются как есть
+    float height = position.z;
+    if (dynamic_cast<PickupItem*>(object)) {
+        height += 0.15f * sinf(SDL_GetTicks() / 500.0f);
+    }
+
+    m_tileRenderer->addVolumetricTile(position.x, position.y, height, palette.addDynamic(color), priority);
+}
+
 void RenderingSystem::renderPlayerIndicator(SDL_Renderer* renderer,
     std::shared_ptr<Player> player,
     int centerX, int centerY) {
     if (!player) return;
 
     // Получаем координаты персонажа в мировом пространстве
-    float playerFullX = player->getFullX();
-    float playerFullY = player->getFullY();
+    float playerFullX = player->getRenderX(m_interpolationAlpha);
+    float playerFullY = player->getRenderY(m_interpolationAlpha);
     float playerHeight = player->getHeight();
 
     // Преобразуем мировые координаты в экранные
@@ -632,30 +718,11 @@ void RenderingSystem::renderPlayer(SDL_Renderer* renderer,
     if (!player) return;
 
     // Полные координаты игрока
-    float playerFullX = player->getFullX();
-    float playerFullY = player->getFullY();
+    float playerFullX = player->getRenderX(m_interpolationAlpha);
+    float playerFullY = player->getRenderY(m_interpolationAlpha);
     float playerHeight = player->getHeight();
 
-    // Получаем цвета для игрока
-    SDL_Color playerColor = player->getColor();
-    SDL_Color playerLeftColor = {
-        static_cast<Uint8>(playerColor.r * 0.7f),
-        static_cast<Uint8>(playerColor.g * 0.7f),
-        static_cast<Uint8>(playerColor.b * 0.7f),
-        playerColor.a
-    };
-    SDL_Color playerRightColor = {
-        static_cast<Uint8>(playerColor.r * 0.5f),
-        static_cast<Uint8>(playerColor.g * 0.5f),
-        static_cast<Uint8>(playerColor.b * 0.5f),
-        playerColor.a
-    };
-
-    // Добавляем персонажа в рендерер
-    m_tileRenderer->addVolumetricTile(
-        playerFullX, playerFullY, playerHeight,
-        nullptr, nullptr, nullptr,
-        playerColor, playerLeftColor, playerRightColor,
-        priority
-    );
+    // Добавляем персонажа в рендерер (цвета граней - из динамической записи палитры)
+    Uint16 paletteIndex = m_tileRenderer->getPalette().addDynamic(player->getColor());
+    m_tileRenderer->addVolumetricTile(playerFullX, playerFullY, playerHeight, paletteIndex, priority);
 }
\ No newline at end of file
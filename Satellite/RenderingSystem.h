@@ -6,6 +6,10 @@
 #include "Player.h"
 #include "EntityManager.h"
 #include "Camera.h"
+#include "FloorChunkCache.h"
+#include "FieldOfView.h"
+#include "OcclusionBuffer.h"
+#include "JobSystem.h"
 #include <SDL.h>
 #include <memory>
 #include <vector>
@@ -18,6 +22,18 @@
  */
 class RenderingSystem {
 public:
+    static constexpr int MIN_ROWS_PER_BAND = 8;  ///< Минимум строк видимой области в полосе списка отрисовки
+    static constexpr int BANDS_PER_THREAD = 4;   ///< Полос на поток (для выравнивания нагрузки)
+    static constexpr int MIN_DIAGONALS_PER_BAND = 8; ///< Минимум диагоналей в полосе списка отрисовки
+
+    /**
+     * @brief Способ упорядочивания объектов при отрисовке
+     */
+    enum class RenderOrderMode {
+        SORTED,           ///< Приоритеты по calculateZOrderPriority и сортировка в TileRenderer
+        DIAGONAL_BUCKETS  ///< Обход диагоналей X+Y, динамические объекты в корзинах диагоналей
+    };
+
     /**
      * @brief Конструктор
      * @param tileMap Указатель на карту тайлов
@@ -28,6 +44,14 @@ public:
         std::shared_ptr<TileRenderer> tileRenderer,
         std::shared_ptr<IsometricRenderer> isoRenderer);
 
+    /**
+     * @brief Деструктор (отписывается от изменений карты)
+     */
+    ~RenderingSystem();
+
+    RenderingSystem(const RenderingSystem&) = delete;
+    RenderingSystem& operator=(const RenderingSystem&) = delete;
+
     /**
      * @brief Отрисовка игрового мира и всех сущностей
      * @param renderer SDL рендерер
@@ -53,7 +77,104 @@ public:
         std::shared_ptr<Player> player,
         int centerX, int centerY);
 
+    /**
+     * @brief Сброс кэшированных текстур (например, после потери текстур-целей)
+     */
+    void invalidateCaches();
+
+    /**
+     * @brief Выбор способа упорядочивания объектов
+     * @param mode Способ упорядочивания
+     */
+    void setRenderOrderMode(RenderOrderMode mode) { m_renderOrderMode = mode; }
+
+    /**
+     * @brief Получение текущего способа упорядочивания объектов
+     * @return Способ упорядочивания
+     */
+    RenderOrderMode getRenderOrderMode() const { return m_renderOrderMode; }
+
+    /**
+     * @brief Включение или отключение отсечения закрытых тайлов и граней
+     * @param enabled true - отсечение включено
+     */
+    void setOcclusionEnabled(bool enabled) { m_occlusionEnabled = enabled; }
+
+    /**
+     * @brief Проверка, включено ли отсечение закрытых тайлов и граней
+     * @return true, если отсечение включено
+     */
+    bool isOcclusionEnabled() const { return m_occlusionEnabled; }
+
+    /**
+     * @brief Установка коэффициента интерполяции положения игрока и камеры
+     * @param alpha Доля шага симуляции, прошедшая после последнего update()
+     */
+    void setInterpolationAlpha(float alpha) { m_interpolationAlpha = alpha; }
+
+    /**
+     * @brief Установка масштаба разрешения мира
+     *
+     * Мир рисуется в цель уменьшенного размера, поэтому масштаб камеры
+     * домножается на него: в цель попадает та же область мира, что и в окно.
+     *
+     * @param scale Масштаб разрешения (1.0 - родное разрешение)
+     */
+    void setResolutionScale(float scale) { m_resolutionScale = scale; }
+
+    /**
+     * @brief Установка поля зрения для тумана войны
+     *
+     * Ни разу не виденные тайлы не рисуются, исследованные, но невидимые
+     * сейчас - рисуются затемненными. Без поля зрения видна вся карта.
+     *
+     * @param fieldOfView Поле зрения игрока (может быть nullptr)
+     */
+    void setFieldOfView(std::shared_ptr<FieldOfView> fieldOfView);
+
+    /**
+     * @brief Получение поля зрения
+     * @return Поле зрения или nullptr, если туман войны отключен
+     */
+    std::shared_ptr<FieldOfView> getFieldOfView() const { return m_fieldOfView; }
+
 private:
+    /**
+     * @brief Отрезок видимых тайлов в одной строке карты
+     */
+    struct TileSpan {
+        int y;       ///< Строка карты
+        int startX;  ///< Первый видимый X (включительно)
+        int endX;    ///< Последний видимый X (включительно)
+    };
+
+    /**
+     * @brief Видимая область карты для текущего кадра
+     *
+     * Экран в осях U = X - Y и V = X + Y - прямоугольник, поэтому видимые тайлы
+     * образуют на карте ромб, который хранится построчными отрезками.
+     */
+    struct VisibleArea {
+        std::vector<TileSpan> spans;  ///< Отрезки по строкам (только непустые)
+        int startX = 0;               ///< Ограничивающий прямоугольник отрезков
+        int startY = 0;
+        int endX = -1;
+        int endY = -1;
+        int minAntiDiagonal = 0;      ///< Границы полосы видимости по X - Y
+        int maxAntiDiagonal = -1;
+        int minDiagonal = 0;          ///< Границы полосы видимости по X + Y
+        int maxDiagonal = -1;
+    };
+
+    /**
+     * @brief Динамический объект в корзине диагонали
+     */
+    struct DiagonalObject {
+        InteractiveObject* object;  ///< Интерактивный объект (nullptr - игрок)
+        float depth;                ///< X + Y позиции объекта
+        float z;                    ///< Высота объекта
+    };
+
     /**
      * @brief Расчет приоритета визуального порядка для изометрической проекции
      * @param x Координата X объекта в мировом пространстве
@@ -67,7 +188,7 @@ private:
      */
     float calculateZOrderPriority(float x, float y, float z,
         float playerFullX, float playerFullY,
-        float playerDirectionX, float playerDirectionY);
+        float playerDirectionX, float playerDirectionY) const;
 
     /**
      * @brief Отрисовка сцены с использованием блочной Z-сортировки
@@ -76,13 +197,186 @@ private:
      * @param entityManager Указатель на менеджер сущностей
      * @param centerX X координата центра экрана
      * @param centerY Y координата центра экрана
-     * @param biomeType Текущий тип биома
      */
     void renderWithBlockSorting(SDL_Renderer* renderer,
         std::shared_ptr<Player> player,
         std::shared_ptr<EntityManager> entityManager,
-        int centerX, int centerY,
-        int biomeType);
+        int centerX, int centerY);
+
+    /**
+     * @brief Отрисовка сцены обходом диагоналей без сортировки статических тайлов
+     * @param renderer SDL рендерер
+     * @param player Указатель на игрока
+     * @param entityManager Указатель на менеджер сущностей
+     * @param centerX X координата центра экрана
+     * @param centerY Y координата центра экрана
+     */
+    void renderWithDiagonalBuckets(SDL_Renderer* renderer,
+        std::shared_ptr<Player> player,
+        std::shared_ptr<EntityManager> entityManager,
+        int centerX, int centerY);
+
+    /**
+     * @brief Вычисление видимой области карты по углам экрана
+     *
+     * Учитывает положение и масштаб камеры, размер окна и высоту самых высоких
+     * тайлов и объектов, которые могут попасть в кадр снизу.
+     *
+     * @param player Указатель на игрока
+     * @param entityManager Указатель на менеджер сущностей
+     * @param centerX X координата центра экрана
+     * @param centerY Y координата центра экрана
+     * @param viewWidth Ширина области вывода
+     * @param viewHeight Высота области вывода
+     */
+    void computeVisibleArea(const std::shared_ptr<Player>& player,
+        const std::shared_ptr<EntityManager>& entityManager,
+        int centerX, int centerY, int viewWidth, int viewHeight);
+
+    /**
+     * @brief Диапазон X видимых тайлов на диагонали X + Y = diagonal
+     * @param diagonal Номер диагонали
+     * @param xFrom Первый X (выходной параметр)
+     * @param xTo Последний X, включительно (выходной параметр)
+     */
+    void getDiagonalRange(int diagonal, int& xFrom, int& xTo) const;
+
+    /**
+     * @brief Отсечение закрытых тайлов и граней для текущей видимой области
+     *
+     * Объемные тайлы обходятся спереди назад. Тайл, чей прямоугольник на экране
+     * уже закрыт более близкими непрозрачными блоками, помечается скрытым.
+     * Левая и правая грани скрываются, если вплотную к ним стоит непрозрачный
+     * блок не ниже текущего.
+     *
+     * @param centerX X координата центра экрана
+     * @param centerY Y координата центра экрана
+     * @param viewWidth Ширина области вывода
+     * @param viewHeight Высота области вывода
+     */
+    void computeOcclusion(int centerX, int centerY, int viewWidth, int viewHeight);
+
+    /**
+     * @brief Маска видимых граней тайла по результатам отсечения
+     * @param x X координата тайла
+     * @param y Y координата тайла
+     * @return Маска граней (0 - тайл полностью закрыт)
+     */
+    Uint8 getTileFaceMask(int x, int y) const;
+
+    /**
+     * @brief Построение списка отрисовки объемных тайлов для полосы строк
+     *
+     * Вызывается параллельно из JobSystem: читает только карту, маски граней
+     * и поле зрения. Цвет тайла определяется типом, поэтому индексы записей
+     * палитры постоянны и динамические записи не нужны. Список сортируется
+     * по ключу с сохранением порядка добавления.
+     *
+     * @param firstSpan Первая строка видимой области (индекс в spans)
+     * @param endSpan Строка после последней
+     * @param tiles Список отрисовки полосы (выходной параметр)
+     * @param playerFullX X координата игрока
+     * @param playerFullY Y координата игрока
+     * @param directionX Направление игрока по X
+     * @param directionY Направление игрока по Y
+     */
+    void buildDrawSlice(int firstSpan, int endSpan, std::vector<RenderableTile>& tiles,
+        float playerFullX, float playerFullY, float directionX, float directionY) const;
+
+    /**
+     * @brief Построение списка объемных тайлов полосы диагоналей (вызывается из задач JobSystem)
+     *
+     * Диагонали обходятся от дальней к ближней, поэтому список уже упорядочен
+     * и ключи сортировки не нужны. Конец тайлов каждой диагонали записывается
+     * в m_diagonalEnds, чтобы динамические объекты вставлялись между диагоналями.
+     * Полосы пишут в непересекающиеся элементы m_diagonalEnds.
+     *
+     * @param firstDiagonal Диагональ с индексом 0 (X+Y)
+     * @param firstIndex Индекс первой диагонали полосы
+     * @param endIndex Индекс диагонали после последней
+     * @param tiles Список отрисовки полосы (выходной параметр)
+     */
+    void buildDiagonalSlice(int firstDiagonal, int firstIndex, int endIndex, std::vector<RenderableTile>& tiles);
+
+    /**
+     * @brief Проверка попадания позиции объекта в видимую область
+     * @param x X координата в мировом пространстве
+     * @param y Y координата в мировом пространстве
+     * @return true, если объект может быть виден
+     */
+    bool isInVisibleArea(float x, float y) const;
+
+    /**
+     * @brief Состояние тайла в тумане войны
+     * @param x X координата тайла
+     * @param y Y координата тайла
+     * @return Состояние тайла (без поля зрения - VISIBLE)
+     */
+    FieldOfView::Visibility getTileVisibility(int x, int y) const {
+        return m_fieldOfView ? m_fieldOfView->getVisibility(x, y) : FieldOfView::Visibility::VISIBLE;
+    }
+
+    /**
+     * @brief Состояние тайла, на котором стоит объект
+     * @param object Интерактивный объект
+     * @return Состояние тайла объекта
+     */
+    FieldOfView::Visibility getObjectVisibility(const InteractiveObject* object) const;
+
+    /**
+     * @brief Проверка, нужно ли рисовать объект с учетом тумана войны
+     *
+     * Объекты рисуются только в поле зрения; двери - часть планировки
+     * и остаются на исследованных тайлах.
+     *
+     * @param object Интерактивный объект
+     * @return true, если объект нужно рисовать
+     */
+    bool isObjectRevealed(InteractiveObject* object) const;
+
+    /**
+     * @brief Индекс записи палитры для объемного тайла карты
+     * @param type Тип тайла
+     * @param remembered Тайл исследован, но сейчас не виден
+     * @return Индекс постоянной записи типа (затемненной для исследованного тайла)
+     */
+    static Uint16 getTilePaletteIndex(TileType type, bool remembered);
+
+    /**
+     * @brief Целочисленное деление с округлением вниз
+     * @param value Делимое
+     * @param divisor Положительный делитель
+     * @return Частное, округленное к минус бесконечности
+     */
+    static int floorDiv(int value, int divisor);
+
+    /**
+     * @brief Целочисленное деление с округлением вверх
+     * @param value Делимое
+     * @param divisor Положительный делитель
+     * @return Частное, округленное к плюс бесконечности
+     */
+    static int ceilDiv(int value, int divisor);
+
+    /**
+     * @brief Отрисовка элементов поверх мира (указатель направления, прогресс дверей)
+     * @param renderer SDL рендерер
+     * @param player Указатель на игрока
+     * @param entityManager Указатель на менеджер сущностей
+     * @param centerX X координата центра экрана
+     * @param centerY Y координата центра экрана
+     */
+    void renderOverlays(SDL_Renderer* renderer,
+        const std::shared_ptr<Player>& player,
+        const std::shared_ptr<EntityManager>& entityManager,
+        int centerX, int centerY);
+
+    /**
+     * @brief Добавление интерактивного объекта в список отрисовки
+     * @param object Интерактивный объект (дверь, терминал, предмет и т.д.)
+     * @param priority Приоритет отрисовки
+     */
+    void addInteractiveObject(InteractiveObject* object, float priority);
 
     /**
      * @brief Отрисовка персонажа с гарантией видимости
@@ -120,4 +414,20 @@ private:
     std::shared_ptr<TileMap> m_tileMap;                ///< Указатель на карту тайлов
     std::shared_ptr<TileRenderer> m_tileRenderer;      ///< Указатель на рендерер тайлов
     std::shared_ptr<IsometricRenderer> m_isoRenderer;  ///< Указатель на изометрический рендерер
+    std::shared_ptr<FloorChunkCache> m_floorCache;     ///< Кэш запеченного слоя пола
+    std::shared_ptr<FieldOfView> m_fieldOfView;        ///< Поле зрения для тумана войны (может быть nullptr)
+    std::shared_ptr<JobSystem> m_jobSystem;            ///< Пул потоков для построения списка отрисовки
+    std::vector<std::vector<RenderableTile>> m_sliceTiles; ///< Списки отрисовки полос (строк или диагоналей)
+    std::vector<size_t> m_diagonalEnds;                ///< Конец тайлов каждой диагонали в списке ее полосы
+    RenderOrderMode m_renderOrderMode = RenderOrderMode::DIAGONAL_BUCKETS; ///< Способ упорядочивания
+    std::vector<std::vector<DiagonalObject>> m_diagonalBuckets; ///< Корзины динамических объектов по диагоналям
+    VisibleArea m_visibleArea;                         ///< Видимая область текущего кадра
+    OcclusionBuffer m_occlusionBuffer;                 ///< Экранный буфер перекрытия
+    std::vector<Uint8> m_tileFaceMasks;                ///< Маски граней тайлов видимой области (0 - скрыт)
+    bool m_occlusionEnabled = true;                    ///< Отсечение закрытых тайлов включено
+    float m_interpolationAlpha = 1.0f;                 ///< Коэффициент интерполяции для отрисовки
+    float m_resolutionScale = 1.0f;                    ///< Масштаб разрешения мира
+    int m_mapListenerId = 0;                           ///< Подписка на изменения карты
+    float m_maxTileHeight = 0.0f;                      ///< Максимальная высота тайла на карте
+    bool m_maxTileHeightDirty = true;                  ///< Требуется пересчет максимальной высоты
 };
\ No newline at end of file
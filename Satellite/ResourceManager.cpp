@@ -43,8 +43,8 @@ bool ResourceManager::loadTexture(const std::string& id, const std::string& file
         }
     }
 
-    // 5. Создание текстуры из поверхности с проверкой результата
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(m_renderer, surface);
+    // 5. Размещение изображения в атласе (отдельная текстура не создается)
+    TextureAtlas::Region region = m_atlas.addSurface(m_renderer, surface);
 
     // 6. Вывод диагностической информации
     std::cout << "INFO: Surface dimensions: " << surface->w << "x" << surface->h
@@ -54,29 +54,26 @@ bool ResourceManager::loadTexture(const std::string& id, const std::string& file
 
     SDL_FreeSurface(surface);  // Освобождаем поверхность, она больше не нужна
 
-    if (!texture) {
-        std::cerr << "ERROR: Failed to create texture from '" << filePath << "'. SDL Error: " << SDL_GetError() << std::endl;
+    if (!region.isValid()) {
+        std::cerr << "ERROR: Failed to place texture '" << filePath << "' into the atlas. SDL Error: " << SDL_GetError() << std::endl;
         return false;
     }
 
-    // 7. Настройка корректного режима смешивания для текстуры
-    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-
-    // 8. Сохранение текстуры в хранилище
-    m_textures[id] = texture;
+    // 7. Сохранение области в хранилище (страницы атласа смешиваются в режиме BLEND)
+    m_textures[id] = region;
 
     std::cout << "SUCCESS: Texture '" << id << "' loaded successfully from '" << filePath << "'" << std::endl;
     return true;
 }
 
-SDL_Texture* ResourceManager::getTexture(const std::string& id) const {
+TextureAtlas::Region ResourceManager::getAtlasRegion(const std::string& id) const {
     auto it = m_textures.find(id);
     if (it != m_textures.end()) {
         return it->second;
     }
 
     std::cerr << "Texture with id '" << id << "' not found!" << std::endl;
-    return nullptr;
+    return TextureAtlas::Region();
 }
 
 bool ResourceManager::hasTexture(const std::string& id) const {
@@ -86,20 +83,19 @@ bool ResourceManager::hasTexture(const std::string& id) const {
 void ResourceManager::removeTexture(const std::string& id) {
     auto it = m_textures.find(id);
     if (it != m_textures.end()) {
-        SDL_DestroyTexture(it->second);
+        // Место в атласе не освобождается до clearAll (упаковка не поддерживает удаление)
         m_textures.erase(it);
         std::cout << "Texture '" << id << "' removed." << std::endl;
     }
 }
 
 void ResourceManager::clearAll() {
-    // Уничтожаем все текстуры
-    for (auto& pair : m_textures) {
-        SDL_DestroyTexture(pair.second);
-    }
+    // Уничтожаем страницы атласа вместе со всеми текстурами
     m_textures.clear();
+    m_atlas.releaseTextures();
 
-    // Уничтожаем все шрифты
+    // Уничтожаем все шрифты вместе с их глифами
+    m_glyphAtlas.clear();
     for (auto& pair : m_fonts) {
         TTF_CloseFont(pair.second);
     }
@@ -109,25 +105,42 @@ void ResourceManager::clearAll() {
 }
 
 bool ResourceManager::getTextureSize(const std::string& id, int& width, int& height) const {
-    SDL_Texture* texture = getTexture(id);
-    if (!texture) {
+    TextureAtlas::Region region = getAtlasRegion(id);
+    if (!region.isValid()) {
         return false;
     }
 
-    // Получаем размеры текстуры
-    SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+    // Размеры текстуры совпадают с размерами ее области
+    width = region.rect.w;
+    height = region.rect.h;
+    return true;
+}
+
+bool ResourceManager::moveIntoAtlas(const std::string& id, SDL_Texture* texture) {
+    TextureAtlas::Region region = m_atlas.addTexture(m_renderer, texture);
+    SDL_DestroyTexture(texture);
+
+    if (!region.isValid()) {
+        std::cerr << "Failed to place texture '" << id << "' into the atlas" << std::endl;
+        m_textures.erase(id);
+        return false;
+    }
+
+    m_textures[id] = region;
     return true;
 }
 
 bool ResourceManager::createIsometricTexture(const std::string& id, const std::string& newId, int tileWidth, int tileHeight) {
-    // 1. Получаем исходную текстуру
-    SDL_Texture* sourceTexture = getTexture(id);
+    // 1. Получаем область исходной текстуры в атласе
+    TextureAtlas::Region source = getAtlasRegion(id);
+    SDL_Texture* sourceTexture = getAtlasPage(source.page);
     if (!sourceTexture) {
         std::cerr << "Source texture '" << id << "' not found!" << std::endl;
         return false;
     }
 
-    // 2. Создаем новую текстуру для изометрического тайла
+    // 2. Создаем временную текстуру для изометрического тайла
+    //    (рисовать прямо в атлас нельзя: источник может лежать на той же странице)
     SDL_Texture* resultTexture = SDL_CreateTexture(
         m_renderer,
         SDL_PIXELFORMAT_RGBA8888,
@@ -150,8 +163,8 @@ bool ResourceManager::createIsometricTexture(const std::string& id, const std::s
     SDL_RenderClear(m_renderer);
 
     // 5. Получаем размеры исходной текстуры
-    int sourceWidth, sourceHeight;
-    SDL_QueryTexture(sourceTexture, nullptr, nullptr, &sourceWidth, &sourceHeight);
+    int sourceWidth = source.rect.w;
+    int sourceHeight = source.rect.h;
 
     // 6. Размещаем текстуру внутри ромба
     // Вычисляем размер для сохранения пропорций
@@ -182,7 +195,7 @@ bool ResourceManager::createIsometricTexture(const std::string& id, const std::s
     };
 
     // 7. Копируем исходную текстуру
-    SDL_RenderCopy(m_renderer, sourceTexture, NULL, &destRect);
+    SDL_RenderCopy(m_renderer, sourceTexture, &source.rect, &destRect);
 
     // 8. Рисуем ромб вокруг текстуры для обозначения границ
     SDL_Point points[5];
@@ -199,9 +212,10 @@ bool ResourceManager::createIsometricTexture(const std::string& id, const std::s
     // 9. Восстанавливаем исходную цель рендеринга
     SDL_SetRenderTarget(m_renderer, currentTarget);
 
-    // 10. Настраиваем результирующую текстуру
-    SDL_SetTextureBlendMode(resultTexture, SDL_BLENDMODE_NONE);
-    m_textures[newId] = resultTexture;
+    // 10. Переносим результат в атлас (фон непрозрачный, поэтому смешивание страницы ничего не меняет)
+    if (!moveIntoAtlas(newId, resultTexture)) {
+        return false;
+    }
 
     std::cout << "Isometric texture '" << newId << "' created successfully" << std::endl;
     return true;
@@ -209,8 +223,9 @@ bool ResourceManager::createIsometricTexture(const std::string& id, const std::s
 
 
 bool ResourceManager::createIsometricFaceTexture(const std::string& id, const std::string& newId, int faceType, int tileWidth, int tileHeight) {
-    // 1. Получаем исходную текстуру
-    SDL_Texture* sourceTexture = getTexture(id);
+    // 1. Получаем область исходной текстуры в атласе
+    TextureAtlas::Region source = getAtlasRegion(id);
+    SDL_Texture* sourceTexture = getAtlasPage(source.page);
     if (!sourceTexture) {
         std::cerr << "Source texture '" << id << "' not found!" << std::endl;
         return false;
@@ -246,11 +261,7 @@ bool ResourceManager::createIsometricFaceTexture(const std::string& id, const st
         return false;
     }
 
-    // 4. Получаем размеры исходной текстуры
-    int sourceWidth, sourceHeight;
-    SDL_QueryTexture(sourceTexture, nullptr, nullptr, &sourceWidth, &sourceHeight);
-
-    // 5. Создаем новую текстуру для грани с поддержкой альфа-канала
+    // 4. Создаем временную текстуру для грани с поддержкой альфа-канала
     SDL_Texture* targetTexture = SDL_CreateTexture(
         m_renderer,
         SDL_PIXELFORMAT_RGBA8888,
@@ -264,20 +275,20 @@ bool ResourceManager::createIsometricFaceTexture(const std::string& id, const st
         return false;
     }
 
-    // 6. Настраиваем альфа-смешивание и сохраняем текущую цель рендеринга
+    // 5. Настраиваем альфа-смешивание и сохраняем текущую цель рендеринга
     SDL_SetTextureBlendMode(targetTexture, SDL_BLENDMODE_BLEND);
     SDL_Texture* currentTarget = SDL_GetRenderTarget(m_renderer);
     SDL_SetRenderTarget(m_renderer, targetTexture);
 
-    // 7. Очищаем текстуру и делаем ее полностью прозрачной
+    // 6. Очищаем текстуру и делаем ее полностью прозрачной
     SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, 0);
     SDL_RenderClear(m_renderer);
 
-    // 8. Рисуем исходную текстуру на целевую
+    // 7. Рисуем исходную текстуру на целевую
     SDL_Rect destRect = { 0, 0, targetWidth, targetHeight };
-    SDL_RenderCopy(m_renderer, sourceTexture, nullptr, &destRect);
+    SDL_RenderCopy(m_renderer, sourceTexture, &source.rect, &destRect);
 
-    // 9. Для боковых граней добавляем затемнение
+    // 8. Для боковых граней добавляем затемнение
     if (faceType > 0) {
         // Более контрастное затемнение для боковых граней
         int alpha = (faceType == 1) ? 100 : 140;  // Левая грань светлее, правая темнее
@@ -294,24 +305,27 @@ bool ResourceManager::createIsometricFaceTexture(const std::string& id, const st
         }
     }
 
-    // 10. Восстанавливаем исходную цель рендеринга
+    // 9. Восстанавливаем исходную цель рендеринга
     SDL_SetRenderTarget(m_renderer, currentTarget);
 
-    // 11. Сохраняем новую текстуру в менеджере ресурсов
-    m_textures[newId] = targetTexture;
+    // 10. Переносим грань в атлас, временная текстура уничтожается
+    if (!moveIntoAtlas(newId, targetTexture)) {
+        return false;
+    }
 
     std::cout << "Isometric face texture '" << newId << "' (type " << faceType << ") created successfully" << std::endl;
     return true;
 }
 
 bool ResourceManager::debugTextureInfo(const std::string& id) {
-    SDL_Texture* texture = getTexture(id);
+    TextureAtlas::Region region = getAtlasRegion(id);
+    SDL_Texture* texture = getAtlasPage(region.page);
     if (!texture) {
         std::cerr << "DEBUG: Texture '" << id << "' not found!" << std::endl;
         return false;
     }
 
-    // Get detailed information about the texture
+    // Get detailed information about the atlas page holding the texture
     Uint32 format;
     int access, width, height;
     if (SDL_QueryTexture(texture, &format, &access, &width, &height) != 0) {
@@ -321,7 +335,9 @@ bool ResourceManager::debugTextureInfo(const std::string& id) {
 
     // Output information
     std::cout << "DEBUG: Texture '" << id << "':" << std::endl;
-    std::cout << "  - Size: " << width << "x" << height << std::endl;
+    std::cout << "  - Size: " << region.rect.w << "x" << region.rect.h << std::endl;
+    std::cout << "  - Atlas page: " << region.page << " (" << width << "x" << height
+        << "), offset: " << region.rect.x << "," << region.rect.y << std::endl;
 
     // Get format name
     std::string formatName;
@@ -456,6 +472,8 @@ bool ResourceManager::hasFont(const std::string& id) const {
 void ResourceManager::removeFont(const std::string& id) {
     auto it = m_fonts.find(id);
     if (it != m_fonts.end()) {
+        // Глифы и разметки ссылаются на шрифт по указателю
+        m_glyphAtlas.clear();
         TTF_CloseFont(it->second);
         m_fonts.erase(it);
         std::cout << "Font '" << id << "' removed." << std::endl;
@@ -499,6 +517,44 @@ void ResourceManager::renderText(SDL_Renderer* renderer, const std::string& text
     int windowWidth, windowHeight;
     SDL_GetRendererOutputSize(renderer, &windowWidth, &windowHeight);
 
+    // Проверяем, не выходит ли текст за пределы экрана
+    int maxDisplayWidth = windowWidth - 60; // Отступы по 30 пикселей с каждой стороны
+
+    TTF_Font* font = getFont(fontId);
+    if (!font) {
+        std::cerr << "ERROR: Could not render text. Font '" << fontId << "' not found." << std::endl;
+        return;
+    }
+
+    // Разметка строки из кэша (глифы растеризуются только при первом появлении)
+    const GlyphAtlas::TextLayout* layout = m_glyphAtlas.layout(renderer, font, text);
+    if (!layout) {
+        // Атлас заполнен: выводим по-старому, а атлас собираем заново со следующего кадра
+        m_glyphAtlas.clear();
+        renderTextDirect(renderer, text, fontId, x, y, color, maxDisplayWidth);
+        return;
+    }
+
+    int textWidth = layout->width;
+    int textHeight = layout->height;
+    float scale = 1.0f;
+
+    if (textWidth > maxDisplayWidth && textWidth > 0) {
+        // Если текст слишком широкий, масштабируем его по ширине
+        scale = static_cast<float>(maxDisplayWidth) / textWidth;
+        textHeight = static_cast<int>((float)textHeight * scale);
+        textWidth = maxDisplayWidth;
+    }
+
+    // Центрируем текст по X и Y координатам
+    if (!m_glyphAtlas.draw(renderer, *layout,
+        static_cast<float>(x - textWidth / 2), static_cast<float>(y - textHeight / 2), scale, color)) {
+        renderTextDirect(renderer, text, fontId, x, y, color, maxDisplayWidth);
+    }
+}
+
+void ResourceManager::renderTextDirect(SDL_Renderer* renderer, const std::string& text, const std::string& fontId,
+    int x, int y, SDL_Color color, int maxWidth) {
     // Создаем текстуру с текстом
     SDL_Texture* texture = createTextTexture(text, fontId, color);
     if (!texture) {
@@ -509,13 +565,10 @@ void ResourceManager::renderText(SDL_Renderer* renderer, const std::string& text
     int textureWidth, textureHeight;
     SDL_QueryTexture(texture, nullptr, nullptr, &textureWidth, &textureHeight);
 
-    // Проверяем, не выходит ли текст за пределы экрана
-    int maxDisplayWidth = windowWidth - 60; // Отступы по 30 пикселей с каждой стороны
-
-    if (textureWidth > maxDisplayWidth) {
+    if (textureWidth > maxWidth) {
         // Если текст слишком широкий, масштабируем его по ширине
-        textureHeight = static_cast<int>((float)textureHeight * ((float)maxDisplayWidth / textureWidth));
-        textureWidth = maxDisplayWidth;
+        textureHeight = static_cast<int>((float)textureHeight * ((float)maxWidth / textureWidth));
+        textureWidth = maxWidth;
     }
 
     // Настройка целевого прямоугольника для отображения
@@ -532,4 +585,4 @@ void ResourceManager::renderText(SDL_Renderer* renderer, const std::string& text
 
     // Освобождение созданной текстуры
     SDL_DestroyTexture(texture);
-}
\ No newline at end of file
+}
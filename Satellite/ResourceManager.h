@@ -3,6 +3,8 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_ttf.h>  // Добавлен включение SDL_ttf
+#include "TextureAtlas.h"
+#include "GlyphAtlas.h"
 #include <string>
 #include <unordered_map>
 #include <memory>
@@ -26,6 +28,10 @@ public:
 
     /**
      * @brief Загружает текстуру из файла
+     *
+     * Изображение размещается в общем атласе текстур, отдельная текстура
+     * не создается. Для вывода используются getAtlasRegion и getAtlasPage.
+     *
      * @param id Идентификатор ресурса
      * @param filePath Путь к файлу текстуры
      * @return true в случае успеха, false при ошибке
@@ -33,11 +39,24 @@ public:
     bool loadTexture(const std::string& id, const std::string& filePath);
 
     /**
-     * @brief Получает текстуру по идентификатору
+     * @brief Получает область атласа, в которой хранится текстура
      * @param id Идентификатор ресурса
-     * @return Указатель на текстуру или nullptr, если текстура не найдена
+     * @return Дескриптор области (невалидный, если текстура не найдена)
      */
-    SDL_Texture* getTexture(const std::string& id) const;
+    TextureAtlas::Region getAtlasRegion(const std::string& id) const;
+
+    /**
+     * @brief Получает текстуру страницы атласа
+     * @param page Номер страницы (TextureAtlas::Region::page)
+     * @return Текстура страницы или nullptr
+     */
+    SDL_Texture* getAtlasPage(int page) const { return m_atlas.getPageTexture(page); }
+
+    /**
+     * @brief Получает атлас загруженных и производных текстур
+     * @return Ссылка на атлас
+     */
+    const TextureAtlas& getAtlas() const { return m_atlas; }
 
     /**
      * @brief Проверяет, загружена ли текстура с указанным идентификатором
@@ -48,6 +67,10 @@ public:
 
     /**
      * @brief Удаляет текстуру из менеджера ресурсов
+     *
+     * Место в атласе освобождается только в clearAll: упаковка не
+     * поддерживает удаление отдельных областей.
+     *
      * @param id Идентификатор ресурса
      */
     void removeTexture(const std::string& id);
@@ -68,6 +91,10 @@ public:
 
     /**
      * @brief Создает изометрическую текстуру из обычной для использования на тайле
+     *
+     * Результат рисуется во временную текстуру-цель и копируется в атлас,
+     * временная текстура сразу уничтожается.
+     *
      * @param id Идентификатор исходной текстуры
      * @param newId Идентификатор новой изометрической текстуры
      * @param tileWidth Ширина изометрического тайла
@@ -134,6 +161,11 @@ public:
 
     /**
      * @brief Отрисовывает текст на экране
+     *
+     * Текст центрируется в точке (x, y) и сжимается по ширине до размеров окна
+     * с отступами. Глифы берутся из атласа, разметка строк кэшируется, поэтому
+     * повторный вывод той же строки не создает ни поверхностей, ни текстур.
+     *
      * @param renderer Указатель на SDL_Renderer
      * @param text Текст для отображения
      * @param fontId Идентификатор шрифта
@@ -144,8 +176,36 @@ public:
     void renderText(SDL_Renderer* renderer, const std::string& text, const std::string& fontId,
         int x, int y, SDL_Color color);
 
+    /**
+     * @brief Сбрасывает атлас глифов (например, после потери текстур)
+     */
+    void invalidateTextCache() { m_glyphAtlas.clear(); }
+
 private:
+    /**
+     * @brief Отрисовывает текст через временную текстуру (без атласа глифов)
+     * @param renderer Указатель на SDL_Renderer
+     * @param text Текст для отображения
+     * @param fontId Идентификатор шрифта
+     * @param x X-координата центра
+     * @param y Y-координата центра
+     * @param color Цвет текста
+     * @param maxWidth Максимальная ширина текста
+     */
+    void renderTextDirect(SDL_Renderer* renderer, const std::string& text, const std::string& fontId,
+        int x, int y, SDL_Color color, int maxWidth);
+
+    /**
+     * @brief Переносит текстуру-цель в атлас и уничтожает ее
+     * @param id Идентификатор новой текстуры
+     * @param texture Временная текстура (освобождается в любом случае)
+     * @return true, если текстура размещена в атласе
+     */
+    bool moveIntoAtlas(const std::string& id, SDL_Texture* texture);
+
     SDL_Renderer* m_renderer;                                  ///< Указатель на SDL рендерер
-    std::unordered_map<std::string, SDL_Texture*> m_textures;  ///< Хранилище текстур
+    TextureAtlas m_atlas;                                      ///< Атлас загруженных и производных текстур
+    std::unordered_map<std::string, TextureAtlas::Region> m_textures; ///< Области текстур в атласе
     std::unordered_map<std::string, TTF_Font*> m_fonts;        ///< Хранилище шрифтов
+    GlyphAtlas m_glyphAtlas;                                   ///< Атлас глифов и кэш разметки строк
 };
\ No newline at end of file
@@ -164,9 +164,9 @@ void RoomGenerator::clearMap(TileMap* tileMap)
     // Заполняем карту пустыми тайлами
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
-            MapTile* tile = tileMap->getTile(x, y);
+            MapTile tile = tileMap->getTile(x, y);
             if (tile) {
-                tile->setType(TileType::EMPTY);
+                tile.setType(TileType::EMPTY);
             }
         }
     }
@@ -185,7 +185,7 @@ void RoomGenerator::createRoom(TileMap* tileMap, const Room& room)
             if (!tileMap->isValidCoordinate(x, y))
                 continue;
 
-            MapTile* tile = tileMap->getTile(x, y);
+            MapTile tile = tileMap->getTile(x, y);
             if (!tile) continue;
 
             // Определяем, является ли текущая позиция краем комнаты
@@ -194,13 +194,13 @@ void RoomGenerator::createRoom(TileMap* tileMap, const Room& room)
 
             if (isEdge) {
                 // Создаем стены по периметру комнаты
-                tile->setType(wallType);
-                tile->setWalkable(false);
+                tile.setType(wallType);
+                tile.setWalkable(false);
             }
             else {
                 // Внутренность комнаты - пол
-                tile->setType(floorType);
-                tile->setWalkable(true);
+                tile.setType(floorType);
+                tile.setWalkable(true);
             }
         }
     }
@@ -218,10 +218,10 @@ void RoomGenerator::createRoom(TileMap* tileMap, const Room& room)
         int y = cornerPoints[i][1];
 
         if (tileMap->isValidCoordinate(x, y)) {
-            MapTile* tile = tileMap->getTile(x, y);
+            MapTile tile = tileMap->getTile(x, y);
             if (tile) {
-                tile->setType(wallType);
-                tile->setWalkable(false);
+                tile.setType(wallType);
+                tile.setWalkable(false);
             }
         }
     }
@@ -276,19 +276,19 @@ void RoomGenerator::createCorridor(TileMap* tileMap, const Room& room1, const Ro
         if (corridorY >= room1.y && corridorY < room1.y + room1.height) {
             // Восточная стена комнаты 1 (если коридор идет вправо)
             if (x1 < x2 && tileMap->isValidCoordinate(room1.x + room1.width - 1, corridorY)) {
-                MapTile* tile = tileMap->getTile(room1.x + room1.width - 1, corridorY);
+                MapTile tile = tileMap->getTile(room1.x + room1.width - 1, corridorY);
                 if (tile) {
-                    tile->setType(floorType);
-                    tile->setWalkable(true);
+                    tile.setType(floorType);
+                    tile.setWalkable(true);
                 }
             }
 
             // Западная стена комнаты 1 (если коридор идет влево)
             if (x1 > x2 && tileMap->isValidCoordinate(room1.x, corridorY)) {
-                MapTile* tile = tileMap->getTile(room1.x, corridorY);
+                MapTile tile = tileMap->getTile(room1.x, corridorY);
                 if (tile) {
-                    tile->setType(floorType);
-                    tile->setWalkable(true);
+                    tile.setType(floorType);
+                    tile.setWalkable(true);
                 }
             }
         }
@@ -297,19 +297,19 @@ void RoomGenerator::createCorridor(TileMap* tileMap, const Room& room1, const Ro
         if (corridorY >= room2.y && corridorY < room2.y + room2.height) {
             // Западная стена комнаты 2 (если коридор идет влево от нее)
             if (x2 > x1 && tileMap->isValidCoordinate(room2.x, corridorY)) {
-                MapTile* tile = tileMap->getTile(room2.x, corridorY);
+                MapTile tile = tileMap->getTile(room2.x, corridorY);
                 if (tile) {
-                    tile->setType(floorType);
-                    tile->setWalkable(true);
+                    tile.setType(floorType);
+                    tile.setWalkable(true);
                 }
             }
 
             // Восточная стена комнаты 2 (если коридор идет вправо от нее)
             if (x2 < x1 && tileMap->isValidCoordinate(room2.x + room2.width - 1, corridorY)) {
-                MapTile* tile = tileMap->getTile(room2.x + room2.width - 1, corridorY);
+                MapTile tile = tileMap->getTile(room2.x + room2.width - 1, corridorY);
                 if (tile) {
-                    tile->setType(floorType);
-                    tile->setWalkable(true);
+                    tile.setType(floorType);
+                    tile.setWalkable(true);
                 }
             }
         }
@@ -321,19 +321,19 @@ void RoomGenerator::createCorridor(TileMap* tileMap, const Room& room1, const Ro
         if (corridorX >= room1.x && corridorX < room1.x + room1.width) {
             // Южная стена комнаты 1 (если коридор идет вниз)
             if (y1 < y2 && tileMap->isValidCoordinate(corridorX, room1.y + room1.height - 1)) {
-                MapTile* tile = tileMap->getTile(corridorX, room1.y + room1.height - 1);
+                MapTile tile = tileMap->getTile(corridorX, room1.y + room1.height - 1);
                 if (tile) {
-                    tile->setType(floorType);
-                    tile->setWalkable(true);
+                    tile.setType(floorType);
+                    tile.setWalkable(true);
                 }
             }
 
             // Северная стена комнаты 1 (если коридор идет вверх)
             if (y1 > y2 && tileMap->isValidCoordinate(corridorX, room1.y)) {
-                MapTile* tile = tileMap->getTile(corridorX, room1.y);
+                MapTile tile = tileMap->getTile(corridorX, room1.y);
                 if (tile) {
-                    tile->setType(floorType);
-                    tile->setWalkable(true);
+                    tile.setType(floorType);
+                    tile.setWalkable(true);
                 }
             }
         }
@@ -342,19 +342,19 @@ void RoomGenerator::createCorridor(TileMap* tileMap, const Room& room1, const Ro
         if (corridorX >= room2.x && corridorX < room2.x + room2.width) {
             // Северная стена комнаты 2 (если коридор идет вверх от нее)
             if (y2 > y1 && tileMap->isValidCoordinate(corridorX, room2.y)) {
-                MapTile* tile = tileMap->getTile(corridorX, room2.y);
+                MapTile tile = tileMap->getTile(corridorX, room2.y);
                 if (tile) {
-                    tile->setType(floorType);
-                    tile->setWalkable(true);
+                    tile.setType(floorType);
+                    tile.setWalkable(true);
                 }
             }
 
             // Южная стена комнаты 2 (если коридор идет вниз от нее)
             if (y2 < y1 && tileMap->isValidCoordinate(corridorX, room2.y + room2.height - 1)) {
-                MapTile* tile = tileMap->getTile(corridorX, room2.y + room2.height - 1);
+                MapTile tile = tileMap->getTile(corridorX, room2.y + room2.height - 1);
                 if (tile) {
-                    tile->setType(floorType);
-                    tile->setWalkable(true);
+                    tile.setType(floorType);
+                    tile.setWalkable(true);
                 }
             }
         }
@@ -363,10 +363,10 @@ void RoomGenerator::createCorridor(TileMap* tileMap, const Room& room1, const Ro
     // Создаем сам горизонтальный коридор
     for (int x = startX; x <= endX; x++) {
         if (tileMap->isValidCoordinate(x, corridorY)) {
-            MapTile* tile = tileMap->getTile(x, corridorY);
+            MapTile tile = tileMap->getTile(x, corridorY);
             if (tile) {
-                tile->setType(floorType);
-                tile->setWalkable(true);
+                tile.setType(floorType);
+                tile.setWalkable(true);
             }
         }
     }
@@ -374,10 +374,10 @@ void RoomGenerator::createCorridor(TileMap* tileMap, const Room& room1, const Ro
     // Создаем сам вертикальный коридор
     for (int y = startY; y <= endY; y++) {
         if (tileMap->isValidCoordinate(corridorX, y)) {
-            MapTile* tile = tileMap->getTile(corridorX, y);
+            MapTile tile = tileMap->getTile(corridorX, y);
             if (tile) {
-                tile->setType(floorType);
-                tile->setWalkable(true);
+                tile.setType(floorType);
+                tile.setWalkable(true);
             }
         }
     }
@@ -396,14 +396,14 @@ void RoomGenerator::addWallsAroundCorridor(TileMap* tileMap, int startX, int end
         for (int dy = -1; dy <= 1; dy += 2) {
             int y = y1 + dy;
             if (tileMap->isValidCoordinate(x, y)) {
-                MapTile* tile = tileMap->getTile(x, y);
+                MapTile tile = tileMap->getTile(x, y);
                 if (tile) {
                     // Добавляем стену только если тайл пуст или не является полом/проходимым тайлом
-                    TileType currentType = tile->getType();
+                    TileType currentType = tile.getType();
                     if (currentType == TileType::EMPTY ||
                         !(currentType == floorType || IsWalkable(currentType))) {
-                        tile->setType(wallType);
-                        tile->setWalkable(false);
+                        tile.setType(wallType);
+                        tile.setWalkable(false);
                     }
                 }
             }
@@ -416,14 +416,14 @@ void RoomGenerator::addWallsAroundCorridor(TileMap* tileMap, int startX, int end
         for (int dx = -1; dx <= 1; dx += 2) {
             int x = x2 + dx;
             if (tileMap->isValidCoordinate(x, y)) {
-                MapTile* tile = tileMap->getTile(x, y);
+                MapTile tile = tileMap->getTile(x, y);
                 if (tile) {
                     // Добавляем стену только если тайл пуст или не является полом/проходимым тайлом
-                    TileType currentType = tile->getType();
+                    TileType currentType = tile.getType();
                     if (currentType == TileType::EMPTY ||
                         !(currentType == floorType || IsWalkable(currentType))) {
-                        tile->setType(wallType);
-                        tile->setWalkable(false);
+                        tile.setType(wallType);
+                        tile.setWalkable(false);
                     }
                 }
             }
@@ -451,21 +451,21 @@ void RoomGenerator::addWallsAroundCorridor(TileMap* tileMap, int startX, int end
             int checkY = cornerY + corners[i][1];
 
             if (tileMap->isValidCoordinate(checkX, checkY)) {
-                MapTile* tile = tileMap->getTile(checkX, checkY);
+                MapTile tile = tileMap->getTile(checkX, checkY);
                 if (tile) {
                     // Проверяем, не находится ли это в комнате
                     bool isInRoom = false;
 
                     // Здесь можно добавить проверку на нахождение в комнате,
                     // но для простоты просто проверим, является ли это уже полом
-                    if (tile->getType() == floorType || tile->isWalkable()) {
+                    if (tile.getType() == floorType || tile.isWalkable()) {
                         isInRoom = true;
                     }
 
-                    if (!isInRoom && (tile->getType() == TileType::EMPTY ||
-                        !(tile->getType() == floorType || tile->isWalkable()))) {
-                        tile->setType(wallType);
-                        tile->setWalkable(false);
+                    if (!isInRoom && (tile.getType() == TileType::EMPTY ||
+                        !(tile.getType() == floorType || tile.isWalkable()))) {
+                        tile.setType(wallType);
+                        tile.setWalkable(false);
                     }
                 }
             }
@@ -65,7 +65,20 @@ public:
      */
     const std::string& getName() const { return m_name; }
 
+    /**
+     * @brief Установка коэффициента интерполяции перед отрисовкой
+     * @param alpha Доля шага симуляции, прошедшая после последнего update() [0, 1)
+     */
+    virtual void setInterpolationAlpha(float alpha) { m_interpolationAlpha = alpha; }
+
+    /**
+     * @brief Получение коэффициента интерполяции
+     * @return Доля шага симуляции [0, 1)
+     */
+    float getInterpolationAlpha() const { return m_interpolationAlpha; }
+
 protected:
     std::string m_name;                         ///< Имя сцены
+    float m_interpolationAlpha = 1.0f;          ///< Коэффициент интерполяции для отрисовки
     std::vector<std::shared_ptr<Entity>> m_entities;  ///< Список сущностей на сцене
 };
\ No newline at end of file
@@ -0,0 +1,396 @@
+﻿#include "SoftwareRasterizer.h"
+#include "RenderStats.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Набор инструкций выбирается при сборке: AVX2 - при /arch:AVX2 (-mavx2),
+// SSE2 есть на любой x64 платформе
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SATELLITE_SIMD_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SATELLITE_SIMD_SSE2 1
+#endif
+
+SoftwareRasterizer::SoftwareRasterizer()
+    : m_pixels(nullptr), m_width(0), m_height(0), m_pitch(0),
+    m_dirtyTop(0), m_dirtyBottom(-1), m_active(false),
+    m_texture(nullptr), m_textureOwner(nullptr), m_textureWidth(0), m_textureHeight(0) {
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() {
+    releaseTexture();
+}
+
+bool SoftwareRasterizer::begin(SDL_Renderer* renderer) {
+    if (m_active) {
+        return true;
+    }
+
+    if (!renderer) {
+        return false;
+    }
+
+    // SDL_GetRendererOutputSize возвращает размер окна даже при назначенной текстуре-цели
+    int width = 0;
+    int height = 0;
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    if (!target || SDL_QueryTexture(target, nullptr, nullptr, &width, &height) != 0) {
+        SDL_GetRendererOutputSize(renderer, &width, &height);
+    }
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    // 1. Буфер пересоздается только при смене размера цели вывода
+    if (width != m_width || height != m_height) {
+        m_width = width;
+        m_height = height;
+        m_pitch = (width + 7) & ~7;
+
+        // Запас в 8 пикселей позволяет выровнять начало буфера на 32 байта
+        m_storage.assign(static_cast<size_t>(m_pitch) * height + 8, 0);
+        uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.data());
+        size_t offset = ((32 - (address & 31)) & 31) / sizeof(Uint32);
+        m_pixels = m_storage.data() + offset;
+
+        m_dirtyTop = 0;
+        m_dirtyBottom = -1;
+    }
+
+    // 2. Строки прошлого кадра уже очищены в present()
+    m_active = true;
+    return true;
+}
+
+void SoftwareRasterizer::fillDiamond(const SDL_Point* points, SDL_Color color) {
+    if (!m_active || color.a == 0) {
+        return;
+    }
+
+    int centerX = points[0].x;
+    int topY = points[0].y;
+    int middleY = points[1].y;
+    int bottomY = points[2].y;
+    float leftOffset = static_cast<float>(points[3].x - centerX);
+    float rightOffset = static_cast<float>(points[1].x - centerX);
+
+    if (bottomY <= topY || middleY <= topY || middleY >= bottomY) {
+        return;
+    }
+
+    int firstRow = std::max(topY, 0);
+    int lastRow = std::min(bottomY, m_height) - 1;
+    if (firstRow > lastRow) {
+        return;
+    }
+
+    Uint32 argb = toARGB(color);
+    float upperHeight = static_cast<float>(middleY - topY);
+    float lowerHeight = static_cast<float>(bottomY - middleY);
+
+    // Ширина строки линейно растет до средней вершины и линейно убывает после нее
+    for (int y = firstRow; y <= lastRow; ++y) {
+        float rowCenter = y + 0.5f;
+        float t = rowCenter < middleY ?
+            (rowCenter - topY) / upperHeight :
+            (bottomY - rowCenter) / lowerHeight;
+
+        int x0 = static_cast<int>(std::ceil(centerX + leftOffset * t - 0.5f));
+        int x1 = static_cast<int>(std::ceil(centerX + rightOffset * t - 0.5f));
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, m_width);
+        if (x0 < x1) {
+            fillSpan(y, x0, x1, argb, color.a);
+        }
+    }
+
+    markRows(firstRow, lastRow);
+}
+
+void SoftwareRasterizer::fillLeftFace(const SDL_Point* points, SDL_Color color) {
+    fillParallelogram(points[0].x, points[1].x, points[0].y, points[1].y, points[3].y - points[0].y, color);
+}
+
+void SoftwareRasterizer::fillRightFace(const SDL_Point* points, SDL_Color color) {
+    // Вершины правой грани: верхняя левая, верхняя правая, нижняя правая, нижняя левая
+    fillParallelogram(points[0].x, points[1].x, points[0].y, points[1].y, points[3].y - points[0].y, color);
+}
+
+void SoftwareRasterizer::fillParallelogram(int left, int right, int topAtLeft, int topAtRight, int height,
+    SDL_Color color) {
+    if (!m_active || color.a == 0 || right <= left || height <= 0) {
+        return;
+    }
+
+    int firstRow = std::max(std::min(topAtLeft, topAtRight), 0);
+    int lastRow = std::min(std::max(topAtLeft, topAtRight) + height, m_height) - 1;
+    int clipLeft = std::max(left, 0);
+    int clipRight = std::min(right, m_width);
+    if (firstRow > lastRow || clipLeft >= clipRight) {
+        return;
+    }
+
+    Uint32 argb = toARGB(color);
+    float slope = static_cast<float>(topAtRight - topAtLeft) / (right - left);
+
+    // Пиксель внутри, если верхнее ребро над его центром не выше чем на height:
+    // top(x) <= y < top(x) + height, где top(x) = topAtLeft + (x - left) * slope
+    for (int y = firstRow; y <= lastRow; ++y) {
+        float rowCenter = y + 0.5f;
+        float from = static_cast<float>(left);
+        float to = static_cast<float>(right);
+
+        if (slope > 0.0f) {
+            from = std::max(from, left + (rowCenter - height - topAtLeft) / slope);
+            to = std::min(to, left + (rowCenter - topAtLeft) / slope);
+        }
+        else if (slope < 0.0f) {
+            from = std::max(from, left + (rowCenter - topAtLeft) / slope);
+            to = std::min(to, left + (rowCenter - height - topAtLeft) / slope);
+        }
+        else if (rowCenter < topAtLeft || rowCenter >= topAtLeft + height) {
+            continue;
+        }
+
+        int x0 = std::max(static_cast<int>(std::ceil(from - 0.5f)), clipLeft);
+        int x1 = std::min(static_cast<int>(std::ceil(to - 0.5f)), clipRight);
+        if (x0 < x1) {
+            fillSpan(y, x0, x1, argb, color.a);
+        }
+    }
+
+    markRows(firstRow, lastRow);
+}
+
+void SoftwareRasterizer::drawOutline(const SDL_Point* points, int count, SDL_Color color) {
+    if (!m_active || color.a == 0) {
+        return;
+    }
+
+    Uint32 argb = toARGB(color);
+    for (int i = 0; i < count; ++i) {
+        const SDL_Point& a = points[i];
+        const SDL_Point& b = points[(i + 1) % count];
+        drawLine(a.x, a.y, b.x, b.y, argb, color.a);
+    }
+}
+
+void SoftwareRasterizer::drawLine(int x0, int y0, int x1, int y1, Uint32 color, Uint8 alpha) {
+    int dx = std::abs(x1 - x0);
+    int dy = -std::abs(y1 - y0);
+    int stepX = x0 < x1 ? 1 : -1;
+    int stepY = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+
+    markRows(std::max(std::min(y0, y1), 0), std::min(std::max(y0, y1), m_height - 1));
+
+    while (true) {
+        if (x0 >= 0 && x0 < m_width && y0 >= 0 && y0 < m_height) {
+            fillSpan(y0, x0, x0 + 1, color, alpha);
+        }
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+
+        int doubled = 2 * error;
+        if (doubled >= dy) {
+            error += dy;
+            x0 += stepX;
+        }
+        if (doubled <= dx) {
+            error += dx;
+            y0 += stepY;
+        }
+    }
+}
+
+void SoftwareRasterizer::fillSpan(int y, int x0, int x1, Uint32 color, Uint8 alpha) {
+    Uint32* pixel = m_pixels + static_cast<size_t>(y) * m_pitch + x0;
+    Uint32* end = m_pixels + static_cast<size_t>(y) * m_pitch + x1;
+
+    // 1. Непрозрачная заливка: выравниваем начало и пишем по 8 (AVX2) или 4 (SSE2) пикселя
+    if (alpha == 255) {
+#if defined(SATELLITE_SIMD_AVX2)
+        while (pixel < end && (reinterpret_cast<uintptr_t>(pixel) & 31) != 0) {
+            *pixel++ = color;
+        }
+        __m256i wide = _mm256_set1_epi32(static_cast<int>(color));
+        for (; pixel + 8 <= end; pixel += 8) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(pixel), wide);
+        }
+#elif defined(SATELLITE_SIMD_SSE2)
+        while (pixel < end && (reinterpret_cast<uintptr_t>(pixel) & 15) != 0) {
+            *pixel++ = color;
+        }
+        __m128i wide = _mm_set1_epi32(static_cast<int>(color));
+        for (; pixel + 4 <= end; pixel += 4) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(pixel), wide);
+        }
+#endif
+        while (pixel < end) {
+            *pixel++ = color;
+        }
+        return;
+    }
+
+    // 2. Смешивание: out = (src * a + dst * (256 - a)) >> 8 для всех каналов.
+    // Альфа источника принимается за 255, поэтому альфа результата - "источник поверх приемника",
+    // а цвет получается умноженным на альфу (буфер хранит premultiplied alpha, см. present())
+    Uint32 sourceAlpha = alpha;
+    Uint32 inverseAlpha = 256 - sourceAlpha;
+    Uint32 source = color | 0xFF000000u;
+
+#if defined(SATELLITE_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sourceWeighted = _mm_mullo_epi16(
+        _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(source)), zero),
+        _mm_set1_epi16(static_cast<short>(sourceAlpha)));
+    const __m128i inverse = _mm_set1_epi16(static_cast<short>(inverseAlpha));
+
+    for (; pixel + 4 <= end; pixel += 4) {
+        __m128i destination = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixel));
+        __m128i low = _mm_unpacklo_epi8(destination, zero);
+        __m128i high = _mm_unpackhi_epi8(destination, zero);
+        low = _mm_srli_epi16(_mm_add_epi16(sourceWeighted, _mm_mullo_epi16(low, inverse)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(sourceWeighted, _mm_mullo_epi16(high, inverse)), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel), _mm_packus_epi16(low, high));
+    }
+#endif
+
+    for (; pixel < end; ++pixel) {
+        Uint32 destination = *pixel;
+        Uint32 result = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            Uint32 s = (source >> shift) & 0xFF;
+            Uint32 d = (destination >> shift) & 0xFF;
+            result |= ((s * sourceAlpha + d * inverseAlpha) >> 8) << shift;
+        }
+        *pixel = result;
+    }
+}
+
+void SoftwareRasterizer::markRows(int top, int bottom) {
+    if (top > bottom) {
+        return;
+    }
+    if (m_dirtyTop > m_dirtyBottom) {
+        m_dirtyTop = top;
+        m_dirtyBottom = bottom;
+        return;
+    }
+    m_dirtyTop = std::min(m_dirtyTop, top);
+    m_dirtyBottom = std::max(m_dirtyBottom, bottom);
+}
+
+bool SoftwareRasterizer::present(SDL_Renderer* renderer) {
+    if (!m_active) {
+        return true;
+    }
+    m_active = false;
+
+    if (m_dirtyTop > m_dirtyBottom) {
+        return true;
+    }
+
+    SDL_Rect rows = { 0, m_dirtyTop, m_width, m_dirtyBottom - m_dirtyTop + 1 };
+    bool success = true;
+
+    // 1. Потоковая текстура под размер буфера (смешивание - поверх уже нарисованного)
+    if (!m_texture || m_textureOwner != renderer ||
+        m_textureWidth != m_width || m_textureHeight != m_height) {
+        releaseTexture();
+        m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+            m_width, m_height);
+        if (m_texture) {
+            SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+            m_textureOwner = renderer;
+            m_textureWidth = m_width;
+            m_textureHeight = m_height;
+        }
+        else {
+            LOG_ERROR("Failed to create rasterizer texture: " + std::string(SDL_GetError()));
+            success = false;
+        }
+    }
+
+    // 2. Одна загрузка измененных строк и один вывод
+    if (m_texture) {
+        void* locked = nullptr;
+        int lockedPitch = 0;
+        if (SDL_LockTexture(m_texture, &rows, &locked, &lockedPitch) == 0) {
+            const Uint32* source = m_pixels + static_cast<size_t>(rows.y) * m_pitch;
+            Uint8* destination = static_cast<Uint8*>(locked);
+            for (int row = 0; row < rows.h; ++row) {
+                unpremultiplyRow(reinterpret_cast<Uint32*>(destination), source, m_width);
+                source += m_pitch;
+                destination += lockedPitch;
+            }
+            SDL_UnlockTexture(m_texture);
+
+            SDL_RenderCopy(renderer, m_texture, &rows, &rows);
+            RenderStats::getInstance().addDrawCalls();
+        }
+        else {
+            LOG_ERROR("Failed to lock rasterizer texture: " + std::string(SDL_GetError()));
+            success = false;
+        }
+    }
+
+    // 3. Очищаем только затронутые строки
+    std::memset(m_pixels + static_cast<size_t>(rows.y) * m_pitch, 0,
+        static_cast<size_t>(rows.h) * m_pitch * sizeof(Uint32));
+    m_dirtyTop = 0;
+    m_dirtyBottom = -1;
+
+    return success;
+}
+
+void SoftwareRasterizer::unpremultiplyRow(Uint32* destination, const Uint32* source, int count) {
+    // Обратные величины альфы в формате 16.16: деление заменяется умножением
+    static const std::vector<Uint32> reciprocals = []() {
+        std::vector<Uint32> table(256, 0);
+        for (Uint32 alpha = 1; alpha < 256; ++alpha) {
+            table[alpha] = ((255u << 16) + alpha / 2) / alpha;
+        }
+        return table;
+    }();
+
+    for (int i = 0; i < count; ++i) {
+        Uint32 pixel = source[i];
+        Uint32 alpha = pixel >> 24;
+
+        // Непрозрачные и пустые пиксели (большинство) копируются как есть
+        if (alpha == 255 || alpha == 0) {
+            destination[i] = pixel;
+            continue;
+        }
+
+        Uint32 reciprocal = reciprocals[alpha];
+        Uint32 r = std::min(255u, (((pixel >> 16) & 0xFF) * reciprocal + 0x8000) >> 16);
+        Uint32 g = std::min(255u, (((pixel >> 8) & 0xFF) * reciprocal + 0x8000) >> 16);
+        Uint32 b = std::min(255u, ((pixel & 0xFF) * reciprocal + 0x8000) >> 16);
+        destination[i] = (alpha << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+void SoftwareRasterizer::releaseTexture() {
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+        m_texture = nullptr;
+    }
+    m_textureOwner = nullptr;
+    m_textureWidth = 0;
+    m_textureHeight = 0;
+}
+
+Uint32 SoftwareRasterizer::toARGB(SDL_Color color) {
+    return (static_cast<Uint32>(color.a) << 24) | (static_cast<Uint32>(color.r) << 16) |
+        (static_cast<Uint32>(color.g) << 8) | static_cast<Uint32>(color.b);
+}
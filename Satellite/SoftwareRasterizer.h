@@ -0,0 +1,171 @@
+﻿#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+/**
+ * @brief Программный растеризатор граней изометрических тайлов
+ *
+ * Тайлы состоят только из трех фигур: ромба верхней грани и двух
+ * параллелограммов боковых граней с вертикальными сторонами. Для каждой
+ * фигуры границы строки вычисляются напрямую, без перебора ребер, а строки
+ * заливаются в собственный кадровый буфер ARGB8888 SIMD-записями
+ * (AVX2, SSE2 или скалярно - в зависимости от целевой платформы сборки).
+ *
+ * Кадровый буфер выводится в потоковую текстуру один раз на present():
+ * строки, которых касалась отрисовка, копируются в заблокированную
+ * текстуру и выводятся одним SDL_RenderCopy. Собственный буфер нужен
+ * потому, что память заблокированной текстуры доступна только на запись,
+ * а полупрозрачные грани смешиваются с уже нарисованными пикселями.
+ * Смешивание в буфере дает цвет, умноженный на альфу; при загрузке
+ * в текстуру он делится обратно, поскольку SDL_BLENDMODE_BLEND умножает
+ * цвет на альфу сам (пользовательские режимы смешивания программный
+ * рендерер SDL не поддерживает).
+ *
+ * Покрытие пикселей определяется по их центрам, поэтому соседние грани
+ * не перекрываются и не оставляют щелей.
+ */
+class SoftwareRasterizer {
+public:
+    /**
+     * @brief Конструктор
+     */
+    SoftwareRasterizer();
+
+    /**
+     * @brief Деструктор (освобождает текстуру)
+     */
+    ~SoftwareRasterizer();
+
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    /**
+     * @brief Подготовка кадрового буфера под текущую цель вывода
+     *
+     * Если буфер уже начат, ничего не делает. Размер буфера совпадает
+     * с размером текущей цели вывода рендерера.
+     *
+     * @param renderer SDL рендерер
+     * @return true, если в буфер можно рисовать
+     */
+    bool begin(SDL_Renderer* renderer);
+
+    /**
+     * @brief Проверка, начат ли кадровый буфер
+     * @return true, если после begin() еще не было present()
+     */
+    bool isActive() const { return m_active; }
+
+    /**
+     * @brief Заливка ромба верхней грани
+     * @param points Вершины: верхняя, правая, нижняя, левая
+     * @param color Цвет заливки
+     */
+    void fillDiamond(const SDL_Point* points, SDL_Color color);
+
+    /**
+     * @brief Заливка левой боковой грани
+     * @param points Вершины: верхняя левая, верхняя правая, нижняя правая, нижняя левая
+     * @param color Цвет заливки
+     */
+    void fillLeftFace(const SDL_Point* points, SDL_Color color);
+
+    /**
+     * @brief Заливка правой боковой грани
+     * @param points Вершины: верхняя левая, верхняя правая, нижняя правая, нижняя левая
+     * @param color Цвет заливки
+     */
+    void fillRightFace(const SDL_Point* points, SDL_Color color);
+
+    /**
+     * @brief Отрисовка замкнутого контура линиями толщиной в 1 пиксель
+     *
+     * Линии строятся алгоритмом Брезенхэма с включенными концами,
+     * как SDL_RenderDrawLine.
+     *
+     * @param points Вершины контура
+     * @param count Количество вершин
+     * @param color Цвет контура
+     */
+    void drawOutline(const SDL_Point* points, int count, SDL_Color color);
+
+    /**
+     * @brief Вывод кадрового буфера на текущую цель рендерера
+     *
+     * Загружает измененные строки в текстуру, копирует их одним
+     * SDL_RenderCopy и завершает буфер; следующий begin() начнет его с чистого листа.
+     *
+     * @param renderer SDL рендерер
+     * @return true в случае успеха
+     */
+    bool present(SDL_Renderer* renderer);
+
+    /**
+     * @brief Освобождение текстуры (например, после SDL_RENDER_DEVICE_RESET)
+     */
+    void releaseTexture();
+
+private:
+    /**
+     * @brief Заливка параллелограмма с вертикальными сторонами
+     * @param left Левая граница по X
+     * @param right Правая граница по X
+     * @param topAtLeft Y верхнего ребра на левой границе
+     * @param topAtRight Y верхнего ребра на правой границе
+     * @param height Высота грани в пикселях
+     * @param color Цвет заливки
+     */
+    void fillParallelogram(int left, int right, int topAtLeft, int topAtRight, int height, SDL_Color color);
+
+    /**
+     * @brief Заливка отрезка строки
+     * @param y Номер строки (внутри буфера)
+     * @param x0 Первый пиксель (включительно, внутри буфера)
+     * @param x1 Последний пиксель (не включительно, внутри буфера)
+     * @param color Цвет в формате ARGB8888
+     * @param alpha Непрозрачность (255 - запись без смешивания)
+     */
+    void fillSpan(int y, int x0, int x1, Uint32 color, Uint8 alpha);
+
+    /**
+     * @brief Отрисовка линии
+     */
+    void drawLine(int x0, int y0, int x1, int y1, Uint32 color, Uint8 alpha);
+
+    /**
+     * @brief Расширение диапазона измененных строк
+     * @param top Первая строка
+     * @param bottom Последняя строка (включительно)
+     */
+    void markRows(int top, int bottom);
+
+    /**
+     * @brief Копирование строки буфера с делением цвета на альфу
+     * @param destination Строка текстуры
+     * @param source Строка буфера (цвет умножен на альфу)
+     * @param count Количество пикселей
+     */
+    static void unpremultiplyRow(Uint32* destination, const Uint32* source, int count);
+
+    /**
+     * @brief Преобразование цвета SDL в ARGB8888
+     * @param color Цвет
+     * @return Цвет в формате ARGB8888
+     */
+    static Uint32 toARGB(SDL_Color color);
+
+    std::vector<Uint32> m_storage; ///< Память буфера с запасом на выравнивание строк
+    Uint32* m_pixels;              ///< Начало буфера (выровнено на 32 байта)
+    int m_width;                   ///< Ширина буфера
+    int m_height;                  ///< Высота буфера
+    int m_pitch;                   ///< Длина строки в пикселях (кратна 8)
+    int m_dirtyTop;                ///< Первая измененная строка
+    int m_dirtyBottom;             ///< Последняя измененная строка (меньше первой - изменений нет)
+    bool m_active;                 ///< Буфер начат
+
+    SDL_Texture* m_texture;        ///< Потоковая текстура для вывода
+    SDL_Renderer* m_textureOwner;  ///< Рендерер, создавший текстуру
+    int m_textureWidth;            ///< Ширина текстуры
+    int m_textureHeight;           ///< Высота текстуры
+};
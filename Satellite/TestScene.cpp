@@ -7,8 +7,7 @@
 
 TestScene::TestScene(const std::string& name, Engine* engine)
     : Scene(name), m_angle(0.0f), m_testObjectX(0.0f), m_testObjectY(0.0f),
-    m_engine(engine), m_grassTexture(nullptr), m_stoneTexture(nullptr),
-    m_wallTexture(nullptr), m_wallLeftTexture(nullptr), m_wallRightTexture(nullptr) {
+    m_engine(engine) {
     // Инициализация тестовой точки
     m_testPoint = { 400, 300 };
 }
@@ -88,11 +87,11 @@ bool TestScene::initialize() {
                 // 5.4 Получаем созданные текстуры
                 if (isoSuccess) {
                     std::cout << "All isometric textures created successfully" << std::endl;
-                    m_grassTexture = resourceManager->getTexture("iso_grass");
-                    m_stoneTexture = resourceManager->getTexture("iso_stone");
-                    m_wallTexture = resourceManager->getTexture("iso_wall_top");
-                    m_wallLeftTexture = resourceManager->getTexture("iso_wall_left");
-                    m_wallRightTexture = resourceManager->getTexture("iso_wall_right");
+                    m_grassTexture = resourceManager->getAtlasRegion("iso_grass");
+                    m_stoneTexture = resourceManager->getAtlasRegion("iso_stone");
+                    m_wallTexture = resourceManager->getAtlasRegion("iso_wall_top");
+                    m_wallLeftTexture = resourceManager->getAtlasRegion("iso_wall_left");
+                    m_wallRightTexture = resourceManager->getAtlasRegion("iso_wall_right");
 
                     // Проверяем и выводим информацию о текстурах
                     resourceManager->debugTextureInfo("iso_grass");
@@ -104,21 +103,21 @@ bool TestScene::initialize() {
                 else {
                     std::cerr << "Failed to create some isometric textures!" << std::endl;
                     // Используем оригинальные текстуры в случае неудачи
-                    m_grassTexture = resourceManager->getTexture("grass");
-                    m_stoneTexture = resourceManager->getTexture("stone");
-                    m_wallTexture = resourceManager->getTexture("wall");
-                    m_wallLeftTexture = resourceManager->getTexture("wall");
-                    m_wallRightTexture = resourceManager->getTexture("wall");
+                    m_grassTexture = resourceManager->getAtlasRegion("grass");
+                    m_stoneTexture = resourceManager->getAtlasRegion("stone");
+                    m_wallTexture = resourceManager->getAtlasRegion("wall");
+                    m_wallLeftTexture = resourceManager->getAtlasRegion("wall");
+                    m_wallRightTexture = resourceManager->getAtlasRegion("wall");
                 }
             }
             else {
                 std::cerr << "Failed to load some textures" << std::endl;
                 // Продолжаем работу даже в случае ошибки загрузки текстур
-                m_grassTexture = resourceManager->getTexture("grass");
-                m_stoneTexture = resourceManager->getTexture("stone");
-                m_wallTexture = resourceManager->getTexture("wall");
-                m_wallLeftTexture = resourceManager->getTexture("wall");
-                m_wallRightTexture = resourceManager->getTexture("wall");
+                m_grassTexture = resourceManager->getAtlasRegion("grass");
+                m_stoneTexture = resourceManager->getAtlasRegion("stone");
+                m_wallTexture = resourceManager->getAtlasRegion("wall");
+                m_wallLeftTexture = resourceManager->getAtlasRegion("wall");
+                m_wallRightTexture = resourceManager->getAtlasRegion("wall");
             }
         }
         else {
@@ -93,10 +93,10 @@ private:
      */
     std::shared_ptr<TileRenderer> m_tileRenderer;
 
-    // Кэшированные указатели на текстуры
-    SDL_Texture* m_grassTexture;
-    SDL_Texture* m_stoneTexture;
-    SDL_Texture* m_wallTexture;
-    SDL_Texture* m_wallLeftTexture;  // Новая текстура для левой грани стены
-    SDL_Texture* m_wallRightTexture; // Новая текстура для правой грани стены
+    // Кэшированные области текстур в атласе ResourceManager
+    TextureAtlas::Region m_grassTexture;
+    TextureAtlas::Region m_stoneTexture;
+    TextureAtlas::Region m_wallTexture;
+    TextureAtlas::Region m_wallLeftTexture;  // Новая текстура для левой грани стены
+    TextureAtlas::Region m_wallRightTexture; // Новая текстура для правой грани стены
 };
\ No newline at end of file
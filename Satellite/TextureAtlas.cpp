@@ -0,0 +1,307 @@
+﻿#include "TextureAtlas.h"
+#include "Logger.h"
+#include <algorithm>
+
+TextureAtlas::TextureAtlas(int pageSize, int maxPages, int padding)
+    : m_pageSize(pageSize), m_maxPages(maxPages), m_padding(padding),
+    m_rendererQueried(false), m_targetsSupported(false),
+    m_savedTarget(nullptr), m_savedViewport{ 0, 0, 0, 0 }, m_savedClip{ 0, 0, 0, 0 },
+    m_savedClipEnabled(false) {
+}
+
+TextureAtlas::~TextureAtlas() {
+    releaseTextures();
+}
+
+TextureAtlas::Region TextureAtlas::allocate(SDL_Renderer* renderer, int width, int height) {
+    Region region;
+    if (width <= 0 || height <= 0) {
+        return region;
+    }
+
+    queryRenderer(renderer);
+
+    int paddedWidth = width + m_padding;
+    int paddedHeight = height + m_padding;
+    if (paddedWidth > m_pageSize || paddedHeight > m_pageSize) {
+        return region;
+    }
+
+    // 1. Пробуем уже созданные страницы по порядку
+    int x = 0, y = 0;
+    for (size_t i = 0; i < m_pages.size(); ++i) {
+        if (pack(m_pages[i], paddedWidth, paddedHeight, x, y)) {
+            region.page = static_cast<int>(i);
+            region.rect = { x, y, width, height };
+            return region;
+        }
+    }
+
+    // 2. Места нет - открываем новую страницу
+    if (static_cast<int>(m_pages.size()) >= m_maxPages || !addPage(renderer)) {
+        return region;
+    }
+
+    if (pack(m_pages.back(), paddedWidth, paddedHeight, x, y)) {
+        region.page = static_cast<int>(m_pages.size()) - 1;
+        region.rect = { x, y, width, height };
+    }
+    return region;
+}
+
+TextureAtlas::Region TextureAtlas::addSurface(SDL_Renderer* renderer, SDL_Surface* surface) {
+    if (!surface) {
+        return Region();
+    }
+
+    Region region = allocate(renderer, surface->w, surface->h);
+    if (!region.isValid()) {
+        return region;
+    }
+
+    // Страницы хранятся в RGBA8888, поверхность приводится к тому же формату
+    SDL_Surface* converted = surface;
+    if (surface->format->format != SDL_PIXELFORMAT_RGBA8888) {
+        converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA8888, 0);
+        if (!converted) {
+            LOG_WARNING("Failed to convert surface for texture atlas: " + std::string(SDL_GetError()));
+            return Region();
+        }
+    }
+
+    if (SDL_UpdateTexture(m_pages[region.page].texture, &region.rect, converted->pixels, converted->pitch) != 0) {
+        LOG_WARNING("Failed to upload surface to texture atlas: " + std::string(SDL_GetError()));
+        region = Region();
+    }
+
+    if (converted != surface) {
+        SDL_FreeSurface(converted);
+    }
+    return region;
+}
+
+TextureAtlas::Region TextureAtlas::addTexture(SDL_Renderer* renderer, SDL_Texture* texture) {
+    int width = 0, height = 0;
+    if (!texture || SDL_QueryTexture(texture, nullptr, nullptr, &width, &height) != 0) {
+        return Region();
+    }
+
+    queryRenderer(renderer);
+    if (!m_targetsSupported) {
+        return Region();
+    }
+
+    Region region = allocate(renderer, width, height);
+    if (!region.isValid() || !beginRender(renderer, region)) {
+        return Region();
+    }
+
+    // Копируем без смешивания, чтобы прозрачность исходной текстуры сохранилась как есть
+    SDL_BlendMode previousBlendMode;
+    SDL_GetTextureBlendMode(texture, &previousBlendMode);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    SDL_SetTextureBlendMode(texture, previousBlendMode);
+
+    endRender(renderer);
+    return region;
+}
+
+bool TextureAtlas::beginRender(SDL_Renderer* renderer, const Region& region) {
+    queryRenderer(renderer);
+    if (!m_targetsSupported || !region.isValid() || region.page >= static_cast<int>(m_pages.size())) {
+        return false;
+    }
+
+    m_savedTarget = SDL_GetRenderTarget(renderer);
+    SDL_RenderGetViewport(renderer, &m_savedViewport);
+    m_savedClipEnabled = SDL_RenderIsClipEnabled(renderer) == SDL_TRUE;
+    SDL_RenderGetClipRect(renderer, &m_savedClip);
+
+    if (SDL_SetRenderTarget(renderer, m_pages[region.page].texture) != 0) {
+        return false;
+    }
+
+    SDL_RenderSetViewport(renderer, &region.rect);
+    SDL_Rect clip = { 0, 0, region.rect.w, region.rect.h };
+    SDL_RenderSetClipRect(renderer, &clip);
+    return true;
+}
+
+void TextureAtlas::endRender(SDL_Renderer* renderer) {
+    SDL_SetRenderTarget(renderer, m_savedTarget);
+    SDL_RenderSetViewport(renderer, &m_savedViewport);
+    SDL_RenderSetClipRect(renderer, m_savedClipEnabled ? &m_savedClip : nullptr);
+    m_savedTarget = nullptr;
+}
+
+SDL_Texture* TextureAtlas::getPageTexture(int page) const {
+    if (page < 0 || page >= static_cast<int>(m_pages.size())) {
+        return nullptr;
+    }
+    return m_pages[page].texture;
+}
+
+bool TextureAtlas::supportsRendering(SDL_Renderer* renderer) {
+    queryRenderer(renderer);
+    return m_targetsSupported;
+}
+
+void TextureAtlas::clear(SDL_Renderer* renderer) {
+    SDL_Texture* previousTarget = m_targetsSupported ? SDL_GetRenderTarget(renderer) : nullptr;
+    SDL_Rect previousViewport;
+    SDL_RenderGetViewport(renderer, &previousViewport);
+
+    for (Page& page : m_pages) {
+        page.skyline.assign(1, SkylineNode{ 0, 0, m_pageSize });
+
+        // Статические страницы не очищаются: каждая новая область перезаписывается целиком
+        if (m_targetsSupported && SDL_SetRenderTarget(renderer, page.texture) == 0) {
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+            SDL_RenderClear(renderer);
+        }
+    }
+
+    if (m_targetsSupported && !m_pages.empty()) {
+        SDL_SetRenderTarget(renderer, previousTarget);
+        SDL_RenderSetViewport(renderer, &previousViewport);
+    }
+}
+
+void TextureAtlas::releaseTextures() {
+    for (Page& page : m_pages) {
+        if (page.texture) {
+            SDL_DestroyTexture(page.texture);
+        }
+    }
+    m_pages.clear();
+
+    // После сброса устройства возможности рендерера запрашиваются заново
+    m_rendererQueried = false;
+}
+
+void TextureAtlas::queryRenderer(SDL_Renderer* renderer) {
+    if (m_rendererQueried) {
+        return;
+    }
+    m_rendererQueried = true;
+
+    m_targetsSupported = SDL_RenderTargetSupported(renderer) == SDL_TRUE;
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        if (info.max_texture_width > 0) m_pageSize = std::min(m_pageSize, info.max_texture_width);
+        if (info.max_texture_height > 0) m_pageSize = std::min(m_pageSize, info.max_texture_height);
+    }
+}
+
+bool TextureAtlas::addPage(SDL_Renderer* renderer) {
+    Page page;
+    page.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+        m_targetsSupported ? SDL_TEXTUREACCESS_TARGET : SDL_TEXTUREACCESS_STATIC,
+        m_pageSize, m_pageSize);
+    if (!page.texture) {
+        LOG_WARNING("Failed to create texture atlas page: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    SDL_SetTextureBlendMode(page.texture, SDL_BLENDMODE_BLEND);
+    page.skyline.push_back(SkylineNode{ 0, 0, m_pageSize });
+    m_pages.push_back(page);
+
+    // Новая текстура-цель может содержать мусор - очищаем до прозрачного
+    if (m_targetsSupported) {
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+        SDL_Rect previousViewport;
+        SDL_RenderGetViewport(renderer, &previousViewport);
+
+        if (SDL_SetRenderTarget(renderer, page.texture) == 0) {
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+            SDL_RenderClear(renderer);
+        }
+
+        SDL_SetRenderTarget(renderer, previousTarget);
+        SDL_RenderSetViewport(renderer, &previousViewport);
+    }
+    return true;
+}
+
+bool TextureAtlas::pack(Page& page, int width, int height, int& x, int& y) const {
+    // 1. Выбираем отрезок, на котором низ области окажется выше всего (при равенстве - самый узкий)
+    int bestIndex = -1;
+    int bestBottom = 0;
+    int bestWidth = 0;
+
+    for (size_t i = 0; i < page.skyline.size(); ++i) {
+        int top = fitHeight(page, i, width, height);
+        if (top < 0) {
+            continue;
+        }
+
+        int bottom = top + height;
+        if (bestIndex < 0 || bottom < bestBottom ||
+            (bottom == bestBottom && page.skyline[i].width < bestWidth)) {
+            bestIndex = static_cast<int>(i);
+            bestBottom = bottom;
+            bestWidth = page.skyline[i].width;
+            x = page.skyline[i].x;
+            y = top;
+        }
+    }
+
+    if (bestIndex < 0) {
+        return false;
+    }
+
+    // 2. Вставляем новый отрезок над областью и подрезаем перекрытые им
+    SkylineNode node = { x, y + height, width };
+    page.skyline.insert(page.skyline.begin() + bestIndex, node);
+
+    for (size_t i = bestIndex + 1; i < page.skyline.size();) {
+        SkylineNode& current = page.skyline[i];
+        const SkylineNode& previous = page.skyline[i - 1];
+        int previousEnd = previous.x + previous.width;
+        if (current.x >= previousEnd) {
+            break;
+        }
+
+        int shrink = previousEnd - current.x;
+        current.x += shrink;
+        current.width -= shrink;
+        if (current.width > 0) {
+            break;
+        }
+        page.skyline.erase(page.skyline.begin() + i);
+    }
+
+    // 3. Объединяем соседние отрезки одинаковой высоты
+    for (size_t i = 0; i + 1 < page.skyline.size();) {
+        if (page.skyline[i].y == page.skyline[i + 1].y) {
+            page.skyline[i].width += page.skyline[i + 1].width;
+            page.skyline.erase(page.skyline.begin() + i + 1);
+        }
+        else {
+            ++i;
+        }
+    }
+    return true;
+}
+
+int TextureAtlas::fitHeight(const Page& page, size_t nodeIndex, int width, int height) const {
+    int x = page.skyline[nodeIndex].x;
+    if (x + width > m_pageSize) {
+        return -1;
+    }
+
+    // Область ложится на самый высокий из отрезков, которые она накрывает
+    int top = 0;
+    int remaining = width;
+    for (size_t i = nodeIndex; i < page.skyline.size() && remaining > 0; ++i) {
+        top = std::max(top, page.skyline[i].y);
+        if (top + height > m_pageSize) {
+            return -1;
+        }
+        remaining -= page.skyline[i].width;
+    }
+    return top;
+}
@@ -0,0 +1,202 @@
+﻿#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+/**
+ * @brief Атлас текстур: несколько больших страниц с упаковкой по линии горизонта
+ *
+ * Изображения и производные текстуры размещаются в общих страницах, а
+ * вызывающий код получает дескриптор Region (страница и прямоугольник).
+ * Все области одной страницы выводятся без переключения текстуры, что
+ * позволяет объединять их отрисовку в пакеты.
+ *
+ * Упаковка - skyline bottom-left: для каждой страницы хранится ломаная
+ * верхней границы занятой части, новая область ставится туда, где ее
+ * низ окажется выше всего. Освободить отдельную область нельзя, атлас
+ * очищается только целиком (clear).
+ */
+class TextureAtlas {
+public:
+    static constexpr int DEFAULT_PAGE_SIZE = 2048;  ///< Сторона страницы по умолчанию
+    static constexpr int DEFAULT_MAX_PAGES = 4;     ///< Максимальное количество страниц по умолчанию
+
+    /**
+     * @brief Дескриптор области атласа
+     */
+    struct Region {
+        int page = -1;                ///< Номер страницы (-1 - область не выделена)
+        SDL_Rect rect = { 0, 0, 0, 0 }; ///< Прямоугольник на странице
+
+        /**
+         * @brief Проверка, выделена ли область
+         * @return true, если область принадлежит странице атласа
+         */
+        bool isValid() const { return page >= 0; }
+    };
+
+    /**
+     * @brief Конструктор
+     * @param pageSize Желаемая сторона страницы (уменьшается до ограничений рендерера)
+     * @param maxPages Максимальное количество страниц
+     * @param padding Зазор между областями в пикселях (защита от просачивания при фильтрации)
+     */
+    TextureAtlas(int pageSize = DEFAULT_PAGE_SIZE, int maxPages = DEFAULT_MAX_PAGES, int padding = 1);
+
+    /**
+     * @brief Деструктор (освобождает страницы)
+     */
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    /**
+     * @brief Выделение области без заполнения
+     *
+     * При нехватке места создается новая страница (до maxPages).
+     *
+     * @param renderer SDL рендерер
+     * @param width Ширина области
+     * @param height Высота области
+     * @return Дескриптор области (невалидный, если места нет)
+     */
+    Region allocate(SDL_Renderer* renderer, int width, int height);
+
+    /**
+     * @brief Размещение изображения в атласе
+     * @param renderer SDL рендерер
+     * @param surface Исходная поверхность (не освобождается)
+     * @return Дескриптор области (невалидный при ошибке)
+     */
+    Region addSurface(SDL_Renderer* renderer, SDL_Surface* surface);
+
+    /**
+     * @brief Копирование существующей текстуры в атлас
+     *
+     * Требует поддержки текстур-целей.
+     *
+     * @param renderer SDL рендерер
+     * @param texture Исходная текстура
+     * @return Дескриптор области (невалидный при ошибке)
+     */
+    Region addTexture(SDL_Renderer* renderer, SDL_Texture* texture);
+
+    /**
+     * @brief Перенаправление вывода в область атласа
+     *
+     * Область вывода и отсечение ограничиваются прямоугольником области,
+     * координаты отсчитываются от его левого верхнего угла. Каждому успешному
+     * вызову должен соответствовать endRender.
+     *
+     * @param renderer SDL рендерер
+     * @param region Область атласа
+     * @return true, если вывод перенаправлен
+     */
+    bool beginRender(SDL_Renderer* renderer, const Region& region);
+
+    /**
+     * @brief Восстановление цели вывода после beginRender
+     * @param renderer SDL рендерер
+     */
+    void endRender(SDL_Renderer* renderer);
+
+    /**
+     * @brief Получение текстуры страницы
+     * @param page Номер страницы
+     * @return Текстура или nullptr
+     */
+    SDL_Texture* getPageTexture(int page) const;
+
+    /**
+     * @brief Получение количества созданных страниц
+     * @return Количество страниц
+     */
+    int getPageCount() const { return static_cast<int>(m_pages.size()); }
+
+    /**
+     * @brief Проверка, можно ли рисовать в атлас (beginRender)
+     * @param renderer SDL рендерер
+     * @return true, если рендерер поддерживает текстуры-цели
+     */
+    bool supportsRendering(SDL_Renderer* renderer);
+
+    /**
+     * @brief Освобождение всех областей с сохранением страниц
+     *
+     * Страницы очищаются до прозрачного цвета, все выданные дескрипторы
+     * становятся недействительными.
+     *
+     * @param renderer SDL рендерер
+     */
+    void clear(SDL_Renderer* renderer);
+
+    /**
+     * @brief Уничтожение всех страниц (например, после сброса устройства)
+     */
+    void releaseTextures();
+
+private:
+    /**
+     * @brief Отрезок линии горизонта
+     */
+    struct SkylineNode {
+        int x;      ///< Левая граница отрезка
+        int y;      ///< Высота занятой части под отрезком
+        int width;  ///< Ширина отрезка
+    };
+
+    /**
+     * @brief Страница атласа
+     */
+    struct Page {
+        SDL_Texture* texture = nullptr;    ///< Текстура страницы
+        std::vector<SkylineNode> skyline;  ///< Линия горизонта (отрезки слева направо)
+    };
+
+    /**
+     * @brief Однократный запрос ограничений рендерера
+     * @param renderer SDL рендерер
+     */
+    void queryRenderer(SDL_Renderer* renderer);
+
+    /**
+     * @brief Создание новой страницы
+     * @param renderer SDL рендерер
+     * @return true в случае успеха
+     */
+    bool addPage(SDL_Renderer* renderer);
+
+    /**
+     * @brief Поиск места на странице и обновление линии горизонта
+     * @param page Страница
+     * @param width Ширина с учетом зазора
+     * @param height Высота с учетом зазора
+     * @param x Левая граница найденного места (выходной параметр)
+     * @param y Верхняя граница найденного места (выходной параметр)
+     * @return true, если место найдено
+     */
+    bool pack(Page& page, int width, int height, int& x, int& y) const;
+
+    /**
+     * @brief Высота, на которую встанет область, начиная с отрезка nodeIndex
+     * @param page Страница
+     * @param nodeIndex Индекс первого отрезка
+     * @param width Ширина области
+     * @param height Высота области
+     * @return Верх области или -1, если область не помещается
+     */
+    int fitHeight(const Page& page, size_t nodeIndex, int width, int height) const;
+
+    std::vector<Page> m_pages;   ///< Страницы атласа
+    int m_pageSize;              ///< Сторона страницы
+    int m_maxPages;              ///< Максимальное количество страниц
+    int m_padding;               ///< Зазор между областями
+    bool m_rendererQueried;      ///< Ограничения рендерера уже получены
+    bool m_targetsSupported;     ///< Рендерер поддерживает текстуры-цели
+
+    SDL_Texture* m_savedTarget;  ///< Цель вывода до beginRender
+    SDL_Rect m_savedViewport;    ///< Область вывода до beginRender
+    SDL_Rect m_savedClip;        ///< Прямоугольник отсечения до beginRender
+    bool m_savedClipEnabled;     ///< Было ли включено отсечение до beginRender
+};
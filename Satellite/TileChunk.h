@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+
+/**
+ * @brief Значения одного тайла в упакованном виде
+ *
+ * Этим же значением хранится однородный чанк, все тайлы которого одинаковы.
+ */
+struct TileCell {
+    Uint8 type = 0;      ///< Тип тайла (значение TileType)
+    Uint8 flags = 0;     ///< Флаги тайла (TileMap::FLAG_*)
+    Uint8 height = 0;    ///< Высота в 1/TileMap::HEIGHT_SCALE
+
+    bool operator==(const TileCell& other) const {
+        return type == other.type && flags == other.flags && height == other.height;
+    }
+
+    bool operator!=(const TileCell& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Квадратный фрагмент карты тайлов в виде структуры массивов
+ *
+ * Тайлы лежат построчно: индекс ячейки - (y & MASK) * SIZE + (x & MASK),
+ * поэтому по мировым координатам ячейка находится без деления.
+ */
+struct TileChunk {
+    static constexpr int SHIFT = 5;              ///< log2 стороны чанка
+    static constexpr int SIZE = 1 << SHIFT;      ///< Сторона чанка в тайлах
+    static constexpr int MASK = SIZE - 1;        ///< Маска координаты внутри чанка
+    static constexpr int AREA = SIZE * SIZE;     ///< Количество тайлов в чанке
+
+    Uint8 types[AREA];     ///< Типы тайлов
+    Uint8 flags[AREA];     ///< Флаги тайлов
+    Uint8 heights[AREA];   ///< Высоты тайлов
+
+    /**
+     * @brief Индекс ячейки по координатам тайла
+     * @param x X координата тайла (мировая или внутри чанка)
+     * @param y Y координата тайла (мировая или внутри чанка)
+     * @return Индекс в массивах чанка
+     */
+    static int getCellIndex(int x, int y) { return ((y & MASK) << SHIFT) | (x & MASK); }
+
+    /**
+     * @brief Заполнение чанка одним значением
+     * @param cell Значение тайлов
+     */
+    void fill(const TileCell& cell) {
+        std::fill(types, types + AREA, cell.type);
+        std::fill(flags, flags + AREA, cell.flags);
+        std::fill(heights, heights + AREA, cell.height);
+    }
+
+    /**
+     * @brief Получение значения ячейки
+     * @param index Индекс ячейки
+     * @return Значения тайла
+     */
+    TileCell getCell(int index) const {
+        TileCell cell;
+        cell.type = types[index];
+        cell.flags = flags[index];
+        cell.height = heights[index];
+        return cell;
+    }
+
+    /**
+     * @brief Запись значения ячейки
+     * @param index Индекс ячейки
+     * @param cell Значения тайла
+     */
+    void setCell(int index, const TileCell& cell) {
+        types[index] = cell.type;
+        flags[index] = cell.flags;
+        heights[index] = cell.height;
+    }
+
+    /**
+     * @brief Проверка, одинаковы ли все тайлы чанка
+     * @param cell Значение тайлов однородного чанка (выходной параметр)
+     * @return true, если чанк однороден
+     */
+    bool isUniform(TileCell& cell) const {
+        cell = getCell(0);
+        for (int i = 1; i < AREA; ++i) {
+            if (types[i] != cell.type || flags[i] != cell.flags || heights[i] != cell.height) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
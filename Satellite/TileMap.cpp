@@ -1,8 +1,11 @@
 ﻿#include "TileMap.h"
+#include "LevelFile.h"
+#include "TileMapSnapshot.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 
 TileMap::TileMap(int width, int height)
     : m_width(width), m_height(height) {
@@ -14,79 +17,306 @@ TileMap::~TileMap() {
 }
 
 bool TileMap::initialize() {
-    // Изменяем размер внешнего вектора
-    m_tiles.resize(m_height);
+    if (m_width <= 0 || m_height <= 0 || m_width > MAX_DIMENSION || m_height > MAX_DIMENSION) {
+        std::cerr << "Invalid map dimensions: " << m_width << "x" << m_height << std::endl;
+        m_width = 0;
+        m_height = 0;
+        m_chunkCountX = 0;
+        m_chunkCountY = 0;
+        m_allocatedChunkCount = 0;
+        m_chunks.clear();
+        return false;
+    }
 
-    // Инициализируем каждую строку карты
-    for (int y = 0; y < m_height; ++y) {
-        // Изменяем размер внутреннего вектора (строки)
-        m_tiles[y].resize(m_width);
+    // Все чанки однородно пустые, память под тайлы выделяется при записи
+    m_chunkCountX = (m_width + TileChunk::MASK) >> TileChunk::SHIFT;
+    m_chunkCountY = (m_height + TileChunk::MASK) >> TileChunk::SHIFT;
+    m_chunks.clear();
+    m_chunks.resize(static_cast<size_t>(m_chunkCountX) * m_chunkCountY);
 
-        // Инициализируем каждый тайл в строке
-        for (int x = 0; x < m_width; ++x) {
-            m_tiles[y][x] = MapTile(TileType::EMPTY);
-        }
+    TileCell empty = makeCell(TileType::EMPTY);
+    for (ChunkSlot& slot : m_chunks) {
+        slot.uniform = empty;
     }
+    m_allocatedChunkCount = 0;
 
+    notifyAllChanged();
     return true;
 }
 
-bool TileMap::isValidCoordinate(int x, int y) const {
-    return (x >= 0 && x < m_width && y >= 0 && y < m_height);
-}
-
-MapTile* TileMap::getTile(int x, int y) {
+MapTile TileMap::getTile(int x, int y) {
     if (!isValidCoordinate(x, y)) {
-        return nullptr;
+        return MapTile();
     }
 
-    return &m_tiles[y][x];
+    return MapTile(this, x, y);
 }
 
-const MapTile* TileMap::getTile(int x, int y) const {
+const MapTile TileMap::getTile(int x, int y) const {
     if (!isValidCoordinate(x, y)) {
-        return nullptr;
+        return MapTile();
     }
 
-    return &m_tiles[y][x];
+    // Вид константный, поэтому изменить карту через него нельзя
+    return MapTile(const_cast<TileMap*>(this), x, y);
 }
 
 bool TileMap::setTileType(int x, int y, TileType type) {
-    if (!isValidCoordinate(x, y)) {
+    // Запись в выгруженный чанк пропала бы при его загрузке
+    if (!isTileResident(x, y)) {
         return false;
     }
 
-    m_tiles[y][x].setType(type);
+    writeCell(x, y, makeCell(type));
+    notifyChanged(x, y, x, y);
     return true;
 }
 
 bool TileMap::setTileWalkable(int x, int y, bool walkable) {
-    if (!isValidCoordinate(x, y)) {
+    if (!isTileResident(x, y)) {
         return false;
     }
 
-    m_tiles[y][x].setWalkable(walkable);
+    TileCell cell = readCell(x, y);
+    cell.flags = walkable ? (cell.flags | FLAG_WALKABLE) : (cell.flags & ~FLAG_WALKABLE);
+    writeCell(x, y, cell);
+    notifyChanged(x, y, x, y);
     return true;
 }
 
 bool TileMap::setTileTransparent(int x, int y, bool transparent) {
-    if (!isValidCoordinate(x, y)) {
+    if (!isTileResident(x, y)) {
         return false;
     }
 
-    m_tiles[y][x].setTransparent(transparent);
+    TileCell cell = readCell(x, y);
+    cell.flags = transparent ? (cell.flags | FLAG_TRANSPARENT) : (cell.flags & ~FLAG_TRANSPARENT);
+    writeCell(x, y, cell);
+    notifyChanged(x, y, x, y);
     return true;
 }
 
 bool TileMap::setTileHeight(int x, int y, float height) {
-    if (!isValidCoordinate(x, y)) {
+    if (!isTileResident(x, y)) {
+        return false;
+    }
+
+    TileCell cell = readCell(x, y);
+    cell.height = quantizeHeight(height);
+    writeCell(x, y, cell);
+    notifyChanged(x, y, x, y);
+    return true;
+}
+
+void TileMap::writeCell(int x, int y, const TileCell& cell) {
+    ChunkSlot& slot = m_chunks[static_cast<size_t>(y >> TileChunk::SHIFT) * m_chunkCountX + (x >> TileChunk::SHIFT)];
+    if (!slot.tiles && slot.uniform == cell) {
+        return;
+    }
+
+    materialize(slot).setCell(TileChunk::getCellIndex(x, y), cell);
+}
+
+TileChunk& TileMap::materialize(ChunkSlot& slot) {
+    if (!slot.tiles) {
+        slot.tiles = std::make_unique<TileChunk>();
+        slot.tiles->fill(slot.uniform);
+        m_allocatedChunkCount++;
+    }
+    return *slot.tiles;
+}
+
+bool TileMap::copyChunk(int chunkX, int chunkY, TileChunk& chunk) const {
+    if (!isValidChunk(chunkX, chunkY)) {
+        return false;
+    }
+
+    const ChunkSlot& slot = m_chunks[static_cast<size_t>(chunkY) * m_chunkCountX + chunkX];
+    if (!slot.resident) {
+        return false;
+    }
+
+    if (slot.tiles) {
+        chunk = *slot.tiles;
+    }
+    else {
+        chunk.fill(slot.uniform);
+    }
+    return true;
+}
+
+bool TileMap::replaceChunk(int chunkX, int chunkY, std::unique_ptr<TileChunk> chunk) {
+    if (!isValidChunk(chunkX, chunkY) || !chunk) {
+        return false;
+    }
+
+    ChunkSlot& slot = m_chunks[static_cast<size_t>(chunkY) * m_chunkCountX + chunkX];
+    if (slot.tiles) {
+        m_allocatedChunkCount--;
+    }
+
+    TileCell cell;
+    if (chunk->isUniform(cell)) {
+        slot.tiles.reset();
+        slot.uniform = cell;
+    }
+    else {
+        slot.tiles = std::move(chunk);
+        m_allocatedChunkCount++;
+    }
+    slot.resident = true;
+
+    notifyChunkChanged(chunkX, chunkY);
+    return true;
+}
+
+bool TileMap::resetChunk(int chunkX, int chunkY, TileType type) {
+    if (!isValidChunk(chunkX, chunkY)) {
+        return false;
+    }
+
+    ChunkSlot& slot = m_chunks[static_cast<size_t>(chunkY) * m_chunkCountX + chunkX];
+    if (slot.tiles) {
+        slot.tiles.reset();
+        m_allocatedChunkCount--;
+    }
+    slot.uniform = makeCell(type);
+    slot.resident = true;
+
+    notifyChunkChanged(chunkX, chunkY);
+    return true;
+}
+
+bool TileMap::evictChunk(int chunkX, int chunkY) {
+    if (!isValidChunk(chunkX, chunkY)) {
         return false;
     }
 
-    m_tiles[y][x].setHeight(height);
+    ChunkSlot& slot = m_chunks[static_cast<size_t>(chunkY) * m_chunkCountX + chunkX];
+    if (slot.tiles) {
+        slot.tiles.reset();
+        m_allocatedChunkCount--;
+    }
+
+    // Пустота без флагов: сквозь выгруженный чанк не видно и не пройти
+    slot.uniform.type = static_cast<Uint8>(TileType::EMPTY);
+    slot.uniform.flags = 0;
+    slot.uniform.height = 0;
+    slot.resident = false;
+
+    notifyChunkChanged(chunkX, chunkY);
+    return true;
+}
+
+bool TileMap::hasResidentChunk(int minX, int minY, int maxX, int maxY) const {
+    int firstChunkX = std::max(0, minX >> TileChunk::SHIFT);
+    int firstChunkY = std::max(0, minY >> TileChunk::SHIFT);
+    int lastChunkX = std::min(m_chunkCountX - 1, maxX >> TileChunk::SHIFT);
+    int lastChunkY = std::min(m_chunkCountY - 1, maxY >> TileChunk::SHIFT);
+
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            if (m_chunks[static_cast<size_t>(chunkY) * m_chunkCountX + chunkX].resident) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TileMap::isAreaResident(int minX, int minY, int maxX, int maxY) const {
+    int firstChunkX = std::max(0, minX >> TileChunk::SHIFT);
+    int firstChunkY = std::max(0, minY >> TileChunk::SHIFT);
+    int lastChunkX = std::min(m_chunkCountX - 1, maxX >> TileChunk::SHIFT);
+    int lastChunkY = std::min(m_chunkCountY - 1, maxY >> TileChunk::SHIFT);
+
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            if (!m_chunks[static_cast<size_t>(chunkY) * m_chunkCountX + chunkX].resident) {
+                return false;
+            }
+        }
+    }
     return true;
 }
 
+int TileMap::compact() {
+    int released = 0;
+    for (ChunkSlot& slot : m_chunks) {
+        TileCell cell;
+        if (slot.tiles && slot.tiles->isUniform(cell)) {
+            slot.tiles.reset();
+            slot.uniform = cell;
+            released++;
+        }
+    }
+
+    m_allocatedChunkCount -= released;
+    return released;
+}
+
+float TileMap::getMaxTileHeight() const {
+    Uint8 maxHeight = 0;
+    for (const ChunkSlot& slot : m_chunks) {
+        if (slot.tiles) {
+            maxHeight = std::max(maxHeight, *std::max_element(slot.tiles->heights, slot.tiles->heights + TileChunk::AREA));
+        }
+        else {
+            maxHeight = std::max(maxHeight, slot.uniform.height);
+        }
+    }
+    return maxHeight / HEIGHT_SCALE;
+}
+
+float TileMap::getMaxTileHeight(int minX, int minY, int maxX, int maxY) const {
+    minX = std::max(0, minX);
+    minY = std::max(0, minY);
+    maxX = std::min(m_width - 1, maxX);
+    maxY = std::min(m_height - 1, maxY);
+    if (minX > maxX || minY > maxY) {
+        return 0.0f;
+    }
+
+    Uint8 maxHeight = 0;
+    for (int chunkY = minY >> TileChunk::SHIFT; chunkY <= maxY >> TileChunk::SHIFT; ++chunkY) {
+        for (int chunkX = minX >> TileChunk::SHIFT; chunkX <= maxX >> TileChunk::SHIFT; ++chunkX) {
+            const ChunkSlot& slot = m_chunks[static_cast<size_t>(chunkY) * m_chunkCountX + chunkX];
+            if (!slot.tiles) {
+                maxHeight = std::max(maxHeight, slot.uniform.height);
+                continue;
+            }
+
+            // Строки части чанка внутри прямоугольника
+            int left = std::max(minX, chunkX << TileChunk::SHIFT) & TileChunk::MASK;
+            int right = std::min(maxX, (chunkX << TileChunk::SHIFT) + TileChunk::MASK) & TileChunk::MASK;
+            int top = std::max(minY, chunkY << TileChunk::SHIFT);
+            int bottom = std::min(maxY, (chunkY << TileChunk::SHIFT) + TileChunk::MASK);
+            for (int y = top; y <= bottom; ++y) {
+                const Uint8* row = slot.tiles->heights + TileChunk::getCellIndex(0, y);
+                maxHeight = std::max(maxHeight, *std::max_element(row + left, row + right + 1));
+            }
+        }
+    }
+    return maxHeight / HEIGHT_SCALE;
+}
+
+TileCell TileMap::makeCell(TileType type) {
+    TileCell cell;
+    cell.type = static_cast<Uint8>(type);
+    cell.flags = getDefaultFlags(type);
+    cell.height = quantizeHeight(GetDefaultHeight(type));
+    return cell;
+}
+
+Uint8 TileMap::quantizeHeight(float height) {
+    float scaled = std::round(height * HEIGHT_SCALE);
+    return static_cast<Uint8>(std::max(0.0f, std::min(255.0f, scaled)));
+}
+
+Uint8 TileMap::getDefaultFlags(TileType type) {
+    return (IsWalkable(type) ? FLAG_WALKABLE : 0) | (IsTransparent(type) ? FLAG_TRANSPARENT : 0);
+}
+
 void TileMap::fillRect(int startX, int startY, int endX, int endY, TileType type) {
     // Нормализуем координаты (убеждаемся, что startX <= endX и startY <= endY)
     if (startX > endX) std::swap(startX, endX);
@@ -98,12 +328,47 @@ void TileMap::fillRect(int startX, int startY, int endX, int endY, TileType type
     endX = std::min(m_width - 1, endX);
     endY = std::min(m_height - 1, endY);
 
-    // Заполняем прямоугольник
-    for (int y = startY; y <= endY; ++y) {
-        for (int x = startX; x <= endX; ++x) {
-            setTileType(x, y, type);
+    if (startX > endX || startY > endY) {
+        return;
+    }
+
+    // Чанки, накрытые прямоугольником целиком, становятся однородными без выделения памяти
+    TileCell cell = makeCell(type);
+    for (int chunkY = startY >> TileChunk::SHIFT; chunkY <= endY >> TileChunk::SHIFT; ++chunkY) {
+        for (int chunkX = startX >> TileChunk::SHIFT; chunkX <= endX >> TileChunk::SHIFT; ++chunkX) {
+            int chunkLeft = chunkX << TileChunk::SHIFT;
+            int chunkTop = chunkY << TileChunk::SHIFT;
+            int left = std::max(startX, chunkLeft);
+            int top = std::max(startY, chunkTop);
+            int right = std::min(endX, chunkLeft + TileChunk::MASK);
+            int bottom = std::min(endY, chunkTop + TileChunk::MASK);
+
+            // Ячейки крайних чанков за границей карты не читаются, их можно не учитывать
+            ChunkSlot& slot = m_chunks[static_cast<size_t>(chunkY) * m_chunkCountX + chunkX];
+            if (!slot.resident) {
+                continue;
+            }
+
+            if (left == chunkLeft && top == chunkTop &&
+                right == std::min(m_width - 1, chunkLeft + TileChunk::MASK) &&
+                bottom == std::min(m_height - 1, chunkTop + TileChunk::MASK)) {
+                if (slot.tiles) {
+                    slot.tiles.reset();
+                    m_allocatedChunkCount--;
+                }
+                slot.uniform = cell;
+                continue;
+            }
+
+            for (int y = top; y <= bottom; ++y) {
+                for (int x = left; x <= right; ++x) {
+                    writeCell(x, y, cell);
+                }
+            }
         }
     }
+
+    notifyChanged(startX, startY, endX, endY);
 }
 
 void TileMap::createRoom(int startX, int startY, int endX, int endY, TileType floorType, TileType wallType) {
@@ -174,68 +439,83 @@ void TileMap::createDoor(int x, int y, TileType doorType) {
     }
 }
 
-bool TileMap::isTileWalkable(int x, int y) const {
-    const MapTile* tile = getTile(x, y);
-    if (!tile) {
-        return false; // Если координаты за пределами карты, считаем тайл непроходимым
+void TileMap::clear() {
+    // Очищаем карту: все чанки снова однородно пустые
+    TileCell empty = makeCell(TileType::EMPTY);
+    for (ChunkSlot& slot : m_chunks) {
+        slot.tiles.reset();
+        slot.uniform = empty;
+        slot.resident = true;
     }
+    m_allocatedChunkCount = 0;
+
+    notifyAllChanged();
+}
 
-    return tile->isWalkable();
+bool TileMap::saveToFile(const std::string& filename) const {
+    return LevelFile::save(filename, *this);
 }
 
-bool TileMap::isTileTransparent(int x, int y) const {
-    const MapTile* tile = getTile(x, y);
-    if (!tile) {
-        return true; // Если координаты за пределами карты, считаем тайл прозрачным
+bool TileMap::loadFromFile(const std::string& filename) {
+    if (!LevelFile::hasSignature(filename)) {
+        return loadLegacyFile(filename);
     }
 
-    return tile->isTransparent();
+    LevelFile level;
+    return level.open(filename) && loadFromLevel(level);
 }
 
-void TileMap::clear() {
-    // Очищаем карту, заполняя ее пустыми тайлами
-    for (int y = 0; y < m_height; ++y) {
-        for (int x = 0; x < m_width; ++x) {
-            m_tiles[y][x] = MapTile(TileType::EMPTY);
-        }
+bool TileMap::loadFromLevel(const LevelFile& level) {
+    if (!level.isOpen()) {
+        return false;
     }
+
+    // Размеры карты уже проверены при открытии файла
+    const LevelFileHeader& header = level.getHeader();
+    return loadChunks(static_cast<int>(header.width), static_cast<int>(header.height), level);
 }
 
-bool TileMap::saveToFile(const std::string& filename) const {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file for writing: " << filename << std::endl;
+bool TileMap::loadFromSnapshot(const TileMapSnapshot& snapshot) {
+    return loadChunks(snapshot.getWidth(), snapshot.getHeight(), snapshot);
+}
+
+template <typename ChunkSource>
+bool TileMap::loadChunks(int width, int height, const ChunkSource& source) {
+    // 1. Все чанки однородно пустые
+    m_width = width;
+    m_height = height;
+    if (!initialize()) {
         return false;
     }
 
-    // Записываем размеры карты
-    file.write(reinterpret_cast<const char*>(&m_width), sizeof(m_width));
-    file.write(reinterpret_cast<const char*>(&m_height), sizeof(m_height));
-
-    // Записываем тайлы
-    for (int y = 0; y < m_height; ++y) {
-        for (int x = 0; x < m_width; ++x) {
-            const MapTile& tile = m_tiles[y][x];
-
-            // Записываем тип тайла
-            TileType type = tile.getType();
-            file.write(reinterpret_cast<const char*>(&type), sizeof(type));
-
-            // Записываем свойства тайла
-            bool walkable = tile.isWalkable();
-            bool transparent = tile.isTransparent();
-            float height = tile.getHeight();
-            file.write(reinterpret_cast<const char*>(&walkable), sizeof(walkable));
-            file.write(reinterpret_cast<const char*>(&transparent), sizeof(transparent));
-            file.write(reinterpret_cast<const char*>(&height), sizeof(height));
+    // 2. Однородные чанки - одно значение из индекса, остальные копируются целиком
+    int chunkCount = m_chunkCountX * m_chunkCountY;
+    bool loaded = true;
+    for (int chunkIndex = 0; chunkIndex < chunkCount && loaded; ++chunkIndex) {
+        const LevelChunkEntry& entry = source.getChunkEntry(chunkIndex);
+        ChunkSlot& slot = m_chunks[chunkIndex];
+        if (entry.dataIndex == LevelFile::NO_CHUNK_DATA) {
+            slot.uniform.type = entry.type;
+            slot.uniform.flags = entry.flags;
+            slot.uniform.height = entry.height;
+        }
+        else {
+            loaded = source.copyChunk(chunkIndex, materialize(slot));
         }
     }
 
-    file.close();
+    if (!loaded) {
+        std::cerr << "Corrupted chunk data, map cleared" << std::endl;
+        clear();
+        return false;
+    }
+
+    // Тайлы записаны напрямую, минуя сеттеры, поэтому оповещаем о смене всей карты
+    notifyAllChanged();
     return true;
 }
 
-bool TileMap::loadFromFile(const std::string& filename) {
+bool TileMap::loadLegacyFile(const std::string& filename) {
     std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Failed to open file for reading: " << filename << std::endl;
@@ -248,7 +528,7 @@ bool TileMap::loadFromFile(const std::string& filename) {
     file.read(reinterpret_cast<char*>(&height), sizeof(height));
 
     // Проверяем размеры
-    if (width <= 0 || height <= 0 || width > 1000 || height > 1000) {
+    if (width <= 0 || height <= 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
         std::cerr << "Invalid map dimensions: " << width << "x" << height << std::endl;
         file.close();
         return false;
@@ -275,11 +555,47 @@ bool TileMap::loadFromFile(const std::string& filename) {
             file.read(reinterpret_cast<char*>(&height), sizeof(height));
 
             // Устанавливаем свойства тайла
-            MapTile tile(type, walkable, transparent, height);
-            m_tiles[y][x] = tile;
+            TileCell cell;
+            cell.type = static_cast<Uint8>(type);
+            cell.flags = (walkable ? FLAG_WALKABLE : 0) | (transparent ? FLAG_TRANSPARENT : 0);
+            cell.height = quantizeHeight(height);
+            writeCell(x, y, cell);
         }
     }
 
     file.close();
+    compact();
+
+    // Тайлы записаны напрямую, минуя сеттеры, поэтому оповещаем о смене всей карты
+    notifyAllChanged();
     return true;
+}
+
+int TileMap::addChangeListener(ChangeListener listener) {
+    int listenerId = m_nextListenerId++;
+    m_listeners.emplace_back(listenerId, std::move(listener));
+    return listenerId;
+}
+
+void TileMap::removeChangeListener(int listenerId) {
+    m_listeners.erase(
+        std::remove_if(m_listeners.begin(), m_listeners.end(),
+            [listenerId](const std::pair<int, ChangeListener>& entry) {
+                return entry.first == listenerId;
+            }),
+        m_listeners.end());
+}
+
+void TileMap::notifyChanged(int minX, int minY, int maxX, int maxY) {
+    for (auto& entry : m_listeners) {
+        entry.second(minX, minY, maxX, maxY);
+    }
+}
+
+void TileMap::notifyChunkChanged(int chunkX, int chunkY) {
+    int left = chunkX << TileChunk::SHIFT;
+    int top = chunkY << TileChunk::SHIFT;
+    notifyChanged(left, top,
+        std::min(m_width, left + TileChunk::SIZE) - 1,
+        std::min(m_height, top + TileChunk::SIZE) - 1);
 }
\ No newline at end of file
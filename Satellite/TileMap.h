@@ -1,16 +1,57 @@
 ﻿#pragma once
 
 #include "MapTile.h"
+#include "TileChunk.h"
 #include <vector>
 #include <memory>
 #include <string>
 #include <functional>
 
+class LevelFile;
+class TileMapSnapshot;
+
 /**
  * @brief Класс для управления картой из тайлов
+ *
+ * Карта разбита на чанки TileChunk::SIZE x TileChunk::SIZE, каталог
+ * чанков - плоский массив, поэтому доступ к тайлу остается O(1). Чанк,
+ * все тайлы которого одинаковы (пустота, сплошная порода), хранится одним
+ * значением TileCell; память под массивы выделяется при первой записи,
+ * нарушающей однородность, а compact() возвращает такие чанки обратно.
+ * Внутри чанка тайлы хранятся структурой массивов: тип, флаги и высота -
+ * по байту на тайл.
+ *
+ * Обходы сетки (коллизии, отрисовка, генерация) читают значения через
+ * getTileType, getTileFlags и getTileHeight; getTile возвращает вид
+ * MapTile для остального кода. Цвет тайла определяется его типом.
+ *
+ * Чанк может быть выгружен (evictChunk, см. ChunkStreamer): его тайлы
+ * читаются как непрозрачная непроходимая пустота без флагов, а запись
+ * в него отклоняется, пока replaceChunk не вернет настоящее содержимое.
+ * Слушатели отличают выгрузку от изменения по isChunkResident.
  */
 class TileMap {
 public:
+    static constexpr Uint8 FLAG_WALKABLE = 0x01;     ///< Тайл проходим
+    static constexpr Uint8 FLAG_TRANSPARENT = 0x02;  ///< Сквозь тайл видно
+    static constexpr float HEIGHT_SCALE = 100.0f;    ///< Высота хранится в сотых долях (0.00 - 2.55)
+    static constexpr int MAX_DIMENSION = 32768;      ///< Наибольшая ширина и высота карты в тайлах (см. TileRenderer::makeSortKey)
+
+    /**
+     * @brief Слушатель изменений карты
+     *
+     * Вызывается с прямоугольником измененных тайлов (границы включительно):
+     * одним тайлом для сеттеров, прямоугольником для fillRect и чанком при
+     * его замене. Если карта была переинициализирована, очищена или загружена
+     * целиком, все четыре значения равны ALL_TILES.
+     */
+    using ChangeListener = std::function<void(int minX, int minY, int maxX, int maxY)>;
+
+    /**
+     * @brief Значение координат, означающее изменение всей карты
+     */
+    static constexpr int ALL_TILES = -1;
+
     /**
      * @brief Конструктор
      * @param width Ширина карты в тайлах
@@ -25,7 +66,10 @@ public:
 
     /**
      * @brief Инициализация карты
-     * @return true в случае успеха, false при ошибке
+     *
+     * Все чанки создаются однородными пустыми, память под тайлы не выделяется.
+     *
+     * @return true в случае успеха, false при недопустимом размере
      */
     bool initialize();
 
@@ -47,23 +91,78 @@ public:
      * @param y Y координата
      * @return true, если координаты в пределах карты, false в противном случае
      */
-    bool isValidCoordinate(int x, int y) const;
+    bool isValidCoordinate(int x, int y) const {
+        return x >= 0 && x < m_width && y >= 0 && y < m_height;
+    }
 
     /**
      * @brief Получение тайла по координатам
+     *
+     * Изменения через вид оповещают слушателей, как методы setTile*.
+     *
      * @param x X координата
      * @param y Y координата
-     * @return Указатель на тайл или nullptr, если координаты вне карты
+     * @return Вид на тайл (пустой, если координаты вне карты)
      */
-    MapTile* getTile(int x, int y);
+    MapTile getTile(int x, int y);
 
     /**
      * @brief Получение тайла по координатам (константная версия)
      * @param x X координата
      * @param y Y координата
-     * @return Константный указатель на тайл или nullptr, если координаты вне карты
+     * @return Вид на тайл только для чтения (пустой, если координаты вне карты)
+     */
+    const MapTile getTile(int x, int y) const;
+
+    /**
+     * @brief Получение типа тайла
+     * @param x X координата
+     * @param y Y координата
+     * @return Тип тайла (EMPTY вне карты)
+     */
+    TileType getTileType(int x, int y) const {
+        if (!isValidCoordinate(x, y)) {
+            return TileType::EMPTY;
+        }
+        const ChunkSlot& slot = getSlot(x, y);
+        return static_cast<TileType>(slot.tiles ? slot.tiles->types[TileChunk::getCellIndex(x, y)] : slot.uniform.type);
+    }
+
+    /**
+     * @brief Получение флагов тайла
+     * @param x X координата
+     * @param y Y координата
+     * @return Флаги FLAG_* (0 вне карты)
+     */
+    Uint8 getTileFlags(int x, int y) const {
+        if (!isValidCoordinate(x, y)) {
+            return 0;
+        }
+        const ChunkSlot& slot = getSlot(x, y);
+        return slot.tiles ? slot.tiles->flags[TileChunk::getCellIndex(x, y)] : slot.uniform.flags;
+    }
+
+    /**
+     * @brief Получение высоты тайла
+     * @param x X координата
+     * @param y Y координата
+     * @return Высота тайла (0 вне карты)
+     */
+    float getTileHeight(int x, int y) const {
+        if (!isValidCoordinate(x, y)) {
+            return 0.0f;
+        }
+        const ChunkSlot& slot = getSlot(x, y);
+        return (slot.tiles ? slot.tiles->heights[TileChunk::getCellIndex(x, y)] : slot.uniform.height) / HEIGHT_SCALE;
+    }
+
+    /**
+     * @brief Получение цвета тайла
+     * @param x X координата
+     * @param y Y координата
+     * @return Цвет типа тайла
      */
-    const MapTile* getTile(int x, int y) const;
+    SDL_Color getTileColor(int x, int y) const { return MapTile::getTypeColor(getTileType(x, y)); }
 
     /**
      * @brief Установка типа тайла по координатам
@@ -103,6 +202,9 @@ public:
 
     /**
      * @brief Заполнение прямоугольной области карты одним типом тайлов
+     *
+     * Выгруженные чанки пропускаются.
+     *
      * @param startX Начальная X координата
      * @param startY Начальная Y координата
      * @param endX Конечная X координата
@@ -154,15 +256,214 @@ public:
      * @param y Y координата
      * @return true, если тайл проходим, false в противном случае
      */
-    bool isTileWalkable(int x, int y) const;
+    bool isTileWalkable(int x, int y) const { return (getTileFlags(x, y) & FLAG_WALKABLE) != 0; }
 
     /**
      * @brief Проверка прозрачности тайла по координатам
      * @param x X координата
      * @param y Y координата
-     * @return true, если тайл прозрачен, false в противном случае
+     * @return true, если тайл прозрачен или лежит за пределами карты
+     */
+    bool isTileTransparent(int x, int y) const {
+        return !isValidCoordinate(x, y) || (getTileFlags(x, y) & FLAG_TRANSPARENT) != 0;
+    }
+
+    /**
+     * @brief Наибольшая высота тайла на карте
+     *
+     * Однородные чанки проверяются одним значением.
+     *
+     * @return Высота самого высокого тайла
+     */
+    float getMaxTileHeight() const;
+
+    /**
+     * @brief Наибольшая высота тайла в прямоугольнике
+     *
+     * Однородные чанки проверяются одним значением.
+     *
+     * @param minX Левая граница (включительно)
+     * @param minY Верхняя граница
+     * @param maxX Правая граница (включительно)
+     * @param maxY Нижняя граница (включительно)
+     * @return Высота самого высокого тайла (0, если прямоугольник вне карты)
+     */
+    float getMaxTileHeight(int minX, int minY, int maxX, int maxY) const;
+
+    /**
+     * @brief Получение количества чанков по горизонтали
+     * @return Количество столбцов чанков
+     */
+    int getChunkCountX() const { return m_chunkCountX; }
+
+    /**
+     * @brief Получение количества чанков по вертикали
+     * @return Количество строк чанков
+     */
+    int getChunkCountY() const { return m_chunkCountY; }
+
+    /**
+     * @brief Получение количества чанков с выделенной памятью
+     * @return Количество неоднородных чанков
+     */
+    int getAllocatedChunkCount() const { return m_allocatedChunkCount; }
+
+    /**
+     * @brief Проверка, существует ли чанк с такими координатами
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @return true, если чанк лежит в пределах карты
+     */
+    bool isValidChunk(int chunkX, int chunkY) const {
+        return chunkX >= 0 && chunkX < m_chunkCountX && chunkY >= 0 && chunkY < m_chunkCountY;
+    }
+
+    /**
+     * @brief Проверка, выделена ли под чанк память
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @return true, если чанк существует и хранит тайлы поштучно
+     */
+    bool isChunkAllocated(int chunkX, int chunkY) const {
+        return isValidChunk(chunkX, chunkY) && m_chunks[chunkY * m_chunkCountX + chunkX].tiles != nullptr;
+    }
+
+    /**
+     * @brief Проверка, находятся ли тайлы чанка в карте
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @return true, если чанк существует и не выгружен
+     */
+    bool isChunkResident(int chunkX, int chunkY) const {
+        return isValidChunk(chunkX, chunkY) && m_chunks[chunkY * m_chunkCountX + chunkX].resident;
+    }
+
+    /**
+     * @brief Проверка, находится ли тайл в загруженном чанке
+     * @param x X координата
+     * @param y Y координата
+     * @return true, если тайл существует и его чанк не выгружен
+     */
+    bool isTileResident(int x, int y) const {
+        return isValidCoordinate(x, y) && getSlot(x, y).resident;
+    }
+
+    /**
+     * @brief Проверка, пересекает ли прямоугольник хотя бы один загруженный чанк
+     * @param minX Левая граница (включительно)
+     * @param minY Верхняя граница (включительно)
+     * @param maxX Правая граница (включительно)
+     * @param maxY Нижняя граница (включительно)
+     * @return true, если в прямоугольнике есть загруженные тайлы
+     */
+    bool hasResidentChunk(int minX, int minY, int maxX, int maxY) const;
+
+    /**
+     * @brief Проверка, загружены ли все чанки, которые пересекает прямоугольник
+     * @param minX Левая граница (включительно)
+     * @param minY Верхняя граница (включительно)
+     * @param maxX Правая граница (включительно)
+     * @param maxY Нижняя граница (включительно)
+     * @return true, если выгруженных тайлов в прямоугольнике нет
      */
-    bool isTileTransparent(int x, int y) const;
+    bool isAreaResident(int minX, int minY, int maxX, int maxY) const;
+
+    /**
+     * @brief Получение тайлов неоднородного чанка без копирования
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @return Тайлы чанка или nullptr, если чанк однороден или не существует
+     */
+    const TileChunk* getChunkTiles(int chunkX, int chunkY) const {
+        return isValidChunk(chunkX, chunkY) ? m_chunks[chunkY * m_chunkCountX + chunkX].tiles.get() : nullptr;
+    }
+
+    /**
+     * @brief Получение значения тайлов однородного чанка
+     * @param chunkX X координата чанка (внутри карты)
+     * @param chunkY Y координата чанка (внутри карты)
+     * @return Значение тайлов (для неоднородного чанка не используется)
+     */
+    TileCell getChunkUniformCell(int chunkX, int chunkY) const {
+        return m_chunks[chunkY * m_chunkCountX + chunkX].uniform;
+    }
+
+    /**
+     * @brief Копирование тайлов чанка
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @param chunk Тайлы чанка (выходной параметр; однородный чанк разворачивается)
+     * @return true, если чанк существует и не выгружен
+     */
+    bool copyChunk(int chunkX, int chunkY, TileChunk& chunk) const;
+
+    /**
+     * @brief Замена всех тайлов чанка
+     *
+     * Однородный чанк сохраняется одним значением, иначе карта забирает
+     * переданную память себе. Выгруженный чанк снова становится загруженным.
+     * Слушатели получают прямоугольник чанка.
+     *
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @param chunk Новые тайлы чанка
+     * @return true, если чанк существует
+     */
+    bool replaceChunk(int chunkX, int chunkY, std::unique_ptr<TileChunk> chunk);
+
+    /**
+     * @brief Заполнение чанка одним типом тайлов с освобождением его памяти
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @param type Тип тайлов
+     * @return true, если чанк существует
+     */
+    bool resetChunk(int chunkX, int chunkY, TileType type);
+
+    /**
+     * @brief Выгрузка чанка с освобождением его памяти
+     *
+     * Тайлы чанка до replaceChunk читаются как пустота без флагов
+     * (непроходимая и непрозрачная), запись в них отклоняется. Слушатели
+     * получают прямоугольник чанка и видят его через isChunkResident
+     * уже выгруженным.
+     *
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @return true, если чанк существует
+     */
+    bool evictChunk(int chunkX, int chunkY);
+
+    /**
+     * @brief Освобождение памяти чанков, ставших однородными
+     *
+     * Вызывается после генерации или загрузки карты. Слушатели не
+     * оповещаются: значения тайлов не меняются.
+     *
+     * @return Количество освобожденных чанков
+     */
+    int compact();
+
+    /**
+     * @brief Упакованные значения тайла заданного типа
+     * @param type Тип тайла
+     * @return Тип со стандартными флагами и высотой
+     */
+    static TileCell makeCell(TileType type);
+
+    /**
+     * @brief Квантование высоты для хранения
+     * @param height Высота тайла
+     * @return Высота в сотых долях, ограниченная диапазоном байта
+     */
+    static Uint8 quantizeHeight(float height);
+
+    /**
+     * @brief Стандартные флаги типа тайла
+     * @param type Тип тайла
+     * @return Флаги FLAG_* по IsWalkable и IsTransparent
+     */
+    static Uint8 getDefaultFlags(TileType type);
 
     /**
      * @brief Очистка карты (заполнение пустыми тайлами)
@@ -170,7 +471,7 @@ public:
     void clear();
 
     /**
-     * @brief Сохранение карты в файл
+     * @brief Сохранение карты в файл уровня (LevelFile, без объектов)
      * @param filename Имя файла
      * @return true в случае успеха, false при ошибке
      */
@@ -178,13 +479,144 @@ public:
 
     /**
      * @brief Загрузка карты из файла
+     *
+     * Файл уровня отображается в память (см. LevelFile), файлы прежнего
+     * формата без заголовка читаются потоком.
+     *
      * @param filename Имя файла
      * @return true в случае успеха, false при ошибке
      */
     bool loadFromFile(const std::string& filename);
 
+    /**
+     * @brief Загрузка карты из открытого файла уровня
+     *
+     * Однородные чанки берутся из индекса, остальные копируются
+     * из плоскостей файла целиком или распаковываются.
+     *
+     * @param level Открытый файл уровня
+     * @return true в случае успеха, false при ошибке
+     */
+    bool loadFromLevel(const LevelFile& level);
+
+    /**
+     * @brief Загрузка карты из сжатого снимка
+     * @param snapshot Снимок карты
+     * @return true в случае успеха, false при ошибке
+     */
+    bool loadFromSnapshot(const TileMapSnapshot& snapshot);
+
+    /**
+     * @brief Подписка на изменения карты
+     * @param listener Функция, вызываемая при изменении тайлов
+     * @return Идентификатор подписки для removeChangeListener
+     */
+    int addChangeListener(ChangeListener listener);
+
+    /**
+     * @brief Отмена подписки на изменения карты
+     * @param listenerId Идентификатор, полученный от addChangeListener
+     */
+    void removeChangeListener(int listenerId);
+
 private:
+    /**
+     * @brief Оповещение слушателей об изменении прямоугольника тайлов
+     * @param minX Левая граница (или ALL_TILES)
+     * @param minY Верхняя граница (или ALL_TILES)
+     * @param maxX Правая граница, включительно (или ALL_TILES)
+     * @param maxY Нижняя граница, включительно (или ALL_TILES)
+     */
+    void notifyChanged(int minX, int minY, int maxX, int maxY);
+
+    /**
+     * @brief Оповещение слушателей об изменении всей карты
+     */
+    void notifyAllChanged() { notifyChanged(ALL_TILES, ALL_TILES, ALL_TILES, ALL_TILES); }
+
+    /**
+     * @brief Загрузка файла прежнего формата (размеры и поля каждого тайла подряд)
+     * @param filename Имя файла
+     * @return true в случае успеха, false при ошибке
+     */
+    bool loadLegacyFile(const std::string& filename);
+
+    /**
+     * @brief Заполнение карты из индекса чанков и их тайлов
+     *
+     * Источник (LevelFile или TileMapSnapshot) предоставляет getChunkEntry
+     * и copyChunk по индексу чанка.
+     *
+     * @param width Ширина карты
+     * @param height Высота карты
+     * @param source Источник чанков
+     * @return true, если все чанки прочитаны
+     */
+    template <typename ChunkSource>
+    bool loadChunks(int width, int height, const ChunkSource& source);
+
+    /**
+     * @brief Оповещение слушателей о прямоугольнике чанка
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     */
+    void notifyChunkChanged(int chunkX, int chunkY);
+
+    /**
+     * @brief Запись каталога чанков
+     */
+    struct ChunkSlot {
+        std::unique_ptr<TileChunk> tiles;  ///< Тайлы чанка (nullptr - чанк однороден)
+        TileCell uniform;                  ///< Значение тайлов однородного чанка
+        bool resident = true;              ///< Тайлы чанка в карте (false - чанк выгружен)
+    };
+
+    /**
+     * @brief Запись каталога для тайла
+     * @param x X координата (внутри карты)
+     * @param y Y координата (внутри карты)
+     * @return Запись чанка, содержащего тайл
+     */
+    const ChunkSlot& getSlot(int x, int y) const {
+        return m_chunks[static_cast<size_t>(y >> TileChunk::SHIFT) * m_chunkCountX + (x >> TileChunk::SHIFT)];
+    }
+
+    /**
+     * @brief Чтение значений тайла
+     * @param x X координата (внутри карты)
+     * @param y Y координата (внутри карты)
+     * @return Значения тайла
+     */
+    TileCell readCell(int x, int y) const {
+        const ChunkSlot& slot = getSlot(x, y);
+        return slot.tiles ? slot.tiles->getCell(TileChunk::getCellIndex(x, y)) : slot.uniform;
+    }
+
+    /**
+     * @brief Запись значений тайла без оповещения
+     *
+     * Однородный чанк получает собственную память, только если значение
+     * отличается от значения чанка.
+     *
+     * @param x X координата (внутри карты)
+     * @param y Y координата (внутри карты)
+     * @param cell Значения тайла
+     */
+    void writeCell(int x, int y, const TileCell& cell);
+
+    /**
+     * @brief Выделение памяти однородному чанку
+     * @param slot Запись каталога
+     * @return Тайлы чанка
+     */
+    TileChunk& materialize(ChunkSlot& slot);
+
     int m_width;                           ///< Ширина карты в тайлах
     int m_height;                          ///< Высота карты в тайлах
-    std::vector<std::vector<MapTile>> m_tiles; ///< Двумерный массив тайлов
+    int m_chunkCountX = 0;                 ///< Количество чанков по горизонтали
+    int m_chunkCountY = 0;                 ///< Количество чанков по вертикали
+    int m_allocatedChunkCount = 0;         ///< Чанки с выделенной памятью
+    std::vector<ChunkSlot> m_chunks;       ///< Каталог чанков построчно
+    std::vector<std::pair<int, ChangeListener>> m_listeners; ///< Подписчики на изменения карты
+    int m_nextListenerId = 1;              ///< Идентификатор следующей подписки
 };
\ No newline at end of file
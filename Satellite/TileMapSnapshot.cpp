@@ -0,0 +1,91 @@
+﻿#include "TileMapSnapshot.h"
+#include "ChunkCodec.h"
+#include "TileMap.h"
+#include "Logger.h"
+#include <memory>
+#include <string>
+
+TileMapSnapshot::TileMapSnapshot()
+    : m_width(0), m_height(0), m_chunkCountX(0) {
+}
+
+bool TileMapSnapshot::capture(const TileMap& map, const LevelFile::ChunkReader& evictedChunks) {
+    int chunkCountX = map.getChunkCountX();
+    int chunkCountY = map.getChunkCountY();
+
+    m_width = map.getWidth();
+    m_height = map.getHeight();
+    m_chunkCountX = chunkCountX;
+    m_chunkIndex.assign(static_cast<size_t>(chunkCountX) * chunkCountY, LevelChunkEntry());
+    m_chunkOffsets.clear();
+    m_chunkData.clear();
+
+    TileChunk evicted;
+    for (int chunkY = 0; chunkY < chunkCountY; ++chunkY) {
+        for (int chunkX = 0; chunkX < chunkCountX; ++chunkX) {
+            LevelChunkEntry& entry = m_chunkIndex[chunkY * chunkCountX + chunkX];
+            const TileChunk* tiles = map.getChunkTiles(chunkX, chunkY);
+            TileCell uniform = tiles ? TileCell() : map.getChunkUniformCell(chunkX, chunkY);
+
+            // Выгруженный чанк в карте - заглушка, настоящие тайлы читаются из источника
+            if (!map.isChunkResident(chunkX, chunkY)) {
+                if (!evictedChunks || !evictedChunks(chunkX, chunkY, evicted)) {
+                    LOG_ERROR("Failed to read evicted chunk (" + std::to_string(chunkX) + ", " +
+                        std::to_string(chunkY) + ") for map snapshot");
+                    *this = TileMapSnapshot();
+                    return false;
+                }
+                tiles = evicted.isUniform(uniform) ? nullptr : &evicted;
+            }
+
+            if (!tiles) {
+                entry.dataIndex = LevelFile::NO_CHUNK_DATA;
+                entry.type = uniform.type;
+                entry.flags = uniform.flags;
+                entry.height = uniform.height;
+                continue;
+            }
+
+            entry.dataIndex = static_cast<Uint32>(m_chunkOffsets.size());
+            m_chunkOffsets.push_back(m_chunkData.size());
+            ChunkCodec::encode(*tiles, m_chunkData);
+        }
+    }
+    m_chunkOffsets.push_back(m_chunkData.size());
+    return true;
+}
+
+bool TileMapSnapshot::restore(TileMap& map) const {
+    return !isEmpty() && map.loadFromSnapshot(*this);
+}
+
+bool TileMapSnapshot::restoreChunk(TileMap& map, int chunkX, int chunkY) const {
+    if (map.getWidth() != m_width || map.getHeight() != m_height || !map.isValidChunk(chunkX, chunkY)) {
+        return false;
+    }
+
+    std::unique_ptr<TileChunk> chunk(new TileChunk());
+    return copyChunk(chunkY * m_chunkCountX + chunkX, *chunk) &&
+        map.replaceChunk(chunkX, chunkY, std::move(chunk));
+}
+
+bool TileMapSnapshot::copyChunk(int chunkIndex, TileChunk& chunk) const {
+    const LevelChunkEntry& entry = m_chunkIndex[chunkIndex];
+    if (entry.dataIndex == LevelFile::NO_CHUNK_DATA) {
+        TileCell uniform;
+        uniform.type = entry.type;
+        uniform.flags = entry.flags;
+        uniform.height = entry.height;
+        chunk.fill(uniform);
+        return true;
+    }
+
+    Uint64 begin = m_chunkOffsets[entry.dataIndex];
+    Uint64 end = m_chunkOffsets[entry.dataIndex + 1];
+    return ChunkCodec::decode(m_chunkData.data() + begin, static_cast<size_t>(end - begin), chunk);
+}
+
+size_t TileMapSnapshot::getCompressedSize() const {
+    return m_chunkIndex.size() * sizeof(LevelChunkEntry) +
+        m_chunkOffsets.size() * sizeof(Uint64) + m_chunkData.size();
+}
@@ -0,0 +1,120 @@
+﻿#pragma once
+
+#include "LevelFile.h"
+#include "TileChunk.h"
+#include <SDL.h>
+#include <vector>
+
+class TileMap;
+
+/**
+ * @brief Сжатый снимок карты тайлов в памяти
+ *
+ * Однородные чанки хранятся одним значением в индексе, остальные сжаты
+ * ChunkCodec независимо друг от друга. Снимок восстанавливается в карту
+ * целиком или по одному чанку: copyChunk распаковывает только запрошенный
+ * чанк, остальные остаются сжатыми. copyChunk не меняет снимок, поэтому
+ * его можно вызывать из рабочего потока (например, как ChunkStreamer::ChunkLoader).
+ *
+ * Это же представление записывается в сжатый файл уровня (LevelFile).
+ */
+class TileMapSnapshot {
+public:
+    /**
+     * @brief Конструктор (пустой снимок)
+     */
+    TileMapSnapshot();
+
+    /**
+     * @brief Снятие снимка карты
+     *
+     * Тайлы выгруженных чанков карты запрашиваются у evictedChunks.
+     * Если его нет или чтение не удалось, снимок остается пустым.
+     *
+     * @param map Карта тайлов
+     * @param evictedChunks Источник выгруженных чанков
+     * @return true, если снимок снят
+     */
+    bool capture(const TileMap& map, const LevelFile::ChunkReader& evictedChunks = nullptr);
+
+    /**
+     * @brief Восстановление карты целиком
+     * @param map Карта тайлов (размеры меняются на размеры снимка)
+     * @return true в случае успеха
+     */
+    bool restore(TileMap& map) const;
+
+    /**
+     * @brief Восстановление одного чанка в карте
+     * @param map Карта тайлов тех же размеров
+     * @param chunkX X координата чанка
+     * @param chunkY Y координата чанка
+     * @return true в случае успеха
+     */
+    bool restoreChunk(TileMap& map, int chunkX, int chunkY) const;
+
+    /**
+     * @brief Распаковка тайлов чанка
+     * @param chunkIndex Индекс чанка (chunkY * chunkCountX + chunkX)
+     * @param chunk Тайлы чанка (выходной параметр; однородный чанк заполняется его значением)
+     * @return true, если данные чанка корректны
+     */
+    bool copyChunk(int chunkIndex, TileChunk& chunk) const;
+
+    /**
+     * @brief Проверка, снят ли снимок
+     * @return true, если снимок пуст
+     */
+    bool isEmpty() const { return m_chunkIndex.empty(); }
+
+    /**
+     * @brief Получение ширины карты снимка
+     * @return Ширина в тайлах
+     */
+    int getWidth() const { return m_width; }
+
+    /**
+     * @brief Получение высоты карты снимка
+     * @return Высота в тайлах
+     */
+    int getHeight() const { return m_height; }
+
+    /**
+     * @brief Получение записи индекса чанков
+     * @param chunkIndex Индекс чанка
+     * @return Запись индекса
+     */
+    const LevelChunkEntry& getChunkEntry(int chunkIndex) const { return m_chunkIndex[chunkIndex]; }
+
+    /**
+     * @brief Получение индекса чанков
+     * @return Записи индекса построчно
+     */
+    const std::vector<LevelChunkEntry>& getChunkIndex() const { return m_chunkIndex; }
+
+    /**
+     * @brief Получение смещений сжатых чанков
+     * @return Смещение каждого сжатого чанка в getChunkData() и размер данных последним элементом
+     */
+    const std::vector<Uint64>& getChunkOffsets() const { return m_chunkOffsets; }
+
+    /**
+     * @brief Получение сжатых данных чанков
+     * @return Сжатые чанки подряд
+     */
+    const std::vector<Uint8>& getChunkData() const { return m_chunkData; }
+
+    /**
+     * @brief Получение размера снимка в памяти
+     * @return Размер индекса и сжатых данных в байтах
+     */
+    size_t getCompressedSize() const;
+
+private:
+    int m_width;                              ///< Ширина карты в тайлах
+    int m_height;                             ///< Высота карты в тайлах
+    int m_chunkCountX;                        ///< Чанков по горизонтали
+    std::vector<LevelChunkEntry> m_chunkIndex; ///< Индекс чанков
+    std::vector<Uint64> m_chunkOffsets;       ///< Смещения сжатых чанков (+ конец данных)
+    std::vector<Uint8> m_chunkData;           ///< Сжатые чанки
+};
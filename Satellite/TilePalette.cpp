@@ -0,0 +1,90 @@
+﻿#include "TilePalette.h"
+#include "MapTile.h"
+#include "Logger.h"
+#include <limits>
+
+TilePalette::TilePalette()
+    : m_overflowReported(false), m_biomeType(-1) {
+    m_entries.reserve(TYPE_ENTRY_COUNT + 64);
+    build(0);
+}
+
+void TilePalette::build(int biomeType) {
+    if (biomeType == m_biomeType && !m_entries.empty()) {
+        return;
+    }
+
+    m_biomeType = biomeType;
+    m_entries.clear();
+    m_dynamicIndices.clear();
+    m_overflowReported = false;
+
+    // Базовые цвета берутся из таблицы MapTile, чтобы палитра не расходилась с картой.
+    // Сейчас они не зависят от биома; оттенки биомов следует добавлять здесь
+    for (int i = 0; i < TILE_TYPE_COUNT; ++i) {
+        SDL_Color color = MapTile::getTypeColor(static_cast<TileType>(i));
+        m_entries.push_back(makeEntry(color, shade(color, LEFT_SHADE), shade(color, RIGHT_SHADE)));
+    }
+
+    // Затемненные копии для тумана войны
+    for (int i = 0; i < TILE_TYPE_COUNT; ++i) {
+        SDL_Color color = shade(m_entries[i].top, REMEMBERED_SHADE);
+        m_entries.push_back(makeEntry(color, shade(color, LEFT_SHADE), shade(color, RIGHT_SHADE)));
+    }
+}
+
+Uint16 TilePalette::addDynamic(SDL_Color color, float leftShade, float rightShade) {
+    return addDynamic(color, shade(color, leftShade), shade(color, rightShade));
+}
+
+Uint16 TilePalette::addDynamic(SDL_Color top, SDL_Color left, SDL_Color right) {
+    // Объекты одного цвета (двери, терминалы одного типа) получают одну запись
+    DynamicKey key = { packColor(top), packColor(left), packColor(right) };
+    auto it = m_dynamicIndices.find(key);
+    if (it != m_dynamicIndices.end()) {
+        return it->second;
+    }
+
+    // Индексы исчерпаны: выданные записи уже используются тайлами кадра, поэтому не трогаем их
+    if (m_entries.size() > std::numeric_limits<Uint16>::max()) {
+        if (!m_overflowReported) {
+            LOG_WARNING("TilePalette: dynamic entries exceed " +
+                std::to_string(std::numeric_limits<Uint16>::max() + 1) + ", reusing the last entry");
+            m_overflowReported = true;
+        }
+        return static_cast<Uint16>(m_entries.size() - 1);
+    }
+
+    Uint16 index = static_cast<Uint16>(m_entries.size());
+    m_entries.push_back(makeEntry(top, left, right));
+    m_dynamicIndices.emplace(key, index);
+    return index;
+}
+
+void TilePalette::resetDynamic() {
+    if (m_entries.size() > static_cast<size_t>(TYPE_ENTRY_COUNT)) {
+        m_entries.resize(TYPE_ENTRY_COUNT);
+    }
+    m_dynamicIndices.clear();
+    m_overflowReported = false;
+}
+
+TilePalette::Entry TilePalette::makeEntry(SDL_Color top, SDL_Color left, SDL_Color right) {
+    Entry entry;
+    entry.top = top;
+    entry.left = left;
+    entry.right = right;
+    entry.topOutline = shade(top, OUTLINE_SHADE);
+    entry.leftOutline = shade(left, OUTLINE_SHADE);
+    entry.rightOutline = shade(right, OUTLINE_SHADE);
+    return entry;
+}
+
+SDL_Color TilePalette::shade(SDL_Color color, float factor) {
+    return {
+        static_cast<Uint8>(color.r * factor),
+        static_cast<Uint8>(color.g * factor),
+        static_cast<Uint8>(color.b * factor),
+        color.a
+    };
+}
@@ -0,0 +1,175 @@
+﻿#pragma once
+
+#include "TileType.h"
+#include <SDL.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Палитра цветов граней для объемных и плоских тайлов
+ *
+ * Первые TILE_TYPE_COUNT записей соответствуют типам тайлов (индекс равен
+ * значению TileType), следующие TILE_TYPE_COUNT - тем же типам, затемненным
+ * для исследованных, но невидимых сейчас тайлов (туман войны). Все они
+ * строятся один раз для биома. Цвета динамических
+ * объектов (игрок, двери, терминалы) добавляются за ними и сбрасываются
+ * каждый кадр, поэтому индекс записи действителен только до следующего
+ * resetDynamic(). Одинаковые динамические цвета делят одну запись.
+ */
+class TilePalette {
+public:
+    static constexpr int TILE_TYPE_COUNT = static_cast<int>(TileType::FOREST) + 1; ///< Количество типов тайлов
+    static constexpr int TYPE_ENTRY_COUNT = TILE_TYPE_COUNT * 2; ///< Постоянные записи: типы и их затемненные копии
+    static constexpr float REMEMBERED_SHADE = 0.45f; ///< Яркость исследованных, но невидимых тайлов
+
+    static constexpr float LEFT_SHADE = 0.7f;     ///< Затенение левой грани по умолчанию
+    static constexpr float RIGHT_SHADE = 0.5f;    ///< Затенение правой грани по умолчанию
+    static constexpr float OUTLINE_SHADE = 0.8f;  ///< Затенение контура относительно грани
+
+    /**
+     * @brief Цвета одной записи палитры
+     */
+    struct Entry {
+        SDL_Color top;           ///< Верхняя грань
+        SDL_Color left;          ///< Левая грань
+        SDL_Color right;         ///< Правая грань
+        SDL_Color topOutline;    ///< Контур верхней грани
+        SDL_Color leftOutline;   ///< Контур левой грани
+        SDL_Color rightOutline;  ///< Контур правой грани
+    };
+
+    /**
+     * @brief Конструктор (строит палитру для биома по умолчанию)
+     */
+    TilePalette();
+
+    /**
+     * @brief Построение записей типов тайлов для биома
+     *
+     * Повторный вызов с тем же биомом ничего не делает.
+     * Динамические записи при перестроении сбрасываются.
+     *
+     * @param biomeType Номер биома
+     */
+    void build(int biomeType);
+
+    /**
+     * @brief Получение текущего биома палитры
+     * @return Номер биома (-1, если палитра еще не строилась для биома)
+     */
+    int getBiomeType() const { return m_biomeType; }
+
+    /**
+     * @brief Индекс записи для типа тайла
+     * @param type Тип тайла
+     * @return Индекс записи
+     */
+    static Uint16 getTypeIndex(TileType type) { return static_cast<Uint16>(type); }
+
+    /**
+     * @brief Индекс затемненной записи для записи типа
+     * @param typeIndex Индекс записи типа
+     * @return Индекс записи для исследованного, но невидимого тайла
+     */
+    static Uint16 getRememberedIndex(Uint16 typeIndex) { return static_cast<Uint16>(typeIndex + TILE_TYPE_COUNT); }
+
+    /**
+     * @brief Тип тайла постоянной записи
+     * @param index Индекс записи
+     * @return Тип тайла записи (обычной или затемненной), для динамических записей - TileType::EMPTY
+     */
+    static TileType getEntryType(Uint16 index) {
+        return index < TYPE_ENTRY_COUNT ? static_cast<TileType>(index % TILE_TYPE_COUNT) : TileType::EMPTY;
+    }
+
+    /**
+     * @brief Добавление динамической записи по базовому цвету
+     * @param color Цвет верхней грани
+     * @param leftShade Множитель яркости левой грани
+     * @param rightShade Множитель яркости правой грани
+     * @return Индекс записи
+     */
+    Uint16 addDynamic(SDL_Color color, float leftShade = LEFT_SHADE, float rightShade = RIGHT_SHADE);
+
+    /**
+     * @brief Добавление динамической записи с явными цветами граней
+     *
+     * Если записи уже заняли весь диапазон индексов, выданные ранее записи
+     * не перезаписываются: возвращается последняя запись, а переполнение
+     * сообщается в лог один раз до resetDynamic().
+     *
+     * @param top Цвет верхней грани
+     * @param left Цвет левой грани
+     * @param right Цвет правой грани
+     * @return Индекс записи
+     */
+    Uint16 addDynamic(SDL_Color top, SDL_Color left, SDL_Color right);
+
+    /**
+     * @brief Удаление всех динамических записей
+     */
+    void resetDynamic();
+
+    /**
+     * @brief Получение записи по индексу
+     * @param index Индекс записи
+     * @return Запись палитры
+     */
+    const Entry& get(Uint16 index) const { return m_entries[index]; }
+
+    /**
+     * @brief Построение записи по цветам граней (контуры затемняются на OUTLINE_SHADE)
+     * @param top Цвет верхней грани
+     * @param left Цвет левой грани
+     * @param right Цвет правой грани
+     * @return Запись палитры
+     */
+    static Entry makeEntry(SDL_Color top, SDL_Color left, SDL_Color right);
+
+    /**
+     * @brief Затемнение цвета с сохранением прозрачности
+     * @param color Исходный цвет
+     * @param factor Множитель яркости
+     * @return Затемненный цвет
+     */
+    static SDL_Color shade(SDL_Color color, float factor);
+
+private:
+    /**
+     * @brief Ключ динамической записи - цвета трех граней
+     */
+    struct DynamicKey {
+        Uint32 top;
+        Uint32 left;
+        Uint32 right;
+
+        bool operator==(const DynamicKey& other) const {
+            return top == other.top && left == other.left && right == other.right;
+        }
+    };
+
+    /**
+     * @brief Хеш ключа динамической записи
+     */
+    struct DynamicKeyHash {
+        size_t operator()(const DynamicKey& key) const {
+            size_t hash = key.top;
+            hash = hash * 31 + key.left;
+            hash = hash * 31 + key.right;
+            return hash;
+        }
+    };
+
+    /**
+     * @brief Упаковка цвета в 32 бита
+     */
+    static Uint32 packColor(SDL_Color color) {
+        return (static_cast<Uint32>(color.r) << 24) | (static_cast<Uint32>(color.g) << 16) |
+            (static_cast<Uint32>(color.b) << 8) | color.a;
+    }
+
+    std::vector<Entry> m_entries;  ///< Записи типов тайлов, их затемненные копии, затем динамические
+    std::unordered_map<DynamicKey, Uint16, DynamicKeyHash> m_dynamicIndices; ///< Индексы динамических записей по цветам
+    bool m_overflowReported;       ///< Переполнение уже сообщено в текущем кадре
+    int m_biomeType;               ///< Биом, для которого построены записи типов
+};
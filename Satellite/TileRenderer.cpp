@@ -1,8 +1,9 @@
 ﻿#include "TileRenderer.h"
+#include "RenderStats.h"
 #include <iostream>
 
 TileRenderer::TileRenderer(IsometricRenderer* isoRenderer)
-    : m_isoRenderer(isoRenderer) {
+    : m_isoRenderer(isoRenderer), m_spriteCache(isoRenderer) {
 }
 
 TileRenderer::~TileRenderer() {
@@ -11,10 +12,19 @@ TileRenderer::~TileRenderer() {
 
 void TileRenderer::clear() {
     m_tiles.clear();
+    m_spriteCache.beginFrame();
+    m_palette.resetDynamic();
 }
 
 void TileRenderer::addFlatTile(float x, float y, SDL_Texture* texture, SDL_Color color, float priority) {
-    m_tiles.emplace_back(x, y, texture, color, priority);
+    Uint16 paletteIndex = m_palette.addDynamic(color, color, color);
+    m_tiles.emplace_back(x, y, texture, paletteIndex, priority);
+    m_tiles.back().sortKey = makeSortKey(m_tiles.back(), TileType::EMPTY);
+}
+
+void TileRenderer::addFlatTile(float x, float y, Uint16 paletteIndex, float priority) {
+    m_tiles.emplace_back(x, y, nullptr, paletteIndex, priority);
+    m_tiles.back().sortKey = makeSortKey(m_tiles.back(), TilePalette::getEntryType(paletteIndex));
 }
 
 void TileRenderer::addVolumetricTile(float x, float y, float z,
@@ -24,11 +34,104 @@ void TileRenderer::addVolumetricTile(float x, float y, float z,
     SDL_Color topColor,
     SDL_Color leftColor,
     SDL_Color rightColor,
-    float priority) {
+    float priority,
+    Uint8 faceMask) {
+    Uint16 paletteIndex = m_palette.addDynamic(topColor, leftColor, rightColor);
     m_tiles.emplace_back(x, y, z,
         topTexture, leftTexture, rightTexture,
-        topColor, leftColor, rightColor,
-        priority);
+        paletteIndex, priority);
+    m_tiles.back().faceMask = faceMask;
+    m_tiles.back().sortKey = makeSortKey(m_tiles.back(), TileType::EMPTY);
+}
+
+void TileRenderer::addVolumetricTile(float x, float y, float z, Uint16 paletteIndex,
+    float priority, Uint8 faceMask) {
+    m_tiles.emplace_back(x, y, z, nullptr, nullptr, nullptr, paletteIndex, priority);
+    m_tiles.back().faceMask = faceMask;
+    m_tiles.back().sortKey = makeSortKey(m_tiles.back(), TilePalette::getEntryType(paletteIndex));
+}
+
+Uint64 TileRenderer::makeSortKey(const RenderableTile& tile, TileType type) {
+    // 1. Приоритет с шагом 1/16 (точнее прежнего допуска в сравнении не требуется)
+    double scaledPriority = static_cast<double>(tile.renderPriority) * 16.0;
+    Uint64 priority = 0;
+    if (scaledPriority > 0.0) {
+        priority = scaledPriority >= 4294967295.0 ? 0xFFFFFFFFull : static_cast<Uint64>(scaledPriority + 0.5);
+    }
+
+    // 2. Вода всегда рисуется под другими объектами с тем же приоритетом
+    Uint64 notWater = type == TileType::WATER ? 0u : 1u;
+
+    // 3. Диагональ (X+Y) с шагом в полтайла
+    float diagonal = (tile.worldX + tile.worldY) * 2.0f;
+    Uint64 diagonalBits = 0;
+    if (diagonal > 0.0f) {
+        diagonalBits = diagonal >= 131071.0f ? 131071u : static_cast<Uint64>(diagonal);
+    }
+
+    // 4. Высота с шагом 1/8, ограниченная сверху
+    float scaledHeight = tile.worldZ * 8.0f;
+    Uint64 height = 0;
+    if (scaledHeight > 0.0f) {
+        height = scaledHeight >= 31.0f ? 31u : static_cast<Uint32>(scaledHeight);
+    }
+
+    // 5. Объемные объекты поверх плоских
+    Uint64 volumetric = tile.type == RenderableTile::TileType::VOLUMETRIC ? 1u : 0u;
+
+    return (priority << 32) | (notWater << 23) | (diagonalBits << 6) | (height << 1) | volumetric;
+}
+
+void TileRenderer::radixSortEntries() {
+    const size_t count = m_sortEntries.size();
+    if (count < 2) {
+        return;
+    }
+    m_sortScratch.resize(count);
+
+    SortEntry* source = m_sortEntries.data();
+    SortEntry* target = m_sortScratch.data();
+
+    // Биты, в которых ключи различаются: на экране помещается небольшой
+    // диапазон приоритетов, поэтому обычно сортируются 3-4 байта из 8
+    Uint64 varying = 0;
+    const Uint64 firstKey = source[0].key;
+    for (size_t i = 1; i < count; ++i) {
+        varying |= source[i].key ^ firstKey;
+    }
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        // Все ключи совпадают в этом байте - проход ничего не меняет
+        if (((varying >> shift) & 0xFF) == 0) {
+            continue;
+        }
+
+        // 1. Гистограмма текущего байта
+        size_t histogram[256] = {};
+        for (size_t i = 0; i < count; ++i) {
+            histogram[(source[i].key >> shift) & 0xFF]++;
+        }
+
+        // 2. Префиксные суммы дают начальные позиции корзин
+        size_t offset = 0;
+        for (size_t& bucket : histogram) {
+            size_t bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+
+        // 3. Устойчивое распределение по корзинам
+        for (size_t i = 0; i < count; ++i) {
+            target[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+        }
+
+        std::swap(source, target);
+    }
+
+    // Результат должен оказаться в m_sortEntries
+    if (source != m_sortEntries.data()) {
+        m_sortEntries.swap(m_sortScratch);
+    }
 }
 
 void TileRenderer::render(SDL_Renderer* renderer, int centerX, int centerY) {
@@ -38,71 +141,126 @@ void TileRenderer::render(SDL_Renderer* renderer, int centerX, int centerY) {
     }
 
     // Z-СОРТИРОВКА для правильного порядка отображения тайлов
-    std::sort(m_tiles.begin(), m_tiles.end(),
-        [](const RenderableTile& a, const RenderableTile& b) {
-            // 1. Сортировка по приоритету
-            if (std::abs(a.renderPriority - b.renderPriority) > 0.001f) {
-                return a.renderPriority < b.renderPriority;
-            }
-
-            // 2. НОВОЕ: Специальная обработка для воды - вода всегда отображается под объектами
-            // Этот код можно определить по цвету, но безопаснее передавать флаг "isWater"
-            bool aIsWater = (a.topColor.r < 100 && a.topColor.g > 150 && a.topColor.b > 200);
-            bool bIsWater = (b.topColor.r < 100 && b.topColor.g > 150 && b.topColor.b > 200);
-
-            if (aIsWater && !bIsWater) {
-                return true; // Вода рисуется под другими объектами
-            }
-            if (!aIsWater && bIsWater) {
-                return false; // Другие объекты рисуются поверх воды
-            }
-
-            // 3. Если приоритеты равны, используем сумму координат (X+Y)
-            float sumA = a.worldX + a.worldY;
-            float sumB = b.worldX + b.worldY;
-
-            if (std::abs(sumA - sumB) > 0.01f) {
-                return sumA < sumB;
-            }
-
-            // 4. При равных (X+Y) сортируем по высоте (Z)
-            if (std::abs(a.worldZ - b.worldZ) > 0.001f) {
-                return a.worldZ < b.worldZ;
-            }
-
-            // 5. Крайний случай - объемные объекты поверх плоских
-            if (a.type != b.type) {
-                return a.type == RenderableTile::TileType::FLAT &&
-                    b.type == RenderableTile::TileType::VOLUMETRIC;
-            }
-
-            // 6. Детерминированный порядок для избежания "мерцания"
-            if (std::abs(a.worldX - b.worldX) > 0.001f) {
-                return a.worldX < b.worldX;
-            }
-
-            return a.worldY < b.worldY;
-        });
+    // Ключи посчитаны при добавлении, сортируются пары (ключ, индекс) за линейное время
+    m_sortEntries.resize(m_tiles.size());
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        m_sortEntries[i] = { m_tiles[i].sortKey, static_cast<Uint32>(i) };
+    }
+    radixSortEntries();
 
     // Рендерим тайлы в отсортированном порядке
-    for (const auto& tile : m_tiles) {
-        if (tile.type == RenderableTile::TileType::FLAT) {
-            // Рендеринг плоского тайла
-            m_isoRenderer->renderTile(
-                renderer,
-                tile.worldX, tile.worldY, tile.worldZ,
-                tile.topColor,
-                centerX, centerY
-            );
+    for (const SortEntry& entry : m_sortEntries) {
+        drawTile(renderer, m_tiles[entry.index], centerX, centerY);
+    }
+
+    // Выводим накопленные грани до того, как поверх начнут рисовать в обход рендерера
+    m_isoRenderer->flush(renderer);
+}
+
+void TileRenderer::mergePresorted(const std::vector<std::vector<RenderableTile>>& slices) {
+    // 1. Уже добавленные тайлы (игрок, объекты) упорядочиваются отдельно - их немного
+    m_sortEntries.resize(m_tiles.size());
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        m_sortEntries[i] = { m_tiles[i].sortKey, static_cast<Uint32>(i) };
+    }
+    radixSortEntries();
+
+    // 2. Голова каждого списка; добавленные тайлы - последний список
+    struct MergeHead {
+        Uint64 key;   ///< Ключ текущего элемента
+        Uint32 list;  ///< Номер списка (меньший выигрывает при равных ключах)
+        size_t pos;   ///< Позиция текущего элемента в списке
+    };
+    const Uint32 addedList = static_cast<Uint32>(slices.size());
+
+    size_t total = m_tiles.size();
+    std::vector<MergeHead> heads;
+    heads.reserve(slices.size() + 1);
+    for (Uint32 list = 0; list < addedList; ++list) {
+        if (!slices[list].empty()) {
+            heads.push_back({ slices[list].front().sortKey, list, 0 });
+            total += slices[list].size();
+        }
+    }
+    if (!m_sortEntries.empty()) {
+        heads.push_back({ m_sortEntries.front().key, addedList, 0 });
+    }
+
+    // Куча с минимальным (ключ, список) на вершине
+    auto later = [](const MergeHead& a, const MergeHead& b) {
+        return a.key != b.key ? a.key > b.key : a.list > b.list;
+    };
+    std::make_heap(heads.begin(), heads.end(), later);
+
+    // 3. K-путевое слияние: каждый раз забираем наименьшую голову
+    m_mergeBuffer.clear();
+    m_mergeBuffer.reserve(total);
+    while (!heads.empty()) {
+        std::pop_heap(heads.begin(), heads.end(), later);
+        MergeHead& head = heads.back();
+
+        size_t size = 0;
+        if (head.list == addedList) {
+            m_mergeBuffer.push_back(m_tiles[m_sortEntries[head.pos].index]);
+            size = m_sortEntries.size();
+        }
+        else {
+            m_mergeBuffer.push_back(slices[head.list][head.pos]);
+            size = slices[head.list].size();
+        }
+
+        if (++head.pos < size) {
+            head.key = head.list == addedList ?
+                m_sortEntries[head.pos].key : slices[head.list][head.pos].sortKey;
+            std::push_heap(heads.begin(), heads.end(), later);
         }
         else {
-            // Рендеринг объемного тайла
-            m_isoRenderer->renderVolumetricTile(
-                renderer,
-                tile.worldX, tile.worldY, tile.worldZ,
-                tile.topColor, tile.leftColor, tile.rightColor,
-                centerX, centerY
-            );
+            heads.pop_back();
         }
     }
-}
\ No newline at end of file
+
+    m_tiles.swap(m_mergeBuffer);
+}
+
+void TileRenderer::renderInOrder(SDL_Renderer* renderer, int centerX, int centerY) {
+    for (const auto& tile : m_tiles) {
+        drawTile(renderer, tile, centerX, centerY);
+    }
+
+    m_isoRenderer->flush(renderer);
+}
+
+void TileRenderer::appendInOrder(const RenderableTile* tiles, size_t count) {
+    m_tiles.insert(m_tiles.end(), tiles, tiles + count);
+}
+
+void TileRenderer::drawTile(SDL_Renderer* renderer, const RenderableTile& tile, int centerX, int centerY) {
+    const TilePalette::Entry& colors = m_palette.get(tile.paletteIndex);
+    RenderStats::getInstance().addTile();
+
+    if (tile.type == RenderableTile::TileType::FLAT) {
+        // Рендеринг плоского тайла
+        m_isoRenderer->renderTile(
+            renderer,
+            tile.worldX, tile.worldY, tile.worldZ,
+            colors.top,
+            centerX, centerY
+        );
+    }
+    else {
+        // Непрозрачные блоки постоянных типов копируются из атласа
+        if (m_spriteCacheEnabled && m_spriteCache.draw(renderer, m_palette, tile.paletteIndex,
+            tile.worldX, tile.worldY, tile.worldZ, tile.faceMask, centerX, centerY)) {
+            return;
+        }
+
+        // Рендеринг объемного тайла
+        m_isoRenderer->renderVolumetricTile(
+            renderer,
+            tile.worldX, tile.worldY, tile.worldZ,
+            colors,
+            centerX, centerY,
+            tile.faceMask
+        );
+    }
+}
@@ -2,6 +2,8 @@
 
 #include "RenderableTile.h"
 #include "IsometricRenderer.h"
+#include "TilePalette.h"
+#include "BlockSpriteCache.h"
 #include "ResourceManager.h"
 #include <vector>
 #include <algorithm>
@@ -23,7 +25,9 @@ public:
     ~TileRenderer();
 
     /**
-     * @brief Очистка всех тайлов
+     * @brief Очистка всех тайлов и динамических записей палитры
+     *
+     * Вызывается в начале каждого кадра; заодно начинает кадр кэша спрайтов.
      */
     void clear();
 
@@ -37,6 +41,15 @@ public:
      */
     void addFlatTile(float x, float y, SDL_Texture* texture, SDL_Color color, float priority = 0.0f);
 
+    /**
+     * @brief Добавление плоского тайла с цветом из палитры
+     * @param x X координата в мировом пространстве
+     * @param y Y координата в мировом пространстве
+     * @param paletteIndex Индекс записи палитры (см. getPalette)
+     * @param priority Приоритет отрисовки (выше значение = отображается поверх)
+     */
+    void addFlatTile(float x, float y, Uint16 paletteIndex, float priority = 0.0f);
+
     /**
      * @brief Добавление объемного тайла
      * @param x X координата в мировом пространстве
@@ -49,6 +62,7 @@ public:
      * @param leftColor Цвет левой грани
      * @param rightColor Цвет правой грани
      * @param priority Приоритет отрисовки (выше значение = отображается поверх)
+     * @param faceMask Маска видимых граней (IsometricRenderer::FaceMask)
      */
     void addVolumetricTile(float x, float y, float z,
         SDL_Texture* topTexture,
@@ -57,7 +71,44 @@ public:
         SDL_Color topColor,
         SDL_Color leftColor,
         SDL_Color rightColor,
-        float priority = 0.0f);
+        float priority = 0.0f,
+        Uint8 faceMask = IsometricRenderer::FACE_ALL);
+
+    /**
+     * @brief Добавление объемного тайла с цветами граней из палитры
+     * @param x X координата в мировом пространстве
+     * @param y Y координата в мировом пространстве
+     * @param z Z координата (высота)
+     * @param paletteIndex Индекс записи палитры (см. getPalette)
+     * @param priority Приоритет отрисовки (выше значение = отображается поверх)
+     * @param faceMask Маска видимых граней (IsometricRenderer::FaceMask)
+     */
+    void addVolumetricTile(float x, float y, float z, Uint16 paletteIndex,
+        float priority = 0.0f,
+        Uint8 faceMask = IsometricRenderer::FACE_ALL);
+
+    /**
+     * @brief Получение палитры цветов граней
+     * @return Палитра (динамические записи живут до следующего clear)
+     */
+    TilePalette& getPalette() { return m_palette; }
+
+    /**
+     * @brief Включение или отключение вывода блоков из кэша спрайтов
+     * @param enabled true - непрозрачные блоки выводятся из атласа
+     */
+    void setSpriteCacheEnabled(bool enabled) { m_spriteCacheEnabled = enabled; }
+
+    /**
+     * @brief Проверка, включен ли кэш спрайтов блоков
+     * @return true, если кэш включен
+     */
+    bool isSpriteCacheEnabled() const { return m_spriteCacheEnabled; }
+
+    /**
+     * @brief Сброс кэша спрайтов блоков (например, после потери текстур-целей)
+     */
+    void invalidateSpriteCache() { m_spriteCache.invalidate(); }
 
     /**
      * @brief Отрисовка всех тайлов
@@ -67,7 +118,89 @@ public:
      */
     void render(SDL_Renderer* renderer, int centerX, int centerY);
 
+    /**
+     * @brief Отрисовка тайлов в порядке добавления, без сортировки
+     *
+     * Используется, когда вызывающий код уже добавил тайлы от дальних к ближним.
+     *
+     * @param renderer SDL рендерер
+     * @param centerX X координата центра экрана
+     * @param centerY Y координата центра экрана
+     */
+    void renderInOrder(SDL_Renderer* renderer, int centerX, int centerY);
+
+    /**
+     * @brief Добавление заранее построенных тайлов в конец списка
+     *
+     * Тайлы копируются как есть (палитра и маска граней уже заданы),
+     * ключ сортировки не пересчитывается - список выводится через renderInOrder().
+     *
+     * @param tiles Первый тайл
+     * @param count Количество тайлов
+     */
+    void appendInOrder(const RenderableTile* tiles, size_t count);
+
+    /**
+     * @brief Слияние заранее отсортированных списков с добавленными тайлами
+     *
+     * Каждый список должен быть упорядочен по sortKey (с сохранением порядка
+     * добавления при равных ключах). Уже добавленные тайлы сортируются сами
+     * по себе, после чего все списки сливаются в m_tiles без общей сортировки.
+     * При равных ключах раньше идут списки с меньшим номером, добавленные
+     * тайлы - последними, что совпадает с результатом render().
+     * После слияния тайлы выводятся через renderInOrder().
+     *
+     * @param slices Отсортированные списки тайлов с заданными палитрой и ключом
+     */
+    void mergePresorted(const std::vector<std::vector<RenderableTile>>& slices);
+
+    /**
+     * @brief Построение 64-битного ключа сортировки тайла
+     *
+     * Раскладка ключа (от старших битов к младшим):
+     * [приоритет x16 : 32][не используется : 8][не вода : 1][(X+Y) x2 : 17][Z x8 : 5][объемный : 1].
+     * Приоритет и диагональ помещаются без насыщения и переполнения на картах
+     * до TileMap::MAX_DIMENSION тайлов по стороне. Равные ключи сохраняют
+     * порядок добавления, что заменяет прежние сравнения по X и Y и исключает мерцание.
+     *
+     * @param tile Тайл
+     * @param type Тип тайла (TileType::EMPTY для объектов, не являющихся тайлами карты)
+     * @return Ключ сортировки (больший ключ рисуется позже)
+     */
+    static Uint64 makeSortKey(const RenderableTile& tile, TileType type);
+
 private:
+    /**
+     * @brief Элемент сортировки: ключ и индекс тайла
+     */
+    struct SortEntry {
+        Uint64 key;
+        Uint32 index;
+    };
+
+    /**
+     * @brief Устойчивая поразрядная сортировка m_sortEntries по ключу (LSD, до 8 проходов по 8 бит)
+     *
+     * Байты, одинаковые у всех ключей кадра (старшие байты приоритета,
+     * неиспользуемые биты), пропускаются без построения гистограммы.
+     */
+    void radixSortEntries();
+
+    /**
+     * @brief Отрисовка одного тайла
+     * @param renderer SDL рендерер
+     * @param tile Тайл
+     * @param centerX X координата центра экрана
+     * @param centerY Y координата центра экрана
+     */
+    void drawTile(SDL_Renderer* renderer, const RenderableTile& tile, int centerX, int centerY);
+
     std::vector<RenderableTile> m_tiles;  ///< Вектор тайлов для отрисовки
+    std::vector<SortEntry> m_sortEntries; ///< Ключи и индексы тайлов для сортировки
+    std::vector<SortEntry> m_sortScratch; ///< Временный буфер поразрядной сортировки
+    std::vector<RenderableTile> m_mergeBuffer; ///< Результат слияния отсортированных списков
+    TilePalette m_palette;                ///< Палитра цветов граней
     IsometricRenderer* m_isoRenderer;     ///< Указатель на изометрический рендерер
+    BlockSpriteCache m_spriteCache;       ///< Атлас заранее отрисованных блоков
+    bool m_spriteCacheEnabled = true;     ///< Блоки выводятся из атласа
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 ﻿#include "UIManager.h"
 #include "Logger.h"
 #include "ResourceManager.h"
+#include <algorithm>
 #include <cmath>
 
 UIManager::UIManager(Engine* engine)
@@ -8,6 +9,10 @@ UIManager::UIManager(Engine* engine)
     LOG_INFO("UIManager initialized");
 }
 
+UIManager::~UIManager() {
+    invalidateCaches();
+}
+
 void UIManager::render(SDL_Renderer* renderer,
     std::shared_ptr<IsometricRenderer> isoRenderer,
     std::shared_ptr<TileMap> tileMap,
@@ -35,6 +40,73 @@ void UIManager::render(SDL_Renderer* renderer,
         interactionSystem->getCurrentTerminal()) {
         renderTerminalInfo(renderer, interactionSystem->getCurrentTerminal());
     }
+
+    // 4. Отрисовка миникарты
+    if (m_minimapVisible && tileMap) {
+        renderMinimap(renderer, tileMap, player);
+    }
+}
+
+void UIManager::setFieldOfView(std::shared_ptr<FieldOfView> fieldOfView) {
+    m_fieldOfView = fieldOfView;
+    if (m_minimap) {
+        m_minimap->setFieldOfView(fieldOfView);
+    }
+}
+
+void UIManager::renderMinimap(SDL_Renderer* renderer, std::shared_ptr<TileMap> tileMap,
+    std::shared_ptr<Player> player) {
+    // 1. Миникарта подписана на конкретную карту - при смене карты создаем новую
+    if (!m_minimap || m_minimap->getTileMap() != tileMap.get()) {
+        m_minimap = std::make_shared<Minimap>(tileMap);
+        m_minimap->setFieldOfView(m_fieldOfView);
+    }
+
+    int mapWidth = tileMap->getWidth();
+    int mapHeight = tileMap->getHeight();
+    if (mapWidth <= 0 || mapHeight <= 0) {
+        return;
+    }
+
+    // 2. Размер на экране: целое число пикселей на тайл, для больших карт - сжатие
+    int longestSide = std::max(mapWidth, mapHeight);
+    int cellSize = MINIMAP_MAX_SIZE / longestSide;
+    SDL_Rect mapRect;
+    if (cellSize >= 1) {
+        mapRect.w = mapWidth * cellSize;
+        mapRect.h = mapHeight * cellSize;
+    }
+    else {
+        mapRect.w = mapWidth * MINIMAP_MAX_SIZE / longestSide;
+        mapRect.h = mapHeight * MINIMAP_MAX_SIZE / longestSide;
+    }
+
+    int windowWidth, windowHeight;
+    SDL_GetRendererOutputSize(renderer, &windowWidth, &windowHeight);
+    mapRect.x = windowWidth - mapRect.w - MINIMAP_MARGIN;
+    mapRect.y = MINIMAP_MARGIN;
+
+    // 3. Подложка и рамка
+    SDL_Rect frame = { mapRect.x - 2, mapRect.y - 2, mapRect.w + 4, mapRect.h + 4 };
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_RenderFillRect(renderer, &frame);
+    SDL_SetRenderDrawColor(renderer, 120, 120, 140, 255);
+    SDL_RenderDrawRect(renderer, &frame);
+
+    // 4. Сама карта - одним копированием текстуры
+    if (!m_minimap->render(renderer, mapRect)) {
+        return;
+    }
+
+    // 5. Отметка игрока
+    if (player) {
+        int markerX = mapRect.x + static_cast<int>(player->getFullX() * mapRect.w / mapWidth);
+        int markerY = mapRect.y + static_cast<int>(player->getFullY() * mapRect.h / mapHeight);
+        SDL_Rect marker = { markerX - 2, markerY - 2, 4, 4 };
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderFillRect(renderer, &marker);
+    }
 }
 
 void UIManager::renderInteractionPrompt(SDL_Renderer* renderer, const std::string& prompt) {
@@ -250,7 +322,6 @@ void UIManager::renderTerminalInfo(SDL_Renderer* renderer, std::shared_ptr<Termi
         int infoWidth = windowWidth / 2 + 100;
         int infoHeight = windowHeight / 2 + 50;
 
-        // Отрисовываем полупрозрачный прямоугольник для фона
         SDL_Rect infoRect = {
             windowWidth / 2 - infoWidth / 2,
             windowHeight / 2 - infoHeight / 2,
@@ -258,149 +329,241 @@ void UIManager::renderTerminalInfo(SDL_Renderer* renderer, std::shared_ptr<Termi
             infoHeight
         };
 
-        // Устанавливаем цвет фона
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-        SDL_SetRenderDrawColor(renderer, bgColor.r, bgColor.g, bgColor.b, bgColor.a);
+        TerminalPanelContent content;
+        content.title = terminal->getName();
+        content.header = headerText;
+        content.body = contentText;
+        content.textColor = textColor;
+        content.bgColor = bgColor;
+        content.compromised = showCompromisedMessage;
+
+        // Панель берется из кэша; каждый вариант мигания хранится отдельно
+        TerminalPanelCache& cache = m_terminalPanels[showCompromisedMessage ? 1 : 0];
+        if (!updateTerminalPanel(renderer, cache, font, content, infoWidth, infoHeight)) {
+            // Текстуры-цели недоступны - рисуем панель напрямую
+            drawTerminalPanel(renderer, font, content, infoRect, true);
+            return;
+        }
+
+        SDL_RenderCopy(renderer, cache.texture, nullptr, &infoRect);
+    }
+    else {
+        // Если шрифты недоступны, просто выводим в лог
+        LOG_INFO("Terminal info display: " + terminal->getName());
+    }
+}
+
+void UIManager::drawTerminalPanel(SDL_Renderer* renderer, TTF_Font* font,
+    const TerminalPanelContent& content, const SDL_Rect& infoRect, bool fillBackground) {
+    // Устанавливаем цвет фона
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    if (fillBackground) {
+        SDL_SetRenderDrawColor(renderer, content.bgColor.r, content.bgColor.g, content.bgColor.b, content.bgColor.a);
         SDL_RenderFillRect(renderer, &infoRect);
+    }
 
-        // Рисуем рамку для окна терминала
-        // Для предупреждения рисуем красную рамку
-        if (showCompromisedMessage) {
-            SDL_SetRenderDrawColor(renderer, 255, 70, 70, 200);
-        }
-        else {
-            SDL_SetRenderDrawColor(renderer, textColor.r, textColor.g, textColor.b, 180);
-        }
-        SDL_RenderDrawRect(renderer, &infoRect);
-
-        // Отображаем название терминала вверху (всегда)
-        std::string terminalTitle = terminal->getName();
-
-        // Рисуем заголовок
-        SDL_Surface* titleSurface = TTF_RenderText_Blended(font, terminalTitle.c_str(), textColor);
-        if (titleSurface) {
-            SDL_Texture* titleTexture = SDL_CreateTextureFromSurface(renderer, titleSurface);
-            if (titleTexture) {
-                SDL_Rect titleRect;
-                titleRect.w = titleSurface->w;
-                titleRect.h = titleSurface->h;
-                titleRect.x = windowWidth / 2 - titleRect.w / 2;
-                titleRect.y = infoRect.y + 20;
-
-                SDL_RenderCopy(renderer, titleTexture, NULL, &titleRect);
-                SDL_DestroyTexture(titleTexture);
-            }
-            SDL_FreeSurface(titleSurface);
+    // Рисуем рамку для окна терминала
+    // Для предупреждения рисуем красную рамку
+    if (content.compromised) {
+        SDL_SetRenderDrawColor(renderer, 255, 70, 70, 200);
+    }
+    else {
+        SDL_SetRenderDrawColor(renderer, content.textColor.r, content.textColor.g, content.textColor.b, 180);
+    }
+    SDL_RenderDrawRect(renderer, &infoRect);
+
+    // Рисуем заголовок
+    SDL_Surface* titleSurface = TTF_RenderText_Blended(font, content.title.c_str(), content.textColor);
+    if (titleSurface) {
+        SDL_Texture* titleTexture = SDL_CreateTextureFromSurface(renderer, titleSurface);
+        if (titleTexture) {
+            SDL_Rect titleRect;
+            titleRect.w = titleSurface->w;
+            titleRect.h = titleSurface->h;
+            titleRect.x = infoRect.x + infoRect.w / 2 - titleRect.w / 2;
+            titleRect.y = infoRect.y + 20;
+
+            SDL_RenderCopy(renderer, titleTexture, NULL, &titleRect);
+            SDL_DestroyTexture(titleTexture);
         }
+        SDL_FreeSurface(titleSurface);
+    }
 
-        // Отрисовываем разделительную линию под заголовком
-        SDL_Rect dividerRect = {
-            infoRect.x + 40,
-            infoRect.y + 55,
-            infoRect.w - 80,
-            1
-        };
-        SDL_SetRenderDrawColor(renderer, textColor.r, textColor.g, textColor.b, 150);
-        SDL_RenderFillRect(renderer, &dividerRect);
-
-        // Максимальная ширина текста для размещения внутри окна
-        int maxTextWidth = infoWidth - 100; // Оставляем отступы по бокам
-
-        // Вертикальное смещение
-        int yOffset = 80;
-
-        // Отображаем заголовок записи
-        SDL_Surface* headerSurface = TTF_RenderText_Blended(font, headerText.c_str(), textColor);
-        if (headerSurface) {
-            SDL_Texture* headerTexture = SDL_CreateTextureFromSurface(renderer, headerSurface);
-            if (headerTexture) {
-                SDL_Rect headerRect;
-                headerRect.w = headerSurface->w;
-                headerRect.h = headerSurface->h;
-                headerRect.x = infoRect.x + 40;
-                headerRect.y = infoRect.y + yOffset;
-
-                SDL_RenderCopy(renderer, headerTexture, NULL, &headerRect);
-                SDL_DestroyTexture(headerTexture);
-            }
-            SDL_FreeSurface(headerSurface);
+    // Отрисовываем разделительную линию под заголовком
+    SDL_Rect dividerRect = {
+        infoRect.x + 40,
+        infoRect.y + 55,
+        infoRect.w - 80,
+        1
+    };
+    SDL_SetRenderDrawColor(renderer, content.textColor.r, content.textColor.g, content.textColor.b, 150);
+    SDL_RenderFillRect(renderer, &dividerRect);
+
+    // Максимальная ширина текста для размещения внутри окна
+    int maxTextWidth = infoRect.w - 100; // Оставляем отступы по бокам
+
+    // Вертикальное смещение
+    int yOffset = 80;
+
+    // Отображаем заголовок записи
+    SDL_Surface* headerSurface = TTF_RenderText_Blended(font, content.header.c_str(), content.textColor);
+    if (headerSurface) {
+        SDL_Texture* headerTexture = SDL_CreateTextureFromSurface(renderer, headerSurface);
+        if (headerTexture) {
+            SDL_Rect headerRect;
+            headerRect.w = headerSurface->w;
+            headerRect.h = headerSurface->h;
+            headerRect.x = infoRect.x + 40;
+            headerRect.y = infoRect.y + yOffset;
+
+            SDL_RenderCopy(renderer, headerTexture, NULL, &headerRect);
+            SDL_DestroyTexture(headerTexture);
         }
+        SDL_FreeSurface(headerSurface);
+    }
 
-        // Создаем цвет для содержимого (немного прозрачнее)
-        SDL_Color contentColor = { textColor.r, textColor.g, textColor.b, 200 };
+    // Создаем цвет для содержимого (немного прозрачнее)
+    SDL_Color contentColor = { content.textColor.r, content.textColor.g, content.textColor.b, 200 };
 
-        // Разбиваем текст на строки, чтобы поместить их в окно
-        std::vector<std::string> lines;
+    // Разбиваем текст на строки, чтобы поместить их в окно
+    std::vector<std::string> lines;
 
-        // Разделяем текст на строки максимум по 40-45 символов
-        int maxLineLength = 40;
+    // Разделяем текст на строки максимум по 40-45 символов
+    int maxLineLength = 40;
 
-        int startPos = 0;
-        while (startPos < contentText.length()) {
-            int endPos = startPos + maxLineLength;
-            if (endPos >= contentText.length()) {
-                // Если это конец текста, добавляем оставшуюся часть
-                lines.push_back(contentText.substr(startPos));
-                break;
-            }
+    int startPos = 0;
+    while (startPos < content.body.length()) {
+        int endPos = startPos + maxLineLength;
+        if (endPos >= content.body.length()) {
+            // Если это конец текста, добавляем оставшуюся часть
+            lines.push_back(content.body.substr(startPos));
+            break;
+        }
 
-            // Находим последний пробел перед endPos
-            int lastSpace = contentText.rfind(' ', endPos);
-            if (lastSpace > startPos) {
-                // Если есть пробел, разбиваем по нему
-                lines.push_back(contentText.substr(startPos, lastSpace - startPos));
-                startPos = lastSpace + 1;
-            }
-            else {
-                // Если пробела нет, просто разбиваем по maxLineLength
-                lines.push_back(contentText.substr(startPos, maxLineLength));
-                startPos += maxLineLength;
-            }
+        // Находим последний пробел перед endPos
+        int lastSpace = content.body.rfind(' ', endPos);
+        if (lastSpace > startPos) {
+            // Если есть пробел, разбиваем по нему
+            lines.push_back(content.body.substr(startPos, lastSpace - startPos));
+            startPos = lastSpace + 1;
         }
+        else {
+            // Если пробела нет, просто разбиваем по maxLineLength
+            lines.push_back(content.body.substr(startPos, maxLineLength));
+            startPos += maxLineLength;
+        }
+    }
 
-        // Отображаем каждую строку содержимого
-        int lineOffset = 30; // Начальное смещение от заголовка
-        for (const auto& line : lines) {
-            SDL_Surface* lineSurface = TTF_RenderText_Blended(font, line.c_str(), contentColor);
-            if (lineSurface) {
-                SDL_Texture* lineTexture = SDL_CreateTextureFromSurface(renderer, lineSurface);
-                if (lineTexture) {
-                    SDL_Rect lineRect;
-                    lineRect.w = lineSurface->w;
-                    lineRect.h = lineSurface->h;
-                    lineRect.x = infoRect.x + 45; // Небольшой отступ от края
-                    lineRect.y = infoRect.y + yOffset + lineOffset;
-
-                    SDL_RenderCopy(renderer, lineTexture, NULL, &lineRect);
-                    SDL_DestroyTexture(lineTexture);
-                }
-                SDL_FreeSurface(lineSurface);
+    // Отображаем каждую строку содержимого
+    int lineOffset = 30; // Начальное смещение от заголовка
+    for (const auto& line : lines) {
+        SDL_Surface* lineSurface = TTF_RenderText_Blended(font, line.c_str(), contentColor);
+        if (lineSurface) {
+            SDL_Texture* lineTexture = SDL_CreateTextureFromSurface(renderer, lineSurface);
+            if (lineTexture) {
+                SDL_Rect lineRect;
+                lineRect.w = lineSurface->w;
+                lineRect.h = lineSurface->h;
+                lineRect.x = infoRect.x + 45; // Небольшой отступ от края
+                lineRect.y = infoRect.y + yOffset + lineOffset;
+
+                SDL_RenderCopy(renderer, lineTexture, NULL, &lineRect);
+                SDL_DestroyTexture(lineTexture);
             }
+            SDL_FreeSurface(lineSurface);
+        }
+
+        lineOffset += 25; // Переходим к следующей строке
+    }
 
-            lineOffset += 25; // Переходим к следующей строке
+    // Добавляем подсказку для закрытия внизу
+    SDL_Surface* promptSurface = TTF_RenderText_Blended(font, "Press E to close",
+        { content.textColor.r, content.textColor.g, content.textColor.b, 180 });
+    if (promptSurface) {
+        SDL_Texture* promptTexture = SDL_CreateTextureFromSurface(renderer, promptSurface);
+        if (promptTexture) {
+            SDL_Rect promptRect;
+            promptRect.w = promptSurface->w;
+            promptRect.h = promptSurface->h;
+            promptRect.x = infoRect.x + infoRect.w / 2 - promptRect.w / 2;
+            promptRect.y = infoRect.y + infoRect.h - 25;
+
+            SDL_RenderCopy(renderer, promptTexture, NULL, &promptRect);
+            SDL_DestroyTexture(promptTexture);
         }
+        SDL_FreeSurface(promptSurface);
+    }
+}
 
-        // Добавляем подсказку для закрытия внизу
-        SDL_Surface* promptSurface = TTF_RenderText_Blended(font, "Press E to close",
-            { textColor.r, textColor.g, textColor.b, 180 });
-        if (promptSurface) {
-            SDL_Texture* promptTexture = SDL_CreateTextureFromSurface(renderer, promptSurface);
-            if (promptTexture) {
-                SDL_Rect promptRect;
-                promptRect.w = promptSurface->w;
-                promptRect.h = promptSurface->h;
-                promptRect.x = windowWidth / 2 - promptRect.w / 2;
-                promptRect.y = infoRect.y + infoHeight - 25;
-
-                SDL_RenderCopy(renderer, promptTexture, NULL, &promptRect);
-                SDL_DestroyTexture(promptTexture);
-            }
-            SDL_FreeSurface(promptSurface);
+bool UIManager::updateTerminalPanel(SDL_Renderer* renderer, TerminalPanelCache& cache, TTF_Font* font,
+    const TerminalPanelContent& content, int width, int height) {
+    // 1. Панель не изменилась - используем готовую текстуру
+    if (cache.texture && cache.font == font && cache.width == width && cache.height == height &&
+        cache.content == content) {
+        return true;
+    }
+
+    if (SDL_RenderTargetSupported(renderer) != SDL_TRUE) {
+        return false;
+    }
+
+    // 2. Текстура пересоздается только при изменении размера окна
+    if (cache.texture && (cache.width != width || cache.height != height)) {
+        SDL_DestroyTexture(cache.texture);
+        cache.texture = nullptr;
+    }
+
+    if (!cache.texture) {
+        cache.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+            SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!cache.texture) {
+            LOG_WARNING("Failed to create terminal panel texture: " + std::string(SDL_GetError()));
+            return false;
         }
+        SDL_SetTextureBlendMode(cache.texture, SDL_BLENDMODE_BLEND);
     }
-    else {
-        // Если шрифты недоступны, просто выводим в лог
-        LOG_INFO("Terminal info display: " + terminal->getName());
+
+    // 3. Собираем панель в текстуре в тех же координатах относительно ее угла
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_Rect previousViewport;
+    SDL_RenderGetViewport(renderer, &previousViewport);
+    SDL_BlendMode previousBlendMode;
+    SDL_GetRenderDrawBlendMode(renderer, &previousBlendMode);
+
+    SDL_SetRenderTarget(renderer, cache.texture);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    // Фон кладется без смешивания, чтобы в текстуре осталась его собственная прозрачность
+    SDL_Rect panelRect = { 0, 0, width, height };
+    SDL_SetRenderDrawColor(renderer, content.bgColor.r, content.bgColor.g, content.bgColor.b, content.bgColor.a);
+    SDL_RenderFillRect(renderer, &panelRect);
+
+    drawTerminalPanel(renderer, font, content, panelRect, false);
+
+    SDL_SetRenderTarget(renderer, previousTarget);
+    SDL_RenderSetViewport(renderer, &previousViewport);
+    SDL_SetRenderDrawBlendMode(renderer, previousBlendMode);
+
+    cache.font = font;
+    cache.width = width;
+    cache.height = height;
+    cache.content = content;
+    return true;
+}
+
+void UIManager::invalidateCaches() {
+    for (TerminalPanelCache& cache : m_terminalPanels) {
+        if (cache.texture) {
+            SDL_DestroyTexture(cache.texture);
+            cache.texture = nullptr;
+        }
+        cache.font = nullptr;
+    }
+
+    if (m_minimap) {
+        m_minimap->releaseTexture();
     }
 }
 
@@ -7,6 +7,7 @@
 #include "Terminal.h"
 #include "InteractionSystem.h"
 #include "Door.h"
+#include "Minimap.h"
 #include <SDL.h>
 #include <memory>
 #include <string>
@@ -16,12 +17,23 @@
  */
 class UIManager {
 public:
+    static constexpr int MINIMAP_MAX_SIZE = 200;  ///< Наибольшая сторона миникарты на экране
+    static constexpr int MINIMAP_MARGIN = 10;     ///< Отступ миникарты от края экрана
+
     /**
      * @brief Конструктор
      * @param engine Указатель на движок (для доступа к ResourceManager)
      */
     UIManager(Engine* engine);
 
+    /**
+     * @brief Деструктор (освобождает кэшированные текстуры)
+     */
+    ~UIManager();
+
+    UIManager(const UIManager&) = delete;
+    UIManager& operator=(const UIManager&) = delete;
+
     /**
      * @brief Отрисовка интерфейса
      * @param renderer SDL рендерер
@@ -52,6 +64,33 @@ public:
      */
     void renderTerminalInfo(SDL_Renderer* renderer, std::shared_ptr<Terminal> terminal);
 
+    /**
+     * @brief Отрисовка миникарты в правом верхнем углу
+     * @param renderer SDL рендерер
+     * @param tileMap Указатель на карту тайлов
+     * @param player Указатель на игрока (может быть nullptr)
+     */
+    void renderMinimap(SDL_Renderer* renderer, std::shared_ptr<TileMap> tileMap,
+        std::shared_ptr<Player> player);
+
+    /**
+     * @brief Включение или отключение миникарты
+     * @param visible true - миникарта отображается
+     */
+    void setMinimapVisible(bool visible) { m_minimapVisible = visible; }
+
+    /**
+     * @brief Проверка, отображается ли миникарта
+     * @return true, если миникарта отображается
+     */
+    bool isMinimapVisible() const { return m_minimapVisible; }
+
+    /**
+     * @brief Установка поля зрения для тумана войны на миникарте
+     * @param fieldOfView Поле зрения (nullptr - карта видна целиком)
+     */
+    void setFieldOfView(std::shared_ptr<FieldOfView> fieldOfView);
+
     /**
      * @brief Отрисовка отладочной информации
      * @param renderer SDL рендерер
@@ -75,6 +114,71 @@ public:
      */
     static std::string truncateText(const std::string& text, size_t maxLength);
 
+    /**
+     * @brief Сброс кэшированных текстур (например, после потери текстур-целей)
+     */
+    void invalidateCaches();
+
 private:
-    Engine* m_engine;  ///< Указатель на движок
+    /**
+     * @brief Содержимое панели терминала
+     */
+    struct TerminalPanelContent {
+        std::string title;      ///< Название терминала
+        std::string header;     ///< Заголовок записи
+        std::string body;       ///< Текст записи
+        SDL_Color textColor{};  ///< Цвет текста
+        SDL_Color bgColor{};    ///< Цвет фона
+        bool compromised = false; ///< Показывается предупреждение о компрометации
+
+        bool operator==(const TerminalPanelContent& other) const {
+            return compromised == other.compromised &&
+                textColor.r == other.textColor.r && textColor.g == other.textColor.g &&
+                textColor.b == other.textColor.b && textColor.a == other.textColor.a &&
+                bgColor.r == other.bgColor.r && bgColor.g == other.bgColor.g &&
+                bgColor.b == other.bgColor.b && bgColor.a == other.bgColor.a &&
+                title == other.title && header == other.header && body == other.body;
+        }
+    };
+
+    /**
+     * @brief Собранная панель терминала в текстуре-цели
+     */
+    struct TerminalPanelCache {
+        SDL_Texture* texture = nullptr;  ///< Текстура панели
+        TTF_Font* font = nullptr;        ///< Шрифт, которым собрана панель
+        int width = 0;                   ///< Ширина панели
+        int height = 0;                  ///< Высота панели
+        TerminalPanelContent content;    ///< Содержимое, по которому собрана панель
+    };
+
+    /**
+     * @brief Отрисовка панели терминала (фон, рамка, заголовки, текст, подсказка)
+     * @param renderer SDL рендерер
+     * @param font Шрифт
+     * @param content Содержимое панели
+     * @param infoRect Прямоугольник панели
+     * @param fillBackground Заливать ли фон панели
+     */
+    void drawTerminalPanel(SDL_Renderer* renderer, TTF_Font* font,
+        const TerminalPanelContent& content, const SDL_Rect& infoRect, bool fillBackground);
+
+    /**
+     * @brief Пересборка панели в текстуре, если изменились содержимое, шрифт или размер
+     * @param renderer SDL рендерер
+     * @param cache Кэш панели
+     * @param font Шрифт
+     * @param content Содержимое панели
+     * @param width Ширина панели
+     * @param height Высота панели
+     * @return true, если текстура панели готова к выводу
+     */
+    bool updateTerminalPanel(SDL_Renderer* renderer, TerminalPanelCache& cache, TTF_Font* font,
+        const TerminalPanelContent& content, int width, int height);
+
+    Engine* m_engine;                         ///< Указатель на движок
+    TerminalPanelCache m_terminalPanels[2];   ///< Панели терминала: обычная и с предупреждением
+    std::shared_ptr<Minimap> m_minimap;       ///< Миникарта текущей карты
+    bool m_minimapVisible = true;             ///< Миникарта отображается
+    std::shared_ptr<FieldOfView> m_fieldOfView; ///< Поле зрения для миникарты (может быть nullptr)
 };
\ No newline at end of file
@@ -70,6 +70,11 @@ std::pair<float, float> WorldGenerator::generateTestMap(int biomeType) {
     // Генерируем карту с правильным типом биома
     roomGen.generateMap(m_tileMap.get(), roomGenBiomeType);
 
+    // Чанки, оставшиеся однородными после генерации, не должны занимать память
+    int releasedChunks = m_tileMap->compact();
+    LOG_DEBUG("Map chunks: " + std::to_string(m_tileMap->getAllocatedChunkCount()) + " allocated, " +
+        std::to_string(releasedChunks) + " compacted");
+
     // Сначала устанавливаем позицию игрока в центре карты
     float centerX = m_tileMap->getWidth() / 2.0f;
     float centerY = m_tileMap->getHeight() / 2.0f;
@@ -84,6 +84,12 @@ public:
         const std::string& name,
         Terminal::TerminalType type);
 
+    /**
+     * @brief Установка текущего биома без генерации карты (например, при загрузке уровня)
+     * @param biomeType Тип биома
+     */
+    void setCurrentBiome(int biomeType) { m_currentBiome = biomeType; }
+
 private:
     /**
      * @brief Поиск углов комнат на карте для размещения терминалов
@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <cmath>
+
+/**
+ * @brief Уровни масштаба для кэшей запеченной графики
+ *
+ * Пока масштаб камеры меняется, кэши не перезапекают графику на каждом
+ * шаге колеса мыши, а выводят ближайший из фиксированных уровней
+ * (0.5x, 1x, 2x) с растяжением. Когда масштаб не меняется STILL_FRAMES
+ * кадров подряд, кэши допекают точный масштаб в пределах бюджета на кадр.
+ */
+class ZoomMipChain {
+public:
+    static constexpr int LEVEL_COUNT = 3;   ///< Количество фиксированных уровней
+    static constexpr int STILL_FRAMES = 8;  ///< Кадров без изменения масштаба до запекания точного уровня
+
+    /**
+     * @brief Получение масштаба уровня
+     * @param index Номер уровня [0, LEVEL_COUNT)
+     * @return Масштаб уровня
+     */
+    static float getLevel(int index) {
+        static const float levels[LEVEL_COUNT] = { 0.5f, 1.0f, 2.0f };
+        return levels[index];
+    }
+
+    /**
+     * @brief Выбор ближайшего уровня
+     *
+     * Расстояние считается в логарифмах: растяжение 0.7x -> 1x
+     * и 1.4x -> 1x дают одинаковую потерю четкости.
+     *
+     * @param zoom Масштаб камеры
+     * @return Номер ближайшего уровня
+     */
+    static int nearestLevelIndex(float zoom) {
+        float logZoom = std::log2(zoom);
+        int nearest = 0;
+        for (int i = 1; i < LEVEL_COUNT; ++i) {
+            if (std::fabs(std::log2(getLevel(i)) - logZoom) < std::fabs(std::log2(getLevel(nearest)) - logZoom)) {
+                nearest = i;
+            }
+        }
+        return nearest;
+    }
+
+    /**
+     * @brief Квантование масштаба до сотых (ключ кэша)
+     * @param zoom Масштаб
+     * @return Масштаб в сотых долях
+     */
+    static int quantize(float zoom) {
+        return static_cast<int>(std::lround(zoom * 100.0f));
+    }
+
+    /**
+     * @brief Учет масштаба очередного кадра
+     * @param zoom Масштаб камеры
+     */
+    void update(float zoom) {
+        if (zoom != m_zoom) {
+            m_zoom = zoom;
+            m_stillFrames = 0;
+        }
+        else if (m_stillFrames < STILL_FRAMES) {
+            m_stillFrames++;
+        }
+    }
+
+    /**
+     * @brief Проверка, что масштаб устоялся и пора запекать точный уровень
+     * @return true, если масштаб не менялся STILL_FRAMES кадров
+     */
+    bool isStill() const { return m_stillFrames >= STILL_FRAMES; }
+
+private:
+    float m_zoom = 0.0f;     ///< Масштаб последнего кадра
+    int m_stillFrames = 0;   ///< Кадров подряд с этим масштабом
+};
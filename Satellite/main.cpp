@@ -2,6 +2,8 @@
 #include "MapScene.h"
 #include <iostream>
 #include <memory>
+#include <string>
+#include <cstdlib>
 
 int main(int argc, char* argv[]) {
     // Для работы с консольными приложениями Windows
@@ -9,8 +11,42 @@ int main(int argc, char* argv[]) {
     SDL_SetMainReady();
 #endif
 
+    // 0. Параметры командной строки:
+    //   --headless             - без дисплея (программный рендерер)
+    //   --benchmark N          - отрисовать N кадров по маршруту камеры и выйти
+    //   --benchmark-out FILE   - CSV с результатами (по умолчанию benchmark.csv)
+    //   --streaming-check      - проверить выгрузку и подгрузку чанков и выйти
+    bool headless = false;
+    bool streamingCheck = false;
+    int benchmarkFrames = 0;
+    std::string benchmarkOut = "benchmark.csv";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+        }
+        else if (arg == "--benchmark" && i + 1 < argc) {
+            benchmarkFrames = std::atoi(argv[++i]);
+        }
+        else if (arg == "--benchmark-out" && i + 1 < argc) {
+            benchmarkOut = argv[++i];
+        }
+        else if (arg == "--streaming-check") {
+            streamingCheck = true;
+        }
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+        }
+    }
+
+    // Без дисплея интерактивный режим бессмыслен - выполняем замер по умолчанию
+    if (headless && benchmarkFrames <= 0 && !streamingCheck) {
+        benchmarkFrames = 300;
+    }
+
     // 1. Создание и инициализация движка
     Engine engine("Satellite Engine - Tile System Demo", 800, 600);
+    engine.setHeadless(headless);
 
     if (!engine.initialize()) {
         std::cerr << "Failed to initialize engine. Exiting..." << std::endl;
@@ -27,6 +63,17 @@ int main(int argc, char* argv[]) {
     // 3. Установка активной сцены
     engine.setActiveScene(mapScene);
 
+    // 3.1. Режим проверки подгрузки чанков
+    if (streamingCheck) {
+        return mapScene->runStreamingCheck() ? 0 : 1;
+    }
+
+    // 3.2. Режим замера: рисуем кадры по маршруту камеры и завершаем работу
+    if (benchmarkFrames > 0) {
+        bool success = mapScene->runBenchmark(benchmarkFrames, benchmarkOut);
+        return success ? 0 : 1;
+    }
+
     // 4. Вывод инструкций
     std::cout << "\n*** Satellite Engine - Tile System Demo ***\n";
     std::cout << "Controls:\n";